@@ -410,7 +410,8 @@ enum cr_op {
     CR_STEP = 1,
     CR_UNLOAD = 2,
     CR_CLOSE = 3,
-    CR_INIT = 4
+    CR_INIT = 4,
+    CR_FIXED_STEP = 5
 };
 
 enum cr_failure {
@@ -2003,6 +2004,13 @@ extern "C" void cr_plugin_event(cr_plugin& ctx, const void* e) {
         cr_plugin_event_call(ctx, e);
 }
 
+// calls guest main with `operation` without checking for reloads, used for extra update passes
+extern "C" int cr_plugin_call(cr_plugin& ctx, enum cr_op operation) {
+    if (ctx.failure == CR_NONE)
+        return cr_plugin_main(ctx, operation);
+    return -1;
+}
+
 extern "C" void* cr_plugin_symbol(cr_plugin& ctx, const char* name)
 {
     if (ctx.failure == CR_NONE) {
@@ -0,0 +1,167 @@
+//
+// Measures log calls per second while several job threads log at the same time
+// The logger mode is set with `log_queue_policy` in rizz.ini ([rizz] section):
+//      block (default): async, producers wait when their queue is full
+//      drop: async, entries are dropped when the queue is full (see "Received")
+//      sync: no logger thread, entries are formatted and dispatched on the calling threads
+// A custom backend is registered, so entries also go through `log_entries` and Log_update
+// Redirect stdout to /dev/null (or nul) when running, so the terminal doesn't dominate the results
+//
+#include "sx/atomic.h"
+#include "sx/string.h"
+#include "sx/timer.h"
+
+#include "rizz/rizz.h"
+#include "rizz/imgui-extra.h"
+#include "rizz/imgui.h"
+
+#include "../common.h"
+
+RIZZ_STATE static rizz_api_core* the_core;
+RIZZ_STATE static rizz_api_gfx* the_gfx;
+RIZZ_STATE static rizz_api_app* the_app;
+RIZZ_STATE static rizz_api_imgui* the_imgui;
+
+typedef struct {
+    rizz_gfx_stage stage;
+    int num_jobs;
+    int calls_per_job;
+    sx_atomic_uint32 num_received;
+    uint32_t run_received;      // value of `num_received` when the last run started
+    int run_calls;
+    double run_secs;
+} logbench_state;
+
+RIZZ_STATE static logbench_state g_bench;
+
+static void logbench_backend(const rizz_log_entry* entry, void* user)
+{
+    sx_unused(entry);
+    sx_unused(user);
+    sx_atomic_fetch_add32_explicit(&g_bench.num_received, 1, SX_ATOMIC_MEMORYORDER_RELAXED);
+}
+
+static void logbench_job_cb(int start, int end, int thrd_index, void* user)
+{
+    sx_unused(thrd_index);
+    sx_unused(user);
+
+    for (int i = start; i < end; i++) {
+        for (int k = 0, c = g_bench.calls_per_job; k < c; k++) {
+            the_core->print_info(0, __FILE__, __LINE__, "bench job=%d call=%d value=%.3f name=%s", i, k,
+                                 (float)k * 0.5f, "logbench");
+        }
+    }
+}
+
+static void logbench_run(void)
+{
+    g_bench.run_received = sx_atomic_load32(&g_bench.num_received);
+    g_bench.run_calls = g_bench.num_jobs * g_bench.calls_per_job;
+
+    uint64_t start_tm = sx_tm_now();
+    sx_job_t job = the_core->job_dispatch(g_bench.num_jobs, logbench_job_cb, NULL, SX_JOB_PRIORITY_HIGH, 0);
+    the_core->job_wait_and_del(job);
+    g_bench.run_secs = sx_tm_sec(sx_tm_since(start_tm));
+
+    rizz_log_warn("logbench: %d jobs x %d calls: %.3f ms, %.3f M calls/s", g_bench.num_jobs,
+                  g_bench.calls_per_job, g_bench.run_secs * 1000.0,
+                  (double)g_bench.run_calls / g_bench.run_secs / 1000000.0);
+}
+
+static bool init()
+{
+    g_bench.stage = the_gfx->stage_register("main", (rizz_gfx_stage){ .id = 0 });
+    sx_assert(g_bench.stage.id);
+
+    g_bench.num_jobs = 4;
+    g_bench.calls_per_job = 50000;
+    the_core->register_log_backend("logbench", logbench_backend, NULL);
+    return true;
+}
+
+static void shutdown()
+{
+    the_core->unregister_log_backend("logbench");
+}
+
+static void render()
+{
+    sg_pass_action pass_action = { .colors[0] = { SG_ACTION_CLEAR, { 0.25f, 0.5f, 0.75f, 1.0f } },
+                                   .depth = { SG_ACTION_DONTCARE, 1.0f } };
+
+    the_gfx->staged.begin(g_bench.stage);
+    the_gfx->staged.begin_default_pass(&pass_action, the_app->width(), the_app->height());
+    the_gfx->staged.end_pass();
+    the_gfx->staged.end();
+
+    show_debugmenu(the_imgui, the_core);
+
+    if (the_imgui->Begin("LogBench", NULL, 0)) {
+        the_imgui->LabelText("Job threads", "%d", the_core->job_num_threads());
+        the_imgui->SliderInt("Jobs", &g_bench.num_jobs, 1, 64, "%d", 0);
+        the_imgui->SliderInt("Calls per job", &g_bench.calls_per_job, 1000, 200000, "%d", 0);
+        if (the_imgui->Button("Run", SX_VEC2_ZERO)) {
+            logbench_run();
+        }
+
+        if (g_bench.run_calls > 0) {
+            the_imgui->Separator();
+            the_imgui->LabelText("Time", "%.3f ms", g_bench.run_secs * 1000.0);
+            the_imgui->LabelText("Calls/s", "%.3f M",
+                                 (double)g_bench.run_calls / g_bench.run_secs / 1000000.0);
+            // custom backends receive entries on the main thread, so this keeps growing for a few frames
+            the_imgui->LabelText("Received", "%u of %d",
+                                 sx_atomic_load32(&g_bench.num_received) - g_bench.run_received,
+                                 g_bench.run_calls);
+        }
+    }
+    the_imgui->End();
+}
+
+rizz_plugin_decl_main(logbench, plugin, e)
+{
+    switch (e) {
+    case RIZZ_PLUGIN_EVENT_STEP:
+        render();
+        break;
+
+    case RIZZ_PLUGIN_EVENT_INIT:
+        the_core = plugin->api->get_api(RIZZ_API_CORE, 0);
+        the_gfx = plugin->api->get_api(RIZZ_API_GFX, 0);
+        the_app = plugin->api->get_api(RIZZ_API_APP, 0);
+        the_imgui = plugin->api->get_api_byname("imgui", 0);
+
+        init();
+        break;
+
+    case RIZZ_PLUGIN_EVENT_LOAD:
+        break;
+
+    case RIZZ_PLUGIN_EVENT_UNLOAD:
+        break;
+
+    case RIZZ_PLUGIN_EVENT_SHUTDOWN:
+        shutdown();
+        break;
+    }
+
+    return 0;
+}
+
+rizz_plugin_decl_event_handler(logbench, e)
+{
+    sx_unused(e);
+}
+
+rizz_game_decl_config(conf)
+{
+    conf->app_name = "logbench";
+    conf->app_version = 1000;
+    conf->app_title = "13 - LogBench";
+    conf->app_flags |= RIZZ_APP_FLAG_HIGHDPI;
+    conf->window_width = EXAMPLES_DEFAULT_WIDTH;
+    conf->window_height = EXAMPLES_DEFAULT_HEIGHT;
+    conf->swap_interval = 2;
+    conf->plugins[0] = "imgui";
+}
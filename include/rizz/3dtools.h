@@ -114,6 +114,13 @@ typedef struct { uint32_t id; } rizz_material;
 //      The catch is when you setup your pipeline, all shaders should comply for one or more vertex-buffer formats
 //      So in our example, every shader must take one of the 4 buffer formats or multiple of them
 // vertex_attrs is all vertex attributes of the source model and is not related for vertex buffer formats
+// attribute formats in the layout can be compressed, the source data is converted on load:
+//      - FLOATx: copied as is
+//      - POSITION with USHORT4N: quantized inside mesh bounds (rizz_model_mesh.bounds), w is 1.0
+//        reconstruct in the shader with: pos = bounds.min + v.xyz*(bounds.max - bounds.min)
+//      - NORMAL/TANGENT/BINORMAL with SHORT2N: octahedral encoded unit vectors (tangent.w is lost)
+//      - other SHORTxN/BYTE4N: snorm, USHORTxN/UBYTE4N: unorm (clamped to [-1, 1] and [0, 1])
+//      - SHORTx/BYTE4/UBYTE4: integers (joint indices)
 // gpu_t struct is created only for models without STREAM buffer flag
 //
 // mandate:
@@ -165,6 +172,7 @@ typedef struct rizz_model_mesh {
     int num_vbuffs;
     sg_index_type index_type;
     rizz_model_submesh* submeshes;
+    sx_aabb bounds;     // bounds of all vertices, also used for dequantizing USHORT4N positions
 
     struct cpu_t {
         void* vbuffs[SG_MAX_SHADERSTAGE_BUFFERS];      // arbitary struct for each vbuff (count=num_vbuffs)
@@ -120,6 +120,11 @@
 #    define RIZZ_CONFIG_MAX_PLUGINS 64
 #endif
 
+// maximum number of variables that can be registered with `rizz_api_core.tls_register`
+#ifndef RIZZ_CONFIG_MAX_TLS_VARS
+#    define RIZZ_CONFIG_MAX_TLS_VARS 32
+#endif
+
 #ifndef RIZZ_CONFIG_EVENTQUEUE_MAX_EVENTS
 #    define RIZZ_CONFIG_EVENTQUEUE_MAX_EVENTS 4
 #endif
@@ -128,6 +133,40 @@
 #    define RIZZ_CONFIG_PROFILER (~RIZZ_FINAL)
 #endif
 
+// number of begin/end events in each block of profile captures. each thread records into it's own
+// block and full blocks are streamed to the trace file by the capture's writer thread
+#ifndef RIZZ_CONFIG_PROFILE_CAPTURE_EVENTS
+#    define RIZZ_CONFIG_PROFILE_CAPTURE_EVENTS 8192
+#endif
+
+// size of the per-thread ring buffer (in begin/end events) for always-on frame profiler history
+// this caps the history that is dumped on frame spikes for threads with many samples. must be power-of-two
+#ifndef RIZZ_CONFIG_PROFILE_HISTORY_EVENTS
+#    define RIZZ_CONFIG_PROFILE_HISTORY_EVENTS 16384
+#endif
+
+// number of records in each thread's log queue, the logger thread formats and dispatches them
+// when the queue is full, `rizz_config.log_queue_policy` decides to block or drop. must be power-of-two
+#ifndef RIZZ_CONFIG_LOG_QUEUE_SIZE
+#    define RIZZ_CONFIG_LOG_QUEUE_SIZE 512
+#endif
+
+// size of each log record in bytes, format string, arguments and strings are packed into the record
+// texts that don't fit are formatted on the calling thread and allocated from heap
+#ifndef RIZZ_CONFIG_LOG_RECORD_SIZE
+#    define RIZZ_CONFIG_LOG_RECORD_SIZE 256
+#endif
+
+// binary log files (RIZZ_CORE_FLAG_LOG_TO_BINARY_FILE) are rotated when they exceed this size (bytes)
+// only the last RIZZ_CONFIG_LOG_BINARY_FILE_COUNT files are kept (app.rlog, app.1.rlog, ...)
+#ifndef RIZZ_CONFIG_LOG_BINARY_FILE_SIZE
+#    define RIZZ_CONFIG_LOG_BINARY_FILE_SIZE 0x1000000
+#endif
+
+#ifndef RIZZ_CONFIG_LOG_BINARY_FILE_COUNT
+#    define RIZZ_CONFIG_LOG_BINARY_FILE_COUNT 4
+#endif
+
 #ifndef RIZZ_MAX_PATH
 #    define RIZZ_MAX_PATH 256
 #endif
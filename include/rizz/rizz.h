@@ -513,6 +513,21 @@ typedef struct rizz_api_camera {
     void (*calc_frustum_points)(const rizz_camera* cam, sx_vec3 frustum[8]);
     void (*calc_frustum_points_range)(const rizz_camera* cam, sx_vec3 frustum[8], float fnear, float ffar);
     void (*calc_frustum_planes)(sx_plane frustum[_RIZZ_CAMERA_VIEWPLANE_COUNT], const sx_mat4* viewproj_mat);
+
+    // batch culling against frustum planes (from calc_frustum_planes)
+    // out_visible_bits: one bit per item (bit (i%32) of word [i/32]), set if the item is visible
+    //                   must hold at least (count+31)/32 words, all the words are overwritten
+    // spheres: xyz = center, w = radius
+    // _mt versions split big batches into jobs and wait for them, don't call them from jobs
+    // that hold locks
+    void (*cull_aabbs)(const sx_plane planes[_RIZZ_CAMERA_VIEWPLANE_COUNT], const sx_aabb* aabbs,
+                       int count, uint32_t* out_visible_bits);
+    void (*cull_spheres)(const sx_plane planes[_RIZZ_CAMERA_VIEWPLANE_COUNT], const sx_vec4* spheres,
+                         int count, uint32_t* out_visible_bits);
+    void (*cull_aabbs_mt)(const sx_plane planes[_RIZZ_CAMERA_VIEWPLANE_COUNT], const sx_aabb* aabbs,
+                          int count, uint32_t* out_visible_bits);
+    void (*cull_spheres_mt)(const sx_plane planes[_RIZZ_CAMERA_VIEWPLANE_COUNT],
+                            const sx_vec4* spheres, int count, uint32_t* out_visible_bits);
     void (*fps_init)(rizz_camera_fps* cam, float fov_deg, sx_rect viewport, float fnear, float ffar);
     void (*fps_lookat)(rizz_camera_fps* cam, sx_vec3 pos, sx_vec3 target, sx_vec3 up);
     void (*fps_pitch)(rizz_camera_fps* cam, float pitch);
@@ -549,7 +564,9 @@ enum rizz_core_flags_ {
     RIZZ_CORE_FLAG_DETECT_LEAKS = 0x10,         // Detect memory leaks (default on in _DEBUG builds)
     RIZZ_CORE_FLAG_HEAP_TEMP_ALLOCATOR = 0x20,  // Replace temp allocator backends with heap, so we can better trace out-of-bounds and corruption
     RIZZ_CORE_FLAG_HOT_RELOAD_PLUGINS = 0x40,   // Enables hot reloading for all modules and plugins including the game itself
-    RIZZ_CORE_FLAG_TRACE_TEMP_ALLOCATOR = 0x80  // Enable memory tracing on temp allocators, slows them down, but provides more insight on temp allocations
+    RIZZ_CORE_FLAG_TRACE_TEMP_ALLOCATOR = 0x80, // Enable memory tracing on temp allocators, slows them down, but provides more insight on temp allocations
+    RIZZ_CORE_FLAG_SAMPLE_ALLOCATIONS = 0x100,  // Use sampling memory tracing (RIZZ_MEMOPTION_SAMPLE_ALLOCS) instead of tracing every allocation, suitable for release builds
+    RIZZ_CORE_FLAG_LOG_TO_BINARY_FILE = 0x200   // log to binary file `app_name.rlog` (unformatted, rotated by size), view with scripts/log-tools/rlog-view.py
 };
 typedef uint32_t rizz_core_flags;
 
@@ -563,16 +580,40 @@ typedef enum rizz_log_level {
     _RIZZ_LOG_LEVEL_COUNT
 } rizz_log_level;
 
+// what happens when a thread's log queue is full (see RIZZ_CONFIG_LOG_QUEUE_SIZE)
+typedef enum rizz_log_queue_policy {
+    RIZZ_LOG_QUEUE_POLICY_BLOCK = 0,    // wait for the logger thread to make room
+    RIZZ_LOG_QUEUE_POLICY_DROP,         // drop the entry (errors are never dropped)
+    RIZZ_LOG_QUEUE_POLICY_SYNC          // no logger thread, format and dispatch on the calling thread
+} rizz_log_queue_policy;
+
 enum rizz_mem_options_ {
-    RIZZ_MEMOPTION_TRACE_CALLSTACK  = 0x1,  // Stores callstacks per allocation call
-    RIZZ_MEMOPTION_INSERT_CANARIES  = 0x4,  // inserts canaries for out of boundary detection
-    RIZZ_MEMOPTION_MULTITHREAD      = 0x8,  // allocation calls can be called from multiple threads
-    RIZZ_MEMOPTION_ALL              = 0xf   // all options above
+    RIZZ_MEMOPTION_TRACE_CALLSTACK    = 0x1,  // Stores callstacks per allocation call
+    RIZZ_MEMOPTION_COUNT_FRAME_ALLOCS = 0x2,  // Counts allocation calls per-frame (see trace_alloc_frame_stats)
+    RIZZ_MEMOPTION_INSERT_CANARIES    = 0x4,  // inserts canaries for out of boundary detection
+    RIZZ_MEMOPTION_MULTITHREAD        = 0x8,  // allocation calls can be called from multiple threads
+    RIZZ_MEMOPTION_ALL                = 0xf,  // all options above
+    RIZZ_MEMOPTION_SAMPLE_ALLOCS      = 0x10  // Only traces one allocation every N bytes (see trace_alloc_set_sample_interval)
+                                              // and scales the stats, so they are un-biased estimates 
 };
 typedef uint32_t rizz_mem_options;
 
 #define RIZZ_MEMOPTION_INHERIT 0xffffffff
 
+// allocation counts of a trace allocator (and it's children) in the previous frame
+typedef struct rizz_mem_frame_stats {
+    uint32_t num_allocs;        // malloc/realloc calls
+    uint32_t num_frees;
+    uint32_t peak_num_allocs;   // maximum `num_allocs` of all frames since allocator is created
+    uint64_t alloc_size;        // total bytes requested by malloc/realloc calls
+} rizz_mem_frame_stats;
+
+typedef enum rizz_mem_sample_format {
+    RIZZ_MEM_SAMPLE_FORMAT_PPROF = 0,           // legacy pprof heap profile text (in-use and allocated)
+    RIZZ_MEM_SAMPLE_FORMAT_COLLAPSED_INUSE,     // flamegraph collapsed stacks, weighted by in-use bytes
+    RIZZ_MEM_SAMPLE_FORMAT_COLLAPSED_ALLOC      // flamegraph collapsed stacks, weighted by allocated bytes
+} rizz_mem_sample_format;
+
 // main app/game config
 typedef struct rizz_config {
     const char* app_name;
@@ -584,6 +625,7 @@ typedef struct rizz_config {
     rizz_app_flags app_flags;
     rizz_core_flags core_flags;
     rizz_log_level log_level;   // default = RIZZ_LOG_LEVEL_INFO 
+    rizz_log_queue_policy log_queue_policy; // default = RIZZ_LOG_QUEUE_POLICY_BLOCK
 
     const char* plugins[RIZZ_CONFIG_MAX_PLUGINS];
     const char* _dummy;     // this is always initialized to 0, so we can count plugins array
@@ -608,9 +650,23 @@ typedef struct rizz_config {
 
     int tmp_mem_max;        // per-frame temp memory size. in kbytes (default: 10mb per-thread)
 
+    // fixed-step: when fixed_step_rate > 0, RIZZ_PLUGIN_EVENT_FIXED_STEP is sent to plugins
+    //             `fixed_step_rate` times per second of frame time (before STEP event), with a
+    //             constant delta of `fixed_step_dt`. simulation runs at most `fixed_step_max_steps`
+    //             times per frame and the rest of the time is dropped, so hitches can't snowball
+    //             use `fixed_step_alpha` in STEP to interpolate between the last two fixed states
+    int fixed_step_rate;        // steps per second (default = 0, disabled)
+    int fixed_step_max_steps;   // default = 5
+
     int profiler_listen_port;           // default: 17815
     int profiler_update_interval_ms;    // default: 10ms
 
+    // frame profiler always keeps the last `profiler_history_secs` of profile samples from all threads
+    // when a frame takes longer than `profiler_spike_threshold_ms`, the history is dumped to
+    // .profiler/spike_<frame>_<ms>.json (chrome trace format). also see `profile_history_dump`
+    int profiler_history_secs;          // default: 2
+    float profiler_spike_threshold_ms;  // default: 0 (disabled)
+
     bool imgui_docking;     // Enable imgui docking. (also see rizz_api_imgui_extra.dock_space_id)
 } rizz_config;
 
@@ -652,6 +708,36 @@ RIZZ_API void ANativeActivity_onCreate_(ANativeActivity*, void*, size_t);
 // return >= 0 for success and -1 for failure
 typedef int(rizz_core_cmd_cb)(int argc, char* argv[], void* user);
 
+// frame tasks: per-frame work is scheduled by core as a dependency graph. built-in sub-systems
+//              (http, vfs, assets, gfx, coroutines, plugin updates, logs, imgui) are tasks too
+//              every task declares the resources it reads and writes. a task waits for all tasks 
+//              that were added before it and have conflicting access (write/write or read/write)
+//              tasks without conflicts run concurrently, and tasks without MAIN_THREAD flag are 
+//              dispatched to job threads
+//              built-in tasks run user code (plugin updates, coroutines, console commands) on the 
+//              main thread, and declare write access to all built-in resources
+//              so tasks that only need their own resources (RIZZ_FRAME_RES_USER bits) run in 
+//              parallel with the whole frame
+enum rizz_frame_res_ {
+    RIZZ_FRAME_RES_GPU = 0x1,           // gfx objects and queues (create/destroy/execute)
+    RIZZ_FRAME_RES_ASSET = 0x2,         // asset database and async loads
+    RIZZ_FRAME_RES_VFS = 0x4,           // async vfs callbacks
+    RIZZ_FRAME_RES_HTTP = 0x8,
+    RIZZ_FRAME_RES_CORO = 0x10,
+    RIZZ_FRAME_RES_PLUGIN = 0x20,       // plugin and application state
+    RIZZ_FRAME_RES_LOG = 0x40,          // log backends
+    RIZZ_FRAME_RES_BUILTIN = 0xffff,    // all built-in resources
+    RIZZ_FRAME_RES_USER = 0x10000       // first user-defined resource bit (up to 0x80000000)
+};
+typedef uint32_t rizz_frame_res;
+
+enum rizz_frame_task_flags_ { 
+    RIZZ_FRAME_TASK_MAIN_THREAD = 0x1 
+};
+typedef uint32_t rizz_frame_task_flags;
+
+typedef void(rizz_frame_task_cb)(float dt, void* user);
+
 typedef struct rizz_log_entry {
     rizz_log_level type;
     uint32_t channels;
@@ -691,19 +777,40 @@ typedef struct rizz_api_core {
 
     // TLS functions are used for setting TLS variables to worker threads by an external source
     // register: use name to identify the variable (Id). (not thread-safe)
+    //           returns the slot of the variable, that can be used with `tls_var_slot`
+    //           maximum number of variables is RIZZ_CONFIG_MAX_TLS_VARS
     // tls_var: gets pointer to variable, (thread-safe)
     //          `init_cb` will be called on the thread if it's the first time the variable is
     //          is fetched. you should initialize the variable and return it's pointer
     //          destroying tls variables are up to the user, after variable is destroyed, the return
     //          value of tls_var may be invalid
-    void (*tls_register)(const char* name, void* user,
-                         void* (*init_cb)(int thread_idx, uint32_t thread_id, void* user));
+    // tls_var_slot: same as tls_var, but without name lookup. use this in hot paths
+    int (*tls_register)(const char* name, void* user,
+                        void* (*init_cb)(int thread_idx, uint32_t thread_id, void* user));
     void* (*tls_var)(const char* name);
+    void* (*tls_var_slot)(int slot);
 
     sx_alloc* (*trace_alloc_create)(const char* name, rizz_mem_options mem_opts, const char* parent, const sx_alloc* alloc);
     void (*trace_alloc_destroy)(sx_alloc* alloc);
     void (*trace_alloc_clear)(sx_alloc* alloc);
+    // captures are streamed to `.memory/<name>.rmem` (next to executable) during the frame(s), 
+    // use scripts/profile-tools/mem-capture-to-json.py to convert them to json
     void (*trace_alloc_capture_frame)(void);
+    void (*trace_alloc_capture_frames)(int num_frames);
+    // needs RIZZ_MEMOPTION_COUNT_FRAME_ALLOCS option on the allocator, otherwise returns zeros
+    rizz_mem_frame_stats (*trace_alloc_frame_stats)(const sx_alloc* alloc);
+    // steady-state scopes: code between begin/end (on the calling thread) should not allocate from 
+    //                      any trace allocator that counts frame allocs, after `warmup_frames` is 
+    //                      passed since the first time `tag` is seen. 
+    //                      Allocations in these scopes are reported as errors with assert
+    //                      use `rizz_mem_steady_state` macro for convenience
+    void (*trace_alloc_steady_state_begin)(const char* tag, int warmup_frames);
+    void (*trace_alloc_steady_state_end)(void);
+    // sampling: allocators with RIZZ_MEMOPTION_SAMPLE_ALLOCS record one allocation every `interval`
+    //           bytes on average (default: 512kb), picked randomly. stats are collected per-callsite
+    //           `sample_dump` writes them to file. pass NULL filepath to write to `.memory` directory
+    void (*trace_alloc_set_sample_interval)(uint32_t interval);
+    bool (*trace_alloc_sample_dump)(const char* filepath, rizz_mem_sample_format format);
 
     rizz_version (*version)(void);
 
@@ -713,6 +820,11 @@ typedef struct rizz_api_core {
     float (*fps)(void);
     float (*fps_mean)(void);
     int64_t (*frame_index)(void);
+    // fixed-step, see rizz_config.fixed_step_rate. rate=0 disables fixed steps
+    void (*set_fixed_step_rate)(int steps_per_sec);
+    float (*fixed_step_dt)(void);
+    float (*fixed_step_alpha)(void);        // [0, 1) remaining fraction of a step after last fixed step
+    int64_t (*fixed_step_index)(void);      // total number of fixed steps so far
     void (*pause)(void);
     void (*resume)(void);
     bool (*is_paused)(void);
@@ -739,6 +851,9 @@ typedef struct rizz_api_core {
     int (*job_thread_index)(void);
 
     void (*coro_invoke)(void (*coro_cb)(sx_fiber_transfer), void* user);
+    // same as coro_invoke, but after the first yield/wait, the coroutine is resumed on job threads 
+    // concurrently with other job coroutines. use it for scripts that don't touch main-thread state
+    void (*coro_invoke_job)(void (*coro_cb)(sx_fiber_transfer), void* user);
     void (*coro_end)(void* pfrom);
     void (*coro_wait)(void* pfrom, int msecs);
     void (*coro_yield)(void* pfrom, int nframes);
@@ -748,6 +863,9 @@ typedef struct rizz_api_core {
     void (*unregister_log_backend)(const char* name);
 
     // use rizz_log_xxxx macros instead of these
+    // entries are formatted and dispatched by the logger thread. `fmt` and string arguments are copied
+    // so they can be temporary buffers, but `source_file` must stay valid (use __FILE__)
+    // errors return after they are dispatched to the built-in backends
     void (*print_info)(uint32_t channels, const char* source_file, int line, const char* fmt, ...);
     void (*print_debug)(uint32_t channels, const char* source_file, int line, const char* fmt, ...);
     void (*print_verbose)(uint32_t channels, const char* source_file, int line, const char* fmt, ...);
@@ -758,13 +876,25 @@ typedef struct rizz_api_core {
     void (*begin_profile_sample)(const char* name, rizz_profile_flags flags, uint32_t* hash_cache);
     void (*end_profile_sample)(void);
 
+    // profile captures are streamed to .profiler/<filename>.rtrace (binary), the file is created when
+    // the first block of samples is full, or when the capture ends
+    // use scripts/profile-tools/profile-trace-convert.py to convert them to chrome json or perfetto trace
     rizz_profile_capture (*profile_capture_create)(const char* filename);
     void (*profile_capture_end)(rizz_profile_capture tp);
     void (*profile_capture_sample_begin)(rizz_profile_capture tp, const char* name, const char* file, uint32_t line);
     void (*profile_capture_sample_end)(rizz_profile_capture tp);
     rizz_profile_capture (*profile_capture_startup)(void);
+    // takes a snapshot of the frame profiler history, which is written to .profiler/<name>.json in the
+    // background. returns false if the snapshot could not be taken
+    bool (*profile_history_dump)(const char* name);
 
     void (*register_console_command)(const char* cmd, rizz_core_cmd_cb* callback, const char* shortcut, void* user);
+
+    // frame tasks (see rizz_frame_res_ comments). changes take effect on the next frame
+    // `name` must be unique. add/remove must only be called from the main thread
+    void (*frame_task_add)(const char* name, rizz_frame_task_cb* task_fn, void* user,
+                           rizz_frame_res reads, rizz_frame_res writes, rizz_frame_task_flags flags);
+    void (*frame_task_remove)(const char* name);
     void (*execute_console_command)(const char* cmd_and_args);
 
     // debugging
@@ -802,6 +932,7 @@ typedef struct rizz_api_core {
 #define rizz_coro_yieldn(_n)             (RIZZ_CORE_API_VARNAME)->coro_yield(&__transfer.from, (_n))
 #define rizz_coro_end()                  (RIZZ_CORE_API_VARNAME)->coro_end(&__transfer.from)
 #define rizz_coro_invoke(_name, _user)   (RIZZ_CORE_API_VARNAME)->coro_invoke(coro__##_name, (_user))
+#define rizz_coro_invoke_job(_name, _user) (RIZZ_CORE_API_VARNAME)->coro_invoke_job(coro__##_name, (_user))
 
 // using these macros are preferred to begin_profile_sample() and end_profile_sample()
 // because They provide cache variables for name hashing and also somewhat emulates C++ RAII
@@ -835,6 +966,14 @@ typedef struct rizz_api_core {
 #define rizz_profile_startup_begin(_name)   (RIZZ_CORE_API_VARNAME)->profile_capture_sample_begin((RIZZ_CORE_API_VARNAME)->profile_capture_startup(), _name, __FILE__, __LINE__)
 #define rizz_profile_startup_end()          (RIZZ_CORE_API_VARNAME)->profile_capture_sample_end((RIZZ_CORE_API_VARNAME)->profile_capture_startup())
 
+// usage pattern:
+// rizz_mem_steady_state("physics", 10) {
+//  ...
+// } // any trace allocation inside the block after 10 frames is reported
+#define rizz_mem_steady_state(_tag, _warmup_frames) \
+            sx_defer((RIZZ_CORE_API_VARNAME)->trace_alloc_steady_state_begin(_tag, _warmup_frames), \
+                     (RIZZ_CORE_API_VARNAME)->trace_alloc_steady_state_end())
+
 #define rizz_with_temp_alloc(_name) sx_with(const sx_alloc* _name = (RIZZ_CORE_API_VARNAME)->tmp_alloc_push(), \
                                             (RIZZ_CORE_API_VARNAME)->tmp_alloc_pop()) 
 
@@ -993,12 +1132,27 @@ typedef enum rizz_gfx_perframe_trace_zone {
     _RIZZ_GFX_TRACE_COUNT
 } rizz_gfx_perframe_trace_zone;
 
+// gpu time of a profile sample (staged/immediate begin_profile_sample), stages are profiled as
+// "Stage: <name>" samples
+typedef struct rizz_gfx_gpu_sample {
+    char name[32];
+    int depth;      // nesting depth of the sample, 0 is the top-level
+    float ms;
+} rizz_gfx_gpu_sample;
+
 typedef struct rizz_gfx_perframe_trace_info {
     int num_draws;
     int num_instances;
     int num_apply_pipelines;
     int num_apply_passes;
     int num_elements;
+
+    // gpu timing, only on RIZZ_GFX_TRACE_COMMON zone, requires RIZZ_CORE_FLAG_PROFILE_GPU and GL 3.3 backend
+    // results are read back with a few frames of latency, `gpu_frame` is the frame index they belong to
+    int64_t gpu_frame;
+    float gpu_ms;                               // from the first to the last sample of the frame
+    int num_gpu_samples;
+    const rizz_gfx_gpu_sample* gpu_samples;     // in the order of begin calls
 } rizz_gfx_perframe_trace_info;
 
 typedef struct rizz_gfx_trace_info {
@@ -1359,7 +1513,8 @@ typedef enum rizz_plugin_event {
     RIZZ_PLUGIN_EVENT_STEP = 1,
     RIZZ_PLUGIN_EVENT_UNLOAD = 2,
     RIZZ_PLUGIN_EVENT_SHUTDOWN = 3,
-    RIZZ_PLUGIN_EVENT_INIT = 4
+    RIZZ_PLUGIN_EVENT_INIT = 4,
+    RIZZ_PLUGIN_EVENT_FIXED_STEP = 5    // see rizz_config.fixed_step_rate
 } rizz_plugin_event;
 
 typedef enum rizz_plugin_crash {
@@ -1378,7 +1533,14 @@ typedef enum rizz_plugin_crash {
     RIZZ_PLUGIN_CRASH_USER = 0x100,
 } rizz_plugin_crash;
 
-enum rizz_plugin_info_flags_ { RIZZ_PLUGIN_INFO_EVENT_HANDLER = 0x1 };
+// RIZZ_PLUGIN_INFO_UPDATE_ON_JOB: plugin's RIZZ_PLUGIN_EVENT_STEP runs on a job thread, after all of
+//                                 it's dependencies are stepped and concurrently with the plugins that
+//                                 it doesn't depend on. rendering must be done with `the_gfx->staged`
+//                                 the flag is ignored (step runs on main thread) if hot-reload is enabled
+enum rizz_plugin_info_flags_ {
+    RIZZ_PLUGIN_INFO_EVENT_HANDLER = 0x1,
+    RIZZ_PLUGIN_INFO_UPDATE_ON_JOB = 0x2
+};
 typedef uint32_t rizz_plugin_info_flags;
 
 // Plugins should implement these functions (names should be the same without the _cb)
@@ -1396,6 +1558,7 @@ typedef struct rizz_plugin_info {
     int num_deps;
     char name[32];
     char desc[256];
+    rizz_plugin_info_flags flags;
 
 #ifdef RIZZ_BUNDLE
     // These callback functions are automatically assigned by auto-generated script (see
@@ -1431,14 +1594,15 @@ typedef struct rizz_plugin {
 #    define rizz_plugin_decl_event_handler(_name, __event_param_name) \
         RIZZ_PLUGIN_EXPORT void rizz_plugin_event_handler(const rizz_app_event* __event_param_name)
 
-#    define rizz_plugin_implement_info(_name, _version, _desc, _deps, _num_deps) \
-        RIZZ_PLUGIN_EXPORT void rizz_plugin_get_info(rizz_plugin_info* out_info) \
-        {                                                                        \
-            out_info->version = (_version);                                      \
-            out_info->deps = (_deps);                                            \
-            out_info->num_deps = (_num_deps);                                    \
-            sx_strcpy(out_info->name, sizeof(out_info->name), #_name);           \
-            sx_strcpy(out_info->desc, sizeof(out_info->desc), (_desc));          \
+#    define rizz_plugin_implement_info_flags(_name, _version, _desc, _deps, _num_deps, _flags) \
+        RIZZ_PLUGIN_EXPORT void rizz_plugin_get_info(rizz_plugin_info* out_info)               \
+        {                                                                                      \
+            out_info->version = (_version);                                                    \
+            out_info->deps = (_deps);                                                          \
+            out_info->num_deps = (_num_deps);                                                  \
+            out_info->flags = (_flags);                                                        \
+            sx_strcpy(out_info->name, sizeof(out_info->name), #_name);                         \
+            sx_strcpy(out_info->desc, sizeof(out_info->desc), (_desc));                        \
         }
 #else
 #    define rizz_plugin_decl_main(_name, _plugin_param_name, _event_param_name)          \
@@ -1448,17 +1612,21 @@ typedef struct rizz_plugin {
         RIZZ_PLUGIN_EXPORT void rizz_plugin_event_handler_##_name(    \
             const rizz_app_event* __event_param_name)
 
-#    define rizz_plugin_implement_info(_name, _version, _desc, _deps, _num_deps)         \
-        RIZZ_PLUGIN_EXPORT void rizz_plugin_get_info_##_name(rizz_plugin_info* out_info) \
-        {                                                                                \
-            out_info->version = (_version);                                              \
-            out_info->deps = (_deps);                                                    \
-            out_info->num_deps = (_num_deps);                                            \
-            sx_strcpy(out_info->name, sizeof(out_info->name), #_name);                   \
-            sx_strcpy(out_info->desc, sizeof(out_info->desc), (_desc));                  \
+#    define rizz_plugin_implement_info_flags(_name, _version, _desc, _deps, _num_deps, _flags) \
+        RIZZ_PLUGIN_EXPORT void rizz_plugin_get_info_##_name(rizz_plugin_info* out_info)       \
+        {                                                                                      \
+            out_info->version = (_version);                                                    \
+            out_info->deps = (_deps);                                                          \
+            out_info->num_deps = (_num_deps);                                                  \
+            out_info->flags = (_flags);                                                        \
+            sx_strcpy(out_info->name, sizeof(out_info->name), #_name);                         \
+            sx_strcpy(out_info->desc, sizeof(out_info->desc), (_desc));                        \
         }
 #endif    // RIZZ_BUNDLE
 
+#define rizz_plugin_implement_info(_name, _version, _desc, _deps, _num_deps) \
+    rizz_plugin_implement_info_flags(_name, _version, _desc, _deps, _num_deps, 0)
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // @http
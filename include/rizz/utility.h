@@ -3,6 +3,9 @@
 
 typedef struct rizz_api_imgui rizz_api_imgui;
 
+// precomputed spline, see rizz_api_utility.spline.create_evaluatorXX
+typedef struct rizz_spline_evaluator rizz_spline_evaluator;
+
 #define RIZZ_SPLINE3D_NODE_FIELDS \
     struct {                      \
         sx_vec3 pos;              \
@@ -52,9 +55,13 @@ typedef struct rizz_gradient_key {
     sx_color color;
 } rizz_gradient_key;
 
+#define RIZZ_GRADIENT_LUT_SIZE 64
+
 typedef struct rizz_gradient {
     rizz_gradient_key keys[RIZZ_GRADIENT_MAX_KEYS];
     uint32_t num_keys;
+    bool baked;    // set by gradient.bake, lut is then kept up-to-date by key functions
+    sx_color lut[RIZZ_GRADIENT_LUT_SIZE];
 } rizz_gradient;
 
 #define RIZZ_GRAPH_MAX_KEYS 8
@@ -66,15 +73,44 @@ typedef struct rizz_graph_key {
     float rwing;
 } rizz_graph_key;
 
+#define RIZZ_GRAPH_LUT_SIZE 64
+
 typedef struct rizz_graph {
     rizz_graph_key keys[RIZZ_GRAPH_MAX_KEYS];
     uint32_t num_keys;
+    bool baked;    // set by graph.bake, lut is then kept up-to-date by key functions
+    float lut[RIZZ_GRAPH_LUT_SIZE];
 } rizz_graph;
 
 typedef struct rizz_api_utility {
     struct {
         void (*eval2d)(const rizz_spline2d_desc* desc, sx_vec2* result);
         void (*eval3d)(const rizz_spline3d_desc* desc, sx_vec3* result);
+
+        // evaluator objects precompute segment polynomials and an arc-length table, for sampling
+        // the same spline many times. `desc->time` and `desc->usereval` are ignored
+        // arclen_resolution: number of arc-length samples per segment (<=0: default=16)
+        // nodes can be modified after creation, but changes are not reflected in the evaluator
+        rizz_spline_evaluator* (*create_evaluator3d)(const rizz_spline3d_desc* desc,
+                                                     int arclen_resolution, const sx_alloc* alloc);
+        rizz_spline_evaluator* (*create_evaluator2d)(const rizz_spline2d_desc* desc,
+                                                     int arclen_resolution, const sx_alloc* alloc);
+        void (*destroy_evaluator)(rizz_spline_evaluator* ev, const sx_alloc* alloc);
+        float (*length)(const rizz_spline_evaluator* ev);
+
+        // evaluates `count` times, with the same time semantics as eval2d/eval3d (norm/loop)
+        void (*eval_many3d)(const rizz_spline_evaluator* ev, const float* ts, sx_vec3* results,
+                            int count);
+        void (*eval_many2d)(const rizz_spline_evaluator* ev, const float* ts, sx_vec2* results,
+                            int count);
+
+        // constant-speed sampling: evaluates at distances along the curve [0..length]
+        // distances are wrapped for looped splines and clamped otherwise
+        // sorted distances are cheaper than unsorted ones
+        void (*eval_distance3d)(const rizz_spline_evaluator* ev, const float* distances,
+                                sx_vec3* results, int count);
+        void (*eval_distance2d)(const rizz_spline_evaluator* ev, const float* distances,
+                                sx_vec2* results, int count);
     } spline;
     struct {
         float (*perlin1d)(float x);
@@ -83,6 +119,29 @@ typedef struct rizz_api_utility {
         float (*perlin1d_fbm)(float x, int octave);
         float (*perlin2d_fbm)(float x, float y, int octave);
         float (*perlin3d_fbm)(float x, float y, float z, int octave);
+
+        // batch evaluation, perlin uses 4/8-wide SIMD kernels
+        // grid: out[y*width + x] = fbm(origin + (x, y)*step), `out` must hold width*height floats
+        //       big grids are split into row tiles and evaluated in parallel with job_dispatch
+        void (*perlin2d_grid)(float* out, int width, int height, sx_vec2 origin, sx_vec2 step,
+                              int octave);
+        void (*perlin2d_fbm_many)(float* out, const float* xs, const float* ys, int count,
+                                  int octave);
+        // 3d grid: out[(z*height + y)*width + x], `out` must hold width*height*depth floats
+        void (*perlin3d_grid)(float* out, int width, int height, int depth, sx_vec3 origin,
+                              sx_vec3 step, int octave);
+        void (*perlin3d_fbm_many)(float* out, const float* xs, const float* ys, const float* zs,
+                                  int count, int octave);
+
+        // simplex and value noise variants, cheaper per octave than perlin
+        float (*simplex2d)(float x, float y);
+        float (*simplex2d_fbm)(float x, float y, int octave);
+        void (*simplex2d_grid)(float* out, int width, int height, sx_vec2 origin, sx_vec2 step,
+                               int octave);
+        float (*value2d)(float x, float y);
+        float (*value2d_fbm)(float x, float y, int octave);
+        void (*value2d_grid)(float* out, int width, int height, sx_vec2 origin, sx_vec2 step,
+                             int octave);
     } noise;
     struct {
         void (*init)(rizz_gradient* gradient, sx_color start, sx_color end);
@@ -90,6 +149,12 @@ typedef struct rizz_api_utility {
         bool (*remove_key)(rizz_gradient* gradient, int index);
         bool (*move_key)(rizz_gradient* gradient, int index, float t);
         void (*eval)(const rizz_gradient* gradient, float t, sx_color* outcolor);
+        // baking samples the gradient into a lookup table (RIZZ_GRADIENT_LUT_SIZE), after that
+        // eval/eval_many interpolate the table instead of searching the keys. the table is
+        // re-baked by add_key/move_key/remove_key and the editor
+        void (*bake)(rizz_gradient* gradient);
+        void (*eval_many)(const rizz_gradient* gradient, const float* ts, sx_color* outcolors,
+                          int count);
         void (*edit)(const rizz_api_imgui* api, const char* label, rizz_gradient* gradient);
     } gradient;
     struct {
@@ -98,6 +163,9 @@ typedef struct rizz_api_utility {
         bool (*remove_key)(rizz_graph* graph, int index);
         bool (*move_key)(rizz_graph* graph, int index, float t, float value);
         float (*eval)(const rizz_graph* graph, float t);
+        // see gradient.bake
+        void (*bake)(rizz_graph* graph);
+        void (*eval_many)(const rizz_graph* graph, const float* ts, float* outvalues, int count);
         float (*eval_remap)(const rizz_graph* graph, float t, float t_min, float t_max, float v_min,
                             float v_max);
         void (*edit)(const rizz_api_imgui* api, const char* label, rizz_graph* graph,
@@ -80,6 +80,18 @@
 //                                 then gets back to the coroutine
 //      sx_coro_yieldn             yields current coroutine and gets back to it after N updates
 //      sx_coro_update             Updates fiber-context state with a delta-time as input.
+//                                 Only coroutines that are due are resumed, yields are kept in
+//                                 buckets of updates and waits in a timer wheel (msecs)
+//      sx_coro_invoke_any_thread  Same as sx_coro_invoke, but the coroutine can be resumed on other
+//                                 threads, using sx_coro_update_begin/sx_coro_resume_ready. these
+//                                 coroutines should not keep thread-local data between yields
+//      sx_coro_update_begin       Same as sx_coro_update, but only resumes the coroutines that are
+//                                 invoked with sx_coro_invoke. returns the number of due
+//                                 coroutines that are invoked with sx_coro_invoke_any_thread
+//      sx_coro_resume_ready       resumes the due coroutine [0..N) returned by sx_coro_update_begin
+//                                 can be called from any thread for different indexes. example:
+//                                      int n = sx_coro_update_begin(cctx, dt);
+//                                      sx_job_wait_and_del(jobs, sx_job_dispatch(jobs, n, resume_cb, ..));
 //                                 In the game this should be called on each frame
 //      sx_coro_end                Exits the fiber execution and returns to program,
 //                                 This function MUST be called whenever you want to exit the coro
@@ -137,10 +149,13 @@ typedef struct sx_coro_context sx_coro_context;
 SX_API sx_coro_context* sx_coro_create_context(const sx_alloc* alloc, int num_initial_fibers, int stack_sz);
 SX_API void sx_coro_destroy_context(sx_coro_context* ctx);
 SX_API void sx_coro_update(sx_coro_context* ctx, float dt);
+SX_API int sx_coro_update_begin(sx_coro_context* ctx, float dt);
+SX_API void sx_coro_resume_ready(sx_coro_context* ctx, int index);
 SX_API bool sx_coro_replace_callback(sx_coro_context* ctx, sx_fiber_cb* callback,
                                      sx_fiber_cb* new_callback);
 
 SX_API void sx__coro_invoke(sx_coro_context* ctx, sx_fiber_cb* callback, void* user);
+SX_API void sx__coro_invoke_any_thread(sx_coro_context* ctx, sx_fiber_cb* callback, void* user);
 SX_API void sx__coro_end(sx_coro_context* ctx, sx_fiber_t* pfrom);
 SX_API void sx__coro_wait(sx_coro_context* ctx, sx_fiber_t* pfrom, int msecs);
 SX_API void sx__coro_yield(sx_coro_context* ctx, sx_fiber_t* pfrom, int nupdates sx_default(1));
@@ -153,6 +168,8 @@ SX_API void sx__coro_yield(sx_coro_context* ctx, sx_fiber_t* pfrom, int nupdates
 #define sx_coro_yield(_ctx) sx__coro_yield((_ctx), &__transfer.from, 1)
 #define sx_coro_yieldn(_ctx, _n) sx__coro_yield((_ctx), &__transfer.from, (_n))
 #define sx_coro_invoke(_ctx, _name, _user) sx__coro_invoke((_ctx), coro__##_name, (_user))
+#define sx_coro_invoke_any_thread(_ctx, _name, _user) \
+    sx__coro_invoke_any_thread((_ctx), coro__##_name, (_user))
 
 // Low-level functions
 SX_API bool sx_fiber_stack_init(sx_fiber_stack* fstack, unsigned int size sx_default(0));
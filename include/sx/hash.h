@@ -2,7 +2,7 @@
 // Copyright 2018 Sepehr Taghdisian (septag@github). All rights reserved.
 // License: https://github.com/septag/sx#license-bsd-2-clause
 //
-// hash.h - v1.0 - Some nice hash functions and a fast hash-table
+// hash.h - v1.1 - Some nice hash functions and a fast hash-table
 // Reference for hash funcs: https://aras-p.info/blog/2016/08/02/Hash-Functions-all-the-way-down/
 //
 // Hashing functions (Non-cryptographic):
@@ -10,10 +10,17 @@
 //                                               situations
 //      sx_hash_xxh64                 xxhash64 - suitable for bigger data, collision of this is
 //                                               almost zero
+//      sx_hash_xxh3_64               xxh3 64bit - fastest for both small and big data, uses
+//                                    SSE2/AVX2/NEON when available at compile time
+//      sx_hash_xxh3_128              xxh3 128bit - for content identity/caching where 64bit is
+//                                    not enough
 //      sx_hash_fnv32                 Fnv1a hashing, fast and robust for small data (<64 bytes)
 //      sx_hash_fnv32_str             utility function for hashing null-terminated strings
 //      sx_hash_crc32                 famous CRC32 hash, suitable for files and data that need CRC32
 //                                    hash export
+//      sx_hash_crc32c                CRC32C (castagnoli), uses SSE4.2/ARMv8 crc32 instructions when
+//                                    the CPU supports them. Pass the previous result as seed to
+//                                    hash a stream in chunks (same goes for sx_hash_crc32)
 //      sx_hash_u32                   bit-shift hashing of uint32, suitable for pushing indexes
 //                                    into hash table
 //      sx_hash_u64                   bit-shift hashing of uint64, suitable for hashing pointers
@@ -29,6 +36,9 @@
 //
 // XXHash Source: https://github.com/Cyan4973/xxHash
 // The functions above all have 64bit versions... sx_hash_create_xxh64, etc.
+// xxh3 streaming functions are the same, except the digest: sx_hash_xxh3_digest64/digest128
+//
+// v1.1     Updated xxhash to v0.8.2, added xxh3 (64/128bit) and crc32c
 //
 // sx_hashtbl: hash-table based on fibonacci mult hashing
 //             Reference:
@@ -88,6 +98,15 @@ typedef struct sx_alloc sx_alloc;
 SX_API uint32_t sx_hash_xxh32(const void* data, size_t len, uint32_t seed);
 SX_API uint64_t sx_hash_xxh64(const void* data, size_t len, uint64_t seed);
 
+// XXH3: faster than both above on all sizes, 128bit version for content hashing
+typedef struct sx_hash128 {
+    uint64_t low;
+    uint64_t high;
+} sx_hash128;
+
+SX_API uint64_t sx_hash_xxh3_64(const void* data, size_t len, uint64_t seed);
+SX_API sx_hash128 sx_hash_xxh3_128(const void* data, size_t len, uint64_t seed);
+
 // FNV1a: suitable for small data (usually less than 32 bytes), mainly small strings
 SX_INLINE SX_CONSTEXPR uint32_t sx_hash_fnv32(const void* data, size_t len);
 SX_INLINE SX_CONSTEXPR uint32_t sx_hash_fnv32_str(const char* str);
@@ -95,6 +114,9 @@ SX_INLINE SX_CONSTEXPR uint32_t sx_hash_fnv32_str(const char* str);
 // CRC32: Pretty standard hash, mainly used for files
 SX_API uint32_t sx_hash_crc32(const void* data, size_t len, uint32_t seed);
 
+// CRC32C: Castagnoli polynomial, hardware accelerated on most modern CPUs
+SX_API uint32_t sx_hash_crc32c(const void* data, size_t len, uint32_t seed);
+
 // Integer hash functions: useful for pointer/index hashing
 // Reference: https://gist.github.com/badboy/6267743
 SX_INLINE SX_CONSTEXPR uint32_t sx_hash_u32(uint32_t key);
@@ -119,6 +141,16 @@ SX_API void sx_hash_xxh64_init(sx_hash_xxh64_t* state, uint64_t seed);
 SX_API void sx_hash_xxh64_update(sx_hash_xxh64_t* state, const void* data, size_t len);
 SX_API uint64_t sx_hash_xxh64_digest(sx_hash_xxh64_t* state);
 
+// Streaming (state based) hash using xxh3, both 64bit and 128bit digests can be taken from a state
+typedef struct sx_hash_xxh3_s sx_hash_xxh3_t;
+
+SX_API sx_hash_xxh3_t* sx_hash_create_xxh3(const sx_alloc* alloc);
+SX_API void sx_hash_destroy_xxh3(sx_hash_xxh3_t* state, const sx_alloc* alloc);
+SX_API void sx_hash_xxh3_init(sx_hash_xxh3_t* state, uint64_t seed);
+SX_API void sx_hash_xxh3_update(sx_hash_xxh3_t* state, const void* data, size_t len);
+SX_API uint64_t sx_hash_xxh3_digest64(sx_hash_xxh3_t* state);
+SX_API sx_hash128 sx_hash_xxh3_digest128(sx_hash_xxh3_t* state);
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Hash table
 typedef struct sx_hashtbl {
@@ -0,0 +1,47 @@
+//
+// Copyright 2018 Sepehr Taghdisian (septag@github). All rights reserved.
+// License: https://github.com/septag/sx#license-bsd-2-clause
+//
+// math-batch.h - Batch (stream) versions of common transform functions in math-vec.h
+//                Points and AABBs are passed as SoA (structure of arrays) streams, so a single
+//                SIMD register holds the same component of 4 (SSE/NEON) or 8 (AVX2) elements
+//                SIMD path is selected at compile time: AVX2 (+FMA) -> SSE2 -> NEON -> scalar
+//                Define SX_CONFIG_SIMD_DISABLE=1 to force the scalar path
+//
+// Functions:
+//      sx_mat4_mul_vec3_batch      transforms `count` points by a single matrix (same as sx_mat4_mul_vec3)
+//      sx_mat4_mul_vec3_xyz0_batch transforms `count` directions by the rotation part of the matrix
+//                                  (same as sx_mat4_mul_vec3_xyz0)
+//      sx_aabb_transform_batch     transforms `count` AABBs by a single matrix (same as sx_aabb_transform)
+//      sx_mat4_mul_batch           multiplies `count` pairs of matrices: dst[i] = a[i]*b[i]
+//      sx_tx3d_mul_batch           multiplies `count` pairs of transforms: dst[i] = a[i]*b[i]
+//
+// Streams can be unaligned, and `dst` can be the same as `src` (in-place), but they should not
+// partially overlap
+//
+#pragma once
+
+#include "math-types.h"
+
+// SoA stream of 3d vectors, each member points to `count` floats
+typedef struct sx_vec3_soa {
+    float* x;
+    float* y;
+    float* z;
+} sx_vec3_soa;
+
+// SoA stream of AABBs, each member points to `count` floats
+typedef struct sx_aabb_soa {
+    float* xmin;
+    float* ymin;
+    float* zmin;
+    float* xmax;
+    float* ymax;
+    float* zmax;
+} sx_aabb_soa;
+
+SX_API void sx_mat4_mul_vec3_batch(sx_vec3_soa dst, const sx_vec3_soa src, const sx_mat4* mat, int count);
+SX_API void sx_mat4_mul_vec3_xyz0_batch(sx_vec3_soa dst, const sx_vec3_soa src, const sx_mat4* mat, int count);
+SX_API void sx_aabb_transform_batch(sx_aabb_soa dst, const sx_aabb_soa src, const sx_mat4* mat, int count);
+SX_API void sx_mat4_mul_batch(sx_mat4* dst, const sx_mat4* a, const sx_mat4* b, int count);
+SX_API void sx_tx3d_mul_batch(sx_tx3d* dst, const sx_tx3d* a, const sx_tx3d* b, int count);
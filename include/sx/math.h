@@ -45,3 +45,4 @@
 //      v1.3        Added tx3d (transform), box and plane primitives
 //      v1.4        Added more primitives, and quaternion lerping
 //      v1.5        Divided math.h into multiple headers for faster build times
+//      v1.6        Added batch (SoA) transform functions in math-batch.h
@@ -2,7 +2,7 @@
 // Copyright 2018 Sepehr Taghdisian (septag@github). All rights reserved.
 // License: https://github.com/septag/sx#license-bsd-2-clause
 //
-// rng.h - v1.0 - Random number generator
+// rng.h - v1.1 - Random number generator
 //                Currently has PCG implementation
 //                Source: http://www.pcg-random.org
 //
@@ -13,6 +13,26 @@
 //      sx_rng_gen_rangei   generates an integer between the specified rang [min..max]
 //      sx_rng_gen_rangef()
 //
+// Wide (multi-stream) generator: sx_rng_wide
+//      Runs SX_RNG_WIDE_LANES independent xoshiro128++ streams side by side in SIMD registers
+//      (AVX2: 1x8 lanes, SSE2/NEON: 2x4 lanes), made for bulk fills of large arrays
+//      Source: http://prng.di.unimi.it
+//      Output sequence is the same on every SIMD path. Buffers are filled in blocks of
+//      SX_RNG_WIDE_LANES, so a count that isn't a multiple of that discards the rest of the block
+//
+//      sx_rng_wide_seed        initialize all lanes with a seed number, lanes are 2^64 steps apart
+//      sx_rng_wide_seed_stream same as seed, but jumps ahead `stream` times (see sx_rng_wide_jump),
+//                              for example, use job thread index as the stream to get a
+//                              decorrelated generator per thread
+//      sx_rng_wide_jump        advances all lanes by 2^96 steps, equivalent to 2^32 non-overlapping
+//                              sub-sequences for parallel computations
+//      sx_rng_fill_u32         fills buffer with random integers [0..UINT_MAX]
+//      sx_rng_fill_float01     fills buffer with random floats [0..1)
+//      sx_rng_fill_rangef      fills buffer with random floats [min..max)
+//      sx_rng_fill_gauss       fills buffer with normal distributed floats (box-muller)
+//
+// v1.1     Added sx_rng_wide multi-stream generator and bulk fill functions
+//
 #pragma once
 
 #include "sx.h"
@@ -23,6 +43,13 @@ typedef struct sx_rng {
     uint64_t state[2];
 } sx_rng;
 
+#define SX_RNG_WIDE_LANES 8
+
+// state is stored SoA: state[i][lane]
+typedef struct sx_rng_wide {
+    uint32_t state[4][SX_RNG_WIDE_LANES];
+} sx_rng_wide;
+
 SX_API void sx_rng_seed(sx_rng* rng, uint32_t seed);
 SX_API void sx_rng_seed_time(sx_rng* rng);
 SX_API uint32_t sx_rng_gen(sx_rng* rng);
@@ -42,4 +69,12 @@ SX_INLINE float sx_rng_gen_rangef(sx_rng* rng, float _min, float _max)
 
     float const r = sx_rng_genf(rng);
     return _min + r*(_max - _min);
-}
\ No newline at end of file
+}
+
+SX_API void sx_rng_wide_seed(sx_rng_wide* rng, uint32_t seed);
+SX_API void sx_rng_wide_seed_stream(sx_rng_wide* rng, uint32_t seed, int stream);
+SX_API void sx_rng_wide_jump(sx_rng_wide* rng);
+SX_API void sx_rng_fill_u32(sx_rng_wide* rng, uint32_t* out, int count);
+SX_API void sx_rng_fill_float01(sx_rng_wide* rng, float* out, int count);
+SX_API void sx_rng_fill_rangef(sx_rng_wide* rng, float* out, int count, float _min, float _max);
+SX_API void sx_rng_fill_gauss(sx_rng_wide* rng, float* out, int count, float mean, float stddev);
@@ -0,0 +1,44 @@
+//
+// Copyright 2018 Sepehr Taghdisian (septag@github). All rights reserved.
+// License: https://github.com/septag/sx#license-bsd-2-clause
+//
+// vertex-pack.h - Float to compact format converters, mainly for compressing vertex data
+//                 All functions work on contiguous arrays and convert `count` components
+//                 (or vectors for oct/quantize functions)
+//                 SIMD path is selected at compile time (SSE2 or NEON), except for half-floats
+//                 that use F16C instructions if the CPU supports them (checked at runtime)
+//                 Define SX_CONFIG_SIMD_DISABLE=1 to force the scalar path
+//
+// Functions:
+//      sx_pack_half            float -> IEEE 754 half (round to nearest even)
+//      sx_unpack_half          half -> float
+//      sx_pack_snorm16         [-1, 1] float -> int16 (SHORTxN vertex formats)
+//      sx_pack_unorm16         [0, 1] float -> uint16 (USHORTxN vertex formats)
+//      sx_pack_snorm8          [-1, 1] float -> int8 (BYTE4N vertex format)
+//      sx_pack_unorm8          [0, 1] float -> uint8 (UBYTE4N vertex format)
+//                              inputs out of range are clamped
+//      sx_pack_oct_snorm16     unit vectors -> octahedral encoding, 2 x int16 per vector (SHORT2N)
+//      sx_unpack_oct_snorm16   octahedral encoding -> normalized unit vectors
+//      sx_pack_quantize_pos    positions -> uint16 quantized inside `bounds`, 4 x uint16 per
+//                              vector (USHORT4N), w component is always 1.0 (65535)
+//                              shader can reconstruct the position with:
+//                                  pos = bounds.min + v.xyz * (bounds.max - bounds.min)
+//
+// Reference for octahedral encoding:
+//      http://jcgt.org/published/0003/02/01/ (A Survey of Efficient Representations for Independent
+//      Unit Vectors)
+//
+#pragma once
+
+#include "math-types.h"
+
+SX_API void sx_pack_half(uint16_t* dst, const float* src, int count);
+SX_API void sx_unpack_half(float* dst, const uint16_t* src, int count);
+SX_API void sx_pack_snorm16(int16_t* dst, const float* src, int count);
+SX_API void sx_pack_unorm16(uint16_t* dst, const float* src, int count);
+SX_API void sx_pack_snorm8(int8_t* dst, const float* src, int count);
+SX_API void sx_pack_unorm8(uint8_t* dst, const float* src, int count);
+
+SX_API void sx_pack_oct_snorm16(int16_t* dst, const sx_vec3* src, int count);
+SX_API void sx_unpack_oct_snorm16(sx_vec3* dst, const int16_t* src, int count);
+SX_API void sx_pack_quantize_pos(uint16_t* dst, const sx_vec3* src, int count, const sx_aabb* bounds);
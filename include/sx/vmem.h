@@ -25,9 +25,27 @@
 //                                          num_pages: Number of pages starting from `start_page_id`
 //      sx_vmem_free_page/pages             Free a single or a range of pages to be used later again
 //                                          Parameters are same as commit functions
+//      sx_vmem_commit_range/free_range     Same as commit/free pages, but takes a byte range 
+//                                          (offset from the start of reserved memory + size). 
+//                                          offset must be aligned to page size, size is rounded up 
+//                                          to whole pages, so free_range releases exactly the pages 
+//                                          of the matching commit_range. Issues a single syscall 
 //      sx_vmem_commit_size                 Returns total commited bytes. 
 //                                          Basically num_pages*page_size
 //
+//  Flags:
+//      SX_VMEM_WATCH                       Enables write watch (windows only)
+//      SX_VMEM_HUGE_PAGES                  Hints the OS to back the memory with transparent huge pages
+//                                          (linux: madvise(MADV_HUGEPAGE)). Ignored on other platforms
+//      SX_VMEM_HUGE_PAGES_EXPLICIT         Reserves the memory from the explicit huge page pool 
+//                                          (linux: MAP_HUGETLB). Huge TLB mappings cannot be 
+//                                          partially protected, so the whole range is mapped 
+//                                          read/write at init and commit/free only do the 
+//                                          book-keeping. Falls back to SX_VMEM_HUGE_PAGES if the 
+//                                          system doesn't have any huge pages available
+//      SX_VMEM_POPULATE                    Pre-faults the pages on commit, so there won't be any 
+//                                          first-touch page faults afterwards
+//
 #pragma once
 
 #include "sx.h"
@@ -35,7 +53,10 @@
 typedef struct sx_alloc sx_alloc;
 
 typedef enum sx_vmem_flag {
-    SX_VMEM_WATCH = 0x1
+    SX_VMEM_WATCH = 0x1,
+    SX_VMEM_HUGE_PAGES = 0x2,
+    SX_VMEM_HUGE_PAGES_EXPLICIT = 0x4,
+    SX_VMEM_POPULATE = 0x8
 } sx_vmem_flag;
 typedef uint32_t sx_vmem_flags;
 
@@ -44,6 +65,7 @@ typedef struct sx_vmem_context {
     int num_pages;
     int page_size;
     int max_pages;
+    sx_vmem_flags flags;
 } sx_vmem_context;
 
 typedef struct sx_vmem_watch_result {
@@ -61,6 +83,8 @@ SX_API void* sx_vmem_commit_page(sx_vmem_context* vmem, int page_id);
 SX_API void sx_vmem_free_page(sx_vmem_context* vmem, int page_id);
 SX_API void* sx_vmem_commit_pages(sx_vmem_context* vmem, int start_page_id, int num_pages);
 SX_API void sx_vmem_free_pages(sx_vmem_context* vmem, int start_page_id, int num_pages);
+SX_API void* sx_vmem_commit_range(sx_vmem_context* vmem, size_t offset, size_t size);
+SX_API void sx_vmem_free_range(sx_vmem_context* vmem, size_t offset, size_t size);
 SX_API void* sx_vmem_get_page(sx_vmem_context* vmem, int page_id);
 SX_API size_t sx_vmem_commit_size(sx_vmem_context* vmem);
 
@@ -0,0 +1,477 @@
+#
+# Copyright 2021 Sepehr Taghdisian (septag@github). All rights reserved.
+# License: https://github.com/septag/rizz#license-bsd-2-clause
+#
+# Formats binary log files (.rlog files, see RIZZ_CORE_FLAG_LOG_TO_BINARY_FILE) to text
+# Binary layout is defined in src/rizz/core.c (rizz__log_bin_header and rizz__log_bin_record_type)
+# Entries are stored as format strings and packed arguments, they are formatted here with the same
+# conversion and rounding rules of stb_sprintf (see format_stb_double for the digits that can differ)
+# Usage:
+#   python rlog-view.py app.rlog [--rotated] [--level warning] [--channels 0x3] [--thread tid] [-o output.txt]
+#   --rotated also reads older rotated files (app.N.rlog ... app.1.rlog) before the given file
+#
+from __future__ import print_function
+import sys
+import os
+import struct
+import math
+import decimal
+import argparse
+import datetime
+
+LOG_SIGN = 0x474f4c52       # 'RLOG'
+LOG_VERSION = 1
+
+RECORD_CLOCK = 1
+RECORD_SOURCE = 2
+RECORD_ENTRY = 3
+
+LEVELS = ['error', 'warning', 'info', 'verbose', 'debug']
+LEVEL_PREFIXES = ['ERROR: ', 'WARNING: ', '', 'VERBOSE: ', 'DEBUG: ']
+
+header_fmt = struct.Struct('<IIQII32s')
+clock_fmt = struct.Struct('<QQ')
+
+def read_cstr(b):
+    return b.split(b'\0', 1)[0].decode('utf-8', 'replace')
+
+def read_varint(data, offset):
+    value = 0
+    shift = 0
+    while True:
+        b = data[offset] if isinstance(data[offset], int) else ord(data[offset])
+        offset += 1
+        value |= (b & 0x7f) << shift
+        if not (b & 0x80):
+            return value, offset
+        shift += 7
+
+def read_svarint(data, offset):
+    value, offset = read_varint(data, offset)
+    return (value >> 1) ^ -(value & 1), offset
+
+# reads packed arguments in the same order that `rizz__log_pack_args` writes them
+class ArgReader:
+    def __init__(self, payload, ptr_size):
+        self.payload = payload
+        self.offset = 0
+        self.ptr_fmt = '<Q' if ptr_size == 8 else '<I'
+
+    def read(self, fmt):
+        value = struct.unpack_from(fmt, self.payload, self.offset)[0]
+        self.offset += struct.calcsize(fmt)
+        return value
+
+    def read_str(self):
+        length = self.read('<i')
+        if length < 0:
+            return None
+        s = self.payload[self.offset:self.offset+length].decode('utf-8', 'replace')
+        self.offset += length + 1
+        return s
+
+def parse_spec(fmt, i, ptr_size):
+    # mirrors `rizz__log_parse_spec`: returns (flags, star_width, width, star_precision, precision,
+    # is_int64, conversion, next_index). size_t/ptrdiff_t ('z', 't', 'I') follow the writer's pointer size
+    start = i
+    i += 1
+    flags = ''
+    while i < len(fmt) and fmt[i] in '-+ #\'$_':
+        flags += fmt[i]
+        i += 1
+    if i < len(fmt) and fmt[i] == '0':
+        flags += '0'
+        i += 1
+
+    star_width = False
+    width = None
+    if i < len(fmt) and fmt[i] == '*':
+        star_width = True
+        i += 1
+    else:
+        j = i
+        while i < len(fmt) and fmt[i].isdigit():
+            i += 1
+        width = int(fmt[j:i]) if i > j else None
+
+    star_precision = False
+    precision = None
+    if i < len(fmt) and fmt[i] == '.':
+        i += 1
+        if i < len(fmt) and fmt[i] == '*':
+            star_precision = True
+            i += 1
+        else:
+            j = i
+            while i < len(fmt) and fmt[i].isdigit():
+                i += 1
+            precision = int(fmt[j:i]) if i > j else 0
+
+    is_int64 = False
+    if fmt.startswith('ll', i):
+        is_int64 = True
+        i += 2
+    elif i < len(fmt) and fmt[i] in 'hl':
+        i += 1
+    elif i < len(fmt) and fmt[i] == 'j':
+        is_int64 = True
+        i += 1
+    elif i < len(fmt) and fmt[i] in 'zt':
+        is_int64 = ptr_size == 8
+        i += 1
+    elif fmt.startswith('I64', i):
+        is_int64 = True
+        i += 3
+    elif fmt.startswith('I32', i):
+        i += 3
+    elif i < len(fmt) and fmt[i] == 'I':
+        is_int64 = ptr_size == 8
+        i += 1
+
+    conv = fmt[i] if i < len(fmt) else ''
+    if conv:
+        i += 1
+    return flags, star_width, width, star_precision, precision, is_int64, conv, i
+
+def group_digits(digits, sep):
+    head = len(digits) % 3 or 3
+    parts = [digits[:head]] + [digits[k:k+3] for k in range(head, len(digits), 3)]
+    return sep.join(parts)
+
+def pad(s, flags, width, numeric):
+    if width is None or len(s) >= width:
+        return s
+    if '-' in flags:
+        return s.ljust(width)
+    if numeric and '0' in flags:
+        sign = s[0] if s and s[0] in '+- ' else ''
+        prefix = s[len(sign):len(sign)+2] if s[len(sign):len(sign)+2] in ('0x', '0X', '0b', '0B') else ''
+        body = s[len(sign)+len(prefix):]
+        return sign + prefix + body.rjust(width - len(sign) - len(prefix), '0')
+    return s.rjust(width)
+
+def format_int(value, flags, width, precision, conv):
+    sign = ''
+    if conv in 'di':
+        if value < 0:
+            sign = '-'
+            value = -value
+        elif '+' in flags:
+            sign = '+'
+        elif ' ' in flags:
+            sign = ' '
+
+    if conv in 'diu':
+        digits = str(value)
+    elif conv in 'xX':
+        digits = ('%x' if conv == 'x' else '%X') % value
+    elif conv == 'o':
+        digits = '%o' % value
+    else:
+        digits = bin(value)[2:]
+
+    if precision is not None:
+        digits = digits.rjust(precision, '0')
+        if precision == 0 and value == 0:
+            digits = ''
+    if conv in 'diu' and '\'' in flags:
+        digits = group_digits(digits, ',')
+
+    prefix = ''
+    if '#' in flags and value != 0:
+        prefix = {'x': '0x', 'X': '0X', 'o': '0', 'b': '0b', 'B': '0B'}.get(conv, '')
+    return pad(sign + prefix + digits, flags if precision is None else flags.replace('0', ''), width, True)
+
+def format_hex_double(value, precision, conv):
+    # same rounding and digits of stb_sprintf's '%a', which differs from float.hex()
+    bits = struct.unpack('<Q', struct.pack('<d', value))[0]
+    sign = '-' if bits >> 63 else ''
+    exponent = (bits >> 52) & 0x7ff
+    n64 = bits & ((1 << 52) - 1)
+    if exponent == 0:
+        dp = -1022 if n64 else 0
+    else:
+        n64 |= 1 << 52
+        dp = exponent - 1023
+    precision = 6 if precision is None else precision
+    n64 = (n64 << 8) & 0xffffffffffffffff
+    if precision < 15:
+        n64 = (n64 + ((8 << 56) >> (precision*4))) & 0xffffffffffffffff
+    digits = '0123456789ABCDEF' if conv == 'A' else '0123456789abcdef'
+    s = sign + '0x' + digits[(n64 >> 60) & 15]
+    if precision:
+        s += '.'
+        for _ in range(0, min(precision, 13)):
+            n64 = (n64 << 4) & 0xffffffffffffffff
+            s += digits[(n64 >> 60) & 15]
+        s += '0' * (precision - min(precision, 13))
+    return s + ('P' if conv == 'A' else 'p') + ('-' if dp < 0 else '+') + str(abs(dp))
+
+# stb_sprintf takes 19 significant decimal digits of the value and rounds them half away from zero
+# (0.5 is added at the last printed digit), python rounds the exact binary value half to even, so
+# '%.0f' of 2.5 is '3' in stb and '2' in python. digits are produced from the value rounded the stb
+# way here. stb also ignores '#' for floats and prints NaN/Inf. stb gets those 19 digits with an
+# approximate power of ten, so digits past the 17th significant one (beyond double precision) can differ
+def format_stb_double(value, flags, precision, conv):
+    negative = math.copysign(1.0, value) < 0
+    sign = '-' if negative else ('+' if '+' in flags else (' ' if ' ' in flags else ''))
+    if math.isnan(value) or math.isinf(value):
+        return sign + ('NaN' if math.isnan(value) else 'Inf')
+
+    lower = conv.lower()
+    with decimal.localcontext() as ctx:
+        ctx.prec = 1000
+        d = decimal.Decimal(abs(value))
+        if d:
+            d = d.quantize(decimal.Decimal(1).scaleb(d.adjusted() - 18), rounding=decimal.ROUND_HALF_UP)
+        exp = d.adjusted() if d else 0
+
+        def exp_text(r, digits):
+            mantissa, _, e = format(r, '.%de' % digits).partition('e')
+            return mantissa + 'e' + e[0] + e[1:].rjust(2, '0')
+
+        if lower == 'f':
+            r = d.quantize(decimal.Decimal(1).scaleb(-precision), rounding=decimal.ROUND_HALF_UP)
+            s = format(r, '.%df' % precision)
+        elif lower == 'e':
+            r = d.quantize(decimal.Decimal(1).scaleb(exp - precision), rounding=decimal.ROUND_HALF_UP)
+            s = exp_text(r, precision)
+        else:
+            digits = max(precision, 1)
+            r = d.quantize(decimal.Decimal(1).scaleb(exp - digits + 1), rounding=decimal.ROUND_HALF_UP)
+            x = r.adjusted() if r else 0
+            if -4 <= x < digits:
+                s = format(r, '.%df' % max(digits - 1 - x, 0))
+                if '.' in s:
+                    s = s.rstrip('0').rstrip('.')
+            else:
+                s = exp_text(r, digits - 1)
+                mantissa, _, e = s.partition('e')
+                if '.' in mantissa:
+                    mantissa = mantissa.rstrip('0').rstrip('.')
+                s = mantissa + 'e' + e
+
+    s = sign + s
+    return s.upper() if conv in 'EG' else s
+
+def format_double(value, flags, width, precision, conv):
+    if conv in 'aA':
+        return pad(format_hex_double(value, precision, conv), flags, width, True)
+
+    # '$' flags: metric suffix (kilo -> kibi -> jedec), '_': no space before the suffix
+    metric = flags.count('$')
+    suffix = ''
+    if metric and conv == 'f':
+        divisor = 1024.0 if metric > 1 else 1000.0
+        index = 0
+        while index < 4 and (value >= divisor or value <= -divisor):
+            value /= divisor
+            index += 1
+        suffix = '' if '_' in flags else ' '
+        if index > 0:
+            suffix += ('_KMGT' if metric > 1 else '_kMGT')[index]
+            if metric == 2:
+                suffix += 'i'
+
+    s = format_stb_double(value, flags, precision if precision is not None else 6, conv)
+    if '\'' in flags:
+        sign = s[0] if s[0] in '+- ' else ''
+        whole, dot, frac = s[len(sign):].partition('.')
+        if whole.isdigit():
+            s = sign + group_digits(whole, ',') + dot + frac
+    return pad(s + suffix, flags, width, True)
+
+def format_text(fmt, payload, ptr_size):
+    args = ArgReader(payload, ptr_size)
+    out = []
+    i = 0
+    while True:
+        k = fmt.find('%', i)
+        if k < 0:
+            out.append(fmt[i:])
+            break
+        out.append(fmt[i:k])
+        flags, star_width, width, star_precision, precision, is_int64, conv, i = parse_spec(fmt, k, ptr_size)
+
+        # negative star width/precision are ignored, same as stb_sprintf
+        if star_width:
+            width = args.read('<i')
+            if width < 0:
+                width = None
+        if star_precision:
+            precision = args.read('<i')
+            if precision < 0:
+                precision = None
+
+        if conv and conv in 'diuxXobB':
+            if conv in 'di':
+                value = args.read('<q' if is_int64 else '<i')
+            else:
+                value = args.read('<Q' if is_int64 else '<I')
+            if '$' in flags:
+                # integers with metric suffix are printed as floats
+                if precision is None:
+                    precision = 0 if abs(value) < 1024 else 1
+                out.append(format_double(float(value), flags, width, precision, 'f'))
+            else:
+                out.append(format_int(value, flags, width, precision, conv))
+        elif conv and conv in 'feEgGaA':
+            out.append(format_double(args.read('<d'), flags, width, precision, conv))
+        elif conv == 's':
+            s = args.read_str()
+            s = 'null' if s is None else s
+            if precision is not None:
+                s = s[:precision]
+            out.append(pad(s, flags, width, False))
+        elif conv == 'c':
+            out.append(pad(chr(args.read('<I') & 0xff), flags, width, False))
+        elif conv == 'p':
+            out.append(pad('%0*x' % (ptr_size*2, args.read(args.ptr_fmt)), flags, width, False))
+        else:
+            out.append(conv)    # '%%' and unknown conversions
+    return ''.join(out)
+
+# maps cycle-clock timestamps to microseconds, using CLOCK records of the file
+class Clock:
+    def __init__(self):
+        self.points = []
+
+    def add(self, cycles, us):
+        self.points.append((cycles, us))
+
+    def to_us(self, cycles):
+        points = self.points
+        if not points:
+            return 0
+        if len(points) == 1:
+            return points[0][1]
+        lo = 0
+        hi = len(points) - 1
+        while hi - lo > 1:
+            mid = (lo + hi) // 2
+            if points[mid][0] <= cycles:
+                lo = mid
+            else:
+                hi = mid
+        # extrapolate with the nearest segment that has valid timing
+        (c0, u0), (c1, u1) = points[lo], points[hi]
+        if c1 <= c0:
+            return u0
+        return u0 + (cycles - c0) * (u1 - u0) / float(c1 - c0)
+
+# returns (header dict, entries), entries: (timestamp_us, level, channels, thread_id, source_file, line, text)
+def parse_log(data):
+    sign, version, start_time_us, ptr_size, _, app_name = header_fmt.unpack_from(data, 0)
+    if sign != LOG_SIGN:
+        raise ValueError('invalid binary log file')
+    if version != LOG_VERSION:
+        raise ValueError('binary log version mismatch: %d (expected %d)' % (version, LOG_VERSION))
+
+    header = {
+        'app_name': read_cstr(app_name),
+        'start_time_us': start_time_us,
+        'ptr_size': ptr_size
+    }
+    sources = {}
+    clock = Clock()
+    raw_entries = []
+    timestamp = 0
+    offset = header_fmt.size
+    size = len(data)
+    try:
+        while offset < size:
+            rtype = data[offset] if isinstance(data[offset], int) else ord(data[offset])
+            offset += 1
+            if rtype == RECORD_CLOCK:
+                cycles, us = clock_fmt.unpack_from(data, offset)
+                offset += clock_fmt.size
+                clock.add(cycles, us)
+            elif rtype == RECORD_SOURCE:
+                source_id, offset = read_varint(data, offset)
+                line, offset = read_varint(data, offset)
+                length, offset = read_varint(data, offset)
+                file = data[offset:offset+length].decode('utf-8', 'replace')
+                offset += length
+                length, offset = read_varint(data, offset)
+                fmt = data[offset:offset+length].decode('utf-8', 'replace')
+                offset += length
+                sources[source_id] = (file, line, fmt)
+            elif rtype == RECORD_ENTRY:
+                source_id, offset = read_varint(data, offset)
+                level = data[offset] if isinstance(data[offset], int) else ord(data[offset])
+                channels, offset = read_varint(data, offset + 1)
+                thread_id, offset = read_varint(data, offset)
+                delta, offset = read_svarint(data, offset)
+                length, offset = read_varint(data, offset)
+                payload = data[offset:offset+length]
+                if len(payload) != length:
+                    raise IndexError()
+                offset += length
+                timestamp += delta
+                raw_entries.append((timestamp, level, channels, thread_id, source_id, payload))
+            else:
+                print('warning: invalid record type %d at offset %d, log is truncated' % (rtype, offset - 1), file=sys.stderr)
+                break
+    except (IndexError, struct.error):
+        print('warning: unexpected end of file, log is truncated', file=sys.stderr)
+
+    entries = []
+    for timestamp, level, channels, thread_id, source_id, payload in raw_entries:
+        file, line, fmt = sources.get(source_id, ('', 0, ''))
+        if fmt:
+            try:
+                text = format_text(fmt, payload, ptr_size)
+            except struct.error:
+                text = fmt + ' <invalid arguments>'
+        else:
+            text = payload.decode('utf-8', 'replace')
+        entries.append((start_time_us + clock.to_us(timestamp), level, channels, thread_id, file, line, text))
+    return header, entries
+
+def rotated_files(filepath):
+    base = os.path.splitext(filepath)[0]
+    files = []
+    index = 1
+    while os.path.isfile('%s.%d.rlog' % (base, index)):
+        files.append('%s.%d.rlog' % (base, index))
+        index += 1
+    return list(reversed(files))
+
+def main():
+    parser = argparse.ArgumentParser(description='Formats rizz binary log files (.rlog) to text')
+    parser.add_argument('filepath', help='binary log file (app.rlog)')
+    parser.add_argument('--rotated', action='store_true', help='also read older rotated files (app.N.rlog)')
+    parser.add_argument('--level', choices=LEVELS, default='debug', help='maximum log level to show')
+    parser.add_argument('--channels', type=lambda x: int(x, 0), default=0, help='only show entries of these channels (mask)')
+    parser.add_argument('--thread', type=int, default=None, help='only show entries of this thread id')
+    parser.add_argument('-o', '--output', help='output text file (default: stdout)')
+    args = parser.parse_args()
+
+    files = (rotated_files(args.filepath) if args.rotated else []) + [args.filepath]
+    max_level = LEVELS.index(args.level)
+    out = open(args.output, 'w') if args.output else sys.stdout
+    num_entries = 0
+    for filepath in files:
+        with open(filepath, 'rb') as f:
+            header, entries = parse_log(f.read())
+
+        for timestamp, level, channels, thread_id, file, line, text in entries:
+            if level > max_level:
+                continue
+            if args.channels and not (channels & args.channels):
+                continue
+            if args.thread is not None and thread_id != args.thread:
+                continue
+            tm = datetime.datetime.fromtimestamp(timestamp / 1000000.0).strftime('%H:%M:%S.%f')
+            source = '%s(%d): ' % (file, line) if file else ''
+            prefix = LEVEL_PREFIXES[level] if level < len(LEVEL_PREFIXES) else ''
+            out.write('%s [%d] %s%s%s\n' % (tm, thread_id, source, prefix, text))
+            num_entries += 1
+
+    if args.output:
+        out.close()
+        print('written: %s (%d entries)' % (args.output, num_entries))
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,176 @@
+#
+# Copyright 2019 Sepehr Taghdisian (septag@github). All rights reserved.
+# License: https://github.com/septag/rizz#license-bsd-2-clause
+#
+# Converts memory capture streams (.rmem files, see `trace_alloc_capture_frame`) to json
+# Binary layout is defined in src/rizz/memory.c (mem_capture_header and mem_capture_xxx_record)
+# Usage:
+#   python mem-capture-to-json.py capture.rmem [output.json]
+#
+from __future__ import print_function
+import sys
+import os
+import struct
+import json
+
+CAPTURE_SIGN = 0x4d454d52   # 'RMEM'
+CAPTURE_VERSION = 2
+
+RECORD_CONTEXT = 1
+RECORD_CALLSTACK = 2
+RECORD_MALLOC = 3
+RECORD_FREE = 4
+RECORD_REALLOC = 5
+RECORD_CONTEXT_STATS = 6
+RECORD_END = 7
+
+header_fmt = struct.Struct('<IIqq32s')
+context_fmt = struct.Struct('<B3xII32s')
+callstack_fmt = struct.Struct('<BxHI')
+frame_fmt = struct.Struct('<IHH')
+event_fmt = struct.Struct('<B3xII4xQQQQQQq')
+context_stats_fmt = struct.Struct('<B3xII4xQQ')
+end_fmt = struct.Struct('<B3xId')
+
+actions = {
+    RECORD_MALLOC: 'Malloc',
+    RECORD_FREE: 'Free',
+    RECORD_REALLOC: 'Realloc'
+}
+
+def read_cstr(b):
+    return b.split(b'\0', 1)[0].decode('utf-8', 'replace')
+
+def parse_capture(data):
+    sign, version, time, start_frame, name = header_fmt.unpack_from(data, 0)
+    if sign != CAPTURE_SIGN:
+        raise ValueError('invalid memory capture file')
+    if version != CAPTURE_VERSION:
+        raise ValueError('memory capture version mismatch: %d (expected %d)' % (version, CAPTURE_VERSION))
+
+    capture = {
+        'name': read_cstr(name),
+        'time': time,
+        'start_frame': start_frame,
+        'duration': 0.0,
+        'num_events': 0,
+        'contexts': {},
+        'context_order': [],
+        'callstacks': {}
+    }
+    contexts = capture['contexts']
+    callstacks = capture['callstacks']
+    events = []
+    offset = header_fmt.size
+    size = len(data)
+    while offset < size:
+        rtype = data[offset] if isinstance(data[offset], int) else ord(data[offset])
+        if rtype == RECORD_CONTEXT:
+            _, id, parent_id, name = context_fmt.unpack_from(data, offset)
+            offset += context_fmt.size
+            if id not in contexts:
+                contexts[id] = {'name': read_cstr(name), 'parent': parent_id, 'items': [],
+                                'num_items': 0, 'alloc_size': 0, 'peak_size': 0}
+                capture['context_order'].append(id)
+        elif rtype == RECORD_CALLSTACK:
+            _, num_frames, id = callstack_fmt.unpack_from(data, offset)
+            offset += callstack_fmt.size
+            frames = []
+            for _ in range(0, num_frames):
+                line, file_len, func_len = frame_fmt.unpack_from(data, offset)
+                offset += frame_fmt.size
+                file = data[offset:offset+file_len].decode('utf-8', 'replace')
+                offset += file_len
+                func = data[offset:offset+func_len].decode('utf-8', 'replace')
+                offset += func_len
+                frames.append({'file': file, 'line': line, 'func': func})
+            callstacks[id] = frames
+        elif rtype in actions:
+            events.append((rtype,) + event_fmt.unpack_from(data, offset)[1:])
+            offset += event_fmt.size
+        elif rtype == RECORD_CONTEXT_STATS:
+            _, id, num_items, alloc_size, peak_size = context_stats_fmt.unpack_from(data, offset)
+            offset += context_stats_fmt.size
+            if id in contexts:
+                contexts[id].update({'num_items': num_items, 'alloc_size': alloc_size, 'peak_size': peak_size})
+        elif rtype == RECORD_END:
+            _, num_events, duration = end_fmt.unpack_from(data, offset)
+            offset += end_fmt.size
+            capture['num_events'] = num_events
+            capture['duration'] = duration
+        else:
+            print('warning: invalid record type %d at offset %d, capture is truncated' % (rtype, offset))
+            break
+
+    # threads record into their own blocks, so contexts, callstacks and events of different threads
+    # are interleaved in the file. events are put back into their global order by sequence
+    events.sort(key=lambda e: e[4])
+    for rtype, ctx_id, callstack_id, time_us, seq, free_seq, ptr, old_ptr, size_, frame in events:
+        item = {
+            'ptr': '0x%x' % ptr,
+            'size': size_,
+            'action': actions[rtype],
+            'frame': frame,
+            'time': time_us / 1000000.0,
+            'seq': seq,
+            'callstack': callstacks.get(callstack_id, []) if callstack_id else []
+        }
+        if rtype == RECORD_REALLOC:
+            item['old_ptr'] = '0x%x' % old_ptr
+            item['free_seq'] = free_seq
+        if ctx_id in contexts:
+            contexts[ctx_id]['items'].append(item)
+
+    return capture
+
+def build_context_tree(capture, parent_id):
+    nodes = []
+    contexts = capture['contexts']
+    for id in capture['context_order']:
+        ctx = contexts[id]
+        if ctx['parent'] != parent_id:
+            continue
+        node = {
+            'name': ctx['name'],
+            'num_items': ctx['num_items'],
+            'alloc_size': ctx['alloc_size'],
+            'peak_size': ctx['peak_size'],
+            'items': ctx['items']
+        }
+        children = build_context_tree(capture, id)
+        if children:
+            node['children'] = children
+        nodes.append(node)
+    return nodes
+
+def main():
+    if len(sys.argv) < 2:
+        print('Usage: python mem-capture-to-json.py capture.rmem [output.json]')
+        return 1
+
+    in_filepath = sys.argv[1]
+    out_filepath = sys.argv[2] if len(sys.argv) > 2 else os.path.splitext(in_filepath)[0] + '.json'
+    with open(in_filepath, 'rb') as f:
+        capture = parse_capture(f.read())
+
+    # root context ("<memory>") is not written, like the old capture dumps
+    roots = [id for id in capture['context_order'] if capture['contexts'][id]['parent'] == 0]
+    items = []
+    for root_id in roots:
+        items.extend(build_context_tree(capture, root_id))
+
+    out = {
+        'name': capture['name'],
+        'time': capture['time'],
+        'start_frame': capture['start_frame'],
+        'duration': capture['duration'],
+        'total_in_capture': capture['num_events'],
+        'items': items
+    }
+    with open(out_filepath, 'w') as f:
+        json.dump(out, f, indent=2)
+    print('written: %s' % out_filepath)
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
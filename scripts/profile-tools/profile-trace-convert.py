@@ -0,0 +1,220 @@
+#
+# Copyright 2021 Sepehr Taghdisian (septag@github). All rights reserved.
+# License: https://github.com/septag/rizz#license-bsd-2-clause
+#
+# Converts profile capture streams (.rtrace files, see `profile_capture_create`) to chrome json trace
+# or perfetto protobuf trace (both can be opened in https://ui.perfetto.dev)
+# Binary layout is defined in src/rizz/profiler.c (profile_trace_header and profile_trace_record_type)
+# Usage:
+#   python profile-trace-convert.py capture.rtrace [output.json|output.perfetto-trace]
+#   output format is chosen by extension, '.json' (default) or '.perfetto-trace'/'.pftrace'
+#
+from __future__ import print_function
+import sys
+import os
+import struct
+import json
+
+TRACE_SIGN = 0x43525452     # 'RTRC'
+TRACE_VERSION = 1
+
+RECORD_STRING = 1
+RECORD_BLOCK = 2
+RECORD_END = 3
+
+header_fmt = struct.Struct('<IIIId32s')
+end_fmt = struct.Struct('<B3xIQQd')
+
+def read_cstr(b):
+    return b.split(b'\0', 1)[0].decode('utf-8', 'replace')
+
+def read_varint(data, offset):
+    value = 0
+    shift = 0
+    while True:
+        b = data[offset] if isinstance(data[offset], int) else ord(data[offset])
+        offset += 1
+        value |= (b & 0x7f) << shift
+        if not (b & 0x80):
+            return value, offset
+        shift += 7
+
+def read_svarint(data, offset):
+    value, offset = read_varint(data, offset)
+    return (value >> 1) ^ -(value & 1), offset
+
+# returns capture dict, events are in the order of each thread: (tid, end, cycles, name, file, line)
+def parse_trace(data):
+    sign, version, pid, _, start_us, name = header_fmt.unpack_from(data, 0)
+    if sign != TRACE_SIGN:
+        raise ValueError('invalid profile trace file')
+    if version != TRACE_VERSION:
+        raise ValueError('profile trace version mismatch: %d (expected %d)' % (version, TRACE_VERSION))
+
+    capture = {
+        'name': read_cstr(name),
+        'pid': pid,
+        'start_us': start_us,
+        'us_per_cycle': 0.0,
+        'num_dropped': 0,
+        'events': []
+    }
+    strings = {0: ''}
+    events = capture['events']
+    offset = header_fmt.size
+    size = len(data)
+    try:
+        while offset < size:
+            rtype = data[offset] if isinstance(data[offset], int) else ord(data[offset])
+            if rtype == RECORD_STRING:
+                index, offset = read_varint(data, offset + 1)
+                length, offset = read_varint(data, offset)
+                strings[index] = data[offset:offset+length].decode('utf-8', 'replace')
+                offset += length
+            elif rtype == RECORD_BLOCK:
+                tid, offset = read_varint(data, offset + 1)
+                num_events, offset = read_varint(data, offset)
+                tm, offset = read_svarint(data, offset)
+                for _ in range(0, num_events):
+                    name_end, offset = read_varint(data, offset)
+                    delta, offset = read_svarint(data, offset)
+                    tm += delta
+                    if name_end & 1:
+                        events.append((tid, True, tm, None, None, 0))
+                    else:
+                        file_index, offset = read_varint(data, offset)
+                        line, offset = read_varint(data, offset)
+                        events.append((tid, False, tm, strings.get(name_end >> 1, ''), strings.get(file_index, ''), line))
+            elif rtype == RECORD_END:
+                _, num_dropped, num_events, cycles, duration_us = end_fmt.unpack_from(data, offset)
+                offset += end_fmt.size
+                capture['num_dropped'] = num_dropped
+                if cycles > 0:
+                    capture['us_per_cycle'] = duration_us / cycles
+            else:
+                print('warning: invalid record type %d at offset %d, trace is truncated' % (rtype, offset))
+                break
+    except IndexError:
+        print('warning: unexpected end of file, trace is truncated')
+
+    if capture['us_per_cycle'] == 0.0:
+        print('warning: trace does not have an end record, assuming cycle-clock is in nanoseconds')
+        capture['us_per_cycle'] = 0.001
+    return capture
+
+def to_us(capture, cycles):
+    return capture['start_us'] + cycles*capture['us_per_cycle']
+
+def write_json(capture, out_filepath):
+    stacks = {}
+    items = []
+    pid = capture['pid']
+    for tid, end, tm, name, file, line in capture['events']:
+        stack = stacks.setdefault(tid, [])
+        if not end:
+            stack.append((tm, name, file, line))
+        elif stack:
+            begin_tm, name, file, line = stack.pop()
+            item = {
+                'ph': 'X',
+                'pid': pid,
+                'tid': tid,
+                'ts': round(to_us(capture, begin_tm), 3),
+                'dur': round((tm - begin_tm)*capture['us_per_cycle'], 3),
+                'name': name
+            }
+            if file:
+                item['args'] = {'caller': '%s@%d' % (file, line)}
+            items.append(item)
+
+    num_unclosed = sum(len(s) for s in stacks.values())
+    if num_unclosed > 0:
+        print('warning: %d samples are not ended' % num_unclosed)
+    with open(out_filepath, 'w') as f:
+        json.dump(items, f, indent=1)
+
+# minimal protobuf encoder for perfetto's trace.proto (Trace/TracePacket/TrackEvent/TrackDescriptor)
+def pb_varint(value):
+    out = bytearray()
+    while True:
+        b = value & 0x7f
+        value >>= 7
+        if value:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+def pb_uint(field, value):
+    return pb_varint(field << 3) + pb_varint(value)
+
+def pb_bytes(field, value):
+    if not isinstance(value, bytes):
+        value = value.encode('utf-8')
+    return pb_varint((field << 3) | 2) + pb_varint(len(value)) + value
+
+def write_perfetto(capture, out_filepath):
+    SLICE_BEGIN = 1
+    SLICE_END = 2
+    SEQ_INCREMENTAL_STATE_CLEARED = 1
+
+    pid = capture['pid']
+    process_uuid = (1 << 62) | pid
+    packets = []
+
+    # ProcessDescriptor: pid = 1, process_name = 6. TrackDescriptor: uuid = 1, process = 3
+    process_desc = pb_uint(1, pid) + pb_bytes(6, capture['name'])
+    packets.append(pb_bytes(60, pb_uint(1, process_uuid) + pb_bytes(3, process_desc)))
+
+    threads = set()
+    depths = {}
+    for tid, end, tm, name, file, line in capture['events']:
+        track_uuid = tid + 1
+        seq_id = tid + 1
+        if tid not in threads:
+            threads.add(tid)
+            thread_desc = pb_uint(1, pid) + pb_uint(2, tid) + pb_bytes(5, 'thread %d' % tid)
+            track_desc = pb_uint(1, track_uuid) + pb_uint(5, process_uuid) + pb_bytes(4, thread_desc)
+            packets.append(pb_bytes(60, track_desc) + pb_uint(10, seq_id) + pb_uint(13, SEQ_INCREMENTAL_STATE_CLEARED))
+
+        depth = depths.get(tid, 0)
+        if end:
+            if depth == 0:
+                continue
+            depths[tid] = depth - 1
+            event = pb_uint(9, SLICE_END) + pb_uint(11, track_uuid)
+        else:
+            depths[tid] = depth + 1
+            event = pb_uint(9, SLICE_BEGIN) + pb_uint(11, track_uuid) + pb_bytes(23, name)
+            if file:
+                event += pb_bytes(4, pb_bytes(10, 'caller') + pb_bytes(6, '%s@%d' % (file, line)))
+        ts_ns = int(to_us(capture, tm)*1000.0)
+        packets.append(pb_uint(8, ts_ns) + pb_uint(10, seq_id) + pb_bytes(11, event))
+
+    with open(out_filepath, 'wb') as f:
+        for packet in packets:
+            f.write(pb_bytes(1, packet))
+
+def main():
+    if len(sys.argv) < 2:
+        print('Usage: python profile-trace-convert.py capture.rtrace [output.json|output.perfetto-trace]')
+        return 1
+
+    in_filepath = sys.argv[1]
+    out_filepath = sys.argv[2] if len(sys.argv) > 2 else os.path.splitext(in_filepath)[0] + '.json'
+    with open(in_filepath, 'rb') as f:
+        capture = parse_trace(f.read())
+
+    if capture['num_dropped'] > 0:
+        print('warning: %d samples were dropped during the capture' % capture['num_dropped'])
+
+    ext = os.path.splitext(out_filepath)[1].lower()
+    if ext in ('.perfetto-trace', '.pftrace'):
+        write_perfetto(capture, out_filepath)
+    else:
+        write_json(capture, out_filepath)
+    print('written: %s (%d events)' % (out_filepath, len(capture['events'])))
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
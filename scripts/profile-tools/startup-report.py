@@ -0,0 +1,95 @@
+#
+# Copyright 2021 Sepehr Taghdisian (septag@github). All rights reserved.
+# License: https://github.com/septag/rizz#license-bsd-2-clause
+#
+# Prints the startup time breakdown from startup captures (run the app with --profile-startup, the
+# capture is saved to .profiler/startup.rtrace). Passing captures of multiple runs prints the
+# min/median/max of every sample, which is handy for comparing cold starts before and after a change
+# Usage:
+#   python startup-report.py startup.rtrace [startup2.rtrace ...] [--min-ms 0.1]
+#
+from __future__ import print_function
+import sys
+import os
+import importlib.util
+
+def load_trace_module():
+    filepath = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'profile-trace-convert.py')
+    spec = importlib.util.spec_from_file_location('profile_trace_convert', filepath)
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    return module
+
+# returns {(thread, path): (order, duration_ms)}, path is the tuple of sample names from the root
+# main thread is the one that starts the earliest sample, samples of all other threads are merged as 'jobs'
+def collect_samples(capture):
+    main_tid = min(capture['events'], key=lambda e: e[2])[0] if capture['events'] else 0
+    stacks = {}
+    samples = {}
+    for tid, end, tm, name, _, _ in capture['events']:
+        stack = stacks.setdefault(tid, [])
+        thread = 'main' if tid == main_tid else 'jobs'
+        if not end:
+            stack.append((tm, name))
+            key = (thread, tuple(s[1] for s in stack))
+            if key not in samples:
+                samples[key] = (len(samples), 0.0)
+        elif stack:
+            key = (thread, tuple(s[1] for s in stack))
+            begin_tm, _ = stack.pop()
+            order, duration = samples[key]
+            samples[key] = (order, duration + (tm - begin_tm)*capture['us_per_cycle']/1000.0)
+    return samples
+
+def median(values):
+    values = sorted(values)
+    n = len(values)
+    return values[n//2] if n % 2 else 0.5*(values[n//2 - 1] + values[n//2])
+
+def main():
+    args = sys.argv[1:]
+    min_ms = 0.0
+    if '--min-ms' in args:
+        i = args.index('--min-ms')
+        min_ms = float(args[i + 1])
+        del args[i:i+2]
+    if not args:
+        print('Usage: python startup-report.py startup.rtrace [startup2.rtrace ...] [--min-ms 0.1]')
+        return 1
+
+    trace = load_trace_module()
+    runs = []
+    for filepath in args:
+        with open(filepath, 'rb') as f:
+            runs.append(collect_samples(trace.parse_trace(f.read())))
+
+    keys = {}
+    for samples in runs:
+        for key, (order, _) in samples.items():
+            keys.setdefault(key, order)
+
+    multi = len(runs) > 1
+    if multi:
+        print('%-56s %10s %10s %10s' % ('sample (%d runs)' % len(runs), 'min(ms)', 'median', 'max'))
+    else:
+        print('%-56s %10s' % ('sample', 'time(ms)'))
+
+    # main thread first, job samples are grouped under their own root
+    for thread in ('main', 'jobs'):
+        thread_keys = sorted((k for k in keys if k[0] == thread), key=lambda k: keys[k])
+        if not thread_keys:
+            continue
+        print('[%s]' % thread)
+        for key in thread_keys:
+            durations = [samples[key][1] for samples in runs if key in samples]
+            if max(durations) < min_ms:
+                continue
+            label = '  '*len(key[1]) + key[1][-1]
+            if multi:
+                print('%-56s %10.3f %10.3f %10.3f' % (label, min(durations), median(durations), max(durations)))
+            else:
+                print('%-56s %10.3f' % (label, durations[0]))
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -13,6 +13,7 @@
 #include "sx/handle.h"
 #include "sx/array.h"
 #include "sx/io.h"
+#include "sx/vertex-pack.h"
 
 #define SX_MAX_BUFFER_FIELDS 128
 #include "sx/linear-buffer.h"
@@ -46,6 +47,9 @@ typedef struct rizz_model_context
 
 RIZZ_STATE static rizz_model_context g_model;
 
+// number of vertices that are converted at once when packing attributes to compressed formats
+#define MODEL__PACK_CHUNK_SIZE 256
+
 typedef enum {
     GLTF_FILTER_NEAREST = 9728,
     GLTF_FILTER_LINEAR = 9729,
@@ -232,6 +236,154 @@ static int model__get_stride(sg_vertex_format fmt)
     }
 }
 
+static bool model__is_float_format(sg_vertex_format fmt)
+{
+    return fmt == SG_VERTEXFORMAT_FLOAT || fmt == SG_VERTEXFORMAT_FLOAT2 ||
+           fmt == SG_VERTEXFORMAT_FLOAT3 || fmt == SG_VERTEXFORMAT_FLOAT4;
+}
+
+static bool model__is_direction_semantic(const char* semantic)
+{
+    return sx_strequal(semantic, "NORMAL") || sx_strequal(semantic, "TANGENT") ||
+           sx_strequal(semantic, "BINORMAL");
+}
+
+// number of source floats per vertex that model__pack_attribute takes for the format
+// SHORT2N directions (octahedral) and USHORT4N positions (quantized) take a full vec3
+static int model__get_pack_components(sg_vertex_format fmt, const char* semantic)
+{
+    switch (fmt) {
+    case SG_VERTEXFORMAT_FLOAT:     return 1;
+    case SG_VERTEXFORMAT_FLOAT2:    return 2;
+    case SG_VERTEXFORMAT_FLOAT3:    return 3;
+    case SG_VERTEXFORMAT_SHORT2:    
+    case SG_VERTEXFORMAT_USHORT2N:  return 2;
+    case SG_VERTEXFORMAT_SHORT2N:   return model__is_direction_semantic(semantic) ? 3 : 2;
+    case SG_VERTEXFORMAT_USHORT4N:  return sx_strequal(semantic, "POSITION") ? 3 : 4;
+    default:                        return 4;
+    }
+}
+
+// packs `count` vertices of contiguous source floats (see model__get_pack_components) to the
+// vertex format. output is also contiguous, model__get_stride(fmt) bytes for each vertex
+static void model__pack_attribute(uint8_t* dst, const float* src, int count, sg_vertex_format fmt,
+                                  const char* semantic, const sx_aabb* bounds)
+{
+    switch (fmt) {
+    case SG_VERTEXFORMAT_FLOAT:
+    case SG_VERTEXFORMAT_FLOAT2:
+    case SG_VERTEXFORMAT_FLOAT3:
+    case SG_VERTEXFORMAT_FLOAT4:
+        sx_memcpy(dst, src, sizeof(float) * model__get_pack_components(fmt, semantic) * count);
+        break;
+    case SG_VERTEXFORMAT_BYTE4N:
+        sx_pack_snorm8((int8_t*)dst, src, count * 4);
+        break;
+    case SG_VERTEXFORMAT_UBYTE4N:
+        sx_pack_unorm8(dst, src, count * 4);
+        break;
+    case SG_VERTEXFORMAT_BYTE4:
+        for (int i = 0; i < count * 4; i++) {
+            ((int8_t*)dst)[i] = (int8_t)src[i];
+        }
+        break;
+    case SG_VERTEXFORMAT_UBYTE4:
+        for (int i = 0; i < count * 4; i++) {
+            dst[i] = (uint8_t)src[i];
+        }
+        break;
+    case SG_VERTEXFORMAT_SHORT2:
+    case SG_VERTEXFORMAT_SHORT4: {
+        int num_comps = fmt == SG_VERTEXFORMAT_SHORT2 ? 2 : 4;
+        for (int i = 0; i < count * num_comps; i++) {
+            ((int16_t*)dst)[i] = (int16_t)src[i];
+        }
+        break;
+    }
+    case SG_VERTEXFORMAT_SHORT2N:
+        if (model__is_direction_semantic(semantic)) {
+            sx_pack_oct_snorm16((int16_t*)dst, (const sx_vec3*)src, count);
+        } else {
+            sx_pack_snorm16((int16_t*)dst, src, count * 2);
+        }
+        break;
+    case SG_VERTEXFORMAT_SHORT4N:
+        sx_pack_snorm16((int16_t*)dst, src, count * 4);
+        break;
+    case SG_VERTEXFORMAT_USHORT2N:
+        sx_pack_unorm16((uint16_t*)dst, src, count * 2);
+        break;
+    case SG_VERTEXFORMAT_USHORT4N:
+        if (sx_strequal(semantic, "POSITION")) {
+            sx_pack_quantize_pos((uint16_t*)dst, (const sx_vec3*)src, count, bounds);
+        } else {
+            sx_pack_unorm16((uint16_t*)dst, src, count * 4);
+        }
+        break;
+    default:
+        sx_assertf(0, "vertex format is not supported by model loader");
+        break;
+    }
+}
+
+// reads back a single vertex attribute written by model__pack_attribute
+static sx_vec4 model__unpack_attribute(const uint8_t* src, sg_vertex_format fmt, const char* semantic,
+                                       const sx_aabb* bounds)
+{
+    sx_vec4 r = sx_vec4f(0, 0, 0, 1.0f);
+    switch (fmt) {
+    case SG_VERTEXFORMAT_FLOAT:
+    case SG_VERTEXFORMAT_FLOAT2:
+    case SG_VERTEXFORMAT_FLOAT3:
+    case SG_VERTEXFORMAT_FLOAT4:
+        sx_memcpy(r.f, src, sizeof(float) * model__get_pack_components(fmt, semantic));
+        break;
+    case SG_VERTEXFORMAT_SHORT2N:
+        if (model__is_direction_semantic(semantic)) {
+            sx_vec3 n;
+            sx_unpack_oct_snorm16(&n, (const int16_t*)src, 1);
+            r = sx_vec4v3(n, 0);
+            break;
+        }
+        // fall through
+    case SG_VERTEXFORMAT_SHORT4N: {
+        int num_comps = fmt == SG_VERTEXFORMAT_SHORT2N ? 2 : 4;
+        for (int i = 0; i < num_comps; i++) {
+            r.f[i] = sx_max((float)((const int16_t*)src)[i] / 32767.0f, -1.0f);
+        }
+        break;
+    }
+    case SG_VERTEXFORMAT_USHORT2N:
+    case SG_VERTEXFORMAT_USHORT4N: {
+        int num_comps = fmt == SG_VERTEXFORMAT_USHORT2N ? 2 : 4;
+        for (int i = 0; i < num_comps; i++) {
+            r.f[i] = (float)((const uint16_t*)src)[i] / 65535.0f;
+        }
+        if (fmt == SG_VERTEXFORMAT_USHORT4N && sx_strequal(semantic, "POSITION")) {
+            r.x = bounds->xmin + r.x * (bounds->xmax - bounds->xmin);
+            r.y = bounds->ymin + r.y * (bounds->ymax - bounds->ymin);
+            r.z = bounds->zmin + r.z * (bounds->zmax - bounds->zmin);
+            r.w = 1.0f;
+        }
+        break;
+    }
+    case SG_VERTEXFORMAT_BYTE4N:
+        for (int i = 0; i < 4; i++) {
+            r.f[i] = sx_max((float)((const int8_t*)src)[i] / 127.0f, -1.0f);
+        }
+        break;
+    case SG_VERTEXFORMAT_UBYTE4N:
+        for (int i = 0; i < 4; i++) {
+            r.f[i] = (float)src[i] / 255.0f;
+        }
+        break;
+    default:
+        sx_assertf(0, "vertex format is not supported by model loader");
+        break;
+    }
+    return r;
+}
+
 static bool model__map_attributes_to_buffer(rizz_model_mesh* mesh, 
                                             const rizz_model_geometry_layout* vertex_layout, 
                                             cgltf_attribute* srcatt, int start_vertex)
@@ -242,20 +394,47 @@ static bool model__map_attributes_to_buffer(rizz_model_mesh* mesh,
     while (attr->semantic) {
         if (sx_strequal(attr->semantic, mapped_att.semantic) && attr->semantic_idx == mapped_att.index) {
             int vertex_stride = vertex_layout->buffer_strides[attr->buffer_index];
-            uint8_t* src_buff = (uint8_t*)access->buffer_view->buffer->data;
             uint8_t* dst_buff = (uint8_t*)mesh->cpu.vbuffs[attr->buffer_index];
             int dst_offset =  start_vertex * vertex_stride + attr->offset;
-            int src_offset = (int)(access->offset + access->buffer_view->offset);
 
             int count = (int)access->count;
-            int src_data_size = (int)access->stride; 
             int dst_data_size = model__get_stride(attr->format);
             sx_assertf(dst_data_size != 0, "you must explicitly declare formats for vertex_layout attributes");
-            int stride = sx_min(dst_data_size, src_data_size);
-            for (int i = 0; i < count; i++) {
-                sx_memcpy(dst_buff + dst_offset + vertex_stride*i, 
-                          src_buff + src_offset + src_data_size*i, 
-                          stride);
+
+            // float source to float destination: plain copy
+            if (model__is_float_format(attr->format) && access->component_type == cgltf_component_type_r_32f &&
+                !access->is_sparse) {
+                uint8_t* src_buff = (uint8_t*)access->buffer_view->buffer->data;
+                int src_offset = (int)(access->offset + access->buffer_view->offset);
+                int src_data_size = (int)access->stride; 
+                int stride = sx_min(dst_data_size, src_data_size);
+                for (int i = 0; i < count; i++) {
+                    sx_memcpy(dst_buff + dst_offset + vertex_stride*i, 
+                              src_buff + src_offset + src_data_size*i, 
+                              stride);
+                }
+                return true;
+            }
+
+            // compressed destination: convert the source to floats and pack them in chunks, so the 
+            // pack functions can work on contiguous arrays, then scatter the result to vertices
+            int num_comps = model__get_pack_components(attr->format, attr->semantic);
+            float floats[MODEL__PACK_CHUNK_SIZE * 4];
+            uint8_t packed[MODEL__PACK_CHUNK_SIZE * 16];
+            for (int base = 0; base < count; base += MODEL__PACK_CHUNK_SIZE) {
+                int num_verts = sx_min(MODEL__PACK_CHUNK_SIZE, count - base);
+                for (int i = 0; i < num_verts; i++) {
+                    float v[4] = { 0, 0, 0, 1.0f };
+                    cgltf_accessor_read_float(access, (cgltf_size)(base + i), v, 4);
+                    sx_memcpy(floats + i*num_comps, v, sizeof(float)*num_comps);
+                }
+
+                model__pack_attribute(packed, floats, num_verts, attr->format, attr->semantic, &mesh->bounds);
+
+                uint8_t* dst = dst_buff + dst_offset + vertex_stride*base;
+                for (int i = 0; i < num_verts; i++) {
+                    sx_memcpy(dst + vertex_stride*i, packed + dst_data_size*i, dst_data_size);
+                }
             }
 
             return true;
@@ -290,13 +469,15 @@ static bool model__gltf_has_tangents(const cgltf_primitive* prim)
 }
 
 static uint8_t* model__layout_get_attr(rizz_model_mesh* mesh, const rizz_model_geometry_layout* vertex_layout, 
-                                       const char* semantic, int semantic_idx, int* pvertex_stride)
+                                       const char* semantic, int semantic_idx, int* pvertex_stride,
+                                       sg_vertex_format* pformat)
 {
     const rizz_vertex_attr* attr = &vertex_layout->attrs[0];
     
     while (attr->semantic) {
         if (sx_strequal(attr->semantic, semantic) && attr->semantic_idx == semantic_idx) {
             *pvertex_stride = vertex_layout->buffer_strides[attr->buffer_index];
+            *pformat = attr->format;
             uint8_t* dst_buff = (uint8_t*)mesh->cpu.vbuffs[attr->buffer_index];
             return dst_buff + attr->offset;
         }
@@ -306,11 +487,34 @@ static uint8_t* model__layout_get_attr(rizz_model_mesh* mesh, const rizz_model_g
     return NULL;
 }
 
+static void model__write_direction(uint8_t* dst, sg_vertex_format fmt, const char* semantic, sx_vec3 dir)
+{
+    uint8_t packed[16];
+    sx_vec4 v = sx_vec4v3(dir, 1.0f);
+    model__pack_attribute(packed, v.f, 1, fmt, semantic, NULL);
+    sx_memcpy(dst, packed, model__get_stride(fmt));
+}
+
 static void model__calculate_tangents(rizz_model_mesh* mesh, const rizz_model_geometry_layout* vertex_layout)
 {
     sg_index_type index_type = mesh->index_type;
     void* ibuff = mesh->cpu.ibuff;
 
+    // vertex data may already be packed to compressed formats, so read/write them through the 
+    // format aware functions
+    int pos_stride = 0, uv_stride = 0, normal_stride = 0, tangent_stride = 0, bitangent_stride = 0;
+    sg_vertex_format pos_fmt, uv_fmt, normal_fmt, tangent_fmt, bitangent_fmt;
+    uint8_t* pos_ptr = model__layout_get_attr(mesh, vertex_layout, "POSITION", 0, &pos_stride, &pos_fmt);
+    uint8_t* uv_ptr = model__layout_get_attr(mesh, vertex_layout, "TEXCOORD", 0, &uv_stride, &uv_fmt);
+    uint8_t* normal_ptr = model__layout_get_attr(mesh, vertex_layout, "NORMAL", 0, &normal_stride, &normal_fmt);
+    uint8_t* tangent_ptr = model__layout_get_attr(mesh, vertex_layout, "TANGENT", 0, &tangent_stride, &tangent_fmt);
+    uint8_t* bitangent_ptr = model__layout_get_attr(mesh, vertex_layout, "BINORMAL", 0, &bitangent_stride, &bitangent_fmt);
+    if (!pos_ptr || !uv_ptr || !normal_ptr || !tangent_ptr) {
+        rizz_log_warn("model: mesh '%s' needs POSITION, TEXCOORD, NORMAL and TANGENT in the layout to calculate tangents",
+                      mesh->name);
+        return;
+    }
+
     const sx_alloc* tmp_alloc = the_core->tmp_alloc_push();
     sx_scope(the_core->tmp_alloc_pop()) {
 
@@ -335,18 +539,13 @@ static void model__calculate_tangents(rizz_model_mesh* mesh, const rizz_model_ge
                 i3 = indices[i+2];
             }
 
-            int pos_stride = 0, uv_stride = 0;
-            uint8_t* pos_ptr = model__layout_get_attr(mesh, vertex_layout, "POSITION", 0, &pos_stride);
-            uint8_t* uv_ptr = model__layout_get_attr(mesh, vertex_layout, "TEXCOORD", 0, &uv_stride);
-
-            sx_vec3 v1 = *((sx_vec3*)(pos_ptr + pos_stride*i1));
-            sx_vec3 v2 = *((sx_vec3*)(pos_ptr + pos_stride*i2));
-            sx_vec3 v3 = *((sx_vec3*)(pos_ptr + pos_stride*i3));
-
-            sx_vec2 w1 = *((sx_vec2*)(uv_ptr + uv_stride*i1));
-            sx_vec2 w2 = *((sx_vec2*)(uv_ptr + uv_stride*i2));
-            sx_vec2 w3 = *((sx_vec2*)(uv_ptr + uv_stride*i3));
+            sx_vec4 v1 = model__unpack_attribute(pos_ptr + pos_stride*i1, pos_fmt, "POSITION", &mesh->bounds);
+            sx_vec4 v2 = model__unpack_attribute(pos_ptr + pos_stride*i2, pos_fmt, "POSITION", &mesh->bounds);
+            sx_vec4 v3 = model__unpack_attribute(pos_ptr + pos_stride*i3, pos_fmt, "POSITION", &mesh->bounds);
 
+            sx_vec4 w1 = model__unpack_attribute(uv_ptr + uv_stride*i1, uv_fmt, "TEXCOORD", NULL);
+            sx_vec4 w2 = model__unpack_attribute(uv_ptr + uv_stride*i2, uv_fmt, "TEXCOORD", NULL);
+            sx_vec4 w3 = model__unpack_attribute(uv_ptr + uv_stride*i3, uv_fmt, "TEXCOORD", NULL);
             float x1 = v2.x - v1.x;
             float x2 = v3.x - v1.x;
             float y1 = v2.y - v1.y;
@@ -374,22 +573,21 @@ static void model__calculate_tangents(rizz_model_mesh* mesh, const rizz_model_ge
         }
 
         for (int i = 0, num_verts = mesh->num_vertices; i < num_verts; i++) {
-            int normal_stride = 0, tangent_stride = 0, bitangent_stride = 0;
-            uint8_t* normal_ptr = model__layout_get_attr(mesh, vertex_layout, "NORMAL", 0, &normal_stride);
-            uint8_t* tangent_ptr = model__layout_get_attr(mesh, vertex_layout, "TANGENT", 0, &tangent_stride);
-            uint8_t* bitangent_ptr = model__layout_get_attr(mesh, vertex_layout, "BINORMAL", 0, &bitangent_stride);
-
-            sx_vec3 n = *((sx_vec3*)(normal_ptr + normal_stride*i));
+            sx_vec4 nv = model__unpack_attribute(normal_ptr + normal_stride*i, normal_fmt, "NORMAL", NULL);
+            sx_vec3 n = sx_vec3fv(nv.f);
             sx_vec3 t = tan1[i];
         
             if (sx_vec3_dot(t, t) != 0) {
                 sx_vec3 tangent = sx_vec3_norm(sx_vec3_sub(t, sx_vec3_mulf(n, sx_vec3_dot(n, t))));
-                *((sx_vec3*)(tangent_ptr + tangent_stride*i)) = tangent;
+                model__write_direction(tangent_ptr + tangent_stride*i, tangent_fmt, "TANGENT", tangent);
         
                 // (Dot(Cross(n, t), tan2[a]) < 0.0F) ? -1.0F : 1.0F;
                 float handedness = (sx_vec3_dot(sx_vec3_cross(n, t), tan2[i]) < 0.0f) ? -1.0f : 1.0f;
 
-                *((sx_vec3*)(bitangent_ptr + bitangent_stride*i)) = sx_vec3_mulf(sx_vec3_cross(n, tangent), -handedness);
+                if (bitangent_ptr) {
+                    model__write_direction(bitangent_ptr + bitangent_stride*i, bitangent_fmt, "BINORMAL",
+                                           sx_vec3_mulf(sx_vec3_cross(n, tangent), -handedness));
+                }
             }
         }
     }   // scope
@@ -408,6 +606,30 @@ static void model__setup_buffers(rizz_model_mesh* mesh, const rizz_model_geometr
     bool calc_tangents = false;
     bool layout_has_tangents = model__layout_has_tangents(vertex_layout);
 
+    // mesh bounds must be known before mapping the attributes, quantized positions depend on them
+    mesh->bounds = sx_aabb_empty();
+    for (cgltf_size i = 0; i < srcmesh->primitives_count; i++) {
+        cgltf_primitive* srcprim = &srcmesh->primitives[i];
+        for (cgltf_size k = 0; k < srcprim->attributes_count; k++) {
+            cgltf_attribute* srcatt = &srcprim->attributes[k];
+            if (srcatt->type != cgltf_attribute_type_position || srcatt->index != 0) {
+                continue;
+            }
+
+            cgltf_accessor* access = srcatt->data;
+            if (access->has_min && access->has_max) {
+                sx_aabb_add_point(&mesh->bounds, sx_vec3fv(access->min));
+                sx_aabb_add_point(&mesh->bounds, sx_vec3fv(access->max));
+            } else {
+                for (cgltf_size v = 0; v < access->count; v++) {
+                    float pos[3] = { 0 };
+                    cgltf_accessor_read_float(access, v, pos, 3);
+                    sx_aabb_add_point(&mesh->bounds, sx_vec3fv(pos));
+                }
+            }
+        }
+    }
+
     for (int i = 0; i < (int)srcmesh->primitives_count; i++) {
         cgltf_primitive* srcprim = &srcmesh->primitives[i];
 
@@ -820,18 +1042,7 @@ static bool model__on_load(rizz_asset_load_data* data, const rizz_asset_load_par
                 }
 
                 // bounds
-                sx_aabb bounds = sx_aabb_empty();
-                if (node->mesh_id != -1) {
-                    rizz_model_mesh* mesh = &model->meshes[node->mesh_id];
-                    const rizz_vertex_attr* attr = model__find_attribute(layout, "POSITION", 0);
-                    int vertex_stride = layout->buffer_strides[attr->buffer_index];
-                    uint8_t* vbuff = mesh->cpu.vbuffs[attr->buffer_index];
-                    for (int v = 0; v < mesh->num_vertices; v++) {
-                        sx_vec3 pos = *((sx_vec3*)(vbuff + v*vertex_stride + attr->offset));
-                        sx_aabb_add_point(&bounds, pos);
-                    }
-                }
-                node->bounds = bounds;
+                node->bounds = node->mesh_id != -1 ? model->meshes[node->mesh_id].bounds : sx_aabb_empty();
             }
 
             // build node hierarchy based on node names
@@ -1823,6 +1823,17 @@ static void imgui__graphics_debugger(const rizz_gfx_trace_info* info, bool* p_op
                     the__imgui.EndTable();
                 }
                 the__imgui.Separator();
+
+                if (pf->num_gpu_samples > 0) {
+                    imgui__label_spacing(text_offset, -1.0f, "GpuTime (ms)", "%.2f", pf->gpu_ms);
+                    for (int i = 0; i < pf->num_gpu_samples; i++) {
+                        const rizz_gfx_gpu_sample* sample = &pf->gpu_samples[i];
+                        char label[64];
+                        sx_snprintf(label, sizeof(label), "%*s%s", sample->depth * 2, "", sample->name);
+                        imgui__label_spacing(text_offset * 2.0f, -1.0f, label, "%.2f", sample->ms);
+                    }
+                    the__imgui.Separator();
+                }
                 
                 imgui__label_spacing(text_offset, -1.0f, "Pipelines", "%d", info->num_pipelines);
                 imgui__label_spacing(text_offset, -1.0f, "Shaders", "%d", info->num_shaders);
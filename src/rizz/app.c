@@ -251,6 +251,8 @@ static uint32_t rizz__app_convert_core_flags(const char* value)
         return RIZZ_CORE_FLAG_TRACE_TEMP_ALLOCATOR;
     } else if (sx_strequalnocase(value, "HOT_RELOAD_PLUGINS")) {
         return RIZZ_CORE_FLAG_HOT_RELOAD_PLUGINS;
+    } else if (sx_strequalnocase(value, "LOG_TO_BINARY_FILE")) {
+        return RIZZ_CORE_FLAG_LOG_TO_BINARY_FILE;
     } else {
         return 0;
     }
@@ -329,6 +331,16 @@ static void rizz__app_load_ini(const char* filename, rizz_config* conf)
                 id = sx_ini_find_property(ini, rizz_id, "log_level", 0);
                 if (id != -1) 
                     conf->log_level = rizz__app_convert_log_level(sx_ini_property_value(ini, rizz_id, id));
+                id = sx_ini_find_property(ini, rizz_id, "log_queue_policy", 0);
+                if (id != -1) {
+                    const char* policy = sx_ini_property_value(ini, rizz_id, id);
+                    if (sx_strequalnocase(policy, "drop")) 
+                        conf->log_queue_policy = RIZZ_LOG_QUEUE_POLICY_DROP;
+                    else if (sx_strequalnocase(policy, "sync"))
+                        conf->log_queue_policy = RIZZ_LOG_QUEUE_POLICY_SYNC;
+                    else 
+                        conf->log_queue_policy = RIZZ_LOG_QUEUE_POLICY_BLOCK;
+                }
                 id = sx_ini_find_property(ini, rizz_id, "window_width", 0);
                 if (id != -1) 
                     conf->window_width = sx_toint(sx_ini_property_value(ini, rizz_id, id));
@@ -374,12 +386,24 @@ static void rizz__app_load_ini(const char* filename, rizz_config* conf)
                 id = sx_ini_find_property(ini, rizz_id, "tmp_mem_max", 0);
                 if (id != -1)
                     conf->tmp_mem_max = sx_toint(sx_ini_property_value(ini, rizz_id, id));
+                id = sx_ini_find_property(ini, rizz_id, "fixed_step_rate", 0);
+                if (id != -1)
+                    conf->fixed_step_rate = sx_toint(sx_ini_property_value(ini, rizz_id, id));
+                id = sx_ini_find_property(ini, rizz_id, "fixed_step_max_steps", 0);
+                if (id != -1)
+                    conf->fixed_step_max_steps = sx_toint(sx_ini_property_value(ini, rizz_id, id));
                 id = sx_ini_find_property(ini, rizz_id, "profiler_listen_port", 0);
                 if (id != -1)
                     conf->profiler_listen_port = sx_toint(sx_ini_property_value(ini, rizz_id, id));
                 id = sx_ini_find_property(ini, rizz_id, "profiler_update_interval_ms", 0);
                 if (id != -1)
                     conf->profiler_update_interval_ms = sx_toint(sx_ini_property_value(ini, rizz_id, id));
+                id = sx_ini_find_property(ini, rizz_id, "profiler_history_secs", 0);
+                if (id != -1)
+                    conf->profiler_history_secs = sx_toint(sx_ini_property_value(ini, rizz_id, id));
+                id = sx_ini_find_property(ini, rizz_id, "profiler_spike_threshold_ms", 0);
+                if (id != -1)
+                    conf->profiler_spike_threshold_ms = sx_tofloat(sx_ini_property_value(ini, rizz_id, id));
                 id = sx_ini_find_property(ini, rizz_id, "imgui_docking", 0);
                 if (id != -1) 
                     conf->imgui_docking = sx_tobool(sx_ini_property_value(ini, rizz_id, id));
@@ -419,6 +443,7 @@ static void rizz__app_init(void)
     if (!rizz__core_init(&g_app.conf)) {
         rizz__log_error("core init failed");
         rizz__profile_startup_end();
+        rizz__log_flush();
         rizz__app_message_box("core init failed, see log for details");
         exit(-1);
     }
@@ -426,19 +451,16 @@ static void rizz__app_init(void)
 
     // add game plugins
     int num_plugins = 0;
-    rizz__profile_startup_begin("plugins_load");
-    for (int i = 0; i < RIZZ_CONFIG_MAX_PLUGINS; i++) {
-        if (!g_app.conf.plugins[i] || !g_app.conf.plugins[i][0])
-            break;
-        
-        rizz__profile_startup_begin(g_app.conf.plugins[i]);
-        if (!the__plugin.load(g_app.conf.plugins[i])) {
-            exit(-1);
-        }
-        rizz__profile_startup_end();
-        
+    while (num_plugins < RIZZ_CONFIG_MAX_PLUGINS && g_app.conf.plugins[num_plugins] &&
+           g_app.conf.plugins[num_plugins][0]) {
         ++num_plugins;
     }
+
+    rizz__profile_startup_begin("plugins_load");
+    if (!rizz__plugin_load_all(g_app.conf.plugins, num_plugins)) {
+        rizz__log_flush();
+        exit(-1);
+    }
     rizz__profile_startup_end();
 
     // add game
@@ -447,6 +469,7 @@ static void rizz__app_init(void)
         if (!rizz__plugin_load_abs(g_app.game_filepath, true, g_app.conf.plugins, num_plugins)) {
             sx_snprintf(errmsg, sizeof(errmsg), g_app.game_filepath);
             rizz__log_error(errmsg);
+            rizz__log_flush();
             rizz__app_message_box(errmsg);
             exit(-1);
         }
@@ -454,6 +477,7 @@ static void rizz__app_init(void)
         if (!rizz__plugin_load_abs(ENTRY_NAME, true, g_app.conf.plugins, num_plugins)) {
             sx_snprintf(errmsg, sizeof(errmsg), g_app.game_filepath);
             rizz__log_error(errmsg);
+            rizz__log_flush();
             rizz__app_message_box(errmsg);
             exit(-1);
         }
@@ -464,6 +488,7 @@ static void rizz__app_init(void)
     rizz__profile_startup_begin("init_plugins");
     if (!rizz__plugin_init_plugins()) {
         rizz__log_error("initializing plugins failed");
+        rizz__log_flush();
         rizz__app_message_box("initializing plugins failed, see log for details");
         exit(-1);
     }
@@ -710,7 +735,7 @@ sapp_desc sokol_main(int argc, char* argv[])
         { "version", 'V', SX_CMDLINE_OPTYPE_FLAG_SET, &version, 1, "Print version", 0x0 },
         { "run", 'r', SX_CMDLINE_OPTYPE_REQUIRED, 0x0, 'r', "Game/App module to run", "filepath" },
         { "profile-gpu", 'g', SX_CMDLINE_OPTYPE_FLAG_SET, &profile_gpu, 1, "Enable gpu profiler", 0x0 },
-        { "profile-startup", 'S', SX_CMDLINE_OPTYPE_FLAG_SET, &profile_startup, 1, "Profile startup times and save them to .profile/startup.json", 0x0 },
+        { "profile-startup", 'S', SX_CMDLINE_OPTYPE_FLAG_SET, &profile_startup, 1, "Profile startup times and save them to .profiler/startup.rtrace", 0x0 },
         { "cwd", 'c', SX_CMDLINE_OPTYPE_REQUIRED, 0x0, 'c', "Change current directory after initialization", 0x0 },
         { "dump-unused-assets", 'U', SX_CMDLINE_OPTYPE_FLAG_SET, &dump_unused_assets, 1, "Dump unused assets into `unused-assets.json`", 0x0 },
         { "crash-dump", 'd', SX_CMDLINE_OPTYPE_FLAG_SET, &crash_dump, 1, "Create crash dump file on program exceptions", 0x0 },
@@ -825,8 +850,10 @@ sapp_desc sokol_main(int argc, char* argv[])
                          .coro_num_init_fibers = 64,
                          .coro_stack_size = 2048,
                          .tmp_mem_max = 10*1024,
+                         .fixed_step_max_steps = 5,
                          .profiler_listen_port = 17815,    // default remotery port
-                         .profiler_update_interval_ms = 10 };
+                         .profiler_update_interval_ms = 10,
+                         .profiler_history_secs = 2 };
 
     if (profile_gpu)
         conf.core_flags |= RIZZ_CORE_FLAG_PROFILE_GPU;
@@ -5,6 +5,27 @@
 #include "internal.h"
 #include "sx/math-vec.h"
 
+#if !SX_CONFIG_SIMD_DISABLE
+#    if defined(__SSE2__) || (SX_COMPILER_MSVC && (SX_ARCH_64BIT || _M_IX86_FP >= 2))
+#        include <xmmintrin.h>
+#        define RIZZ__CULL_SSE 1
+#    elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#        include <arm_neon.h>
+#        define RIZZ__CULL_NEON 1
+#    endif
+#endif
+
+#ifndef RIZZ__CULL_SSE
+#    define RIZZ__CULL_SSE 0
+#endif
+#ifndef RIZZ__CULL_NEON
+#    define RIZZ__CULL_NEON 0
+#endif
+
+// batches bigger than this are split into jobs in cull_xxx_mt functions
+// must be a multiple of 32 so each job writes to it's own range of visibility words
+#define RIZZ__CULL_ITEMS_PER_JOB 4096
+
 static void rizz__cam_init(rizz_camera* cam, float fov_deg, sx_rect viewport, float fnear, float ffar)
 {
     cam->right = SX_VEC3_UNITX;
@@ -137,6 +158,288 @@ static void rizz__calc_frustum_planes(sx_plane frustum[_RIZZ_CAMERA_VIEWPLANE_CO
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Culling: planes are splatted once, then 4 bounds are tested against each plane in SoA form
+// AABB test is center/extent: visible if dot(n, c) + d + dot(|n|, e) >= 0 for all planes
+// Sphere test: visible if dot(n, c) + d + r >= 0 for all planes
+#if RIZZ__CULL_SSE
+typedef __m128 rizz__cull_vec;
+#    define rizz__cull_load(_p) _mm_loadu_ps(_p)
+#    define rizz__cull_splat(_f) _mm_set1_ps(_f)
+#    define rizz__cull_add(_a, _b) _mm_add_ps((_a), (_b))
+#    define rizz__cull_mul(_a, _b) _mm_mul_ps((_a), (_b))
+#    define rizz__cull_ge_zero(_a) _mm_cmpge_ps((_a), _mm_setzero_ps())
+#    define rizz__cull_and(_a, _b) _mm_and_ps((_a), (_b))
+#    define rizz__cull_true() _mm_castsi128_ps(_mm_set1_epi32(-1))
+#    define rizz__cull_movemask(_a) (uint32_t)_mm_movemask_ps(_a)
+#elif RIZZ__CULL_NEON
+typedef float32x4_t rizz__cull_vec;
+#    define rizz__cull_load(_p) vld1q_f32(_p)
+#    define rizz__cull_splat(_f) vdupq_n_f32(_f)
+#    define rizz__cull_add(_a, _b) vaddq_f32((_a), (_b))
+#    define rizz__cull_mul(_a, _b) vmulq_f32((_a), (_b))
+#    define rizz__cull_ge_zero(_a) vreinterpretq_f32_u32(vcgeq_f32((_a), vdupq_n_f32(0)))
+#    define rizz__cull_and(_a, _b) \
+        vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(_a), vreinterpretq_u32_f32(_b)))
+#    define rizz__cull_true() vreinterpretq_f32_u32(vdupq_n_u32(0xffffffff))
+static inline uint32_t rizz__cull_movemask(float32x4_t a)
+{
+    static const uint32_t k_bits[4] = { 1, 2, 4, 8 };
+    uint32x4_t m = vandq_u32(vreinterpretq_u32_f32(a), vld1q_u32(k_bits));
+    uint32x2_t r = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+    return vget_lane_u32(vpadd_u32(r, r), 0);
+}
+#endif
+
+#if RIZZ__CULL_SSE || RIZZ__CULL_NEON
+#    define RIZZ__CULL_SIMD 1
+
+typedef struct rizz__cull_planes {
+    rizz__cull_vec nx[_RIZZ_CAMERA_VIEWPLANE_COUNT];
+    rizz__cull_vec ny[_RIZZ_CAMERA_VIEWPLANE_COUNT];
+    rizz__cull_vec nz[_RIZZ_CAMERA_VIEWPLANE_COUNT];
+    rizz__cull_vec d[_RIZZ_CAMERA_VIEWPLANE_COUNT];
+    rizz__cull_vec anx[_RIZZ_CAMERA_VIEWPLANE_COUNT];
+    rizz__cull_vec any[_RIZZ_CAMERA_VIEWPLANE_COUNT];
+    rizz__cull_vec anz[_RIZZ_CAMERA_VIEWPLANE_COUNT];
+} rizz__cull_planes;
+
+static inline void rizz__cull_splat_planes(rizz__cull_planes* sp, const sx_plane* planes)
+{
+    for (int i = 0; i < _RIZZ_CAMERA_VIEWPLANE_COUNT; i++) {
+        sp->nx[i] = rizz__cull_splat(planes[i].normal[0]);
+        sp->ny[i] = rizz__cull_splat(planes[i].normal[1]);
+        sp->nz[i] = rizz__cull_splat(planes[i].normal[2]);
+        sp->d[i] = rizz__cull_splat(planes[i].dist);
+        sp->anx[i] = rizz__cull_splat(sx_abs(planes[i].normal[0]));
+        sp->any[i] = rizz__cull_splat(sx_abs(planes[i].normal[1]));
+        sp->anz[i] = rizz__cull_splat(sx_abs(planes[i].normal[2]));
+    }
+}
+#else
+#    define RIZZ__CULL_SIMD 0
+#endif
+
+static inline bool rizz__cull_test_aabb(const sx_plane* planes, const sx_aabb* aabb)
+{
+    float cx = (aabb->xmin + aabb->xmax) * 0.5f;
+    float cy = (aabb->ymin + aabb->ymax) * 0.5f;
+    float cz = (aabb->zmin + aabb->zmax) * 0.5f;
+    float ex = (aabb->xmax - aabb->xmin) * 0.5f;
+    float ey = (aabb->ymax - aabb->ymin) * 0.5f;
+    float ez = (aabb->zmax - aabb->zmin) * 0.5f;
+    for (int i = 0; i < _RIZZ_CAMERA_VIEWPLANE_COUNT; i++) {
+        const float* n = planes[i].normal;
+        float d = n[0] * cx + n[1] * cy + n[2] * cz + planes[i].dist;
+        float r = sx_abs(n[0]) * ex + sx_abs(n[1]) * ey + sx_abs(n[2]) * ez;
+        if (d + r < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline bool rizz__cull_test_sphere(const sx_plane* planes, const sx_vec4* sphere)
+{
+    for (int i = 0; i < _RIZZ_CAMERA_VIEWPLANE_COUNT; i++) {
+        const float* n = planes[i].normal;
+        float d = n[0] * sphere->x + n[1] * sphere->y + n[2] * sphere->z + planes[i].dist;
+        if (d + sphere->w < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// tests aabbs[start..end), `start` must be a multiple of 32, bits are written to
+// out_visible_bits[start/32...], whole words are overwritten
+static void rizz__cull_aabbs_range(const sx_plane* planes, const sx_aabb* aabbs, int start,
+                                   int end, uint32_t* out_visible_bits)
+{
+    sx_assert((start & 31) == 0);
+
+    int i = start;
+    uint32_t word = 0;
+#if RIZZ__CULL_SIMD
+    rizz__cull_planes sp;
+    rizz__cull_splat_planes(&sp, planes);
+
+    for (; i + 4 <= end; i += 4) {
+        float cx[4], cy[4], cz[4], ex[4], ey[4], ez[4];
+        for (int k = 0; k < 4; k++) {
+            const sx_aabb* aabb = &aabbs[i + k];
+            cx[k] = (aabb->xmin + aabb->xmax) * 0.5f;
+            cy[k] = (aabb->ymin + aabb->ymax) * 0.5f;
+            cz[k] = (aabb->zmin + aabb->zmax) * 0.5f;
+            ex[k] = (aabb->xmax - aabb->xmin) * 0.5f;
+            ey[k] = (aabb->ymax - aabb->ymin) * 0.5f;
+            ez[k] = (aabb->zmax - aabb->zmin) * 0.5f;
+        }
+
+        rizz__cull_vec vcx = rizz__cull_load(cx), vcy = rizz__cull_load(cy),
+                       vcz = rizz__cull_load(cz);
+        rizz__cull_vec vex = rizz__cull_load(ex), vey = rizz__cull_load(ey),
+                       vez = rizz__cull_load(ez);
+        rizz__cull_vec visible = rizz__cull_true();
+        for (int p = 0; p < _RIZZ_CAMERA_VIEWPLANE_COUNT; p++) {
+            rizz__cull_vec d = rizz__cull_add(
+                rizz__cull_add(rizz__cull_mul(sp.nx[p], vcx), rizz__cull_mul(sp.ny[p], vcy)),
+                rizz__cull_add(rizz__cull_mul(sp.nz[p], vcz), sp.d[p]));
+            rizz__cull_vec r = rizz__cull_add(
+                rizz__cull_add(rizz__cull_mul(sp.anx[p], vex), rizz__cull_mul(sp.any[p], vey)),
+                rizz__cull_mul(sp.anz[p], vez));
+            visible = rizz__cull_and(visible, rizz__cull_ge_zero(rizz__cull_add(d, r)));
+        }
+
+        word |= rizz__cull_movemask(visible) << (i & 31);
+        if ((i & 31) == 28) {
+            out_visible_bits[i >> 5] = word;
+            word = 0;
+        }
+    }
+#endif
+
+    for (; i < end; i++) {
+        word |= (rizz__cull_test_aabb(planes, &aabbs[i]) ? 1u : 0u) << (i & 31);
+        if ((i & 31) == 31) {
+            out_visible_bits[i >> 5] = word;
+            word = 0;
+        }
+    }
+
+    if (end & 31) {
+        out_visible_bits[end >> 5] = word;
+    }
+}
+
+static void rizz__cull_spheres_range(const sx_plane* planes, const sx_vec4* spheres, int start,
+                                     int end, uint32_t* out_visible_bits)
+{
+    sx_assert((start & 31) == 0);
+
+    int i = start;
+    uint32_t word = 0;
+#if RIZZ__CULL_SIMD
+    rizz__cull_planes sp;
+    rizz__cull_splat_planes(&sp, planes);
+
+    for (; i + 4 <= end; i += 4) {
+        float cx[4], cy[4], cz[4], r[4];
+        for (int k = 0; k < 4; k++) {
+            cx[k] = spheres[i + k].x;
+            cy[k] = spheres[i + k].y;
+            cz[k] = spheres[i + k].z;
+            r[k] = spheres[i + k].w;
+        }
+
+        rizz__cull_vec vcx = rizz__cull_load(cx), vcy = rizz__cull_load(cy),
+                       vcz = rizz__cull_load(cz), vr = rizz__cull_load(r);
+        rizz__cull_vec visible = rizz__cull_true();
+        for (int p = 0; p < _RIZZ_CAMERA_VIEWPLANE_COUNT; p++) {
+            rizz__cull_vec d = rizz__cull_add(
+                rizz__cull_add(rizz__cull_mul(sp.nx[p], vcx), rizz__cull_mul(sp.ny[p], vcy)),
+                rizz__cull_add(rizz__cull_mul(sp.nz[p], vcz), sp.d[p]));
+            visible = rizz__cull_and(visible, rizz__cull_ge_zero(rizz__cull_add(d, vr)));
+        }
+
+        word |= rizz__cull_movemask(visible) << (i & 31);
+        if ((i & 31) == 28) {
+            out_visible_bits[i >> 5] = word;
+            word = 0;
+        }
+    }
+#endif
+
+    for (; i < end; i++) {
+        word |= (rizz__cull_test_sphere(planes, &spheres[i]) ? 1u : 0u) << (i & 31);
+        if ((i & 31) == 31) {
+            out_visible_bits[i >> 5] = word;
+            word = 0;
+        }
+    }
+
+    if (end & 31) {
+        out_visible_bits[end >> 5] = word;
+    }
+}
+
+static void rizz__cull_aabbs(const sx_plane planes[_RIZZ_CAMERA_VIEWPLANE_COUNT],
+                             const sx_aabb* aabbs, int count, uint32_t* out_visible_bits)
+{
+    sx_assert(count >= 0);
+    rizz__cull_aabbs_range(planes, aabbs, 0, count, out_visible_bits);
+}
+
+static void rizz__cull_spheres(const sx_plane planes[_RIZZ_CAMERA_VIEWPLANE_COUNT],
+                               const sx_vec4* spheres, int count, uint32_t* out_visible_bits)
+{
+    sx_assert(count >= 0);
+    rizz__cull_spheres_range(planes, spheres, 0, count, out_visible_bits);
+}
+
+typedef struct rizz__cull_job_data {
+    const sx_plane* planes;
+    const void* bounds;
+    int count;
+    uint32_t* out_visible_bits;
+} rizz__cull_job_data;
+
+static void rizz__cull_aabbs_job_cb(int start, int end, int thrd_index, void* user)
+{
+    sx_unused(thrd_index);
+    const rizz__cull_job_data* data = user;
+    rizz__cull_aabbs_range(data->planes, data->bounds, start * RIZZ__CULL_ITEMS_PER_JOB,
+                           sx_min(end * RIZZ__CULL_ITEMS_PER_JOB, data->count),
+                           data->out_visible_bits);
+}
+
+static void rizz__cull_spheres_job_cb(int start, int end, int thrd_index, void* user)
+{
+    sx_unused(thrd_index);
+    const rizz__cull_job_data* data = user;
+    rizz__cull_spheres_range(data->planes, data->bounds, start * RIZZ__CULL_ITEMS_PER_JOB,
+                             sx_min(end * RIZZ__CULL_ITEMS_PER_JOB, data->count),
+                             data->out_visible_bits);
+}
+
+static void rizz__cull_aabbs_mt(const sx_plane planes[_RIZZ_CAMERA_VIEWPLANE_COUNT],
+                                const sx_aabb* aabbs, int count, uint32_t* out_visible_bits)
+{
+    sx_assert(count >= 0);
+    if (count <= RIZZ__CULL_ITEMS_PER_JOB) {
+        rizz__cull_aabbs_range(planes, aabbs, 0, count, out_visible_bits);
+        return;
+    }
+
+    rizz__cull_job_data data = { .planes = planes,
+                                 .bounds = aabbs,
+                                 .count = count,
+                                 .out_visible_bits = out_visible_bits };
+    int num_jobs = (count + RIZZ__CULL_ITEMS_PER_JOB - 1) / RIZZ__CULL_ITEMS_PER_JOB;
+    sx_job_t job = the__core.job_dispatch(num_jobs, rizz__cull_aabbs_job_cb, &data,
+                                          SX_JOB_PRIORITY_HIGH, 0);
+    the__core.job_wait_and_del(job);
+}
+
+static void rizz__cull_spheres_mt(const sx_plane planes[_RIZZ_CAMERA_VIEWPLANE_COUNT],
+                                  const sx_vec4* spheres, int count, uint32_t* out_visible_bits)
+{
+    sx_assert(count >= 0);
+    if (count <= RIZZ__CULL_ITEMS_PER_JOB) {
+        rizz__cull_spheres_range(planes, spheres, 0, count, out_visible_bits);
+        return;
+    }
+
+    rizz__cull_job_data data = { .planes = planes,
+                                 .bounds = spheres,
+                                 .count = count,
+                                 .out_visible_bits = out_visible_bits };
+    int num_jobs = (count + RIZZ__CULL_ITEMS_PER_JOB - 1) / RIZZ__CULL_ITEMS_PER_JOB;
+    sx_job_t job = the__core.job_dispatch(num_jobs, rizz__cull_spheres_job_cb, &data,
+                                          SX_JOB_PRIORITY_HIGH, 0);
+    the__core.job_wait_and_del(job);
+}
+
 static void rizz__cam_fps_init(rizz_camera_fps* cam, float fov_deg, const sx_rect viewport, float fnear, float ffar)
 {
     rizz__cam_init(&cam->cam, fov_deg, viewport, fnear, ffar);
@@ -203,6 +506,10 @@ rizz_api_camera the__camera = { .init = rizz__cam_init,
                                 .calc_frustum_points = rizz__calc_frustum_points,
                                 .calc_frustum_points_range = rizz__calc_frustum_points_range,
                                 .calc_frustum_planes = rizz__calc_frustum_planes,
+                                .cull_aabbs = rizz__cull_aabbs,
+                                .cull_spheres = rizz__cull_spheres,
+                                .cull_aabbs_mt = rizz__cull_aabbs_mt,
+                                .cull_spheres_mt = rizz__cull_spheres_mt,
                                 .fps_init = rizz__cam_fps_init,
                                 .fps_lookat = rizz__cam_fps_lookat,
                                 .fps_pitch = rizz__cam_fps_pitch,
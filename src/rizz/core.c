@@ -12,6 +12,7 @@
 #include "sx/array.h"
 #include "sx/atomic.h"
 #include "sx/hash.h"
+#include "sx/io.h"
 #include "sx/jobs.h"
 #include "sx/lockless.h"
 #include "sx/macros.h"
@@ -136,10 +137,10 @@ typedef struct rizz__core_cmd {
     void* user;
 } rizz__core_cmd;
 
+// values are kept per-thread in `tl_tls_vars`, indexed by the slot of the variable
 typedef struct rizz__tls_var {
     uint32_t name_hash;
     void* user;
-    sx_tls tls;
     void* (*init_cb)(int thread_idx, uint32_t thread_id, void* user);
 } rizz__tls_var;
 
@@ -156,11 +157,148 @@ typedef struct rizz__log_entry_internal {
     uint64_t timestamp;
 } rizz__log_entry_internal;
 
+#define RIZZ__LOG_MAX_QUEUES 64
+#define RIZZ__LOG_RECORD_HEADER_SIZE 44     // size of rizz__log_record fields before payload (64bit)
+#define RIZZ__LOG_PAYLOAD_SIZE (RIZZ_CONFIG_LOG_RECORD_SIZE - RIZZ__LOG_RECORD_HEADER_SIZE)
+
+#if (RIZZ_CONFIG_LOG_QUEUE_SIZE & (RIZZ_CONFIG_LOG_QUEUE_SIZE - 1)) != 0
+#    error "RIZZ_CONFIG_LOG_QUEUE_SIZE must be power-of-two"
+#endif
+
+typedef enum rizz__log_arg_type {
+    RIZZ__LOG_ARG_NONE = 0,     // '%%' and unknown conversions, doesn't take an argument
+    RIZZ__LOG_ARG_INT32,
+    RIZZ__LOG_ARG_INT64,
+    RIZZ__LOG_ARG_DOUBLE,
+    RIZZ__LOG_ARG_PTR,
+    RIZZ__LOG_ARG_STR,
+    RIZZ__LOG_ARG_INVALID       // '%n' or malformed spec, can't be deferred
+} rizz__log_arg_type;
+
+// single conversion spec of the format string, parsed with the same rules as stb_sprintf
+typedef struct rizz__log_spec {
+    rizz__log_arg_type type;
+    int len;                    // number of characters, starting from '%'
+    bool star_width;            // width and precision that are passed as int arguments ('*')
+    bool star_precision;
+    int precision;              // -1 if it's not set or it's a star
+} rizz__log_spec;
+
+// fixed size record in thread log queues
+// `fmt` points to the copy of the format string in payload, right after the packed arguments, because
+// callers may pass temporary buffers. it's NULL when the text is formatted by the producer (unsupported
+// specs or the arguments didn't fit), in which case payload holds the text or `spill` points to heap
+// allocated text
+typedef struct rizz__log_record {
+    uint64_t timestamp;         // cycle-clock, records of different threads are dispatched in this order
+    const char* fmt;
+    const char* source_file;
+    char* spill;
+    uint32_t channels;
+    int line;
+    uint16_t type;              // rizz_log_level
+    uint16_t payload_size;      // bytes used by packed arguments or pre-formatted text (with null)
+    uint8_t payload[RIZZ__LOG_PAYLOAD_SIZE];
+} rizz__log_record;
+
+// single-producer (owner thread) and single-consumer (logger thread) ring-buffer of records
+typedef struct rizz__log_queue {
+    sx_align_decl(SX_CACHE_LINE_SIZE, sx_atomic_uint32) head;   // written by owner thread
+    sx_align_decl(SX_CACHE_LINE_SIZE, sx_atomic_uint32) tail;   // written by logger thread
+    uint32_t thread_id;
+    rizz__log_record* records;
+} rizz__log_queue;
+
+// binary log file (RIZZ_CORE_FLAG_LOG_TO_BINARY_FILE): header, followed by a stream of records
+// that start with a rizz__log_bin_record_type byte. integers are little-endian, varints are LEB128
+// and signed varints are zigzag encoded. see scripts/log-tools/rlog-view.py for the viewer
+#define RIZZ__LOG_BIN_SIGN 0x474f4c52    // 'RLOG'
+#define RIZZ__LOG_BIN_VERSION 1
+#define RIZZ__LOG_BIN_BLOCK_SIZE 65536
+
+typedef enum rizz__log_bin_record_type {
+    RIZZ__LOG_BIN_CLOCK = 1,    // u64 cycle-clock, u64 microseconds since header's `start_time_us`
+    RIZZ__LOG_BIN_SOURCE,       // varint id, varint line, varint len, file, varint len, format
+    RIZZ__LOG_BIN_ENTRY         // varint source_id, u8 level, varint channels, varint thread_id,
+                                // svarint cycle-clock delta (from previous entry), varint len, payload
+} rizz__log_bin_record_type;
+
+// ENTRY payload is the raw arguments packed by `rizz__log_pack_args`, formatted by the viewer
+// sources without a format string (zero length) have the formatted text as payload instead
+typedef struct rizz__log_bin_header {
+    uint32_t sign;
+    uint32_t version;
+    uint64_t start_time_us;     // unix time
+    uint32_t ptr_size;          // size of packed pointer arguments (%p)
+    uint32_t _reserved;
+    char app_name[32];
+} rizz__log_bin_header;
+
+// contents of a written SOURCE record, kept to verify hash hits (see rizz__log_bin_source_id)
+typedef struct rizz__log_bin_source {
+    int line;
+    int file_offset;            // offset to `source_strs`
+    int file_len;
+    int fmt_offset;
+    int fmt_len;
+} rizz__log_bin_source;
+
+typedef struct rizz__log_bin_writer {
+    sx_mutex mtx;               // writer is used by logger thread and synchronous logging
+    sx_file file;
+    bool opened;
+    int64_t file_size;
+    uint8_t* block;             // entries are written to file in blocks of RIZZ__LOG_BIN_BLOCK_SIZE
+    int block_size;
+    uint64_t start_tick;
+    uint64_t last_timestamp;
+    sx_hashtbl* sources;        // hash(format, file, line), probed on collisions -> source id
+    rizz__log_bin_source* SX_ARRAY source_infos;    // indexed by source id, reset for each file
+    char* SX_ARRAY source_strs;                     // file and format strings of `source_infos`
+    char filepath[RIZZ_MAX_PATH];
+} rizz__log_bin_writer;
+
+typedef struct rizz__log_text_buffer {
+    char* text;
+    int len;
+    int capacity;
+} rizz__log_text_buffer;
+
 typedef struct rizz__show_debugger_deferred {
     bool show;
     bool* p_open;
 } rizz__show_debugger_deferred;
 
+typedef struct rizz__fixed_step {
+    uint64_t step_tick;     // duration of a single step in ticks, 0 = fixed-step is disabled
+    uint64_t accum_tick;    // frame time that is not consumed by fixed steps yet
+    int max_steps;
+    float dt;
+    float alpha;
+    int64_t index;
+} rizz__fixed_step;
+
+typedef struct rizz__frame_task {
+    char name[32];
+    rizz_frame_task_cb* task_fn;
+    void* user;
+    rizz_frame_res reads;
+    rizz_frame_res writes;
+    rizz_frame_task_flags flags;
+    bool builtin;
+    int level;                  // depth in the dependency graph, only used for ordering
+    int first_dep;              // index to `frame_task_deps`: tasks that must finish before this one
+    int num_deps;
+    uint32_t profile_hash;
+    sx_job_t job;               // in-flight worker task of the current frame
+    bool done;
+} rizz__frame_task;
+
+typedef struct rizz__frame_task_op {
+    bool remove;
+    rizz__frame_task task;
+} rizz__frame_task_op;
+
 typedef struct rizz__core {
     const sx_alloc* heap_alloc;
     sx_alloc* core_alloc;
@@ -182,6 +320,15 @@ typedef struct rizz__core {
     uint64_t last_tick;
     float fps_mean;
     float fps_frame;
+    rizz__fixed_step fixed_step;
+
+    // frame graph
+    rizz__frame_task* SX_ARRAY frame_tasks;
+    int* SX_ARRAY frame_task_order;             // indexes to frame_tasks, sorted by level (workers first)
+    int* SX_ARRAY frame_task_deps;              // indexes to frame_tasks, referenced by each task
+    rizz__frame_task_op* SX_ARRAY frame_task_ops;  // add/remove requests, applied on the next frame
+    bool frame_graph_dirty;
+    float frame_dt;
 
     rizz_version ver;
     uint32_t app_ver;
@@ -194,7 +341,8 @@ typedef struct rizz__core {
     sx_queue_spsc* rmt_command_queue;       // type: char*, producer: remotery thread, consumer: main thread
 
     rizz__core_cmd* SX_ARRAY console_cmds;
-    rizz__tls_var* SX_ARRAY tls_vars;
+    rizz__tls_var tls_vars[RIZZ_CONFIG_MAX_TLS_VARS];
+    int num_tls_vars;
     
     // logging
     char log_file[32];
@@ -204,6 +352,21 @@ typedef struct rizz__core {
     sx_mutex log_mtx;   // mutex used to protected `log_entries` and `log_strpool`
     rizz__log_entry_internal* SX_ARRAY log_entries; 
     sx_strpool* log_strpool;
+    FILE* log_fp;       // kept open by logger thread, NULL if the file should be opened on every entry
+    rizz__log_bin_writer log_bin;
+
+    // async logging: each thread pushes records to it's own queue, logger thread formats them and 
+    // dispatches to built-in backends. entries for custom backends are queued in `log_entries`
+    rizz__log_queue* log_queues[RIZZ__LOG_MAX_QUEUES];
+    sx_atomic_uint32 log_num_queues;
+    sx_mutex log_queues_mtx;            // protects adding new queues 
+    sx_thread* log_thread;
+    sx_sem log_sem;                     // wakes up logger thread
+    sx_atomic_uint32 log_running;       // producers push to queues only while logger thread is running
+    sx_atomic_uint32 log_sleeping;      // logger thread is waiting (or about to wait) on `log_sem`
+    sx_atomic_uint32 log_quit;
+    sx_atomic_uint32 log_num_dropped;   // total entries dropped by RIZZ_LOG_QUEUE_POLICY_DROP
+    rizz_log_queue_policy log_queue_policy;
     
     // built-in imgui windows
     rizz__show_debugger_deferred show_memory;
@@ -217,12 +380,16 @@ typedef struct rizz__core {
     sx_strpool* strpool;    // used by `str_alloc` to allocate strings dynamically
 
     int64_t mem_capture_frame;
+    int64_t mem_capture_end_frame;      // last frame of the capture (inclusive)
     bool paused;
 } rizz__core;
 
 static rizz__core g_core;
 
 static _Thread_local rizz__tmp_alloc_tls tl_tmp_alloc;
+static _Thread_local void* tl_tls_vars[RIZZ_CONFIG_MAX_TLS_VARS];
+static _Thread_local rizz__log_queue* tl_log_queue;
+static _Thread_local bool tl_log_thread;    // true for logger thread, which always logs synchronously
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // @log
@@ -367,7 +534,6 @@ static void rizz__log_backend_terminal(const rizz_log_entry* entry, void* user)
     }
 }
 
-// TODO: backend should only just open the file once per frame 
 static void rizz__log_backend_file(const rizz_log_entry* entry, void* user)
 {
     sx_unused(user);
@@ -375,10 +541,12 @@ static void rizz__log_backend_file(const rizz_log_entry* entry, void* user)
     char source[128];
     rizz__log_make_source_str(source, sizeof(source), entry->source_file, entry->line);
 
-    FILE* f = fopen(g_core.log_file, "at");
+    // logger thread keeps the file open and flushes it after each batch of entries
+    FILE* f = g_core.log_fp ? g_core.log_fp : fopen(g_core.log_file, "at");
     if (f) {
         fprintf(f, "%s%s%s\n", source, k_log_entry_types[entry->type], entry->text);
-        fclose(f);
+        if (f != g_core.log_fp)
+            fclose(f);
     }
 }
 
@@ -432,6 +600,253 @@ static void rizz__log_backend_remotery(const rizz_log_entry* entry, void* user)
     }
 }
 
+static int rizz__log_bin_varint(uint8_t* p, uint64_t value)
+{
+    int n = 0;
+    while (value >= 0x80) {
+        p[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    p[n++] = (uint8_t)value;
+    return n;
+}
+
+static void rizz__log_bin_flush_block(rizz__log_bin_writer* w)
+{
+    if (w->block_size > 0) {
+        if (sx_file_write(&w->file, w->block, w->block_size) == w->block_size) {
+            w->file_size += w->block_size;
+        }
+        w->block_size = 0;
+    }
+}
+
+static void rizz__log_bin_write(rizz__log_bin_writer* w, const void* data, int size)
+{
+    if (w->block_size + size > RIZZ__LOG_BIN_BLOCK_SIZE) {
+        rizz__log_bin_flush_block(w);
+    }
+
+    if (size > RIZZ__LOG_BIN_BLOCK_SIZE) {
+        if (sx_file_write(&w->file, data, size) == size) {
+            w->file_size += size;
+        }
+    } else {
+        sx_memcpy(w->block + w->block_size, data, size);
+        w->block_size += size;
+    }
+}
+
+static void rizz__log_bin_write_clock(rizz__log_bin_writer* w)
+{
+    uint8_t rec[17];
+    uint64_t clock[2] = { sx_cycle_clock(), (uint64_t)sx_tm_us(sx_tm_since(w->start_tick)) };
+    rec[0] = RIZZ__LOG_BIN_CLOCK;
+    sx_memcpy(rec + 1, clock, sizeof(clock));
+    rizz__log_bin_write(w, rec, sizeof(rec));
+}
+
+// shifts older files: app.rlog -> app.1.rlog -> app.2.rlog ..., the oldest one is deleted
+static void rizz__log_bin_rotate_files(const char* filepath)
+{
+    char src[RIZZ_MAX_PATH];
+    char dst[RIZZ_MAX_PATH];
+    char base[RIZZ_MAX_PATH];
+    char ext[32];
+    sx_os_path_splitext(ext, sizeof(ext), base, sizeof(base), filepath);
+
+    for (int i = RIZZ_CONFIG_LOG_BINARY_FILE_COUNT - 1; i > 0; i--) {
+        sx_snprintf(dst, sizeof(dst), "%s.%d.rlog", base, i);
+        if (i > 1) {
+            sx_snprintf(src, sizeof(src), "%s.%d.rlog", base, i - 1);
+        } else {
+            sx_strcpy(src, sizeof(src), filepath);
+        }
+
+        if (sx_os_path_exists(src)) {
+            if (sx_os_path_exists(dst)) {
+                sx_os_del(dst, SX_FILE_TYPE_REGULAR);
+            }
+            sx_os_rename(src, dst);
+        }
+    }
+}
+
+static bool rizz__log_bin_open_file(rizz__log_bin_writer* w)
+{
+    rizz__log_bin_rotate_files(w->filepath);
+
+    // keep the handle that writes the header for the entries. reopening in append mode isn't portable,
+    // on windows SX_FILE_APPEND doesn't seek to the end and the entries would overwrite the header
+    rizz__log_bin_header header = { .sign = RIZZ__LOG_BIN_SIGN,
+                                    .version = RIZZ__LOG_BIN_VERSION,
+                                    .start_time_us = (uint64_t)time(NULL) * 1000000,
+                                    .ptr_size = (uint32_t)sizeof(void*) };
+    sx_strcpy(header.app_name, sizeof(header.app_name), g_core.app_name);
+
+    if (!sx_file_open(&w->file, w->filepath, SX_FILE_WRITE)) {
+        return false;
+    }
+    if (sx_file_write(&w->file, &header, sizeof(header)) != sizeof(header)) {
+        sx_file_close(&w->file);
+        return false;
+    }
+
+    w->opened = true;
+    w->file_size = sizeof(header);
+    w->start_tick = sx_tm_now();
+    w->last_timestamp = 0;
+    sx_hashtbl_clear(w->sources);
+    sx_array_clear(w->source_infos);
+    sx_array_clear(w->source_strs);
+    rizz__log_bin_write_clock(w);
+    return true;
+}
+
+static void rizz__log_bin_close_file(rizz__log_bin_writer* w)
+{
+    if (w->opened) {
+        rizz__log_bin_write_clock(w);
+        rizz__log_bin_flush_block(w);
+        sx_file_close(&w->file);
+        w->opened = false;
+    }
+}
+
+static bool rizz__log_bin_init(const char* filepath)
+{
+    rizz__log_bin_writer* w = &g_core.log_bin;
+    sx_mutex_init(&w->mtx);
+    sx_strcpy(w->filepath, sizeof(w->filepath), filepath);
+    w->block = sx_malloc(g_core.core_alloc, RIZZ__LOG_BIN_BLOCK_SIZE);
+    w->sources = sx_hashtbl_create(g_core.core_alloc, 256);
+    if (!w->block || !w->sources) {
+        sx_memory_fail();
+        return false;
+    }
+
+    return rizz__log_bin_open_file(w);
+}
+
+static void rizz__log_bin_release(void)
+{
+    rizz__log_bin_writer* w = &g_core.log_bin;
+    if (w->block) {
+        rizz__log_bin_close_file(w);
+        sx_free(g_core.core_alloc, w->block);
+        sx_hashtbl_destroy(w->sources, g_core.core_alloc);
+        sx_array_free(g_core.core_alloc, w->source_infos);
+        sx_array_free(g_core.core_alloc, w->source_strs);
+        sx_mutex_release(&w->mtx);
+        sx_memset(w, 0x0, sizeof(*w));
+    }
+}
+
+// writes buffered entries to the file, the file is rotated if it exceeds RIZZ_CONFIG_LOG_BINARY_FILE_SIZE
+static void rizz__log_bin_flush(void)
+{
+    rizz__log_bin_writer* w = &g_core.log_bin;
+    if (!w->block) {
+        return;
+    }
+
+    sx_mutex_lock(w->mtx) {
+        if (w->opened && w->block_size > 0) {
+            rizz__log_bin_write_clock(w);
+            rizz__log_bin_flush_block(w);
+            if (w->file_size >= RIZZ_CONFIG_LOG_BINARY_FILE_SIZE) {
+                rizz__log_bin_close_file(w);
+                rizz__log_bin_open_file(w);
+            }
+        }
+    }
+}
+
+static uint32_t rizz__log_bin_source_id(rizz__log_bin_writer* w, const char* fmt, const char* file, int line)
+{
+    // hash the contents, pointers are not unique between plugin reloads
+    const char* fmt_str = fmt ? fmt : "";
+    const char* file_str = file ? file : "";
+    int fmt_len = sx_strlen(fmt_str);
+    int file_len = sx_strlen(file_str);
+    uint32_t hash = sx_hash_xxh32(fmt_str, fmt_len, (uint32_t)line);
+    hash = sx_hash_xxh32(file_str, file_len, hash);
+
+    // on collisions, probe the next keys until we find the same source or an empty one
+    // zero is reserved for empty hash table keys
+    uint32_t key = hash ? hash : 1;
+    int index;
+    while ((index = sx_hashtbl_find(w->sources, key)) != -1) {
+        int source_id = sx_hashtbl_get(w->sources, index);
+        const rizz__log_bin_source* src = &w->source_infos[source_id];
+        if (src->line == line && src->file_len == file_len && src->fmt_len == fmt_len &&
+            sx_memcmp(w->source_strs + src->file_offset, file_str, file_len) == 0 &&
+            sx_memcmp(w->source_strs + src->fmt_offset, fmt_str, fmt_len) == 0) {
+            return (uint32_t)source_id;
+        }
+        key = (key + 1) ? (key + 1) : 1;
+    }
+
+    uint32_t id = (uint32_t)sx_array_count(w->source_infos);
+    rizz__log_bin_source src = { .line = line,
+                                 .file_offset = sx_array_count(w->source_strs),
+                                 .file_len = file_len,
+                                 .fmt_offset = sx_array_count(w->source_strs) + file_len,
+                                 .fmt_len = fmt_len };
+    sx_array_push(g_core.core_alloc, w->source_infos, src);
+    char* strs = sx_array_add(g_core.core_alloc, w->source_strs, file_len + fmt_len);
+    sx_memcpy(strs, file_str, file_len);
+    sx_memcpy(strs + file_len, fmt_str, fmt_len);
+    if (sx_hashtbl_full(w->sources)) {
+        sx_hashtbl_grow(&w->sources, g_core.core_alloc);
+    }
+    sx_hashtbl_add(w->sources, key, (int)id);
+
+    uint8_t rec[32];
+    int n = 0;
+    rec[n++] = RIZZ__LOG_BIN_SOURCE;
+    n += rizz__log_bin_varint(rec + n, id);
+    n += rizz__log_bin_varint(rec + n, (uint64_t)(line > 0 ? line : 0));
+    n += rizz__log_bin_varint(rec + n, (uint64_t)file_len);
+    rizz__log_bin_write(w, rec, n);
+    rizz__log_bin_write(w, file, file_len);
+    n = rizz__log_bin_varint(rec, (uint64_t)fmt_len);
+    rizz__log_bin_write(w, rec, n);
+    rizz__log_bin_write(w, fmt, fmt_len);
+    return id;
+}
+
+// `fmt` is NULL if payload is formatted text
+static void rizz__log_bin_entry(rizz_log_level type, uint32_t channels, uint32_t thread_id,
+                                uint64_t timestamp, const char* fmt, const char* source_file,
+                                int line, const void* payload, int payload_size)
+{
+    rizz__log_bin_writer* w = &g_core.log_bin;
+    if (!w->block) {
+        return;
+    }
+
+    sx_mutex_lock(w->mtx) {
+        if (w->opened) {
+            uint32_t source_id = rizz__log_bin_source_id(w, fmt, source_file, line);
+            int64_t delta = (int64_t)(timestamp - w->last_timestamp);
+            w->last_timestamp = timestamp;
+
+            uint8_t rec[64];
+            int n = 0;
+            rec[n++] = RIZZ__LOG_BIN_ENTRY;
+            n += rizz__log_bin_varint(rec + n, source_id);
+            rec[n++] = (uint8_t)type;
+            n += rizz__log_bin_varint(rec + n, channels);
+            n += rizz__log_bin_varint(rec + n, thread_id);
+            n += rizz__log_bin_varint(rec + n, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+            n += rizz__log_bin_varint(rec + n, (uint64_t)payload_size);
+            rizz__log_bin_write(w, rec, n);
+            rizz__log_bin_write(w, payload, payload_size);
+        }
+    }
+}
+
 static void rizz__log_dispatch_entry(rizz_log_entry* entry)
 {
     // built-in backends are thread-safe, so we pass them immediately
@@ -442,6 +857,15 @@ static void rizz__log_dispatch_entry(rizz_log_entry* entry)
     rizz__log_backend_android(entry, NULL);
 #endif
 
+    if (g_core.flags & RIZZ_CORE_FLAG_LOG_TO_FILE) {
+        rizz__log_backend_file(entry, NULL);
+    }
+
+    if (g_core.flags & RIZZ_CORE_FLAG_LOG_TO_PROFILER) {
+        rizz__log_backend_remotery(entry, NULL);
+    }
+
+    // custom backends are called from the main thread (see rizz__log_update)
     if (g_core.log_num_backends > 0) {
         if (entry->channels == 0)
             entry->channels = 0xffffffff;
@@ -458,17 +882,348 @@ static void rizz__log_dispatch_entry(rizz_log_entry* entry)
     }
 }
 
-static void rizz__set_log_level(rizz_log_level level)
+// parses the conversion spec that `fmt` points to ('%'), returns the character after the spec
+// rules (and argument sizes) must be identical to stb_sprintf, because the packed arguments are
+// passed back to sx_snprintf with the same spec
+static const char* rizz__log_parse_spec(const char* fmt, rizz__log_spec* spec)
 {
-    g_core.log_level = level;
+    sx_assert(fmt[0] == '%');
+    const char* f = fmt + 1;
+    bool int64 = false;
+
+    spec->star_width = spec->star_precision = false;
+    spec->precision = -1;
+
+    // flags
+    for (;;) {
+        char c = *f;
+        if (c == '-' || c == '+' || c == ' ' || c == '#' || c == '\'' || c == '$' || c == '_') {
+            ++f;
+        } else {
+            if (c == '0')
+                ++f;
+            break;
+        }
+    }
+
+    // width and precision
+    if (*f == '*') {
+        spec->star_width = true;
+        ++f;
+    } else {
+        while (*f >= '0' && *f <= '9')
+            ++f;
+    }
+
+    if (*f == '.') {
+        ++f;
+        if (*f == '*') {
+            spec->star_precision = true;
+            ++f;
+        } else {
+            spec->precision = 0;
+            while (*f >= '0' && *f <= '9') {
+                spec->precision = spec->precision*10 + (*f - '0');
+                ++f;
+            }
+        }
+    }
+
+    // integer size
+    switch (*f) {
+    case 'h':
+        ++f;
+        break;
+    case 'l':
+        ++f;
+        if (*f == 'l') {
+            int64 = true;
+            ++f;
+        }
+        break;
+    case 'j':
+        int64 = true;
+        ++f;
+        break;
+    case 'z':
+    case 't':
+        int64 = sizeof(char*) == 8;
+        ++f;
+        break;
+    case 'I':
+        if (f[1] == '6' && f[2] == '4') {
+            int64 = true;
+            f += 3;
+        } else if (f[1] == '3' && f[2] == '2') {
+            f += 3;
+        } else {
+            int64 = sizeof(void*) == 8;
+            ++f;
+        }
+        break;
+    default:
+        break;
+    }
+
+    // clang-format off
+    switch (*f) {
+    case 's':   spec->type = RIZZ__LOG_ARG_STR;         break;
+    case 'c':   spec->type = RIZZ__LOG_ARG_INT32;       break;
+    case 'p':   spec->type = RIZZ__LOG_ARG_PTR;         break;
+    case 'A': case 'a': case 'G': case 'g': case 'E': case 'e': case 'f':
+                spec->type = RIZZ__LOG_ARG_DOUBLE;      break;
+    case 'B': case 'b': case 'o': case 'X': case 'x': case 'u': case 'i': case 'd':
+                spec->type = int64 ? RIZZ__LOG_ARG_INT64 : RIZZ__LOG_ARG_INT32;     break;
+    case 'n':
+    case '\0':  spec->type = RIZZ__LOG_ARG_INVALID;     break;
+    default:    spec->type = RIZZ__LOG_ARG_NONE;        break;
+    }
+    // clang-format on
+
+    if (*f != '\0')
+        ++f;
+    spec->len = (int)(intptr_t)(f - fmt);
+    if (spec->len > 32)
+        spec->type = RIZZ__LOG_ARG_INVALID;
+    return f;
+}
+
+// packs format arguments into the payload of the record, strings are copied
+// returns false if the format can't be deferred or arguments don't fit in the record
+static bool rizz__log_pack_args(rizz__log_record* rec, const char* fmt, va_list args)
+{
+    uint8_t* p = rec->payload;
+    const uint8_t* end = rec->payload + sizeof(rec->payload);
+    rizz__log_spec spec;
+
+    #define RIZZ__LOG_PACK(_type, _value)               \
+        if (p + sizeof(_type) > end) return false;      \
+        { _type _v = (_value); sx_memcpy(p, &_v, sizeof(_type)); p += sizeof(_type); }
+
+    while ((fmt = sx_strchar(fmt, '%')) != NULL) {
+        fmt = rizz__log_parse_spec(fmt, &spec);
+        int precision = spec.precision;
+        if (spec.type == RIZZ__LOG_ARG_INVALID) {
+            return false;
+        }
+        if (spec.star_width) {
+            RIZZ__LOG_PACK(int32_t, va_arg(args, int32_t));
+        }
+        if (spec.star_precision) {
+            precision = va_arg(args, int32_t);
+            RIZZ__LOG_PACK(int32_t, precision);
+        }
+
+        switch (spec.type) {
+        case RIZZ__LOG_ARG_INT32:   RIZZ__LOG_PACK(uint32_t, va_arg(args, uint32_t));    break;
+        case RIZZ__LOG_ARG_INT64:   RIZZ__LOG_PACK(uint64_t, va_arg(args, uint64_t));    break;
+        case RIZZ__LOG_ARG_DOUBLE:  RIZZ__LOG_PACK(double, va_arg(args, double));        break;
+        case RIZZ__LOG_ARG_PTR:     RIZZ__LOG_PACK(uintptr_t, (uintptr_t)va_arg(args, void*));  break;
+        case RIZZ__LOG_ARG_STR: {
+            // string is copied after it's length (-1 for NULL), precision limits the string, so
+            // non null-terminated strings ("%.*s") are also copied correctly
+            const char* str = va_arg(args, const char*);
+            int len = 0;
+            if (str) {
+                while ((precision < 0 || len < precision) && str[len])
+                    ++len;
+            } else {
+                len = -1;
+            }
+            RIZZ__LOG_PACK(int32_t, len);
+            if (len >= 0) {
+                if (p + len + 1 > end)
+                    return false;
+                sx_memcpy(p, str, len);
+                p[len] = '\0';
+                p += len + 1;
+            }
+            break;
+        }
+        default:    break;
+        }
+    }
+    #undef RIZZ__LOG_PACK
+
+    rec->payload_size = (uint16_t)(intptr_t)(p - rec->payload);
+    return true;
 }
 
-static void rizz__print_info(uint32_t channels, const char* source_file, int line, const char* fmt, ...)
+static char* rizz__log_text_reserve(rizz__log_text_buffer* buff, int size)
 {
-    if (g_core.log_level < RIZZ_LOG_LEVEL_INFO) {
+    if (buff->len + size > buff->capacity) {
+        int capacity = sx_max(buff->capacity*2, buff->len + size);
+        char* text = sx_realloc(g_core.core_alloc, buff->text, capacity);
+        if (!text) {
+            sx_memory_fail();
+            return NULL;
+        }
+        buff->text = text;
+        buff->capacity = capacity;
+    }
+    return buff->text + buff->len;
+}
+
+// formats the text of the record that is packed by `rizz__log_pack_args` into `buff`
+static void rizz__log_format_record(const rizz__log_record* rec, rizz__log_text_buffer* buff)
+{
+    const char* fmt = rec->fmt;
+    const uint8_t* p = rec->payload;
+    rizz__log_spec spec;
+
+    #define RIZZ__LOG_UNPACK(_type, _var) \
+        _type _var; sx_memcpy(&_var, p, sizeof(_type)); p += sizeof(_type)
+
+    buff->len = 0;
+    while (*fmt) {
+        const char* spec_start = sx_strchar(fmt, '%');
+        int literal_len = spec_start ? (int)(intptr_t)(spec_start - fmt) : sx_strlen(fmt);
+        char* dst = rizz__log_text_reserve(buff, literal_len + 1);
+        if (!dst)
+            return;
+        sx_memcpy(dst, fmt, literal_len);
+        buff->len += literal_len;
+        if (!spec_start)
+            break;
+
+        fmt = rizz__log_parse_spec(spec_start, &spec);
+        sx_assert(spec.type != RIZZ__LOG_ARG_INVALID);
+
+        // rebuild the spec with '*' replaced by actual values
+        char spec_str[64];
+        int spec_len = 0;
+        int width = 0;
+        for (int i = 0; i < spec.len; i++) {
+            if (spec_start[i] == '*') {
+                // stb_sprintf ignores negative width and precision, so they are left out
+                RIZZ__LOG_UNPACK(int32_t, star);
+                bool is_precision = i > 0 && spec_start[i - 1] == '.';
+                if (star >= 0) {
+                    spec_len += sx_snprintf(spec_str + spec_len, sizeof(spec_str) - spec_len, "%d", star);
+                    if (!is_precision)
+                        width = star;
+                } else if (is_precision) {
+                    --spec_len;    // remove '.'
+                }
+            } else {
+                spec_str[spec_len++] = spec_start[i];
+            }
+        }
+        spec_str[spec_len] = '\0';
+        if (!spec.star_width) {
+            const char* w = spec_start + 1;
+            while (*w && sx_strchar("-+ #'$_0", *w))
+                ++w;
+            width = sx_toint(w);
+        }
+
+        // reserve enough space for the widest number formatting, so text is never truncated
+        int reserve = width + 512;
+        const char* str = NULL;
+        if (spec.type == RIZZ__LOG_ARG_STR) {
+            RIZZ__LOG_UNPACK(int32_t, len);
+            if (len >= 0) {
+                str = (const char*)p;
+                p += len + 1;
+            }
+            reserve = width + sx_max(len, 8) + 1;
+        }
+
+        dst = rizz__log_text_reserve(buff, reserve);
+        if (!dst)
+            return;
+
+        int written = 0;
+        switch (spec.type) {
+        case RIZZ__LOG_ARG_INT32:   { RIZZ__LOG_UNPACK(uint32_t, n);    written = sx_snprintf(dst, reserve, spec_str, n);   break; }
+        case RIZZ__LOG_ARG_INT64:   { RIZZ__LOG_UNPACK(uint64_t, n);    written = sx_snprintf(dst, reserve, spec_str, n);   break; }
+        case RIZZ__LOG_ARG_DOUBLE:  { RIZZ__LOG_UNPACK(double, n);      written = sx_snprintf(dst, reserve, spec_str, n);   break; }
+        case RIZZ__LOG_ARG_PTR:     { RIZZ__LOG_UNPACK(uintptr_t, n);   written = sx_snprintf(dst, reserve, spec_str, (void*)n);  break; }
+        case RIZZ__LOG_ARG_STR:     written = sx_snprintf(dst, reserve, spec_str, str);    break;
+        default:                    written = sx_snprintf(dst, reserve, spec_str);         break;
+        }
+        buff->len += sx_min(written, reserve - 1);
+    }
+    #undef RIZZ__LOG_UNPACK
+
+    if (rizz__log_text_reserve(buff, 1))
+        buff->text[buff->len] = '\0';
+}
+
+static void rizz__log_wake(void)
+{
+    if (sx_atomic_exchange32(&g_core.log_sleeping, 0)) {
+        sx_semaphore_post(&g_core.log_sem, 1);
+    }
+}
+
+// waits until the logger thread dispatches the records of the queue before `head`
+static void rizz__log_wait_queue(rizz__log_queue* queue, uint32_t head)
+{
+    while ((int32_t)(head - sx_atomic_load32_explicit(&queue->tail, SX_ATOMIC_MEMORYORDER_ACQUIRE)) > 0 &&
+           !sx_atomic_load32(&g_core.log_quit)) {
+        rizz__log_wake();
+        sx_thread_yield();
+    }
+}
+
+// waits until the logger thread dispatches all the records that are queued by now, call it before
+// exiting abnormally, so no log entries are lost
+void rizz__log_flush(void)
+{
+    if (!g_core.log_thread || tl_log_thread) {
         return;
     }
 
+    uint32_t num_queues = sx_atomic_load32_explicit(&g_core.log_num_queues, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    for (uint32_t i = 0; i < num_queues; i++) {
+        rizz__log_queue* queue = g_core.log_queues[i];
+        rizz__log_wait_queue(queue, sx_atomic_load32_explicit(&queue->head, SX_ATOMIC_MEMORYORDER_ACQUIRE));
+    }
+
+    if (g_core.log_fp) {
+        fflush(g_core.log_fp);
+    }
+    rizz__log_bin_flush();
+}
+
+// returns the queue of the calling thread, creates one on first call
+// NULL means there are no more queue slots, so the caller should log synchronously
+static rizz__log_queue* rizz__log_thread_queue(void)
+{
+    if (tl_log_queue) {
+        return tl_log_queue;
+    }
+
+    rizz__log_queue* queue = NULL;
+    sx_mutex_lock(g_core.log_queues_mtx) {
+        uint32_t index = sx_atomic_load32_explicit(&g_core.log_num_queues, SX_ATOMIC_MEMORYORDER_RELAXED);
+        if (index < RIZZ__LOG_MAX_QUEUES) {
+            queue = sx_malloc(g_core.core_alloc, sizeof(rizz__log_queue));
+            rizz__log_record* records = sx_malloc(g_core.core_alloc, sizeof(rizz__log_record)*RIZZ_CONFIG_LOG_QUEUE_SIZE);
+            if (queue && records) {
+                sx_memset(queue, 0x0, sizeof(rizz__log_queue));
+                queue->thread_id = sx_thread_tid();
+                queue->records = records;
+                g_core.log_queues[index] = queue;
+                sx_atomic_store32_explicit(&g_core.log_num_queues, index + 1, SX_ATOMIC_MEMORYORDER_RELEASE);
+            } else {
+                sx_free(g_core.core_alloc, queue);
+                sx_free(g_core.core_alloc, records);
+                queue = NULL;
+            }
+        }
+    }
+
+    tl_log_queue = queue;
+    return queue;
+}
+
+// formats on the calling thread and dispatches immediately, used when logger thread is not running
+// (init/shutdown) or calling thread is the logger itself
+static void rizz__log_print_sync(rizz_log_level type, uint32_t channels, const char* source_file,
+                                 int line, const char* fmt, va_list args)
+{
     int fmt_len = sx_strlen(fmt);
     char* text = alloca(fmt_len + 1024);    // reserve only 1k for format replace strings
     if (!text) {
@@ -476,46 +1231,320 @@ static void rizz__print_info(uint32_t channels, const char* source_file, int lin
         return;
     }
 
-    va_list args;
-    va_start(args, fmt);
-    sx_vsnprintf(text, fmt_len + 1024, fmt, args);
-    va_end(args);
+    int text_len = sx_vsnprintf(text, fmt_len + 1024, fmt, args);
+
+    if (g_core.flags & RIZZ_CORE_FLAG_LOG_TO_BINARY_FILE) {
+        rizz__log_bin_entry(type, channels, sx_thread_tid(), sx_cycle_clock(), NULL, source_file,
+                            line, text, text_len);
+    }
 
-    rizz__log_dispatch_entry(&(rizz_log_entry){ .type = RIZZ_LOG_LEVEL_INFO,
+    rizz__log_dispatch_entry(&(rizz_log_entry){ .type = type,
                                                 .channels = channels,
-                                                .text_len = sx_strlen(text),
+                                                .text_len = text_len,
                                                 .source_file_len = source_file ? sx_strlen(source_file) : 0,
                                                 .text = text,
                                                 .source_file = source_file,
                                                 .line = line });
 }
 
-static void rizz__print_debug(uint32_t channels, const char* source_file, int line, const char* fmt, ...)
+static void rizz__log_print(rizz_log_level type, uint32_t channels, const char* source_file,
+                            int line, const char* fmt, va_list args)
 {
-#ifdef _DEBUG
-    if (g_core.log_level < RIZZ_LOG_LEVEL_DEBUG) {
+    rizz__log_queue* queue = NULL;
+    if (!tl_log_thread && sx_atomic_load32_explicit(&g_core.log_running, SX_ATOMIC_MEMORYORDER_ACQUIRE)) {
+        queue = rizz__log_thread_queue();
+    }
+
+    if (!queue) {
+        rizz__log_print_sync(type, channels, source_file, line, fmt, args);
         return;
     }
 
-    int fmt_len = sx_strlen(fmt);
-    char* text = alloca(fmt_len + 1024);    // reserve only 1k for format replace strings
-    if (!text) {
-        sx_assert_alwaysf(0, "out of stack memory");
+    // wait or drop if the queue is full
+    uint32_t head = sx_atomic_load32_explicit(&queue->head, SX_ATOMIC_MEMORYORDER_RELAXED);
+    while (head - sx_atomic_load32_explicit(&queue->tail, SX_ATOMIC_MEMORYORDER_ACQUIRE) >= RIZZ_CONFIG_LOG_QUEUE_SIZE) {
+        if (g_core.log_queue_policy == RIZZ_LOG_QUEUE_POLICY_DROP && type != RIZZ_LOG_LEVEL_ERROR) {
+            sx_atomic_fetch_add32(&g_core.log_num_dropped, 1);
+            return;
+        }
+        sx_atomic_store32(&g_core.log_sleeping, 0);
+        sx_semaphore_post(&g_core.log_sem, 1);
+        sx_thread_yield();
+    }
+
+    rizz__log_record* rec = &queue->records[head & (RIZZ_CONFIG_LOG_QUEUE_SIZE - 1)];
+    rec->timestamp = sx_cycle_clock();
+    rec->fmt = fmt;
+    rec->source_file = source_file;
+    rec->spill = NULL;
+    rec->channels = channels;
+    rec->line = line;
+    rec->type = (uint16_t)type;
+
+    va_list pack_args;
+    va_copy(pack_args, args);
+    bool packed = rizz__log_pack_args(rec, fmt, pack_args);
+    va_end(pack_args);
+
+    if (packed) {
+        int fmt_size = sx_strlen(fmt) + 1;
+        if (rec->payload_size + fmt_size <= (int)sizeof(rec->payload)) {
+            char* fmt_copy = (char*)rec->payload + rec->payload_size;
+            sx_memcpy(fmt_copy, fmt, fmt_size);
+            rec->fmt = fmt_copy;
+        } else {
+            packed = false;
+        }
+    }
+
+    if (!packed) {
+        // format it here, if the text doesn't fit, allocate it from heap
+        va_list format_args;
+        va_copy(format_args, args);
+        int len = sx_vsnprintf((char*)rec->payload, sizeof(rec->payload), fmt, format_args);
+        va_end(format_args);
+        if (len >= (int)sizeof(rec->payload) - 1) {
+            rec->spill = sx_vsnprintf_alloc(g_core.core_alloc, fmt, args);
+        }
+        rec->fmt = NULL;
+        rec->payload_size = (uint16_t)(len + 1);
+    }
+
+    sx_atomic_store32_explicit(&queue->head, head + 1, SX_ATOMIC_MEMORYORDER_RELEASE);
+    rizz__log_wake();
+
+    // errors are usually followed by a shutdown or a crash, so wait until it's dispatched. records
+    // before it are dispatched first, so the order is preserved
+    if (type == RIZZ_LOG_LEVEL_ERROR) {
+        rizz__log_wait_queue(queue, head + 1);
+    }
+}
+
+static void rizz__log_dispatch_record(const rizz__log_record* rec, uint32_t thread_id,
+                                      rizz__log_text_buffer* buff)
+{
+    const char* text = rec->spill ? rec->spill : (const char*)rec->payload;
+
+    // binary log gets the packed arguments as they are, formatting is left to the viewer
+    if (g_core.flags & RIZZ_CORE_FLAG_LOG_TO_BINARY_FILE) {
+        if (rec->fmt) {
+            rizz__log_bin_entry((rizz_log_level)rec->type, rec->channels, thread_id, rec->timestamp,
+                                rec->fmt, rec->source_file, rec->line, rec->payload, rec->payload_size);
+        } else {
+            rizz__log_bin_entry((rizz_log_level)rec->type, rec->channels, thread_id, rec->timestamp,
+                                NULL, rec->source_file, rec->line, text, sx_strlen(text));
+        }
+    }
+
+    if (rec->fmt) {
+        rizz__log_format_record(rec, buff);
+        text = buff->text ? buff->text : "";
+    }
+
+    rizz__log_dispatch_entry(&(rizz_log_entry){ .type = (rizz_log_level)rec->type,
+                                                .channels = rec->channels,
+                                                .text_len = sx_strlen(text),
+                                                .source_file_len = rec->source_file ? sx_strlen(rec->source_file) : 0,
+                                                .text = text,
+                                                .source_file = rec->source_file,
+                                                .line = rec->line });
+    if (rec->spill) {
+        sx_array_free(g_core.core_alloc, rec->spill);    // allocated by sx_vsnprintf_alloc
+    }
+}
+
+// dispatches records of all queues, ordered by their timestamps. returns number of dispatched records
+static int rizz__log_drain(rizz__log_text_buffer* buff)
+{
+    uint32_t num_queues = sx_atomic_load32_explicit(&g_core.log_num_queues, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    int count = 0;
+
+    for (;;) {
+        rizz__log_queue* next = NULL;
+        uint64_t next_tm = UINT64_MAX;
+        for (uint32_t i = 0; i < num_queues; i++) {
+            rizz__log_queue* queue = g_core.log_queues[i];
+            uint32_t tail = sx_atomic_load32_explicit(&queue->tail, SX_ATOMIC_MEMORYORDER_RELAXED);
+            if (tail != sx_atomic_load32_explicit(&queue->head, SX_ATOMIC_MEMORYORDER_ACQUIRE)) {
+                uint64_t tm = queue->records[tail & (RIZZ_CONFIG_LOG_QUEUE_SIZE - 1)].timestamp;
+                if (tm < next_tm) {
+                    next = queue;
+                    next_tm = tm;
+                }
+            }
+        }
+
+        if (!next) {
+            break;
+        }
+
+        uint32_t tail = sx_atomic_load32_explicit(&next->tail, SX_ATOMIC_MEMORYORDER_RELAXED);
+        rizz__log_dispatch_record(&next->records[tail & (RIZZ_CONFIG_LOG_QUEUE_SIZE - 1)], next->thread_id, buff);
+        sx_atomic_store32_explicit(&next->tail, tail + 1, SX_ATOMIC_MEMORYORDER_RELEASE);
+        ++count;
+    }
+
+    return count;
+}
+
+static bool rizz__log_queues_empty(void)
+{
+    uint32_t num_queues = sx_atomic_load32_explicit(&g_core.log_num_queues, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    for (uint32_t i = 0; i < num_queues; i++) {
+        rizz__log_queue* queue = g_core.log_queues[i];
+        if (sx_atomic_load32(&queue->tail) != sx_atomic_load32(&queue->head)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int rizz__log_thread_fn(void* user1, void* user2)
+{
+    sx_unused(user1);
+    sx_unused(user2);
+
+    tl_log_thread = true;
+    rizz__log_text_buffer buff = { 0 };
+    uint32_t num_dropped = 0;
+
+    for (;;) {
+        bool quit = sx_atomic_load32(&g_core.log_quit) != 0;
+        int count = rizz__log_drain(&buff);
+
+        uint32_t total_dropped = sx_atomic_load32(&g_core.log_num_dropped);
+        if (total_dropped != num_dropped) {
+            rizz__log_warn("log queue is full: %u entries dropped", total_dropped - num_dropped);
+            num_dropped = total_dropped;
+        }
+
+        if (count > 0) {
+            if (g_core.log_fp)
+                fflush(g_core.log_fp);
+            rizz__log_bin_flush();
+            continue;
+        }
+        if (quit) {
+            break;
+        }
+
+        // raise the flag and check the queues again, so records pushed in between are not missed
+        sx_atomic_exchange32(&g_core.log_sleeping, 1);
+        if (!rizz__log_queues_empty()) {
+            sx_atomic_exchange32(&g_core.log_sleeping, 0);
+            continue;
+        }
+        sx_semaphore_wait(&g_core.log_sem, -1);
+        sx_atomic_exchange32(&g_core.log_sleeping, 0);
+    }
+
+    sx_free(g_core.core_alloc, buff.text);
+    return 0;
+}
+
+static void rizz__log_start_thread(rizz_log_queue_policy policy)
+{
+    g_core.log_queue_policy = policy;
+
+    if (g_core.flags & RIZZ_CORE_FLAG_LOG_TO_FILE) {
+        g_core.log_fp = fopen(g_core.log_file, "at");
+    }
+
+    if (policy == RIZZ_LOG_QUEUE_POLICY_SYNC) {
+        return;
+    }
+
+    g_core.log_thread = sx_thread_create(g_core.core_alloc, rizz__log_thread_fn, NULL, 256*1024, "Logger", NULL);
+    if (g_core.log_thread) {
+        sx_atomic_store32_explicit(&g_core.log_running, 1, SX_ATOMIC_MEMORYORDER_RELEASE);
+    } else {
+        rizz__log_warn("creating logger thread failed, logging synchronously");
+    }
+}
+
+// switches between logging on the calling thread and on the logger thread. queued records keep
+// pointers to source files, so plugins are unloaded and reloaded in sync mode
+void rizz__log_set_async(bool async)
+{
+    if (!g_core.log_thread) {
+        return;
+    }
+
+    if (async) {
+        sx_atomic_store32(&g_core.log_running, 1);
+    } else {
+        sx_atomic_store32(&g_core.log_running, 0);
+        while (!rizz__log_queues_empty()) {
+            sx_atomic_store32(&g_core.log_sleeping, 0);
+            sx_semaphore_post(&g_core.log_sem, 1);
+            sx_thread_yield();
+        }
+    }
+}
+
+// dispatches the remaining records and stops the logger thread, logging continues synchronously
+static void rizz__log_stop_thread(void)
+{
+    if (g_core.log_thread) {
+        sx_atomic_store32(&g_core.log_running, 0);
+        sx_atomic_store32(&g_core.log_quit, 1);
+        sx_semaphore_post(&g_core.log_sem, 1);
+        sx_thread_destroy(g_core.log_thread, g_core.core_alloc);
+        g_core.log_thread = NULL;
+    }
+
+    if (g_core.log_fp) {
+        fclose(g_core.log_fp);
+        g_core.log_fp = NULL;
+    }
+}
+
+// all other threads must be stopped before calling this
+static void rizz__log_release_queues(void)
+{
+    for (uint32_t i = 0, c = sx_atomic_load32(&g_core.log_num_queues); i < c; i++) {
+        rizz__log_queue* queue = g_core.log_queues[i];
+        // records that are pushed right after the logger thread is stopped are not dispatched
+        for (uint32_t k = queue->tail; k != queue->head; k++) {
+            char* spill = queue->records[k & (RIZZ_CONFIG_LOG_QUEUE_SIZE - 1)].spill;
+            sx_array_free(g_core.core_alloc, spill);
+        }
+        sx_free(g_core.core_alloc, queue->records);
+        sx_free(g_core.core_alloc, queue);
+        g_core.log_queues[i] = NULL;
+    }
+    sx_atomic_store32(&g_core.log_num_queues, 0);
+    tl_log_queue = NULL;
+}
+
+static void rizz__set_log_level(rizz_log_level level)
+{
+    g_core.log_level = level;
+}
+
+static void rizz__print_info(uint32_t channels, const char* source_file, int line, const char* fmt, ...)
+{
+    if (g_core.log_level < RIZZ_LOG_LEVEL_INFO) {
         return;
     }
 
     va_list args;
     va_start(args, fmt);
-    sx_vsnprintf(text, fmt_len + 1024, fmt, args);
+    rizz__log_print(RIZZ_LOG_LEVEL_INFO, channels, source_file, line, fmt, args);
     va_end(args);
+}
 
-    rizz__log_dispatch_entry(&(rizz_log_entry){ .type = RIZZ_LOG_LEVEL_DEBUG,
-                                                .channels = channels,
-                                                .text_len = sx_strlen(text),
-                                                .source_file_len = source_file ? sx_strlen(source_file) : 0,
-                                                .text = text,
-                                                .source_file = source_file,
-                                                .line = line });
+static void rizz__print_debug(uint32_t channels, const char* source_file, int line, const char* fmt, ...)
+{
+#ifdef _DEBUG
+    if (g_core.log_level < RIZZ_LOG_LEVEL_DEBUG) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    rizz__log_print(RIZZ_LOG_LEVEL_DEBUG, channels, source_file, line, fmt, args);
+    va_end(args);
 #else   // if _DEBUG
     sx_unused(channels);
     sx_unused(source_file);
@@ -530,25 +1559,10 @@ static void rizz__print_verbose(uint32_t channels, const char* source_file, int
         return;
     }
 
-    int fmt_len = sx_strlen(fmt);
-    char* text = alloca(fmt_len + 1024);    // reserve only 1k for format replace strings
-    if (!text) {
-        sx_assert_alwaysf(0, "out of stack memory");
-        return;
-    }
-
     va_list args;
     va_start(args, fmt);
-    sx_vsnprintf(text, fmt_len + 1024, fmt, args);
+    rizz__log_print(RIZZ_LOG_LEVEL_VERBOSE, channels, source_file, line, fmt, args);
     va_end(args);
-
-    rizz__log_dispatch_entry(&(rizz_log_entry){ .type = RIZZ_LOG_LEVEL_VERBOSE,
-                                                .channels = channels,
-                                                .text_len = sx_strlen(text),
-                                                .source_file_len = source_file ? sx_strlen(source_file) : 0,
-                                                .text = text,
-                                                .source_file = source_file,
-                                                .line = line });
 }
 
 static void rizz__print_error(uint32_t channels, const char* source_file, int line, const char* fmt, ...)
@@ -557,53 +1571,23 @@ static void rizz__print_error(uint32_t channels, const char* source_file, int li
         return;
     }
 
-    int fmt_len = sx_strlen(fmt);
-    char* text = alloca(fmt_len + 1024);    // reserve only 1k for format replace strings
-    if (!text) {
-        sx_assert_alwaysf(0, "out of stack memory");
-        return;
-    }
-
     va_list args;
     va_start(args, fmt);
-    sx_vsnprintf(text, fmt_len + 1024, fmt, args);
+    rizz__log_print(RIZZ_LOG_LEVEL_ERROR, channels, source_file, line, fmt, args);
     va_end(args);
-
-    rizz__log_dispatch_entry(&(rizz_log_entry){ .type = RIZZ_LOG_LEVEL_ERROR,
-                                                .channels = channels,
-                                                .text_len = sx_strlen(text),
-                                                .source_file_len = source_file ? sx_strlen(source_file) : 0,
-                                                .text = text,
-                                                .source_file = source_file,
-                                                .line = line });
 }
 
 static void rizz__print_warning(uint32_t channels, const char* source_file, int line,
-                                const char* fmt, ...)
-{
-    if (g_core.log_level < RIZZ_LOG_LEVEL_WARNING) {
-        return;
-    }
-
-    int fmt_len = sx_strlen(fmt);
-    char* text = alloca(fmt_len + 1024);    // reserve only 1k for format replace strings
-    if (!text) {
-        sx_assert_alwaysf(0, "out of stack memory");
+                                const char* fmt, ...)
+{
+    if (g_core.log_level < RIZZ_LOG_LEVEL_WARNING) {
         return;
     }
 
     va_list args;
     va_start(args, fmt);
-    sx_vsnprintf(text, fmt_len + 1024, fmt, args);
+    rizz__log_print(RIZZ_LOG_LEVEL_WARNING, channels, source_file, line, fmt, args);
     va_end(args);
-
-    rizz__log_dispatch_entry(&(rizz_log_entry){ .type = RIZZ_LOG_LEVEL_WARNING,
-                                                .channels = channels,
-                                                .text_len = sx_strlen(text),
-                                                .source_file_len = source_file ? sx_strlen(source_file) : 0,
-                                                .text = text,
-                                                .source_file = source_file,
-                                                .line = line });
 }
 
 static void rizz__log_update()
@@ -739,6 +1723,61 @@ int64_t rizz__frame_index(void)
     return g_core.frame_idx;
 }
 
+static void rizz__set_fixed_step_rate(int steps_per_sec)
+{
+    sx_assert(steps_per_sec >= 0);
+
+    rizz__fixed_step* fs = &g_core.fixed_step;
+    if (steps_per_sec > 0) {
+        // ticks don't have a fixed unit, so calculate how many ticks make a single step
+        fs->step_tick = (uint64_t)(1.0 / ((double)steps_per_sec * sx_tm_sec(1)) + 0.5);
+        fs->dt = 1.0f / (float)steps_per_sec;
+    } else {
+        fs->step_tick = 0;
+        fs->dt = 0;
+    }
+    fs->accum_tick = 0;
+    fs->alpha = 0;
+}
+
+static float rizz__fixed_step_dt(void)
+{
+    return g_core.fixed_step.dt;
+}
+
+static float rizz__fixed_step_alpha(void)
+{
+    return g_core.fixed_step.alpha;
+}
+
+static int64_t rizz__fixed_step_index(void)
+{
+    return g_core.fixed_step.index;
+}
+
+// consumes frame time in constant steps. steps are counted in integer ticks, so the number of 
+// steps for a given sequence of frame times is deterministic
+static void rizz__core_fixed_step(uint64_t delta_tick)
+{
+    rizz__fixed_step* fs = &g_core.fixed_step;
+    fs->accum_tick += delta_tick;
+
+    int num_steps = 0;
+    while (fs->accum_tick >= fs->step_tick && num_steps < fs->max_steps) {
+        rizz__plugin_fixed_step();
+        fs->accum_tick -= fs->step_tick;
+        ++fs->index;
+        ++num_steps;
+    }
+
+    // couldn't catch up (long frame or hitch), drop the whole steps that are left 
+    if (fs->accum_tick >= fs->step_tick) {
+        fs->accum_tick %= fs->step_tick;
+    }
+
+    fs->alpha = (float)((double)fs->accum_tick / (double)fs->step_tick);
+}
+
 void rizz__set_cache_dir(const char* path)
 {
     sx_unused(path);
@@ -1158,6 +2197,65 @@ static int rizz__core_echo_command(int argc, char* argv[], void* user)
     return -1;
 }
 
+static int rizz__core_mem_frame_allocs_command(int argc, char* argv[], void* user)
+{
+    sx_unused(argc);
+    sx_unused(argv);
+    sx_unused(user);
+
+    rizz__mem_log_frame_stats();
+    return 0;
+}
+
+// mem_capture [num_frames]
+static int rizz__core_mem_capture_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    int num_frames = argc > 1 ? sx_toint(argv[1]) : 1;
+    if (num_frames <= 0) {
+        rizz__log_warn("mem_capture: invalid number of frames '%s'", argv[1]);
+        return -1;
+    }
+
+    the__core.trace_alloc_capture_frames(num_frames);
+    return 0;
+}
+
+// mem_sample_dump [pprof|inuse|alloc] [filepath]
+static int rizz__core_mem_sample_dump_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    rizz_mem_sample_format format = RIZZ_MEM_SAMPLE_FORMAT_PPROF;
+    if (argc > 1) {
+        if (sx_strequal(argv[1], "inuse")) {
+            format = RIZZ_MEM_SAMPLE_FORMAT_COLLAPSED_INUSE;
+        } else if (sx_strequal(argv[1], "alloc")) {
+            format = RIZZ_MEM_SAMPLE_FORMAT_COLLAPSED_ALLOC;
+        } else if (!sx_strequal(argv[1], "pprof")) {
+            rizz__log_warn("mem_sample_dump: invalid format '%s', must be 'pprof', 'inuse' or 'alloc'", argv[1]);
+            return -1;
+        }
+    }
+
+    return rizz__mem_sample_dump(argc > 2 ? argv[2] : NULL, format) ? 0 : -1;
+}
+
+// profile_dump [name]
+static int rizz__core_profile_dump_command(int argc, char* argv[], void* user)
+{
+    sx_unused(user);
+
+    char name[64];
+    if (argc > 1) {
+        sx_strcpy(name, sizeof(name), argv[1]);
+    } else {
+        sx_snprintf(name, sizeof(name), "frame_%lld", (long long)g_core.frame_idx);
+    }
+    return rizz__profile_history_dump(name) ? 0 : -1;
+}
+
 static bool rizz__init_tmp_alloc_tls(rizz__tmp_alloc_tls* tmpalloc)
 {
     sx_assert(!tmpalloc->init);
@@ -1226,6 +2324,398 @@ static void rizz__release_tmp_alloc_tls(rizz__tmp_alloc_tls* tmpalloc)
     tmpalloc->init = false;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// @frame-graph
+static void rizz__frame_task_http_poll(float dt, void* user)
+{
+    sx_unused(dt);
+    sx_unused(user);
+    rizz__http_poll();
+}
+
+static void rizz__frame_task_http(float dt, void* user)
+{
+    sx_unused(dt);
+    sx_unused(user);
+    rizz__http_update();
+}
+
+static void rizz__frame_task_vfs(float dt, void* user)
+{
+    sx_unused(dt);
+    sx_unused(user);
+    rizz__vfs_async_update();
+}
+
+static void rizz__frame_task_asset(float dt, void* user)
+{
+    sx_unused(dt);
+    sx_unused(user);
+    rizz__asset_update();
+}
+
+static void rizz__frame_task_gfx(float dt, void* user)
+{
+    sx_unused(dt);
+    sx_unused(user);
+    rizz__gfx_update();
+}
+
+static void rizz__coro_job_cb(int start, int end, int thrd_index, void* user)
+{
+    sx_unused(thrd_index);
+    sx_unused(user);
+    for (int i = start; i < end; i++) {
+        sx_coro_resume_ready(g_core.coro, i);
+    }
+}
+
+static void rizz__frame_task_coroutines(float dt, void* user)
+{
+    sx_unused(user);
+
+    // main-thread coroutines are resumed here, due coroutines of `coro_invoke_job` are spread 
+    // over job threads and the task waits for them
+    int num_jobs = sx_coro_update_begin(g_core.coro, dt);
+    if (num_jobs > 0) {
+        sx_job_t job = sx_job_dispatch(g_core.jobs, num_jobs, rizz__coro_job_cb, NULL,
+                                       SX_JOB_PRIORITY_HIGH, 0);
+        sx_job_wait_and_del(g_core.jobs, job);
+    }
+}
+
+static void rizz__frame_task_fixed_step(float dt, void* user)
+{
+    sx_unused(dt);
+    sx_unused(user);
+    // fixed-step simulation runs before the regular update, so STEP can interpolate the results
+    if (g_core.fixed_step.step_tick > 0) {
+        rizz__core_fixed_step(g_core.delta_tick);
+    }
+}
+
+static void rizz__frame_task_plugins(float dt, void* user)
+{
+    sx_unused(user);
+    rizz__plugin_update(dt);
+}
+
+static void rizz__frame_task_console(float dt, void* user)
+{
+    sx_unused(dt);
+    sx_unused(user);
+
+    // consume console commands from remotery
+    if (g_core.rmt_command_queue) {
+        char* cmd;
+        while (sx_queue_spsc_consume(g_core.rmt_command_queue, (void*)&cmd)) {
+            rizz__execute_console_command(cmd);
+            sx_free(g_core.profiler_alloc, cmd);
+        }
+    }
+}
+
+static void rizz__frame_task_command_buffers(float dt, void* user)
+{
+    sx_unused(dt);
+    sx_unused(user);
+    // execute remaining commands from the 'staged' API
+    rizz__gfx_execute_command_buffers_final();
+}
+
+static void rizz__frame_task_log(float dt, void* user)
+{
+    sx_unused(dt);
+    sx_unused(user);
+    // flush queued logs
+    rizz__log_update();
+}
+
+static void rizz__frame_task_imgui(float dt, void* user)
+{
+    sx_unused(dt);
+    sx_unused(user);
+
+    rizz_api_imgui* the_imgui = the__plugin.get_api_byname("imgui", 0);
+    if (the_imgui) {
+        rizz_api_imgui_extra* the_imguix = the__plugin.get_api_byname("imgui_extra", 0);
+        if (g_core.show_memory.show) {
+            rizz__mem_show_debugger(g_core.show_memory.p_open);
+            g_core.show_memory.show = false;
+        }
+        if (g_core.show_graphics.show) {
+            the_imguix->graphics_debugger(the__gfx.trace_info(), g_core.show_graphics.p_open);
+            g_core.show_graphics.show = false;
+        }
+        if (g_core.show_log.show) {
+            the_imguix->show_log(g_core.show_log.p_open);
+            g_core.show_log.show = false;
+        }
+
+        rizz__gfx_trace_reset_frame_stats(RIZZ_GFX_TRACE_IMGUI);
+        the_imgui->Render();
+    }
+}
+
+static int rizz__frame_task_find(const char* name)
+{
+    for (int i = 0, c = sx_array_count(g_core.frame_tasks); i < c; i++) {
+        if (sx_strequal(g_core.frame_tasks[i].name, name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// frame task ops are not thread-safe, they can only be requested from the main thread
+static void rizz__frame_task_add(const char* name, rizz_frame_task_cb* task_fn, void* user,
+                                 rizz_frame_res reads, rizz_frame_res writes,
+                                 rizz_frame_task_flags flags)
+{
+    sx_assert(name);
+    sx_assert(task_fn);
+
+    rizz__frame_task_op op = { .task = { .task_fn = task_fn,
+                                         .user = user,
+                                         .reads = reads,
+                                         .writes = writes,
+                                         .flags = flags } };
+    sx_strcpy(op.task.name, sizeof(op.task.name), name);
+    sx_array_push(g_core.core_alloc, g_core.frame_task_ops, op);
+}
+
+static void rizz__frame_task_remove(const char* name)
+{
+    sx_assert(name);
+
+    rizz__frame_task_op op = { .remove = true };
+    sx_strcpy(op.task.name, sizeof(op.task.name), name);
+    sx_array_push(g_core.core_alloc, g_core.frame_task_ops, op);
+}
+
+static void rizz__frame_graph_add_builtin(const char* name, rizz_frame_task_cb* task_fn,
+                                          rizz_frame_res reads, rizz_frame_res writes,
+                                          rizz_frame_task_flags flags)
+{
+    rizz__frame_task task = { .task_fn = task_fn,
+                              .reads = reads,
+                              .writes = writes,
+                              .flags = flags,
+                              .builtin = true };
+    sx_strcpy(task.name, sizeof(task.name), name);
+    sx_array_push(g_core.core_alloc, g_core.frame_tasks, task);
+    g_core.frame_graph_dirty = true;
+}
+
+// built-in tasks are added in the same order that sub-systems used to be updated sequentially, 
+// except http, which is split into polling and callbacks (see below). tasks that run user code are
+// main-thread only and write all built-in resources, so their order is preserved. these are 
+// http/vfs/asset callbacks, coroutines, plugins, console commands and custom log backends 
+// (Log_update). gfx tasks use the GPU context, which is bound to the main thread
+// the only work that is independent of user code is polling http sockets. it runs on job threads 
+// with HTTP access only, after Vfs and concurrently with Asset and Gfx. finished requests call 
+// their callbacks later in the main-thread Http task
+static void rizz__frame_graph_init(void)
+{
+    const rizz_frame_task_flags main_thread = RIZZ_FRAME_TASK_MAIN_THREAD;
+    const rizz_frame_res user_code = RIZZ_FRAME_RES_BUILTIN & ~RIZZ_FRAME_RES_LOG;
+
+    rizz__frame_graph_add_builtin("Vfs", rizz__frame_task_vfs, 0, user_code, main_thread);
+    rizz__frame_graph_add_builtin("Asset", rizz__frame_task_asset, RIZZ_FRAME_RES_VFS,
+                                  RIZZ_FRAME_RES_ASSET | RIZZ_FRAME_RES_GPU, main_thread);
+    rizz__frame_graph_add_builtin("Http_poll", rizz__frame_task_http_poll, 0, RIZZ_FRAME_RES_HTTP, 0);
+    rizz__frame_graph_add_builtin("Gfx", rizz__frame_task_gfx, 0, RIZZ_FRAME_RES_GPU, main_thread);
+    rizz__frame_graph_add_builtin("Http", rizz__frame_task_http, 0, user_code, main_thread);
+    rizz__frame_graph_add_builtin("Coroutines", rizz__frame_task_coroutines, 0, user_code, main_thread);
+    rizz__frame_graph_add_builtin("Fixed_step", rizz__frame_task_fixed_step, 0, user_code, main_thread);
+    rizz__frame_graph_add_builtin("Plugins", rizz__frame_task_plugins, 0, user_code, main_thread);
+    rizz__frame_graph_add_builtin("Console", rizz__frame_task_console, 0, user_code, main_thread);
+    rizz__frame_graph_add_builtin("Execute_command_buffers", rizz__frame_task_command_buffers,
+                                  RIZZ_FRAME_RES_PLUGIN, RIZZ_FRAME_RES_GPU, main_thread);
+    // log entries are pushed from any thread, so user code doesn't write to LOG. flush reads PLUGIN 
+    // only to be scheduled after all user code of the frame. custom backends (imgui log window for 
+    // example) are not thread-safe, so it stays on the main thread
+    rizz__frame_graph_add_builtin("Log_update", rizz__frame_task_log, RIZZ_FRAME_RES_PLUGIN,
+                                  RIZZ_FRAME_RES_LOG, main_thread);
+    rizz__frame_graph_add_builtin("ImGui_draw", rizz__frame_task_imgui,
+                                  RIZZ_FRAME_RES_LOG | RIZZ_FRAME_RES_PLUGIN, RIZZ_FRAME_RES_GPU,
+                                  main_thread);
+}
+
+static void rizz__frame_graph_apply_ops(void)
+{
+    for (int i = 0, c = sx_array_count(g_core.frame_task_ops); i < c; i++) {
+        const rizz__frame_task_op* op = &g_core.frame_task_ops[i];
+        int index = rizz__frame_task_find(op->task.name);
+        if (op->remove) {
+            if (index != -1) {
+                sx_assertf(!g_core.frame_tasks[index].builtin, "cannot remove built-in frame tasks");
+                // keep the order, because dependencies are resolved by the order of tasks
+                int count = sx_array_count(g_core.frame_tasks);
+                sx_memmove(&g_core.frame_tasks[index], &g_core.frame_tasks[index + 1],
+                           sizeof(rizz__frame_task) * (count - index - 1));
+                sx_array_pop_last(g_core.frame_tasks);
+            }
+        } else {
+            if (index == -1) {
+                sx_array_push(g_core.core_alloc, g_core.frame_tasks, op->task);
+            } else {
+                rizz__log_warn("frame task '%s' already exists", op->task.name);
+            }
+        }
+    }
+    sx_array_clear(g_core.frame_task_ops);
+    g_core.frame_graph_dirty = true;
+}
+
+static bool rizz__frame_task_conflicts(const rizz__frame_task* a, const rizz__frame_task* b)
+{
+    return (a->writes & (b->reads | b->writes)) || (b->writes & a->reads);
+}
+
+static void rizz__frame_graph_build(void)
+{
+    int num_tasks = sx_array_count(g_core.frame_tasks);
+    int num_levels = 0;
+    sx_array_clear(g_core.frame_task_deps);
+    for (int i = 0; i < num_tasks; i++) {
+        rizz__frame_task* task = &g_core.frame_tasks[i];
+        task->level = 0;
+        task->first_dep = sx_array_count(g_core.frame_task_deps);
+        task->num_deps = 0;
+        for (int k = 0; k < i; k++) {
+            if (rizz__frame_task_conflicts(task, &g_core.frame_tasks[k])) {
+                task->level = sx_max(task->level, g_core.frame_tasks[k].level + 1);
+                sx_array_push(g_core.core_alloc, g_core.frame_task_deps, k);
+                ++task->num_deps;
+            }
+        }
+        num_levels = sx_max(num_levels, task->level + 1);
+    }
+
+    // any order that puts dependencies first works, sorting by level with worker tasks first gets 
+    // the workers dispatched as early as possible
+    sx_array_clear(g_core.frame_task_order);
+    for (int l = 0; l < num_levels; l++) {
+        for (int pass = 0; pass < 2; pass++) {
+            bool main_pass = pass == 1;
+            for (int i = 0; i < num_tasks; i++) {
+                const rizz__frame_task* task = &g_core.frame_tasks[i];
+                bool main_thread = (task->flags & RIZZ_FRAME_TASK_MAIN_THREAD) != 0;
+                if (task->level == l && main_thread == main_pass) {
+                    sx_array_push(g_core.core_alloc, g_core.frame_task_order, i);
+                }
+            }
+        }
+    }
+
+    g_core.frame_graph_dirty = false;
+}
+
+static void rizz__frame_task_run(rizz__frame_task* task)
+{
+    the__core.begin_profile_sample(task->name, 0, &task->profile_hash);
+    task->task_fn(g_core.frame_dt, task->user);
+    the__core.end_profile_sample();
+}
+
+static void rizz__frame_task_job_cb(int start, int end, int thrd_index, void* user)
+{
+    sx_unused(start);
+    sx_unused(end);
+    sx_unused(thrd_index);
+    rizz__frame_task_run((rizz__frame_task*)user);
+}
+
+static bool rizz__frame_task_ready(const rizz__frame_task* task)
+{
+    for (int i = 0; i < task->num_deps; i++) {
+        if (!g_core.frame_tasks[g_core.frame_task_deps[task->first_dep + i]].done) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void rizz__frame_graph_run(float dt)
+{
+    if (sx_array_count(g_core.frame_task_ops) > 0) {
+        rizz__frame_graph_apply_ops();
+    }
+    if (g_core.frame_graph_dirty) {
+        rizz__frame_graph_build();
+    }
+
+    g_core.frame_dt = dt;
+    int num_tasks = sx_array_count(g_core.frame_task_order);
+    for (int i = 0; i < num_tasks; i++) {
+        g_core.frame_tasks[i].job = NULL;
+        g_core.frame_tasks[i].done = false;
+    }
+
+    // there are no barriers between levels: worker tasks are dispatched as soon as their own 
+    // dependencies are done, and stay in flight while the main thread runs anything else that is 
+    // ready. the main thread only blocks when nothing else can run, or at the end of the frame
+    int num_done = 0;
+    while (num_done < num_tasks) {
+        bool progress = false;
+        for (int i = 0; i < num_tasks; i++) {
+            rizz__frame_task* task = &g_core.frame_tasks[g_core.frame_task_order[i]];
+            if (task->done) {
+                continue;
+            }
+
+            if (task->job) {
+                if (sx_job_test_and_del(g_core.jobs, task->job)) {
+                    task->job = NULL;
+                    task->done = true;
+                    ++num_done;
+                    progress = true;
+                }
+            } else if (rizz__frame_task_ready(task)) {
+                if (task->flags & RIZZ_FRAME_TASK_MAIN_THREAD) {
+                    rizz__frame_task_run(task);
+                    task->done = true;
+                    ++num_done;
+                } else {
+                    task->job = sx_job_dispatch(g_core.jobs, 1, rizz__frame_task_job_cb, task,
+                                                SX_JOB_PRIORITY_HIGH, 0);
+                }
+                progress = true;
+            }
+        }
+
+        if (!progress) {
+            // everything left is waiting for worker tasks: wait for a dependency of the first 
+            // blocked task, so unrelated long running workers don't hold up the main thread
+            rizz__frame_task* wait_task = NULL;
+            for (int i = 0; i < num_tasks && !wait_task; i++) {
+                const rizz__frame_task* task = &g_core.frame_tasks[g_core.frame_task_order[i]];
+                if (!task->done && !task->job) {
+                    for (int d = 0; d < task->num_deps && !wait_task; d++) {
+                        rizz__frame_task* dep = &g_core.frame_tasks[g_core.frame_task_deps[task->first_dep + d]];
+                        if (dep->job) {
+                            wait_task = dep;
+                        }
+                    }
+                }
+            }
+            // nothing is blocked, only workers are left in flight
+            for (int i = 0; i < num_tasks && !wait_task; i++) {
+                rizz__frame_task* task = &g_core.frame_tasks[g_core.frame_task_order[i]];
+                if (task->job) {
+                    wait_task = task;
+                }
+            }
+            sx_assert(wait_task);
+            sx_job_wait_and_del(g_core.jobs, wait_task->job);
+            wait_task->job = NULL;
+            wait_task->done = true;
+            ++num_done;
+        }
+    }
+}
+
 bool rizz__core_init(const rizz_config* conf)
 {
     g_core.heap_alloc = (conf->core_flags & RIZZ_CORE_FLAG_DETECT_LEAKS)
@@ -1238,12 +2728,17 @@ bool rizz__core_init(const rizz_config* conf)
     #endif
     
     rizz__profile_startup_begin("memory_manager");
-    if (!rizz__mem_init(RIZZ_MEMOPTION_TRACE_CALLSTACK|RIZZ_MEMOPTION_MULTITHREAD)) {
+    uint32_t mem_opts = RIZZ_MEMOPTION_TRACE_CALLSTACK|RIZZ_MEMOPTION_MULTITHREAD|RIZZ_MEMOPTION_COUNT_FRAME_ALLOCS;
+    if (conf->core_flags & RIZZ_CORE_FLAG_SAMPLE_ALLOCATIONS) {
+        mem_opts |= RIZZ_MEMOPTION_SAMPLE_ALLOCS;
+    }
+    if (!rizz__mem_init(mem_opts)) {
         sx_assert_alwaysf(0, "Fatal error: memory system init failed");
         rizz__profile_startup_end();
         return false;
     }
     g_core.mem_capture_frame = -1;
+    g_core.mem_capture_end_frame = -1;
     g_core.core_alloc = rizz__mem_create_allocator("Core", RIZZ_MEMOPTION_INHERIT, NULL, g_core.heap_alloc);
     sx_assert_alwaysf(g_core.core_alloc, "Fatal error: could not create core allocator");
     g_core.profiler_alloc = rizz__mem_create_allocator("Profiler", RIZZ_MEMOPTION_INHERIT, "Core", g_core.heap_alloc);
@@ -1257,6 +2752,8 @@ bool rizz__core_init(const rizz_config* conf)
     g_core.app_ver = conf->app_version;
     g_core.flags = conf->core_flags;
     g_core.log_level = conf->log_level;
+    g_core.fixed_step.max_steps = conf->fixed_step_max_steps > 0 ? conf->fixed_step_max_steps : 5;
+    rizz__set_fixed_step_rate(conf->fixed_step_rate);
 
     // resolve number of worker threads if not defined explicitly
     // NOTE: we always have at least one extra worker thread not matter what input is
@@ -1292,22 +2789,32 @@ bool rizz__core_init(const rizz_config* conf)
     sx_assert_alwaysf(g_core.log_strpool, "out of memory");
 
     sx_mutex_init(&g_core.log_mtx);
+    sx_mutex_init(&g_core.log_queues_mtx);
+    sx_semaphore_init(&g_core.log_sem);
 
     #if SX_PLATFORM_ANDROID || SX_PLATFORM_IOS
         // TEMP: remove log to file flag on mobile
-        g_core.flags &= ~RIZZ_CORE_FLAG_LOG_TO_FILE;
+        g_core.flags &= ~(RIZZ_CORE_FLAG_LOG_TO_FILE|RIZZ_CORE_FLAG_LOG_TO_BINARY_FILE);
     #endif
 
     if (g_core.flags & RIZZ_CORE_FLAG_LOG_TO_FILE) {
         sx_strcpy(g_core.log_file, sizeof(g_core.log_file), conf->app_name);
         sx_strcat(g_core.log_file, sizeof(g_core.log_file), ".log");
         rizz__log_init_file(g_core.log_file);
-        rizz__log_register_backend("file", rizz__log_backend_file, NULL);
     }
 
-    if (g_core.flags & RIZZ_CORE_FLAG_LOG_TO_PROFILER) {
-        rizz__log_register_backend("remotery", rizz__log_backend_remotery, NULL);
+    if (g_core.flags & RIZZ_CORE_FLAG_LOG_TO_BINARY_FILE) {
+        char filepath[RIZZ_MAX_PATH];
+        sx_snprintf(filepath, sizeof(filepath), "%s.rlog", conf->app_name);
+        if (!rizz__log_bin_init(filepath)) {
+            g_core.flags &= ~RIZZ_CORE_FLAG_LOG_TO_BINARY_FILE;
+            rizz__log_bin_release();
+            rizz__log_warn("could not open binary log file: %s", filepath);
+        }
     }
+
+    // from here, log entries are formatted and dispatched to built-in backends by logger thread
+    rizz__log_start_thread(conf->log_queue_policy);
     rizz__profile_startup_end();    // log
 
     // log version
@@ -1323,6 +2830,9 @@ bool rizz__core_init(const rizz_config* conf)
     rizz__log_info("(init) vfs");
     rizz__profile_startup_end();
     
+    // frame profiler history, must be initialized before any worker threads start recording samples
+    rizz__profile_history_init(conf->profiler_history_secs, conf->profiler_spike_threshold_ms);
+
     // job dispatcher
     rizz__profile_startup_begin("job_dispatcher");
     g_core.jobs = sx_job_create_context(
@@ -1339,6 +2849,7 @@ bool rizz__core_init(const rizz_config* conf)
     rizz__log_info("(init) jobs: threads=%d, max_fibers=%d, stack_size=%dkb",
                    sx_job_num_worker_threads(g_core.jobs), conf->job_max_fibers,
                    conf->job_stack_size);
+    rizz__frame_graph_init();
     rizz__profile_startup_end();
 
     // asset system
@@ -1472,6 +2983,12 @@ bool rizz__core_init(const rizz_config* conf)
     rizz__json_init();
 
     the__core.register_console_command("echo", rizz__core_echo_command, NULL, NULL);
+    the__core.register_console_command("mem_frame_allocs", rizz__core_mem_frame_allocs_command, NULL, NULL);
+    the__core.register_console_command("mem_capture", rizz__core_mem_capture_command, NULL, NULL);
+    the__core.register_console_command("profile_dump", rizz__core_profile_dump_command, NULL, NULL);
+    if (conf->core_flags & RIZZ_CORE_FLAG_SAMPLE_ALLOCATIONS) {
+        the__core.register_console_command("mem_sample_dump", rizz__core_mem_sample_dump_command, NULL, NULL);
+    }
     rizz__profile_startup_end();
 
     return true;
@@ -1493,6 +3010,9 @@ void rizz__core_release(void)
         return;
     const sx_alloc* alloc = g_core.core_alloc;
 
+    // shutdown logs are dispatched immediately, because plugins are unloaded after this
+    rizz__log_stop_thread();
+
     // First release all plugins (+ game)
     rizz__plugin_release();
 
@@ -1527,6 +3047,10 @@ void rizz__core_release(void)
         sx_mutex_exit(&g_core.rmt_mtx);
     #endif // RMT_ENABLED
     sx_array_free(alloc, g_core.console_cmds);
+    sx_array_free(alloc, g_core.frame_tasks);
+    sx_array_free(alloc, g_core.frame_task_order);
+    sx_array_free(alloc, g_core.frame_task_deps);
+    sx_array_free(alloc, g_core.frame_task_ops);
 
     // release collected temp allocators
     sx_mutex_lock(g_core.tmp_allocs_mtx) {
@@ -1542,6 +3066,10 @@ void rizz__core_release(void)
     sx_mutex_release(&g_core.tmp_allocs_mtx);
 
     // release log backends and queues
+    rizz__log_release_queues();
+    rizz__log_bin_release();
+    sx_semaphore_release(&g_core.log_sem);
+    sx_mutex_release(&g_core.log_queues_mtx);
     sx_mutex_release(&g_core.log_mtx);
     sx_strpool_destroy(g_core.log_strpool, alloc);
     sx_array_free(alloc, g_core.log_entries);
@@ -1554,14 +3082,7 @@ void rizz__core_release(void)
     rizz__mem_destroy_allocator(g_core.coro_alloc);
     rizz__mem_destroy_allocator(g_core.core_alloc);
     rizz__mem_release();
-    
-    for (int i = 0; i < sx_array_count(g_core.tls_vars); i++) {
-        if (g_core.tls_vars[i].tls) {
-            sx_tls_destroy(g_core.tls_vars[i].tls);
-        }
-    }
 
-    sx_array_free(g_core.heap_alloc, g_core.tls_vars);
     rizz__log_info("shutdown");
 
 #ifdef _DEBUG
@@ -1576,12 +3097,19 @@ void rizz__core_frame(void)
         return;
     }
 
-    bool call_end_capture = false;
+    // check the previous frame's time (including present) for spikes
+    if (g_core.frame_idx > 0) {
+        rizz__profile_history_frame(g_core.frame_idx - 1, sx_tm_since(g_core.last_tick));
+    }
+
     if (g_core.mem_capture_frame == g_core.frame_idx) {
         char name[32];
-        sx_snprintf(name, sizeof(name), "frame_%lld", g_core.frame_idx);
+        if (g_core.mem_capture_end_frame > g_core.frame_idx) {
+            sx_snprintf(name, sizeof(name), "frames_%lld_%lld", (long long)g_core.frame_idx, (long long)g_core.mem_capture_end_frame);
+        } else {
+            sx_snprintf(name, sizeof(name), "frame_%lld", (long long)g_core.frame_idx);
+        }
         rizz__mem_begin_capture(name);
-        call_end_capture = true;
     }
 
     rizz__profile(Frame) {
@@ -1681,70 +3209,21 @@ void rizz__core_frame(void)
 
         rizz__gfx_trace_reset_frame_stats(RIZZ_GFX_TRACE_COMMON);
 
-        // update internal sub-systems
-        rizz__http_update();
-        rizz__vfs_async_update();
-        rizz__asset_update();
-        rizz__gfx_update();
-
-        rizz__profile(Coroutines) {
-            sx_coro_update(g_core.coro, dt);
-        }
-
-        // update plugins and application
-        rizz__plugin_update(dt);
-
-        // execute remaining commands from the 'staged' API
-        rizz__profile(Execute_command_buffers) {
-            rizz__gfx_execute_command_buffers_final();
-        }
-
-        // flush queued logs
-        rizz__profile(Log_update) {
-            rizz__log_update();
-        }
-
-        // consume console commands from remotery
-        if (g_core.rmt_command_queue) {
-            char* cmd;
-            while (sx_queue_spsc_consume(g_core.rmt_command_queue, (void*)&cmd)) {
-                rizz__execute_console_command(cmd);
-                sx_free(g_core.profiler_alloc, cmd);
-            }
-        }
-
-        // draw imgui stuff
-        rizz_api_imgui* the_imgui = the__plugin.get_api_byname("imgui", 0);
-        if (the_imgui) {
-            rizz__profile(ImGui_draw) {
-                rizz_api_imgui_extra* the_imguix = the__plugin.get_api_byname("imgui_extra", 0);
-                if (g_core.show_memory.show) {
-                    rizz__mem_show_debugger(g_core.show_memory.p_open);
-                    g_core.show_memory.show = false;
-                }
-                if (g_core.show_graphics.show) {
-                    the_imguix->graphics_debugger(the__gfx.trace_info(), g_core.show_graphics.p_open);
-                    g_core.show_graphics.show = false;
-                }
-                if (g_core.show_log.show) {
-                    the_imguix->show_log(g_core.show_log.p_open);
-                    g_core.show_log.show = false;
-                }
-
-                rizz__gfx_trace_reset_frame_stats(RIZZ_GFX_TRACE_IMGUI);
-                the_imgui->Render();
-            }
-        }
+        // update internal sub-systems, plugins and application
+        rizz__frame_graph_run(dt);
 
         rizz__gfx_commit_gpu();
+        rizz__mem_end_frame();
         ++g_core.frame_idx;
 
         the__gfx.imm.end_profile_sample();
+        rizz__gfx_trace_end_frame(g_core.frame_idx - 1);
     } // profile
 
-    if (call_end_capture) {
+    if (g_core.mem_capture_frame != -1 && g_core.mem_capture_end_frame == g_core.frame_idx) {
         rizz__mem_end_capture();
         g_core.mem_capture_frame = -1;
+        g_core.mem_capture_end_frame = -1;
     }    
 }
 
@@ -1904,10 +3383,12 @@ static void rizz__begin_profile_sample(const char* name, rizz_profile_flags flag
     sx_unused(flags);
     sx_unused(hash_cache);
     rmt__begin_cpu_sample(name, flags, hash_cache);
+    rizz__profile_history_begin(name);
 }
 
 static void rizz__end_profile_sample(void)
 {
+    rizz__profile_history_end();
     rmt__end_cpu_sample();
 }
 
@@ -1916,6 +3397,11 @@ static void rizz__core_coro_invoke(void (*coro_cb)(sx_fiber_transfer), void* use
     sx__coro_invoke(g_core.coro, coro_cb, user);
 }
 
+static void rizz__core_coro_invoke_job(void (*coro_cb)(sx_fiber_transfer), void* user)
+{
+    sx__coro_invoke_any_thread(g_core.coro, coro_cb, user);
+}
+
 static void rizz__core_coro_end(void* pfrom)
 {
     sx__coro_end(g_core.coro, pfrom);
@@ -1953,41 +3439,65 @@ void rizz__core_fix_callback_ptrs(const void** ptrs, const void** new_ptrs, int
                     g_core.console_cmds[k].callback = (rizz_core_cmd_cb*)new_ptrs[i];
                 }
             }
+
+            // frame tasks
+            for (int k = 0, kc = sx_array_count(g_core.frame_tasks); k < kc; k++) {
+                if (g_core.frame_tasks[k].task_fn == ptrs[i]) {
+                    g_core.frame_tasks[k].task_fn = (rizz_frame_task_cb*)new_ptrs[i];
+                }
+            }
         }
     }
 }
 
-static void rizz__core_tls_register(const char* name, void* user,
-                                    void* (*init_cb)(int thread_idx, uint32_t thread_id, void* user))
+static int rizz__core_tls_register(const char* name, void* user,
+                                   void* (*init_cb)(int thread_idx, uint32_t thread_id, void* user))
 {
     sx_assert(name);
     sx_assert(init_cb);
 
-    rizz__tls_var tvar = (rizz__tls_var){ .name_hash = sx_hash_fnv32_str(name),
-                                          .user = user,
-                                          .init_cb = init_cb,
-                                          .tls = sx_tls_create() };
+    // registering the same name again (plugin reload) keeps the slot and the values of threads
+    uint32_t hash = sx_hash_fnv32_str(name);
+    int slot = -1;
+    for (int i = 0; i < g_core.num_tls_vars; i++) {
+        if (g_core.tls_vars[i].name_hash == hash) {
+            slot = i;
+            break;
+        }
+    }
+
+    if (slot == -1) {
+        if (g_core.num_tls_vars == RIZZ_CONFIG_MAX_TLS_VARS) {
+            sx_assertf(0, "too many tls variables, increase RIZZ_CONFIG_MAX_TLS_VARS");
+            return -1;
+        }
+        slot = g_core.num_tls_vars++;
+    }
+
+    g_core.tls_vars[slot] = (rizz__tls_var){ .name_hash = hash, .user = user, .init_cb = init_cb };
+    return slot;
+}
 
-    sx_assert(tvar.tls);
+static void* rizz__core_tls_var_slot(int slot)
+{
+    sx_assert(slot >= 0 && slot < g_core.num_tls_vars);
 
-    sx_array_push(g_core.heap_alloc, g_core.tls_vars, tvar);
+    void* var = tl_tls_vars[slot];
+    if (!var) {
+        const rizz__tls_var* tvar = &g_core.tls_vars[slot];
+        var = tvar->init_cb(sx_job_thread_index(g_core.jobs), sx_job_thread_id(g_core.jobs), tvar->user);
+        tl_tls_vars[slot] = var;
+    }
+    return var;
 }
 
 static void* rizz__core_tls_var(const char* name)
 {
     sx_assert(name);
     uint32_t hash = sx_hash_fnv32_str(name);
-    for (int i = 0, c = sx_array_count(g_core.tls_vars); i < c; i++) {
-        rizz__tls_var* tvar = &g_core.tls_vars[i];
-
-        if (tvar->name_hash == hash) {
-            void* var = sx_tls_get(tvar->tls);
-            if (!var) {
-                var = tvar->init_cb(sx_job_thread_index(g_core.jobs), sx_job_thread_id(g_core.jobs),
-                                    tvar->user);
-                sx_tls_set(tvar->tls, var);
-            }
-            return var;
+    for (int i = 0; i < g_core.num_tls_vars; i++) {
+        if (g_core.tls_vars[i].name_hash == hash) {
+            return rizz__core_tls_var_slot(i);
         }
     }
 
@@ -2065,9 +3575,20 @@ static const char* rizz__str_cstr(sx_str_t handle)
     return sx_strpool_cstr(g_core.strpool, handle);
 }
 
-static void rizz__trace_alloc_capture_frame(void)
+static void rizz__trace_alloc_capture_frames(int num_frames)
 {
+    sx_assert(num_frames > 0);
+    if (g_core.mem_capture_frame != -1) {
+        rizz__log_warn("memory capture is already in progress");
+        return;
+    }
     g_core.mem_capture_frame = g_core.frame_idx + 1;
+    g_core.mem_capture_end_frame = g_core.mem_capture_frame + sx_max(num_frames, 1) - 1;
+}
+
+static void rizz__trace_alloc_capture_frame(void)
+{
+    rizz__trace_alloc_capture_frames(1);
 }
 
 static const sx_alloc* rizz__core_alloc(void)
@@ -2123,10 +3644,17 @@ rizz_api_core the__core = { .heap_alloc = rizz__heap_alloc,
                             .tmp_alloc_push_trace = rizz__tmp_alloc_push_trace,
                             .tls_register = rizz__core_tls_register,
                             .tls_var = rizz__core_tls_var,
+                            .tls_var_slot = rizz__core_tls_var_slot,
                             .trace_alloc_create = rizz__mem_create_allocator,
                             .trace_alloc_destroy = rizz__mem_destroy_allocator,
                             .trace_alloc_clear = rizz__mem_allocator_clear_trace,
                             .trace_alloc_capture_frame = rizz__trace_alloc_capture_frame,
+                            .trace_alloc_capture_frames = rizz__trace_alloc_capture_frames,
+                            .trace_alloc_frame_stats = rizz__mem_frame_stats,
+                            .trace_alloc_steady_state_begin = rizz__mem_steady_state_begin,
+                            .trace_alloc_steady_state_end = rizz__mem_steady_state_end,
+                            .trace_alloc_set_sample_interval = rizz__mem_set_sample_interval,
+                            .trace_alloc_sample_dump = rizz__mem_sample_dump,
                             .version = rizz__version,
                             .delta_tick = rizz__delta_tick,
                             .delta_time = rizz__delta_time,
@@ -2134,6 +3662,10 @@ rizz_api_core the__core = { .heap_alloc = rizz__heap_alloc,
                             .fps = rizz__fps,
                             .fps_mean = rizz__fps_mean,
                             .frame_index = rizz__frame_index,
+                            .set_fixed_step_rate = rizz__set_fixed_step_rate,
+                            .fixed_step_dt = rizz__fixed_step_dt,
+                            .fixed_step_alpha = rizz__fixed_step_alpha,
+                            .fixed_step_index = rizz__fixed_step_index,
                             .pause = rizz__pause,
                             .resume = rizz__resume,
                             .is_paused = rizz__is_paused,
@@ -2151,6 +3683,7 @@ rizz_api_core the__core = { .heap_alloc = rizz__heap_alloc,
                             .job_num_threads = rizz__job_num_threads,
                             .job_thread_index = rizz__job_thread_index,
                             .coro_invoke = rizz__core_coro_invoke,
+                            .coro_invoke_job = rizz__core_coro_invoke_job,
                             .coro_end = rizz__core_coro_end,
                             .coro_wait = rizz__core_coro_wait,
                             .coro_yield = rizz__core_coro_yield,
@@ -2169,7 +3702,10 @@ rizz_api_core the__core = { .heap_alloc = rizz__heap_alloc,
                             .profile_capture_sample_end = rizz__profile_capture_sample_end,
                             .profile_capture_end = rizz__profile_capture_end,
                             .profile_capture_startup = rizz__profile_capture_startup,
+                            .profile_history_dump = rizz__profile_history_dump,
                             .register_console_command = rizz__register_console_command,
+                            .frame_task_add = rizz__frame_task_add,
+                            .frame_task_remove = rizz__frame_task_remove,
                             .execute_console_command = rizz__execute_console_command,
                             .show_graphics_debugger = rizz__show_graphics_debugger,
                             .show_memory_debugger = rizz__show_memory_debugger,
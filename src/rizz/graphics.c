@@ -254,6 +254,38 @@ typedef struct rizz__trace_gfx {
     rizz_gfx_perframe_trace_info* active_trace;
 } rizz__trace_gfx;
 
+// gpu timer: a pair of timestamp queries around each profile sample (TIME_ELAPSED queries can't be nested)
+// queries of each frame are read back RIZZ__GPU_TIMER_FRAMES-1 frames later, so we never stall on results
+#define RIZZ__GPU_TIMER_FRAMES      4
+#define RIZZ__GPU_TIMER_MAX_SAMPLES 128
+
+#if defined(SOKOL_GLCORE33)
+typedef struct rizz__gpu_timer_sample {
+    char name[32];
+    int depth;
+    int begin_query;
+    int end_query;
+} rizz__gpu_timer_sample;
+
+typedef struct rizz__gpu_timer_frame {
+    GLuint queries[RIZZ__GPU_TIMER_MAX_SAMPLES * 2];
+    rizz__gpu_timer_sample samples[RIZZ__GPU_TIMER_MAX_SAMPLES];
+    int num_samples;
+    int num_queries;
+    int64_t frame_idx;
+} rizz__gpu_timer_frame;
+
+typedef struct rizz__gpu_timer {
+    rizz__gpu_timer_frame frames[RIZZ__GPU_TIMER_FRAMES];
+    int cur_frame;
+    int stack[MAX_DEPTH];
+    int depth;
+    int skip_depth;             // >0 when we are inside samples that didn't fit into the frame
+    rizz_gfx_gpu_sample results[RIZZ__GPU_TIMER_MAX_SAMPLES];
+    bool enabled;
+} rizz__gpu_timer;
+#endif
+
 typedef struct rizz__gfx_source_loc {
     const char* file;
     uint32_t line;
@@ -277,6 +309,9 @@ typedef struct rizz__gfx {
         ID3D11DeviceContext2* d3d11_ctx;
         bool                  d3d11_has_marker;
     #endif
+    #if defined(SOKOL_GLCORE33)
+        rizz__gpu_timer gpu_timer;
+    #endif
     rizz__gfx_stream_buffer* SX_ARRAY stream_buffs;    // streaming buffers for append_buffers
 
     sg_buffer* destroy_buffers;
@@ -2225,6 +2260,196 @@ void rizz__gfx_trace_reset_frame_stats(rizz_gfx_perframe_trace_zone zone)
     g_gfx.trace.active_trace = pf;
 }
 
+#if defined(SOKOL_GLCORE33)
+// timestamp queries are core in GL 3.3, otherwise they need ARB_timer_query. some drivers expose the
+// queries but don't have a timestamp counter, so the counter bits should be checked as well
+static bool rizz__gpu_timer_supported(void)
+{
+    if (!glQueryCounter || !glGetQueryObjectui64v || !glGetQueryiv) {
+        return false;
+    }
+
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bool supported = major * 10 + minor >= 33;
+    if (!supported) {
+        GLint num_exts = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &num_exts);
+        for (GLint i = 0; i < num_exts && !supported; i++) {
+            const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+            supported = ext && sx_strequal(ext, "GL_ARB_timer_query");
+        }
+    }
+    if (!supported) {
+        return false;
+    }
+
+    GLint bits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+    return bits > 0;
+}
+#endif
+
+static void rizz__gpu_timer_init(void)
+{
+    #if defined(SOKOL_GLCORE33)
+        rizz__gpu_timer* timer = &g_gfx.gpu_timer;
+        while (glGetError() != GL_NO_ERROR) {}    // clear previous errors
+        if (!rizz__gpu_timer_supported()) {
+            while (glGetError() != GL_NO_ERROR) {}
+            rizz__log_warn("gfx: gpu timestamp queries are not supported");
+            return;
+        }
+
+        for (int i = 0; i < RIZZ__GPU_TIMER_FRAMES; i++) {
+            glGenQueries(RIZZ__GPU_TIMER_MAX_SAMPLES * 2, timer->frames[i].queries);
+            timer->frames[i].frame_idx = -1;
+        }
+        timer->enabled = glGetError() == GL_NO_ERROR;
+        if (!timer->enabled) {
+            rizz__log_warn("gfx: gpu timestamp queries are not supported");
+        }
+    #endif
+}
+
+static void rizz__gpu_timer_release(void)
+{
+    #if defined(SOKOL_GLCORE33)
+        rizz__gpu_timer* timer = &g_gfx.gpu_timer;
+        if (timer->enabled) {
+            for (int i = 0; i < RIZZ__GPU_TIMER_FRAMES; i++) {
+                glDeleteQueries(RIZZ__GPU_TIMER_MAX_SAMPLES * 2, timer->frames[i].queries);
+            }
+            timer->enabled = false;
+        }
+    #endif
+}
+
+static void rizz__gpu_timer_begin(const char* name)
+{
+    #if defined(SOKOL_GLCORE33)
+        rizz__gpu_timer* timer = &g_gfx.gpu_timer;
+        if (!timer->enabled) {
+            return;
+        }
+
+        rizz__gpu_timer_frame* frame = &timer->frames[timer->cur_frame];
+        if (timer->skip_depth > 0 || frame->num_samples == RIZZ__GPU_TIMER_MAX_SAMPLES ||
+            timer->depth == MAX_DEPTH) {
+            ++timer->skip_depth;
+            return;
+        }
+
+        int index = frame->num_samples++;
+        rizz__gpu_timer_sample* sample = &frame->samples[index];
+        sx_strcpy(sample->name, sizeof(sample->name), name);
+        sample->depth = timer->depth;
+        sample->begin_query = frame->num_queries++;
+        sample->end_query = -1;
+        glQueryCounter(frame->queries[sample->begin_query], GL_TIMESTAMP);
+
+        timer->stack[timer->depth++] = index;
+    #else
+        sx_unused(name);
+    #endif
+}
+
+static void rizz__gpu_timer_end(void)
+{
+    #if defined(SOKOL_GLCORE33)
+        rizz__gpu_timer* timer = &g_gfx.gpu_timer;
+        if (!timer->enabled) {
+            return;
+        }
+
+        if (timer->skip_depth > 0) {
+            --timer->skip_depth;
+            return;
+        }
+
+        sx_assertf(timer->depth > 0, "gpu profile sample end is called without begin");
+        if (timer->depth == 0) {
+            return;
+        }
+
+        rizz__gpu_timer_frame* frame = &timer->frames[timer->cur_frame];
+        rizz__gpu_timer_sample* sample = &frame->samples[timer->stack[--timer->depth]];
+        sample->end_query = frame->num_queries++;
+        glQueryCounter(frame->queries[sample->end_query], GL_TIMESTAMP);
+    #endif
+}
+
+#if defined(SOKOL_GLCORE33)
+// reads back the timestamps of the frame into the trace info, returns false if results are not ready
+static bool rizz__gpu_timer_resolve(rizz__gpu_timer_frame* frame)
+{
+    rizz__gpu_timer* timer = &g_gfx.gpu_timer;
+
+    // queries finish in order, so checking the last one is enough
+    GLint available = 0;
+    glGetQueryObjectiv(frame->queries[frame->num_queries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return false;
+    }
+
+    GLuint64 first_tm = UINT64_MAX;
+    GLuint64 last_tm = 0;
+    int num_results = 0;
+    for (int i = 0; i < frame->num_samples; i++) {
+        const rizz__gpu_timer_sample* sample = &frame->samples[i];
+        if (sample->end_query == -1) {
+            continue;
+        }
+
+        GLuint64 begin_tm, end_tm;
+        glGetQueryObjectui64v(frame->queries[sample->begin_query], GL_QUERY_RESULT, &begin_tm);
+        glGetQueryObjectui64v(frame->queries[sample->end_query], GL_QUERY_RESULT, &end_tm);
+        first_tm = sx_min(first_tm, begin_tm);
+        last_tm = sx_max(last_tm, end_tm);
+
+        rizz_gfx_gpu_sample* r = &timer->results[num_results++];
+        sx_memcpy(r->name, sample->name, sizeof(r->name));
+        r->depth = sample->depth;
+        r->ms = end_tm > begin_tm ? (float)((double)(end_tm - begin_tm) / 1000000.0) : 0;
+    }
+
+    rizz_gfx_perframe_trace_info* pf = &g_gfx.trace.t.pf[RIZZ_GFX_TRACE_COMMON];
+    pf->gpu_frame = frame->frame_idx;
+    pf->gpu_ms = last_tm > first_tm ? (float)((double)(last_tm - first_tm) / 1000000.0) : 0;
+    pf->num_gpu_samples = num_results;
+    pf->gpu_samples = timer->results;
+    return true;
+}
+#endif
+
+// called at the end of each frame, after all gpu samples are ended
+void rizz__gfx_trace_end_frame(int64_t frame_idx)
+{
+    #if defined(SOKOL_GLCORE33)
+        rizz__gpu_timer* timer = &g_gfx.gpu_timer;
+        if (!timer->enabled) {
+            return;
+        }
+
+        sx_assertf(timer->depth == 0 && timer->skip_depth == 0, "gpu profile samples are not ended");
+        timer->depth = timer->skip_depth = 0;
+        timer->frames[timer->cur_frame].frame_idx = frame_idx;
+
+        // oldest frame is reused for the next frame, resolve it if it's ready, otherwise drop it
+        timer->cur_frame = (timer->cur_frame + 1) % RIZZ__GPU_TIMER_FRAMES;
+        rizz__gpu_timer_frame* frame = &timer->frames[timer->cur_frame];
+        if (frame->num_queries > 0) {
+            rizz__gpu_timer_resolve(frame);
+        }
+        frame->num_samples = 0;
+        frame->num_queries = 0;
+        frame->frame_idx = -1;
+    #else
+        sx_unused(frame_idx);
+    #endif
+}
+
 static void rizz__gfx_collect_garbage(int64_t frame)
 {
     // check frames and destroy objects if they are past 1 frame
@@ -2383,6 +2608,7 @@ bool rizz__gfx_init(const sg_desc* desc, bool enable_profile)
 
     // profiler
     if (enable_profile) {
+        rizz__gpu_timer_init();
         if (RMT_USE_D3D11) {
             rmt_BindD3D11((void*)rizz__app_d3d11_device(), (void*)rizz__app_d3d11_device_context());
         } else if (RMT_USE_OPENGL) {
@@ -2444,6 +2670,7 @@ void rizz__gfx_release()
 
     // profiler
     if (g_gfx.enable_profile) {
+        rizz__gpu_timer_release();
         if (RMT_USE_D3D11) {
             rmt_UnbindD3D11();
         } else if (RMT_USE_OPENGL) {
@@ -2571,6 +2798,8 @@ static uint8_t* rizz__cb_run_begin_profile_sample(uint8_t* buff)
     sx_unused(hash_cache);
     buff += sizeof(uint32_t*);
     rmt__begin_gpu_sample(name, hash_cache);
+    rizz__gpu_timer_begin(name);
+    rizz__profile_history_begin(name);    // cpu-side execution of the staged commands
     return buff;
 }
 
@@ -2593,6 +2822,8 @@ static void rizz__cb_end_profile_sample(void)
 
 static uint8_t* rizz__cb_run_end_profile_sample(uint8_t* buff)
 {
+    rizz__profile_history_end();
+    rizz__gpu_timer_end();
     rmt__end_gpu_sample();
     return buff;
 }
@@ -3805,10 +4036,12 @@ static void rizz__begin_profile_sample(const char* name, uint32_t* hash_cache)
     sx_unused(hash_cache);
 
     rmt__begin_gpu_sample(name, hash_cache);
+    rizz__gpu_timer_begin(name);
 }
 
 static void rizz__end_profile_sample(void)
 {
+    rizz__gpu_timer_end();
     rmt__end_gpu_sample();
 }
 
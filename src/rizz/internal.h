@@ -26,13 +26,17 @@ bool rizz__plugin_init(const sx_alloc* alloc, const char* plugin_path, bool hot_
 void rizz__plugin_release(void);
 void rizz__plugin_broadcast_event(const rizz_app_event* e);
 void rizz__plugin_update(float dt);
+void rizz__plugin_fixed_step(void);
 bool rizz__plugin_load_abs(const char* filepath, bool entry, const char** deps, int num_deps);
+bool rizz__plugin_load_all(const char** names, int num_names);
 bool rizz__plugin_init_plugins(void);
 
 bool rizz__core_init(const rizz_config* conf);
 void rizz__core_release(void);
 void rizz__core_frame(void);
 void rizz__core_fix_callback_ptrs(const void** ptrs, const void** new_ptrs, int num_ptrs);
+void rizz__log_set_async(bool async);
+void rizz__log_flush(void);
 
 typedef struct mem_trace_context mem_trace_context;
 bool rizz__mem_init(uint32_t opts);
@@ -50,6 +54,13 @@ void rizz__mem_disable_trace(sx_alloc* alloc);
 void rizz__mem_enable_trace_view(sx_alloc* alloc);
 void rizz__mem_disable_trace_view(sx_alloc* alloc);
 void rizz__mem_set_view_name(sx_alloc* alloc, const char* name);
+void rizz__mem_end_frame(void);
+rizz_mem_frame_stats rizz__mem_frame_stats(const sx_alloc* alloc);
+void rizz__mem_steady_state_begin(const char* tag, int warmup_frames);
+void rizz__mem_steady_state_end(void);
+void rizz__mem_log_frame_stats(void);
+void rizz__mem_set_sample_interval(uint32_t interval);
+bool rizz__mem_sample_dump(const char* filepath, rizz_mem_sample_format format);
 
 bool rizz__profile_init(const sx_alloc* alloc);
 void rizz__profile_release(void);
@@ -57,6 +68,11 @@ rizz_profile_capture rizz__profile_capture_create(const char* filename);
 void rizz__profile_capture_end(rizz_profile_capture cid);
 void rizz__profile_capture_sample_begin(rizz_profile_capture cid, const char* name, const char* file, uint32_t line);
 void rizz__profile_capture_sample_end(rizz_profile_capture cid);
+void rizz__profile_history_init(int history_secs, float spike_threshold_ms);
+void rizz__profile_history_begin(const char* name);
+void rizz__profile_history_end(void);
+void rizz__profile_history_frame(int64_t frame_idx, uint64_t frame_tick);
+bool rizz__profile_history_dump(const char* name);
 
 // windows.h
 bool rizz__win_get_vstudio_dir(char* vspath, size_t vspath_size);
@@ -76,6 +92,7 @@ bool rizz__win_get_vstudio_dir(char* vspath, size_t vspath_size);
 #define rizz__coro_yield()                 the__core.coro_yield(&__transfer.from, 1)
 #define rizz__coro_yieldn(_n)              the__core.coro_yield(&__transfer.from, (_n))
 #define rizz__coro_invoke(_name, _user)    the__core.coro_invoke(coro__##_name, (_user))
+#define rizz__coro_invoke_job(_name, _user) the__core.coro_invoke_job(coro__##_name, (_user))
 
 #define rizz__with_temp_alloc(_name) sx_with(const sx_alloc* _name = the__core.tmp_alloc_push(), \
                                              the__core.tmp_alloc_pop()) 
@@ -118,9 +135,11 @@ void rizz__gfx_trace_reset_frame_stats(rizz_gfx_perframe_trace_zone zone);
 void rizz__gfx_execute_command_buffers_final(void);
 void rizz__gfx_update(void);
 void rizz__gfx_commit_gpu(void);
+void rizz__gfx_trace_end_frame(int64_t frame_idx);
 
 bool rizz__http_init(void);
 void rizz__http_release(void);
+void rizz__http_poll(void);
 void rizz__http_update(void);
 
 typedef struct sg_desc sg_desc;
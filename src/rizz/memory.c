@@ -9,6 +9,9 @@
 #include "sx/io.h"
 #include "sx/hash.h"
 #include "sx/atomic.h"
+#include "sx/lockless.h"
+#include "sx/rng.h"
+#include "sx/math-scalar.h"
 
 #include "rizz/imgui.h"
 #include "rizz/imgui-extra.h"
@@ -27,12 +30,24 @@ char* rizz__demangle(const char* symbol);   // demangle.cpp
 #endif
 #include "stackwalkerc/stackwalkerc.h"
 
+#include <stdio.h>   // fopen (/proc/self/maps)
 #include <stdlib.h>  // malloc,free,realloc,qsort
 #include <float.h>
+#include <math.h>    // expm1
 #include <string.h>  // strcmp
 
+#define MEM_STEADY_STATE_MAX_DEPTH 8
+#define MEM_ITEM_TABLE_NUM_SHARDS 16      // power of 2
+#define MEM_ITEM_TABLE_INIT_CAPACITY 64   // power of 2
+#define MEM_SAMPLE_DEFAULT_INTERVAL 524288 // 512kb
+#define MEM_CAPTURE_BLOCK_SIZE 65536      // 64kb
+#define MEM_CAPTURE_SIGN sx_makefourcc('R', 'M', 'E', 'M')
+#define MEM_CAPTURE_VERSION 2
+
 #define mem_trace_context_mutex_enter(opts, mtx) if (opts&RIZZ_MEMOPTION_MULTITHREAD) sx_mutex_enter(&mtx)
 #define mem_trace_context_mutex_exit(opts, mtx)  if (opts&RIZZ_MEMOPTION_MULTITHREAD) sx_mutex_exit(&mtx)
+#define mem_item_table_lock_enter(opts, lock)    if (opts&RIZZ_MEMOPTION_MULTITHREAD) sx_lock_enter(&lock)
+#define mem_item_table_lock_exit(opts, lock)     if (opts&RIZZ_MEMOPTION_MULTITHREAD) sx_lock_exit(&lock)
 
 #if SX_PLATFORM_OSX || SX_PLATFORM_LINUX
 #   if SX_PLATFORM_LINUX
@@ -43,6 +58,14 @@ char* rizz__demangle(const char* symbol);   // demangle.cpp
 #   include <dlfcn.h>
 #endif
 
+// first frames of the captured callstacks are the allocation callbacks of the tracer itself
+// stackwalker already skips them on capture (see sw_set_callstack_limits), backtrace doesn't
+#if SX_PLATFORM_WINDOWS
+#   define MEM_CALLSTACK_SKIP_FRAMES 0
+#else
+#   define MEM_CALLSTACK_SKIP_FRAMES 3
+#endif
+
 // feature-list:
 // callstack
 // leaks
@@ -81,7 +104,7 @@ typedef struct mem_item
     struct mem_item*    next;
     struct mem_item*    prev;
     int64_t             frame;         // record frame number
-    bool                freed;         // for mallocs, reallocs that got freed, but we want to keep the record
+    float               sample_weight; // number of allocations that this item represents (1 if not sampled)
 } mem_item;
 
 typedef struct mem_item_index
@@ -107,16 +130,17 @@ typedef enum mem_item_collapsed_id
     MEMITEM_COLLAPSED_COUNT
 } mem_item_collapsed_id;
 
-typedef struct mem__write_json_context {
-    sx_file file;
-    const char* newline;
-    const char* tab;
-
-    int _depth;
-    bool _is_struct_array;
-    char _tabs[128];
-    int _array_count;
-} mem__write_json_context;
+// open-addressing (linear probing) table of live items, indexed by pointer
+// each trace context has MEM_ITEM_TABLE_NUM_SHARDS of these, so threads that free/realloc 
+// different pointers rarely contend on the same lock
+typedef struct mem_item_table_shard
+{
+    sx_lock_t  lock;
+    int        count;
+    int        capacity;
+    uintptr_t* keys;     // 0 = empty slot
+    mem_item** items;
+} mem_item_table_shard;
 
 typedef struct mem_trace_context
 {
@@ -133,27 +157,202 @@ typedef struct mem_trace_context
     sx_atomic_uint64 peak_size;
     sx_pool*  item_pool;    // item_size = sizeof(mem_item)
     mem_item* items_list;   // first node
-    sx_mutex  mtx;
+    sx_mutex  mtx;          // protects `items_list`, `item_pool` and `cached`
+    mem_item_table_shard item_table[MEM_ITEM_TABLE_NUM_SHARDS];   // live (not freed) items
     mem_item_collapsed* SX_ARRAY cached;     // keep sorted cached data 
 
+    // RIZZ_MEMOPTION_COUNT_FRAME_ALLOCS: counters are accumulated during the frame, and moved to 
+    // `last_frame` in `rizz__mem_end_frame`
+    sx_atomic_uint32 frame_num_allocs;
+    sx_atomic_uint32 frame_num_frees;
+    sx_atomic_uint64 frame_alloc_size;
+    rizz_mem_frame_stats last_frame;
+
     struct mem_trace_context* parent;
     struct mem_trace_context* child;
     struct mem_trace_context* next;
     struct mem_trace_context* prev;
 } mem_trace_context;
 
+// Memory capture stream (.rmem), all values are little-endian:
+//      header: mem_capture_header
+//      records: each record starts with a `mem_capture_record_type` byte
+//          CONTEXT:        mem_capture_context_record
+//          CALLSTACK:      mem_capture_callstack_record, followed by `num_frames` of:
+//                          mem_capture_callstack_frame + file string + func string (not null-terminated)
+//          MALLOC/FREE/REALLOC: mem_capture_event_record
+//                          each thread records into it's own blocks, so events of different threads are
+//                          interleaved in the file. `seq` is the global order of the events
+//          CONTEXT_STATS:  mem_capture_context_stats_record
+//          END:            mem_capture_end_record
+// Callstacks are interned, each one is written once, before the first event that references it.
+// Use scripts/profile-tools/mem-capture-to-json.py to convert captures to json
+typedef enum mem_capture_record_type
+{
+    MEM_CAPTURE_RECORD_CONTEXT = 1,
+    MEM_CAPTURE_RECORD_CALLSTACK,
+    MEM_CAPTURE_RECORD_MALLOC,
+    MEM_CAPTURE_RECORD_FREE,
+    MEM_CAPTURE_RECORD_REALLOC,
+    MEM_CAPTURE_RECORD_CONTEXT_STATS,
+    MEM_CAPTURE_RECORD_END
+} mem_capture_record_type;
+
+typedef struct mem_capture_header
+{
+    uint32_t sign;          // MEM_CAPTURE_SIGN
+    uint32_t version;       // MEM_CAPTURE_VERSION
+    int64_t  time;          // time_t of the start of the capture
+    int64_t  start_frame;
+    char     name[32];
+} mem_capture_header;
+
+typedef struct mem_capture_context_record
+{
+    uint8_t  type;
+    uint8_t  _reserved[3];
+    uint32_t id;            // mem_trace_context.name_hash
+    uint32_t parent_id;     // =0 for root
+    char     name[32];
+} mem_capture_context_record;
+
+typedef struct mem_capture_event_record
+{
+    uint8_t  type;
+    uint8_t  _reserved[3];
+    uint32_t ctx_id;
+    uint32_t callstack_id;  // =0 if there is no callstack (frees)
+    uint32_t _reserved2;
+    uint64_t time_us;       // since the start of the capture
+    uint64_t seq;           // frees are sequenced before the pointer is released, mallocs after it's returned
+    uint64_t free_seq;      // reallocs only: sequence of releasing `old_ptr`
+    uint64_t ptr;           // for frees, this is the freed pointer
+    uint64_t old_ptr;       // reallocs only
+    uint64_t size;
+    int64_t  frame;
+} mem_capture_event_record;
+
+typedef struct mem_capture_context_stats_record
+{
+    uint8_t  type;
+    uint8_t  _reserved[3];
+    uint32_t id;
+    uint32_t num_items;
+    uint32_t _reserved2;
+    uint64_t alloc_size;
+    uint64_t peak_size;
+} mem_capture_context_stats_record;
+
+typedef struct mem_capture_end_record
+{
+    uint8_t  type;
+    uint8_t  _reserved[3];
+    uint32_t num_events;
+    double   duration;
+} mem_capture_end_record;
+
+typedef struct mem_capture_callstack_record
+{
+    uint8_t  type;
+    uint8_t  _reserved;
+    uint16_t num_frames;
+    uint32_t id;
+} mem_capture_callstack_record;
+
+typedef struct mem_capture_callstack_frame
+{
+    uint32_t line;
+    uint16_t file_len;
+    uint16_t func_len;
+} mem_capture_callstack_frame;
+
+// in-memory version of callstack record, symbols are resolved by the writer thread
+typedef struct mem_capture_callstack_raw_record
+{
+    mem_capture_callstack_record r;
+    union {
+        void*           callstack[SW_MAX_FRAMES];
+
+        struct {
+            char        source_file[128];
+            char        source_func[32];
+            uint32_t    source_line;
+        };
+    };
+} mem_capture_callstack_raw_record;
+
+typedef struct mem_capture_block
+{
+    int     size;
+    uint8_t data[MEM_CAPTURE_BLOCK_SIZE];
+} mem_capture_block;
+
+// each allocating thread appends records to it's own block without taking the capture mutex
+// `lock` is only contended when the capture ends and flushes the partial blocks of all threads
+typedef struct mem_capture_thread
+{
+    sx_lock_t lock;
+    uint32_t capture_id;                        // block and callstacks belong to this capture
+    uint32_t num_events;
+    mem_capture_block* block;
+    sx_hashtbl* callstack_tbl;                  // key: callstack_hash, callstacks written by this thread
+    struct mem_capture_thread* next;
+} mem_capture_thread;
+
+// full blocks are handed to the writer thread which resolves the callstacks and streams them to 
+// disk, so capturing doesn't stall the frame 
 typedef struct mem_capture_context
 {
     char name[32];
     uint64_t start_tm; 
-    sx_mutex mtx;
-    mem_item** SX_ARRAY items; 
+    uint32_t id;
+    sx_atomic_uint64 seq;
+    sx_mutex mtx;       // protects everything below
+    sx_sem writer_sem;
+    sx_thread* writer_thrd;
+    sx_file file;
+    bool quit;
+    mem_capture_thread* threads;                // all threads that ever recorded, never removed
+    mem_capture_block** SX_ARRAY full_blocks;   // waiting for writer thread
+    mem_capture_block** SX_ARRAY free_blocks;
 } mem_capture_context;
 
+// RIZZ_MEMOPTION_SAMPLE_ALLOCS: un-biased estimates of all allocations made from a callsite
+typedef struct mem_sample_site
+{
+    uint32_t  callstack_hash;
+    uint16_t  num_callstack_items;
+    void*     callstack[SW_MAX_FRAMES];
+    double    alloc_count;
+    double    alloc_size;
+    double    inuse_count;
+    double    inuse_size;
+} mem_sample_site;
+
+typedef struct mem_sample_tls
+{
+    bool    init;
+    sx_rng  rng;
+    int64_t bytes_until_sample;
+} mem_sample_tls;
+
+typedef struct mem_steady_state_scope
+{
+    const char* tag;
+    bool armed;     // warmup frames are passed, allocations are reported
+} mem_steady_state_scope;
+
+typedef struct mem_steady_state_tls
+{
+    mem_steady_state_scope scopes[MEM_STEADY_STATE_MAX_DEPTH];
+    int depth;
+} mem_steady_state_tls;
+
 typedef struct mem_state
 {
     #if SX_PLATFORM_WINDOWS
         sw_context* sw;
+        sx_mutex sw_mtx;
     #endif
 
     const sx_alloc* alloc;
@@ -161,6 +360,15 @@ typedef struct mem_state
     mem_trace_context* root;
     mem_capture_context capture;
     sx_atomic_uint32 in_capture;
+    sx_mutex steady_state_mtx;
+    sx_hashtbl* steady_state_tags;      // key: hash of tag, value: first frame the tag is seen
+
+    // sampling (RIZZ_MEMOPTION_SAMPLE_ALLOCS)
+    uint32_t sample_interval;
+    uint64_t sample_start_tm;
+    sx_mutex sample_mtx;
+    mem_sample_site* SX_ARRAY sample_sites;
+    sx_hashtbl* sample_site_tbl;        // key: callstack_hash, value: index to `sample_sites`
 } mem_state;
 
 typedef struct mem_imgui_state
@@ -175,6 +383,21 @@ typedef struct mem_imgui_state
 
 static mem_state g_mem;
 static mem_imgui_state g_mem_imgui;
+static _Thread_local mem_steady_state_tls tl_mem_steady_state;
+static _Thread_local mem_sample_tls tl_mem_sample;
+static _Thread_local mem_capture_thread* tl_mem_capture;
+
+#if SX_PLATFORM_WINDOWS
+// dbghelp is single-threaded, and symbols are resolved by both main and memory capture writer threads
+static uint16_t mem_resolve_callstack(void* callstack[], sw_callstack_entry* entries, uint16_t num_entries)
+{
+    uint16_t r = 0;
+    sx_mutex_lock(g_mem.sw_mtx) {
+        r = sw_resolve_callstack(g_mem.sw, callstack, entries, num_entries);
+    }
+    return r;
+}
+#endif
 
 static void mem_callstack_load_module(const char* img, const char* module, uint64_t base_addr, uint32_t size, void* userptr)
 {
@@ -186,6 +409,187 @@ static void mem_callstack_load_module(const char* img, const char* module, uint6
     rizz__log_debug("(init) module: %s (size=%$d)", module, size);
 }
 
+static mem_capture_block* mem_capture_new_block(void)
+{
+    mem_capture_block* block = NULL;
+    sx_mutex_lock(g_mem.capture.mtx) {
+        if (sx_array_count(g_mem.capture.free_blocks) > 0) {
+            block = sx_array_last(g_mem.capture.free_blocks);
+            sx_array_pop_last(g_mem.capture.free_blocks);
+        }
+    }
+
+    if (!block) {
+        block = sx_malloc(g_mem.alloc, sizeof(mem_capture_block));
+        if (!block) {
+            sx_memory_fail();
+            return NULL;
+        }
+    }
+    block->size = 0;
+    return block;
+}
+
+static void mem_capture_submit_block(mem_capture_block* block)
+{
+    sx_mutex_lock(g_mem.capture.mtx) {
+        sx_array_push(g_mem.alloc, g_mem.capture.full_blocks, block);
+    }
+    sx_semaphore_post(&g_mem.capture.writer_sem, 1);
+}
+
+// appends a record to the block, full blocks are submitted to the writer thread and replaced
+static bool mem_capture_write(mem_capture_block** pblock, const void* data, int size)
+{
+    sx_assert(size <= MEM_CAPTURE_BLOCK_SIZE);
+    mem_capture_block* block = *pblock;
+    if (block->size + size > MEM_CAPTURE_BLOCK_SIZE) {
+        mem_capture_submit_block(block);
+        block = *pblock = mem_capture_new_block();
+        if (!block) {
+            return false;
+        }
+    }
+
+    sx_memcpy(block->data + block->size, data, size);
+    block->size += size;
+    return true;
+}
+
+// returns the calling thread's capture state with it's lock taken, or NULL if capture is ended
+static mem_capture_thread* mem_capture_thread_begin(void)
+{
+    mem_capture_thread* thrd = tl_mem_capture;
+    if (!thrd) {
+        thrd = sx_aligned_malloc(g_mem.alloc, sizeof(mem_capture_thread), SX_CACHE_LINE_SIZE);
+        if (!thrd) {
+            sx_memory_fail();
+            return NULL;
+        }
+        sx_memset(thrd, 0x0, sizeof(*thrd));
+        thrd->callstack_tbl = sx_hashtbl_create(g_mem.alloc, 1024);
+        if (!thrd->callstack_tbl) {
+            sx_aligned_free(g_mem.alloc, thrd, SX_CACHE_LINE_SIZE);
+            sx_memory_fail();
+            return NULL;
+        }
+
+        sx_mutex_lock(g_mem.capture.mtx) {
+            thrd->next = g_mem.capture.threads;
+            g_mem.capture.threads = thrd;
+        }
+        tl_mem_capture = thrd;
+    }
+
+    sx_lock_enter(&thrd->lock);
+    // check again inside the lock, end_capture may have already flushed this thread
+    if (!sx_atomic_load32_explicit(&g_mem.in_capture, SX_ATOMIC_MEMORYORDER_ACQUIRE)) {
+        sx_lock_exit(&thrd->lock);
+        return NULL;
+    }
+
+    if (thrd->capture_id != g_mem.capture.id) {
+        thrd->capture_id = g_mem.capture.id;
+        thrd->num_events = 0;
+        thrd->block = NULL;
+        sx_hashtbl_clear(thrd->callstack_tbl);
+    }
+
+    if (!thrd->block) {
+        thrd->block = mem_capture_new_block();
+        if (!thrd->block) {
+            sx_lock_exit(&thrd->lock);
+            return NULL;
+        }
+    }
+    return thrd;
+}
+
+static void mem_capture_thread_end(mem_capture_thread* thrd)
+{
+    sx_lock_exit(&thrd->lock);
+}
+
+static uint64_t mem_capture_next_seq(void)
+{
+    return sx_atomic_fetch_add64_explicit(&g_mem.capture.seq, 1, SX_ATOMIC_MEMORYORDER_RELAXED);
+}
+
+static void mem_capture_write_context(const mem_trace_context* ctx)
+{
+    mem_capture_context_record r = {
+        .type = MEM_CAPTURE_RECORD_CONTEXT,
+        .id = ctx->name_hash,
+        .parent_id = ctx->parent ? ctx->parent->name_hash : 0
+    };
+    sx_strcpy(r.name, sizeof(r.name), ctx->name);
+
+    mem_capture_thread* thrd = mem_capture_thread_begin();
+    if (thrd) {
+        mem_capture_write(&thrd->block, &r, sizeof(r));
+        mem_capture_thread_end(thrd);
+    }
+}
+
+// `seq` is taken by the caller, see mem_capture_event_record
+static void mem_capture_write_event(const mem_item* item, mem_action action, void* ptr, void* old_ptr,
+                                    uint64_t seq, uint64_t free_seq)
+{
+    mem_capture_record_type type;
+    switch (action) {
+    case MEM_ACTION_MALLOC:     type = MEM_CAPTURE_RECORD_MALLOC;   break;
+    case MEM_ACTION_FREE:       type = MEM_CAPTURE_RECORD_FREE;     break;
+    case MEM_ACTION_REALLOC:    type = MEM_CAPTURE_RECORD_REALLOC;  break;
+    default:                    sx_assert(0); return;
+    }
+
+    uint32_t callstack_id = action != MEM_ACTION_FREE ? item->callstack_hash : 0;
+    mem_capture_event_record r = {
+        .type = (uint8_t)type,
+        .ctx_id = item->owner->name_hash,
+        .callstack_id = callstack_id,
+        .time_us = sx_tm_us(sx_tm_since(g_mem.capture.start_tm)),
+        .seq = seq,
+        .free_seq = free_seq,
+        .ptr = (uint64_t)(uintptr_t)ptr,
+        .old_ptr = (uint64_t)(uintptr_t)old_ptr,
+        .size = item->size,
+        .frame = item->frame
+    };
+
+    mem_capture_thread* thrd = mem_capture_thread_begin();
+    if (!thrd) {
+        return;
+    }
+
+    // first time this thread sees the callstack, write the raw addresses (writer thread resolves them)
+    if (callstack_id && sx_hashtbl_find(thrd->callstack_tbl, callstack_id) == -1) {
+        mem_capture_callstack_raw_record cr = {
+            .r = {
+                .type = MEM_CAPTURE_RECORD_CALLSTACK,
+                .num_frames = item->num_callstack_items,
+                .id = callstack_id
+            }
+        };
+        if (item->num_callstack_items > 0) {
+            sx_memcpy(cr.callstack, item->callstack, sizeof(void*)*item->num_callstack_items);
+        } else {
+            sx_strcpy(cr.source_file, sizeof(cr.source_file), item->source_file);
+            sx_strcpy(cr.source_func, sizeof(cr.source_func), item->source_func);
+            cr.source_line = item->source_line;
+        }
+
+        if (mem_capture_write(&thrd->block, &cr, sizeof(cr))) {
+            sx_hashtbl_add_and_grow(thrd->callstack_tbl, callstack_id, 1, g_mem.alloc);
+        }
+    }
+
+    if (thrd->block && mem_capture_write(&thrd->block, &r, sizeof(r))) {
+        ++thrd->num_events;
+    }
+    mem_capture_thread_end(thrd);
+}
+
 static mem_trace_context* mem_find_trace_context(uint32_t name_hash, mem_trace_context* node)
 {
     if (node->name_hash == name_hash) {
@@ -268,22 +672,159 @@ static mem_trace_context* mem_create_trace_context(const char* name, uint32_t me
         sx_mutex_init(&ctx->mtx);
     }
 
+    if (sx_atomic_load32_explicit(&g_mem.in_capture, SX_ATOMIC_MEMORYORDER_ACQUIRE)) {
+        mem_capture_write_context(ctx);
+    }
+
     return ctx;
 }
 
-static mem_item* mem_find_occupied_item(mem_trace_context* ctx, void* ptr)
+SX_INLINE uint64_t mem_item_table_hash(void* ptr)
+{
+    return sx_hash_u64((uint64_t)(uintptr_t)ptr);
+}
+
+SX_INLINE mem_item_table_shard* mem_item_table_get_shard(mem_trace_context* ctx, uint64_t hash)
 {
-    mem_item* it = ctx->items_list;
-    while (it) {
-        if (it->ptr == ptr && !it->freed) {
-            return it;
+    // lower bits are used for slots, so pick the shard from upper bits
+    return &ctx->item_table[(hash >> 48) & (MEM_ITEM_TABLE_NUM_SHARDS - 1)];
+}
+
+static bool mem_item_table_grow(mem_item_table_shard* shard)
+{
+    int new_capacity = shard->capacity ? (shard->capacity << 1) : MEM_ITEM_TABLE_INIT_CAPACITY;
+    uint8_t* buff = sx_malloc(g_mem.alloc, (sizeof(uintptr_t) + sizeof(mem_item*)) * (size_t)new_capacity);
+    if (!buff) {
+        sx_memory_fail();
+        return false;
+    }
+
+    uintptr_t* keys = (uintptr_t*)buff;
+    mem_item** items = (mem_item**)(keys + new_capacity);
+    sx_memset(keys, 0x0, sizeof(uintptr_t) * (size_t)new_capacity);
+
+    uint64_t mask = (uint64_t)new_capacity - 1;
+    for (int i = 0; i < shard->capacity; i++) {
+        if (shard->keys[i]) {
+            uint64_t slot = mem_item_table_hash((void*)shard->keys[i]) & mask;
+            while (keys[slot]) {
+                slot = (slot + 1) & mask;
+            }
+            keys[slot] = shard->keys[i];
+            items[slot] = shard->items[i];
         }
-        it = it->next;
     }
 
-    return NULL;
+    // keys and items are allocated in a single block
+    sx_free(g_mem.alloc, shard->keys);
+    sx_atomic_fetch_add64_explicit(&g_mem.debug_mem_size, 
+                                   (int64_t)(new_capacity - shard->capacity)*(sizeof(uintptr_t) + sizeof(mem_item*)), 
+                                   SX_ATOMIC_MEMORYORDER_RELAXED);
+    shard->keys = keys;
+    shard->items = items;
+    shard->capacity = new_capacity;
+    return true;
+}
+
+// pointers are taken out of the table before they are released (see `mem_alloc_cb`), so an existing 
+// key means the pointer is already live in this context. the old entry is kept and false is returned
+static bool mem_item_table_add(mem_trace_context* ctx, mem_item* item)
+{
+    sx_assert(item->ptr);
+
+    uint64_t hash = mem_item_table_hash(item->ptr);
+    mem_item_table_shard* shard = mem_item_table_get_shard(ctx, hash);
+
+    mem_item_table_lock_enter(ctx->options, shard->lock);
+    // keep load factor under 0.5, linear probing degrades quickly above that
+    if ((shard->count + 1) * 2 > shard->capacity && !mem_item_table_grow(shard)) {
+        mem_item_table_lock_exit(ctx->options, shard->lock);
+        return false;
+    }
+
+    uint64_t mask = (uint64_t)shard->capacity - 1;
+    uint64_t slot = hash & mask;
+    while (shard->keys[slot] && shard->keys[slot] != (uintptr_t)item->ptr) {
+        slot = (slot + 1) & mask;
+    }
+    if (shard->keys[slot]) {
+        mem_item_table_lock_exit(ctx->options, shard->lock);
+        rizz__log_error("mem_trace '%s': pointer 0x%p is already allocated", ctx->name, item->ptr);
+        sx_assertf(0, "pointer is already in the item table");
+        return false;
+    }
+    ++shard->count;
+    shard->keys[slot] = (uintptr_t)item->ptr;
+    shard->items[slot] = item;
+    mem_item_table_lock_exit(ctx->options, shard->lock);
+    return true;
+}
+
+// finds the live item of `ptr` and removes it from the table
+static mem_item* mem_item_table_take(mem_trace_context* ctx, void* ptr)
+{
+    uint64_t hash = mem_item_table_hash(ptr);
+    mem_item_table_shard* shard = mem_item_table_get_shard(ctx, hash);
+    mem_item* item = NULL;
+
+    mem_item_table_lock_enter(ctx->options, shard->lock);
+    if (shard->count > 0) {
+        uint64_t mask = (uint64_t)shard->capacity - 1;
+        uint64_t slot = hash & mask;
+        while (shard->keys[slot] && shard->keys[slot] != (uintptr_t)ptr) {
+            slot = (slot + 1) & mask;
+        }
+
+        if (shard->keys[slot]) {
+            item = shard->items[slot];
+            --shard->count;
+
+            // backward-shift deletion: move up the following entries of the cluster, so we don't 
+            // need tombstones and lookups never get slower over time
+            uint64_t hole = slot;
+            uint64_t next = (slot + 1) & mask;
+            while (shard->keys[next]) {
+                uint64_t home = mem_item_table_hash((void*)shard->keys[next]) & mask;
+                if (((next - home) & mask) >= ((next - hole) & mask)) {
+                    shard->keys[hole] = shard->keys[next];
+                    shard->items[hole] = shard->items[next];
+                    hole = next;
+                }
+                next = (next + 1) & mask;
+            }
+            shard->keys[hole] = 0;
+            shard->items[hole] = NULL;
+        }
+    }
+    mem_item_table_lock_exit(ctx->options, shard->lock);
+
+    return item;
 }
 
+static void mem_item_table_clear(mem_trace_context* ctx)
+{
+    for (int i = 0; i < MEM_ITEM_TABLE_NUM_SHARDS; i++) {
+        mem_item_table_shard* shard = &ctx->item_table[i];
+        mem_item_table_lock_enter(ctx->options, shard->lock);
+        if (shard->capacity) {
+            sx_memset(shard->keys, 0x0, sizeof(uintptr_t) * (size_t)shard->capacity);
+        }
+        shard->count = 0;
+        mem_item_table_lock_exit(ctx->options, shard->lock);
+    }
+}
+
+static void mem_item_table_release(mem_trace_context* ctx)
+{
+    for (int i = 0; i < MEM_ITEM_TABLE_NUM_SHARDS; i++) {
+        mem_item_table_shard* shard = &ctx->item_table[i];
+        sx_free(g_mem.alloc, shard->keys);
+        sx_atomic_fetch_sub64_explicit(&g_mem.debug_mem_size, 
+                                       (int64_t)shard->capacity*(sizeof(uintptr_t) + sizeof(mem_item*)), 
+                                       SX_ATOMIC_MEMORYORDER_RELAXED);
+        sx_memset(shard, 0x0, sizeof(*shard));
+    }
+}
 
 static void mem_destroy_trace_item(mem_trace_context* ctx, mem_item* item)
 {
@@ -301,7 +842,6 @@ static void mem_destroy_trace_item(mem_trace_context* ctx, mem_item* item)
         ctx->items_list = item->next;
     }
     item->next = item->prev = NULL;
-    item->freed = false;
 
     sx_pool_del(ctx->item_pool, item);
 
@@ -309,14 +849,103 @@ static void mem_destroy_trace_item(mem_trace_context* ctx, mem_item* item)
     mem_trace_context_mutex_exit(ctx->options, ctx->mtx);
 }
 
-static void mem_create_trace_item(mem_trace_context* ctx, void* ptr, void* old_ptr, 
-                                  size_t size, const char* file, const char* func, uint32_t line)
+// estimated size/count, based on the item's sampling weight
+SX_INLINE uint64_t mem_item_est_size(const mem_item* item)
+{
+    return (uint64_t)((double)item->size * (double)item->sample_weight);
+}
+
+SX_INLINE uint32_t mem_item_est_count(const mem_item* item)
+{
+    return (uint32_t)(item->sample_weight + 0.5f);
+}
+
+// exponential distribution with the mean of `sample_interval`, so sampling points are a poisson 
+// process over allocated bytes (same as tcmalloc/jemalloc heap profilers)
+static int64_t mem_sample_next_interval(mem_sample_tls* tls)
+{
+    float u = (float)((sx_rng_gen(&tls->rng) >> 8) + 1) * (1.0f / 16777216.0f);    // (0, 1]
+    return (int64_t)(-sx_log(u) * (float)g_mem.sample_interval) + 1;
+}
+
+// returns true if the allocation should be recorded, `weight` is the inverse of the probability 
+// that an allocation with this size gets sampled
+static bool mem_sample_allocation(size_t size, float* weight)
+{
+    mem_sample_tls* tls = &tl_mem_sample;
+    if (!tls->init) {
+        sx_rng_seed(&tls->rng, sx_thread_tid() ^ (uint32_t)sx_tm_now());
+        tls->bytes_until_sample = mem_sample_next_interval(tls);
+        tls->init = true;
+    }
+
+    tls->bytes_until_sample -= (int64_t)size;
+    if (tls->bytes_until_sample > 0) {
+        return false;
+    }
+
+    tls->bytes_until_sample = mem_sample_next_interval(tls);
+    // p = 1 - exp(-size/interval), expm1 keeps the precision for allocations much smaller than interval
+    double p = -expm1(-(double)size / (double)g_mem.sample_interval);
+    *weight = p > 0 ? (float)(1.0 / p) : 1.0f;
+    return true;
+}
+
+static void mem_sample_site_add(const mem_item* item)
+{
+    sx_mutex_lock(g_mem.sample_mtx) {
+        int index = sx_hashtbl_find(g_mem.sample_site_tbl, item->callstack_hash);
+        if (index == -1) {
+            mem_sample_site site = {
+                .callstack_hash = item->callstack_hash,
+                .num_callstack_items = item->num_callstack_items
+            };
+            sx_memcpy(site.callstack, item->callstack, sizeof(void*)*item->num_callstack_items);
+            sx_array_push(g_mem.alloc, g_mem.sample_sites, site);
+            sx_hashtbl_add_and_grow(g_mem.sample_site_tbl, item->callstack_hash, 
+                                    sx_array_count(g_mem.sample_sites) - 1, g_mem.alloc);
+            index = sx_array_count(g_mem.sample_sites) - 1;
+        } else {
+            index = sx_hashtbl_get(g_mem.sample_site_tbl, index);
+        }
+
+        mem_sample_site* site = &g_mem.sample_sites[index];
+        site->alloc_count += (double)item->sample_weight;
+        site->alloc_size += (double)item->size * (double)item->sample_weight;
+        site->inuse_count += (double)item->sample_weight;
+        site->inuse_size += (double)item->size * (double)item->sample_weight;
+    }
+}
+
+static void mem_sample_site_remove(const mem_item* item)
+{
+    sx_mutex_lock(g_mem.sample_mtx) {
+        int index = sx_hashtbl_find(g_mem.sample_site_tbl, item->callstack_hash);
+        if (index != -1) {
+            mem_sample_site* site = &g_mem.sample_sites[sx_hashtbl_get(g_mem.sample_site_tbl, index)];
+            site->inuse_count = sx_max(0.0, site->inuse_count - (double)item->sample_weight);
+            site->inuse_size = sx_max(0.0, site->inuse_size - (double)item->size * (double)item->sample_weight);
+        }
+    }
+}
+
+// `old_item`: item of `old_ptr` that is taken out of the table before `old_ptr` is released
+// `free_seq`: capture sequence that is taken before `old_ptr` is released, =UINT64_MAX if not capturing
+static void mem_create_trace_item(mem_trace_context* ctx, void* ptr, void* old_ptr, mem_item* old_item,
+                                  size_t size, const char* file, const char* func, uint32_t line,
+                                  uint64_t free_seq)
 {
     mem_item item = {0};
     if (old_ptr) {
         item.action = (size == 0) ? MEM_ACTION_FREE : MEM_ACTION_REALLOC;
     }
     bool save_current_call = item.action != MEM_ACTION_FREE;
+    bool sampled = (ctx->options & RIZZ_MEMOPTION_SAMPLE_ALLOCS) ? true : false;
+
+    item.sample_weight = 1.0f;
+    if (save_current_call && sampled) {
+        save_current_call = mem_sample_allocation(size, &item.sample_weight);
+    }
 
     if (save_current_call) {
         sx_atomic_fetch_add64_explicit(&g_mem.debug_mem_size, sizeof(mem_item), SX_ATOMIC_MEMORYORDER_RELAXED);
@@ -354,46 +983,50 @@ static void mem_create_trace_item(mem_trace_context* ctx, void* ptr, void* old_p
     item.ptr = ptr;
     item.frame = the__core.frame_index();
     bool in_capture = sx_atomic_load32_explicit(&g_mem.in_capture, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    if (in_capture && old_ptr && free_seq == UINT64_MAX) {
+        free_seq = mem_capture_next_seq();    // capture began during the call
+    }
 
     // special case: FREE and REALLOC, always have previous malloc trace items that we should take care of
     if (item.action == MEM_ACTION_FREE || item.action == MEM_ACTION_REALLOC) {
-        mem_trace_context_mutex_enter(ctx->options, ctx->mtx);
-        mem_item* old_item = mem_find_occupied_item(ctx, old_ptr);
-        mem_trace_context_mutex_exit(ctx->options, ctx->mtx);
-
         // old_ptr should be either malloc or realloc and belong to this mem_trace_context
-        sx_assert(old_item && old_item->action == MEM_ACTION_MALLOC || old_item->action == MEM_ACTION_REALLOC);
+        // in sampling mode, most of the pointers are not recorded
+        sx_assert(sampled || (old_item && (old_item->action == MEM_ACTION_MALLOC || old_item->action == MEM_ACTION_REALLOC)));
         if (old_item) {
             sx_assert(old_item->size > 0);
+            uint32_t est_count = mem_item_est_count(old_item);
+            uint64_t est_size = mem_item_est_size(old_item);
             mem_trace_context* _ctx = ctx;
             while (_ctx) {
-                sx_atomic_fetch_sub32_explicit(&_ctx->num_items, 1, SX_ATOMIC_MEMORYORDER_RELAXED);                
-                sx_atomic_fetch_sub64_explicit(&_ctx->alloc_size, old_item->size, SX_ATOMIC_MEMORYORDER_RELAXED);
+                sx_atomic_fetch_sub32_explicit(&_ctx->num_items, est_count, SX_ATOMIC_MEMORYORDER_RELAXED);                
+                sx_atomic_fetch_sub64_explicit(&_ctx->alloc_size, est_size, SX_ATOMIC_MEMORYORDER_RELAXED);
                 _ctx = _ctx->parent;
             }
 
+            if (sampled) {
+                mem_sample_site_remove(old_item);
+            }
+
             if (item.action == MEM_ACTION_FREE) {
                 item.size = old_item->size;
             }
 
-            if (!in_capture && item.action == MEM_ACTION_FREE) {
-                mem_destroy_trace_item(ctx, old_item);
-                old_item->freed = true;
-            } else if (in_capture) {
-                old_item->freed = true;
-                sx_mutex_lock(g_mem.capture.mtx) {
-                    sx_array_push(g_mem.alloc, g_mem.capture.items, old_item);
-                }
+            if (in_capture && item.action == MEM_ACTION_FREE) {
+                mem_capture_write_event(&item, MEM_ACTION_FREE, old_ptr, NULL, free_seq, 0);
             }
+
+            mem_destroy_trace_item(ctx, old_item);
         }
     } 
 
     // propogate memory usage to the context and it's parents
-    if (size > 0) {
+    if (size > 0 && save_current_call) {
+        uint32_t est_count = mem_item_est_count(&item);
+        uint64_t est_size = mem_item_est_size(&item);
         mem_trace_context* _ctx = ctx;
         while (_ctx) {
-            sx_atomic_fetch_add32_explicit(&_ctx->num_items, 1, SX_ATOMIC_MEMORYORDER_RELAXED);
-            sx_atomic_fetch_add64_explicit(&_ctx->alloc_size, (int64_t)size, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+            sx_atomic_fetch_add32_explicit(&_ctx->num_items, est_count, SX_ATOMIC_MEMORYORDER_RELAXED);
+            sx_atomic_fetch_add64_explicit(&_ctx->alloc_size, (int64_t)est_size, SX_ATOMIC_MEMORYORDER_ACQUIRE);
             
             unsigned long long cur_peak = _ctx->peak_size;
             while (cur_peak < ctx->alloc_size && 
@@ -424,10 +1057,18 @@ static void mem_create_trace_item(mem_trace_context* ctx, void* ptr, void* old_p
         sx_array_clear(ctx->cached);
         mem_trace_context_mutex_exit(ctx->options, ctx->mtx);
 
+        if (ptr) {
+            mem_item_table_add(ctx, new_item);
+        }
+
+        if (sampled) {
+            mem_sample_site_add(new_item);
+        }
+
         if (in_capture) {
-            sx_mutex_lock(g_mem.capture.mtx) {
-                sx_array_push(g_mem.alloc, g_mem.capture.items, new_item);
-            }
+            uint64_t seq = mem_capture_next_seq();
+            mem_capture_write_event(new_item, new_item->action, ptr, old_ptr, seq, 
+                                    new_item->action == MEM_ACTION_REALLOC ? free_seq : 0);
         }
     }
 }
@@ -471,6 +1112,7 @@ static void mem_destroy_trace_context(mem_trace_context* ctx)
         }
         
         sx_array_free(g_mem.alloc, ctx->cached);
+        mem_item_table_release(ctx);
         sx_pool_destroy(ctx->item_pool, g_mem.alloc);
         sx_free(g_mem.alloc, ctx);
     }
@@ -498,15 +1140,73 @@ static void mem_trace_context_clear(mem_trace_context* ctx)
     ctx->num_items = 0;
     ctx->alloc_size = 0;
     mem_trace_context_mutex_exit(ctx->options, ctx->mtx);
+
+    mem_item_table_clear(ctx);
+}
+
+static void mem_count_frame_alloc(mem_trace_context* ctx, void* old_ptr, size_t size)
+{
+    while (ctx) {
+        if (size > 0) {
+            sx_atomic_fetch_add32_explicit(&ctx->frame_num_allocs, 1, SX_ATOMIC_MEMORYORDER_RELAXED);
+            sx_atomic_fetch_add64_explicit(&ctx->frame_alloc_size, (int64_t)size, SX_ATOMIC_MEMORYORDER_RELAXED);
+        } else if (old_ptr) {
+            sx_atomic_fetch_add32_explicit(&ctx->frame_num_frees, 1, SX_ATOMIC_MEMORYORDER_RELAXED);
+        }
+        ctx = ctx->parent;
+    }
+}
+
+static void mem_check_steady_state(mem_trace_context* ctx, size_t size, const char* file, uint32_t line)
+{
+    mem_steady_state_tls* tls = &tl_mem_steady_state;
+    if (tls->depth == 0 || size == 0) {
+        return;
+    }
+
+    mem_steady_state_scope* scope = &tls->scopes[sx_min(tls->depth, MEM_STEADY_STATE_MAX_DEPTH) - 1];
+    if (scope->armed) {
+        // disarm before reporting, logging can allocate from trace allocators too
+        scope->armed = false;
+        rizz__log_error("steady-state '%s': allocated %$d from '%s' (%s:%u)", scope->tag, (int)size, 
+                        ctx->name, file ? file : "", line);
+        sx_assertf(0, "steady-state '%s' should not allocate", scope->tag);
+    }
 }
 
 static void* mem_alloc_cb(void* ptr, size_t size, uint32_t align, const char* file, const char* func, 
                           uint32_t line, void* user_data)
 {
     mem_trace_context* ctx = user_data;
+    bool traced = !ctx->disabled;
+
+    // frees must be sequenced and taken out of the item table before the pointer is released, 
+    // other threads can allocate the same address again
+    uint64_t free_seq = UINT64_MAX;
+    mem_item* old_item = NULL;
+    if (ptr && traced) {
+        if (sx_atomic_load32_explicit(&g_mem.in_capture, SX_ATOMIC_MEMORYORDER_ACQUIRE)) {
+            free_seq = mem_capture_next_seq();
+        }
+        old_item = mem_item_table_take(ctx, ptr);
+    }
+
     void* p = ctx->redirect_alloc.alloc_cb(ptr, size, align, file, func, line, user_data);
-    if (!ctx->disabled)
-        mem_create_trace_item(ctx, p, ptr, size, file, func, line);
+    if (ptr && size > 0 && !p) {
+        // failed realloc, `ptr` is still valid
+        if (old_item) {
+            mem_item_table_add(ctx, old_item);
+        }
+        return p;
+    }
+
+    // temp allocator tracers don't count frame allocations, so they are also skipped by steady-state
+    if (ctx->options & RIZZ_MEMOPTION_COUNT_FRAME_ALLOCS) {
+        mem_count_frame_alloc(ctx, ptr, size);
+        mem_check_steady_state(ctx, size, file, line);
+    }
+    if (traced)
+        mem_create_trace_item(ctx, p, ptr, old_item, size, file, func, line, free_seq);
     return p;
 }
 
@@ -521,6 +1221,7 @@ bool rizz__mem_init(uint32_t opts)
     g_mem.alloc = the__core.heap_alloc();
 
     #if SX_PLATFORM_WINDOWS
+        sx_mutex_init(&g_mem.sw_mtx);
         g_mem.sw = sw_create_context_capture(
             SW_OPTIONS_SYMBOL|SW_OPTIONS_SOURCEPOS|SW_OPTIONS_MODULEINFO|SW_OPTIONS_SYMBUILDPATH,
             (sw_callbacks) { .load_module = mem_callstack_load_module }, NULL);
@@ -562,6 +1263,15 @@ bool rizz__mem_init(uint32_t opts)
     }
 
     sx_mutex_init(&g_mem.capture.mtx);
+    sx_mutex_init(&g_mem.steady_state_mtx);
+    sx_mutex_init(&g_mem.sample_mtx);
+    g_mem.sample_interval = MEM_SAMPLE_DEFAULT_INTERVAL;
+    g_mem.sample_start_tm = sx_tm_now();
+    g_mem.sample_site_tbl = sx_hashtbl_create(g_mem.alloc, 256);
+    if (!g_mem.sample_site_tbl) {
+        sx_memory_fail();
+        return false;
+    }
 
     g_mem_imgui.collapse_items = true;
 
@@ -570,15 +1280,39 @@ bool rizz__mem_init(uint32_t opts)
 
 void rizz__mem_release(void)
 {
+    rizz__mem_end_capture();
+    sx_array_free(g_mem.alloc, g_mem.capture.full_blocks);
+    sx_array_free(g_mem.alloc, g_mem.capture.free_blocks);
+    mem_capture_thread* thrd = g_mem.capture.threads;
+    while (thrd) {
+        mem_capture_thread* next = thrd->next;
+        sx_hashtbl_destroy(thrd->callstack_tbl, g_mem.alloc);
+        sx_aligned_free(g_mem.alloc, thrd, SX_CACHE_LINE_SIZE);
+        thrd = next;
+    }
+    g_mem.capture.threads = NULL;
+
     #if SX_PLATFORM_WINDOWS
         sw_destroy_context(g_mem.sw);
+        sx_mutex_release(&g_mem.sw_mtx);
     #endif
 
     if (g_mem.root) {
         mem_destroy_trace_context(g_mem.root);
     }
 
+    if (g_mem.steady_state_tags) {
+        sx_hashtbl_destroy(g_mem.steady_state_tags, g_mem.alloc);
+    }
+
+    sx_array_free(g_mem.alloc, g_mem.sample_sites);
+    if (g_mem.sample_site_tbl) {
+        sx_hashtbl_destroy(g_mem.sample_site_tbl, g_mem.alloc);
+    }
+
     sx_mutex_release(&g_mem.capture.mtx);
+    sx_mutex_release(&g_mem.steady_state_mtx);
+    sx_mutex_release(&g_mem.sample_mtx);
 }
 
 sx_alloc* rizz__mem_create_allocator(const char* name, uint32_t mem_opts, const char* parent, const sx_alloc* alloc)
@@ -652,6 +1386,11 @@ static void mem_imgui_context_info(rizz_api_imgui* imgui, rizz_api_imgui_extra*
                               progress_size, size_text, peak_text);
 
     imguix->label("Allocations", "%u", ctx->num_items);
+    if (ctx->options & RIZZ_MEMOPTION_COUNT_FRAME_ALLOCS) {
+        imguix->label("Frame allocations", "%u (peak: %u)", ctx->last_frame.num_allocs, 
+                      ctx->last_frame.peak_num_allocs);
+        imguix->label("Frame alloc size", "%$.2llu", ctx->last_frame.alloc_size);
+    }
     {
         int num_pool_pages = 0;
         sx__pool_page* page = ctx->item_pool->pages;
@@ -665,7 +1404,7 @@ static void mem_imgui_context_info(rizz_api_imgui* imgui, rizz_api_imgui_extra*
     #if SX_PLATFORM_WINDOWS
         void* symbols[SW_MAX_FRAMES] = {(void*)ctx->redirect_alloc.alloc_cb};
         sw_callstack_entry entries[SW_MAX_FRAMES];
-        if (sw_resolve_callstack(g_mem.sw, symbols, entries, 1)) {
+        if (mem_resolve_callstack(symbols, entries, 1)) {
             imgui->TextColored(*imgui->GetStyleColorVec4(ImGuiCol_TextDisabled), "Allocator:");
             imgui->Indent(0);
             imgui->Text(entries[0].name);
@@ -869,7 +1608,7 @@ static mem_item_collapsed* mem_imgui_context_get_collapsed_items(mem_trace_conte
 
                     if (item->num_callstack_items > 0) {    
                         #if SX_PLATFORM_WINDOWS
-                            uint16_t n = sw_resolve_callstack(g_mem.sw, item->callstack, callstack_entries, 
+                            uint16_t n = mem_resolve_callstack(item->callstack, callstack_entries, 
                                                             sx_min((uint16_t)2, item->num_callstack_items));
                             sx_strcpy(citem.entry_symbol, sizeof(citem.entry_symbol), 
                                     callstack_entries[n > 1 ? 1 : 0].und_name);
@@ -1055,7 +1794,7 @@ static void mem_imgui_item(rizz_api_imgui* imgui, rizz_api_imgui_extra* imguix,
     if (item->num_callstack_items) {
         #if SX_PLATFORM_WINDOWS
             sw_callstack_entry entries[SW_MAX_FRAMES];
-            uint16_t resolved = sw_resolve_callstack(g_mem.sw, item->callstack, entries, item->num_callstack_items);
+            uint16_t resolved = mem_resolve_callstack(item->callstack, entries, item->num_callstack_items);
             for (uint16_t i = 0; i < resolved; i++) {
                 imgui->Bullet();
                 sx_snprintf(text, sizeof(text), "%s(%u): %s", entries[i].line_filename, entries[i].line, entries[i].name);
@@ -1070,7 +1809,7 @@ static void mem_imgui_item(rizz_api_imgui* imgui, rizz_api_imgui_extra* imguix,
         #elif SX_PLATFORM_OSX || SX_PLATFORM_LINUX
             Dl_info syminfo;
             char filename[32];
-            for (uint16_t i = 3; i < item->num_callstack_items; i++) {
+            for (uint16_t i = MEM_CALLSTACK_SKIP_FRAMES; i < item->num_callstack_items; i++) {
                 dladdr(item->callstack[i], &syminfo);
                 if (syminfo.dli_sname == NULL)
                     syminfo.dli_sname = "NA";
@@ -1182,16 +1921,6 @@ void rizz__mem_reload_modules(void)
     #endif
 }
 
-void rizz__mem_begin_capture(const char* name)
-{
-    sx_assertf(!g_mem.in_capture, "should end_capture before beginning a new one");
-
-    sx_strcpy(g_mem.capture.name, sizeof(g_mem.capture.name), name);
-    sx_array_clear(g_mem.capture.items);
-    g_mem.capture.start_tm = sx_tm_now();
-    sx_atomic_store32_explicit(&g_mem.in_capture, 1, SX_ATOMIC_MEMORYORDER_RELEASE);
-}
-
 SX_INLINE void mem__writef(sx_file* file, const char* fmt, ...)
 {
     char str[1024];
@@ -1203,135 +1932,222 @@ SX_INLINE void mem__writef(sx_file* file, const char* fmt, ...)
     sx_file_write(file, str, sx_strlen(str));
 }
 
-static const char* mem__serialize_json_update_tabs(mem__write_json_context* jctx)
+// output files are written to `.memory` directory next to the executable
+static void mem__make_output_path(char* filepath, int filepath_size, const char* name, const char* ext)
 {
-    if (jctx->tab[0]) {
-        sx_strcpy(jctx->_tabs, sizeof(jctx->_tabs), jctx->tab);
-        for (int i = 0; i < jctx->_depth; i++) {
-            sx_strcat(jctx->_tabs, sizeof(jctx->_tabs), jctx->tab);
-        }
-    } else {
-        jctx->_tabs[0] = '\0';
+    filepath[0] = '\0';
+    #if !SX_PLATFORM_ANDROID && !SX_PLATFORM_IOS
+        sx_os_path_exepath(filepath, filepath_size);
+    #endif
+    sx_os_path_dirname(filepath, filepath_size, filepath);
+    sx_os_path_join(filepath, filepath_size, filepath, ".memory");
+    if (!sx_os_path_isdir(filepath)) {
+        sx_os_mkdir(filepath);
     }
-
-    return jctx->_tabs;
+    sx_os_path_join(filepath, filepath_size, filepath, name);
+    sx_strcat(filepath, filepath_size, ext);
 }
 
-static void mem__serialize_callstack_item(mem__write_json_context* jctx, 
-                                          const char* file, uint32_t line, const char* func,
-                                          bool last_item)
+static void mem__capture_write_frame(sx_mem_writer* writer, uint32_t line, const char* file, const char* func)
 {
-
-    mem__writef(&jctx->file, "%s{%s", jctx->_tabs, jctx->newline);
-    ++jctx->_depth;
-    mem__serialize_json_update_tabs(jctx);
-
-    // convert paths to unix format, so we won't need to have escape chars
-    char file_unix[RIZZ_MAX_PATH];
-    sx_os_path_unixpath(file_unix, sizeof(file_unix), file);
-    mem__writef(&jctx->file, "%s\"file\": \"%s\",%s", jctx->_tabs, file_unix, jctx->newline);
-    mem__writef(&jctx->file, "%s\"line\": %u,%s", jctx->_tabs, line, jctx->newline);
-    mem__writef(&jctx->file, "%s\"func\": \"%s\"%s", jctx->_tabs, func, jctx->newline);
-
-    --jctx->_depth;
-    mem__serialize_json_update_tabs(jctx);
-
-    mem__writef(&jctx->file, "%s}%s%s", jctx->_tabs, !last_item ? "," : "", jctx->newline);
+    mem_capture_callstack_frame f = { 
+        .line = line, 
+        .file_len = (uint16_t)sx_strlen(file), 
+        .func_len = (uint16_t)sx_strlen(func) 
+    };
+    sx_mem_write_var(writer, f);
+    sx_mem_write(writer, file, f.file_len);
+    sx_mem_write(writer, func, f.func_len);
 }
 
-static void mem__serialize_item(mem__write_json_context* jctx, mem_item* item)
+static void mem__capture_resolve_callstack(sx_mem_writer* writer, const mem_capture_callstack_raw_record* cr)
 {
-    const char* action = "";
-    switch (item->action) {
-        case MEM_ACTION_MALLOC:  action = "Malloc";  break;
-        case MEM_ACTION_FREE:    action = "Free";    break;
-        case MEM_ACTION_REALLOC: action = "Realloc"; break;
+    mem_capture_callstack_record r = cr->r;
+    if (r.num_frames == 0) {
+        r.num_frames = 1;
+        sx_mem_write_var(writer, r);
+        mem__capture_write_frame(writer, cr->source_line, cr->source_file, cr->source_func);
+        return;
     }
 
-    mem__writef(&jctx->file, "%s\"ptr\": \"0x%p\",%s", jctx->_tabs, item->ptr, jctx->newline);
-    mem__writef(&jctx->file, "%s\"size\": %llu,%s", jctx->_tabs, item->size, jctx->newline);
-    mem__writef(&jctx->file, "%s\"action\": \"%s\",%s", jctx->_tabs, action, jctx->newline);
-    mem__writef(&jctx->file, "%s\"callstack\": [%s", jctx->_tabs, jctx->newline);
-    ++jctx->_depth;
-    mem__serialize_json_update_tabs(jctx);
+    #if SX_PLATFORM_WINDOWS
+        sw_callstack_entry entries[SW_MAX_FRAMES];
+        r.num_frames = mem_resolve_callstack((void**)cr->callstack, entries, r.num_frames);
+        sx_mem_write_var(writer, r);
+        for (uint16_t i = 0; i < r.num_frames; i++) {
+            char file_unix[RIZZ_MAX_PATH];
+            sx_os_path_unixpath(file_unix, sizeof(file_unix), entries[i].line_filename);
+            mem__capture_write_frame(writer, entries[i].line, file_unix, entries[i].und_name);
+        }
+    #elif SX_PLATFORM_OSX || SX_PLATFORM_LINUX
+        // first three frames are the allocation callbacks of the tracer itself
+        int first = r.num_frames > 3 ? 3 : 0;
+        r.num_frames -= (uint16_t)first;
+        sx_mem_write_var(writer, r);
+        for (int i = first; i < (int)cr->r.num_frames; i++) {
+            Dl_info syminfo;
+            if (!dladdr(cr->callstack[i], &syminfo)) {
+                sx_memset(&syminfo, 0x0, sizeof(syminfo));
+            }
+            const char* module = syminfo.dli_fname ? syminfo.dli_fname : "";
 
-    if (item->num_callstack_items != 0) {
-        #if SX_PLATFORM_WINDOWS
-            sw_callstack_entry entries[SW_MAX_FRAMES];
-            uint16_t num_resolved = sw_resolve_callstack(g_mem.sw, item->callstack, entries, item->num_callstack_items);
-            if (num_resolved) {
-                for (int i = 0; i < num_resolved; i++) {
-                    mem__serialize_callstack_item(jctx, entries[i].line_filename, entries[i].line, 
-                                                  entries[i].und_name, i == num_resolved - 1);
+            if (syminfo.dli_sname) {
+                char* demangled = rizz__demangle(syminfo.dli_sname);
+                if (demangled) {
+                    char* paranthesis = (char*)sx_strchar(demangled, '(');
+                    if (paranthesis)
+                        *paranthesis = '\0';
                 }
-            } 
-        #endif
-    } else {
-        mem__serialize_callstack_item(jctx, item->source_file, item->source_line, item->source_func, true);
-    }
+                mem__capture_write_frame(writer, 0, module, demangled ? demangled : syminfo.dli_sname);
+                free(demangled);
+            } else {
+                char addr[32];
+                sx_snprintf(addr, sizeof(addr), "0x%p", cr->callstack[i]);
+                mem__capture_write_frame(writer, 0, module, addr);
+            }
+        }
+    #else
+        r.num_frames = 0;
+        sx_mem_write_var(writer, r);
+    #endif
+}
+
+// converts in-memory records of the block to file records, only callstack records are different
+static void mem__capture_process_block(sx_mem_writer* writer, const mem_capture_block* block)
+{
+    int offset = 0;
+    while (offset < block->size) {
+        const uint8_t* data = block->data + offset;
+        int size = 0;
+        switch ((mem_capture_record_type)data[0]) {
+        case MEM_CAPTURE_RECORD_CONTEXT:        size = sizeof(mem_capture_context_record);          break;
+        case MEM_CAPTURE_RECORD_MALLOC:
+        case MEM_CAPTURE_RECORD_FREE:
+        case MEM_CAPTURE_RECORD_REALLOC:        size = sizeof(mem_capture_event_record);            break;
+        case MEM_CAPTURE_RECORD_CONTEXT_STATS:  size = sizeof(mem_capture_context_stats_record);    break;
+        case MEM_CAPTURE_RECORD_END:            size = sizeof(mem_capture_end_record);              break;
+        case MEM_CAPTURE_RECORD_CALLSTACK: {
+            mem_capture_callstack_raw_record cr;
+            sx_memcpy(&cr, data, sizeof(cr));
+            mem__capture_resolve_callstack(writer, &cr);
+            offset += sizeof(cr);
+            continue;
+        }
+        default:
+            sx_assertf(0, "invalid memory capture record");
+            return;
+        }
 
-    --jctx->_depth;
-    mem__serialize_json_update_tabs(jctx);
-    mem__writef(&jctx->file, "%s]%s", jctx->_tabs, jctx->newline);
+        sx_mem_write(writer, data, size);
+        offset += size;
+    }
 }
 
-static void mem__serialize_context(mem__write_json_context* jctx, mem_trace_context* mctx)
+static int mem__capture_writer_thread(void* user1, void* user2)
 {
-    mem__writef(&jctx->file, "%s{%s", jctx->_tabs, jctx->newline);
+    sx_unused(user1);
+    sx_unused(user2);
 
-    ++jctx->_depth;
-    mem__serialize_json_update_tabs(jctx);
+    mem_capture_block** SX_ARRAY blocks = NULL;
+    sx_mem_writer writer;
+    sx_mem_init_writer(&writer, g_mem.alloc, MEM_CAPTURE_BLOCK_SIZE*2);
 
-    mem__writef(&jctx->file, "%s\"name\": \"%s\",%s", jctx->_tabs, mctx->name, jctx->newline);
-    mem__writef(&jctx->file, "%s\"num_items\": %d,%s", jctx->_tabs, mctx->num_items, jctx->newline);
-    mem__writef(&jctx->file, "%s\"alloc_size\": %llu,%s", jctx->_tabs, mctx->alloc_size, jctx->newline);
-    mem__writef(&jctx->file, "%s\"peak_size\": %llu,%s", jctx->_tabs, mctx->peak_size, jctx->newline);
+    bool quit = false;
+    while (!quit) {
+        sx_semaphore_wait(&g_mem.capture.writer_sem, -1);
 
-    mem__writef(&jctx->file, "%s\"items\": [%s", jctx->_tabs, jctx->newline);
-    ++jctx->_depth;
-    mem__serialize_json_update_tabs(jctx);       
-    bool first = true;
-    for (int i = 0, ic = sx_array_count(g_mem.capture.items); i < ic; i++) {
-        if (g_mem.capture.items[i]->owner == mctx) {
-            mem__writef(&jctx->file, "%s%s", jctx->_tabs, !first ? "," : "");
-            mem__writef(&jctx->file, "{%s", jctx->newline);
-            ++jctx->_depth;
-            mem__serialize_json_update_tabs(jctx);   
+        sx_mutex_lock(g_mem.capture.mtx) {
+            for (int i = 0, c = sx_array_count(g_mem.capture.full_blocks); i < c; i++) {
+                sx_array_push(g_mem.alloc, blocks, g_mem.capture.full_blocks[i]);
+            }
+            sx_array_clear(g_mem.capture.full_blocks);
+            quit = g_mem.capture.quit;
+        }
 
-            mem__serialize_item(jctx, g_mem.capture.items[i]);
+        for (int i = 0, c = sx_array_count(blocks); i < c; i++) {
+            sx_mem_seekw(&writer, 0, SX_WHENCE_BEGIN);
+            mem__capture_process_block(&writer, blocks[i]);
+            sx_file_write(&g_mem.capture.file, writer.data, writer.pos);
+        }
 
-            --jctx->_depth;
-            mem__serialize_json_update_tabs(jctx);
-            mem__writef(&jctx->file, "%s}%s", jctx->_tabs, jctx->newline);
-            first = false;
+        sx_mutex_lock(g_mem.capture.mtx) {
+            for (int i = 0, c = sx_array_count(blocks); i < c; i++) {
+                sx_array_push(g_mem.alloc, g_mem.capture.free_blocks, blocks[i]);
+            }
         }
+        sx_array_clear(blocks);
     }
-    --jctx->_depth;
-    mem__serialize_json_update_tabs(jctx);
-    mem__writef(&jctx->file, "%s]%s%s", jctx->_tabs, mctx->child ? "," : "", jctx->newline);
 
-    if (mctx->child) {
-        mem__writef(&jctx->file, "%s\"children\": [%s", jctx->_tabs, jctx->newline);
+    sx_array_free(g_mem.alloc, blocks);
+    sx_mem_release_writer(&writer);
+    return 0;
+}
 
-        ++jctx->_depth;
-        mem__serialize_json_update_tabs(jctx);    
+static void mem__capture_write_contexts(mem_trace_context* ctx)
+{
+    while (ctx) {
+        mem_capture_write_context(ctx);
+        mem__capture_write_contexts(ctx->child);
+        ctx = ctx->next;
+    }
+}
 
-        mem_trace_context* child = mctx->child;
-        while (child) {
-            mem__serialize_context(jctx, child);
-            child = child->next;
-        }
+static void mem__capture_write_context_stats(mem_capture_block** pblock, mem_trace_context* ctx)
+{
+    while (ctx && *pblock) {
+        mem_capture_context_stats_record r = {
+            .type = MEM_CAPTURE_RECORD_CONTEXT_STATS,
+            .id = ctx->name_hash,
+            .num_items = ctx->num_items,
+            .alloc_size = ctx->alloc_size,
+            .peak_size = ctx->peak_size
+        };
+        mem_capture_write(pblock, &r, sizeof(r));
+        mem__capture_write_context_stats(pblock, ctx->child);
+        ctx = ctx->next;
+    }
+}
 
-        --jctx->_depth;
-        mem__serialize_json_update_tabs(jctx);
+void rizz__mem_begin_capture(const char* name)
+{
+    sx_assertf(!g_mem.in_capture, "should end_capture before beginning a new one");
 
-        mem__writef(&jctx->file, "%s]%s", jctx->_tabs, jctx->newline);
+    char filepath[RIZZ_MAX_PATH];
+    mem__make_output_path(filepath, sizeof(filepath), name, ".rmem");
+    if (!sx_file_open(&g_mem.capture.file, filepath, SX_FILE_WRITE)) {
+        rizz__log_error("Could not open file '%s' for writing", filepath);
+        return;
     }
 
-    --jctx->_depth;
-    mem__serialize_json_update_tabs(jctx);
+    mem_capture_header header = {
+        .sign = MEM_CAPTURE_SIGN,
+        .version = MEM_CAPTURE_VERSION,
+        .time = (int64_t)time(NULL),
+        .start_frame = the__core.frame_index()
+    };
+    sx_strcpy(header.name, sizeof(header.name), name);
+    sx_file_write_var(&g_mem.capture.file, header);
+
+    sx_strcpy(g_mem.capture.name, sizeof(g_mem.capture.name), name);
+    g_mem.capture.start_tm = sx_tm_now();
+    g_mem.capture.quit = false;
+    ++g_mem.capture.id;
+    sx_atomic_store64_explicit(&g_mem.capture.seq, 0, SX_ATOMIC_MEMORYORDER_RELAXED);
+
+    sx_semaphore_init(&g_mem.capture.writer_sem);
+    g_mem.capture.writer_thrd = sx_thread_create(g_mem.alloc, mem__capture_writer_thread, NULL, 
+                                                 256*1024, "mem_capture_writer", NULL);
+    if (!g_mem.capture.writer_thrd) {
+        rizz__log_error("could not create memory capture writer thread");
+        sx_semaphore_release(&g_mem.capture.writer_sem);
+        sx_file_close(&g_mem.capture.file);
+        return;
+    }
 
-    mem__writef(&jctx->file, "%s}%s%s", jctx->_tabs, mctx->next ? "," : "", jctx->newline);
+    // contexts are written by this thread after the capture is started, so the contexts that are 
+    // created by other threads in the meantime are also recorded 
+    sx_atomic_store32_explicit(&g_mem.in_capture, 1, SX_ATOMIC_MEMORYORDER_RELEASE);
+    mem__capture_write_contexts(g_mem.root);
 }
 
 bool rizz__mem_end_capture(void)
@@ -1341,80 +2157,63 @@ bool rizz__mem_end_capture(void)
     }
 
     sx_atomic_store32_explicit(&g_mem.in_capture, 0, SX_ATOMIC_MEMORYORDER_RELEASE);
+    double duration = sx_tm_sec(sx_tm_since(g_mem.capture.start_tm));
 
-    mem__write_json_context jctx = {
-        .newline = "\n",
-        .tab = "  "
-    };
-
-    char filepath[RIZZ_MAX_PATH] = {0};
-    #if !SX_PLATFORM_ANDROID && !SX_PLATFORM_IOS
-        sx_os_path_exepath(filepath, sizeof(filepath));
-    #endif
-    sx_os_path_dirname(filepath, sizeof(filepath), filepath);
-    sx_os_path_join(filepath, sizeof(filepath), filepath, ".memory");
-    if (!sx_os_path_isdir(filepath)) {
-        sx_os_mkdir(filepath);
+    // flush partial blocks of all threads, after taking the lock of each thread, it won't record anymore
+    // the list is only prepended to, so we can walk it without holding the mutex
+    mem_capture_thread* threads = NULL;
+    sx_mutex_lock(g_mem.capture.mtx) {
+        threads = g_mem.capture.threads;
     }
-    sx_os_path_join(filepath, sizeof(filepath), filepath, g_mem.capture.name);
-    sx_strcat(filepath, sizeof(filepath), ".json");
 
-    if (!sx_file_open(&jctx.file, filepath, SX_FILE_WRITE)) {
-        rizz__log_error("Could not open file '%s' for writing", filepath);
-        return false;
+    uint32_t num_events = 0;
+    for (mem_capture_thread* thrd = threads; thrd; thrd = thrd->next) {
+        sx_lock_enter(&thrd->lock);
+        if (thrd->capture_id == g_mem.capture.id) {
+            if (thrd->block) {
+                mem_capture_submit_block(thrd->block);
+                thrd->block = NULL;
+            }
+            num_events += thrd->num_events;
+        }
+        sx_lock_exit(&thrd->lock);
     }
 
-    mem__writef(&jctx.file, "{%s", jctx.newline);
-    ++jctx._depth;
-    mem__serialize_json_update_tabs(&jctx);
+    // write final records and hand the last block to the writer thread
+    mem_capture_block* block = mem_capture_new_block();
+    if (block) {
+        mem__capture_write_context_stats(&block, g_mem.root);
 
-    mem__writef(&jctx.file, "%s\"name\": \"%s\",%s", jctx._tabs, g_mem.capture.name, jctx.newline);
-    {
-        time_t t = time(NULL);
-        char time_str[64];
-        sx_strcpy(time_str, sizeof(time_str), asctime(localtime(&t)));
-        int len = sx_strlen(time_str);
-        if (time_str[len-1] == '\n')
-            time_str[len-1] = '\0';
-        mem__writef(&jctx.file, "%s\"time\": \"%s\",%s", jctx._tabs, time_str, jctx.newline);
+        mem_capture_end_record end = {
+            .type = MEM_CAPTURE_RECORD_END,
+            .num_events = num_events,
+            .duration = duration
+        };
+        if (block && mem_capture_write(&block, &end, sizeof(end))) {
+            mem_capture_submit_block(block);
+        }
     }
-    mem__writef(&jctx.file, "%s\"duration\": %f,%s", jctx._tabs, 
-        sx_tm_sec(sx_tm_diff(sx_tm_now(), g_mem.capture.start_tm)), jctx.newline);
-    mem__writef(&jctx.file, "%s\"total_in_capture\": %d,%s", jctx._tabs, 
-        sx_array_count(g_mem.capture.items), jctx.newline);
-
-    // serialize all contexts, but just populate them with the items in the capture
-    mem__writef(&jctx.file, "%s\"items\": [%s", jctx._tabs, jctx.newline);
 
-    ++jctx._depth;
-    mem__serialize_json_update_tabs(&jctx);
-
-    sx_assert(g_mem.root);
-    mem_trace_context* mctx = g_mem.root->child;
-    while (mctx) {
-        mem__serialize_context(&jctx, mctx);
-        mctx = mctx->next;
+    sx_mutex_lock(g_mem.capture.mtx) {
+        g_mem.capture.quit = true;
     }
+    sx_semaphore_post(&g_mem.capture.writer_sem, 1);
 
-    --jctx._depth;
-    mem__serialize_json_update_tabs(&jctx);
-    mem__writef(&jctx.file, "%s]%s", jctx._tabs, jctx.newline);
-
-    mem__writef(&jctx.file, "}%s", jctx.newline);
-    
-    sx_file_close(&jctx.file);
+    sx_thread_destroy(g_mem.capture.writer_thrd, g_mem.alloc);
+    sx_semaphore_release(&g_mem.capture.writer_sem);
+    g_mem.capture.writer_thrd = NULL;
+    sx_file_close(&g_mem.capture.file);
 
-    // remove all "freed" items
-    for (int i = 0, ic = sx_array_count(g_mem.capture.items); i < ic; i++) {
-        mem_item* item = g_mem.capture.items[i];
-        if (item->freed) {
-            mem_destroy_trace_item(item->owner, item);
-        }
+    sx_assert(sx_array_count(g_mem.capture.full_blocks) == 0);
+    for (int i = 0, c = sx_array_count(g_mem.capture.free_blocks); i < c; i++) {
+        sx_free(g_mem.alloc, g_mem.capture.free_blocks[i]);
     }
+    sx_array_clear(g_mem.capture.free_blocks);
 
+    rizz__log_info("memory capture '%s' (%u events, %.2fs) written", g_mem.capture.name, 
+                   num_events, duration);
     return true;
 }
-
 void rizz__mem_merge_peak(sx_alloc* alloc1, sx_alloc* alloc2) 
 {
     mem_trace_context* ctx1 = alloc1->user_data;
@@ -1453,4 +2252,255 @@ void rizz__mem_set_view_name(sx_alloc* alloc, const char* name)
 {
     mem_trace_context* ctx = alloc->user_data;
     sx_strcpy(ctx->name_view, sizeof(ctx->name_view), name);
-}
\ No newline at end of file
+}
+
+static void mem_end_frame_context(mem_trace_context* ctx)
+{
+    rizz_mem_frame_stats* stats = &ctx->last_frame;
+    stats->num_allocs = sx_atomic_exchange32_explicit(&ctx->frame_num_allocs, 0, SX_ATOMIC_MEMORYORDER_RELAXED);
+    stats->num_frees = sx_atomic_exchange32_explicit(&ctx->frame_num_frees, 0, SX_ATOMIC_MEMORYORDER_RELAXED);
+    stats->alloc_size = sx_atomic_exchange64_explicit(&ctx->frame_alloc_size, 0, SX_ATOMIC_MEMORYORDER_RELAXED);
+    stats->peak_num_allocs = sx_max(stats->peak_num_allocs, stats->num_allocs);
+
+    mem_trace_context* child = ctx->child;
+    while (child) {
+        mem_end_frame_context(child);
+        child = child->next;
+    }
+}
+
+void rizz__mem_end_frame(void)
+{
+    if (g_mem.root) {
+        mem_end_frame_context(g_mem.root);
+    }
+}
+
+rizz_mem_frame_stats rizz__mem_frame_stats(const sx_alloc* alloc)
+{
+    sx_assert(alloc && alloc->user_data);
+    const mem_trace_context* ctx = alloc->user_data;
+    return ctx->last_frame;
+}
+
+void rizz__mem_steady_state_begin(const char* tag, int warmup_frames)
+{
+    sx_assert(tag);
+
+    mem_steady_state_tls* tls = &tl_mem_steady_state;
+    sx_assertf(tls->depth < MEM_STEADY_STATE_MAX_DEPTH, "too many nested steady-state scopes");
+    if (tls->depth >= MEM_STEADY_STATE_MAX_DEPTH) {
+        ++tls->depth;
+        return;
+    }
+
+    int64_t frame = the__core.frame_index();
+    int64_t first_frame = frame;
+    uint32_t hash = sx_hash_fnv32_str(tag);
+
+    // disable the scope while registering the tag, because the table itself can grow
+    mem_steady_state_scope* scope = &tls->scopes[tls->depth++];
+    scope->tag = tag;
+    scope->armed = false;
+
+    sx_mutex_lock(g_mem.steady_state_mtx) {
+        if (!g_mem.steady_state_tags) {
+            g_mem.steady_state_tags = sx_hashtbl_create(g_mem.alloc, 32);
+            sx_assert_always(g_mem.steady_state_tags);
+        }
+        int index = sx_hashtbl_find(g_mem.steady_state_tags, hash);
+        if (index != -1) {
+            first_frame = (int64_t)sx_hashtbl_get(g_mem.steady_state_tags, index);
+        } else {
+            sx_hashtbl_add_and_grow(g_mem.steady_state_tags, hash, (int)frame, g_mem.alloc);
+        }
+    }
+
+    scope->armed = (frame - first_frame) >= (int64_t)warmup_frames;
+}
+
+void rizz__mem_steady_state_end(void)
+{
+    mem_steady_state_tls* tls = &tl_mem_steady_state;
+    sx_assertf(tls->depth > 0, "steady_state_end is called without begin");
+    if (tls->depth > 0) {
+        --tls->depth;
+    }
+}
+
+static void mem_log_frame_stats_context(const mem_trace_context* ctx, int depth)
+{
+    if (ctx->options & RIZZ_MEMOPTION_COUNT_FRAME_ALLOCS) {
+        rizz__log_info("%*s%s: allocs=%u, frees=%u, size=%$llu, peak_allocs=%u", depth*2, "", 
+                       ctx->name_view[0] ? ctx->name_view : ctx->name, ctx->last_frame.num_allocs, 
+                       ctx->last_frame.num_frees, ctx->last_frame.alloc_size, 
+                       ctx->last_frame.peak_num_allocs);
+    }
+
+    const mem_trace_context* child = ctx->child;
+    while (child) {
+        mem_log_frame_stats_context(child, depth + 1);
+        child = child->next;
+    }
+}
+
+// prints allocation counts of the previous frame for all trace contexts
+void rizz__mem_log_frame_stats(void)
+{
+    sx_assert(g_mem.root);
+    rizz__log_info("memory: frame #%lld allocations", the__core.frame_index() - 1);
+
+    const mem_trace_context* ctx = g_mem.root->child;
+    while (ctx) {
+        mem_log_frame_stats_context(ctx, 0);
+        ctx = ctx->next;
+    }
+}
+
+void rizz__mem_set_sample_interval(uint32_t interval)
+{
+    sx_assert(interval > 0);
+    g_mem.sample_interval = sx_max(interval, 1u);
+}
+
+// writes a collapsed stack line: "root;...;leaf value"
+static void mem__write_collapsed_site(sx_file* file, const mem_sample_site* site, uint64_t value)
+{
+    if (value == 0) {
+        return;
+    }
+
+    if (site->num_callstack_items <= MEM_CALLSTACK_SKIP_FRAMES) {
+        mem__writef(file, "[unknown]");
+    }
+
+    #if SX_PLATFORM_WINDOWS
+        sw_callstack_entry entries[SW_MAX_FRAMES];
+        uint16_t num_resolved = mem_resolve_callstack((void**)site->callstack, entries, site->num_callstack_items);
+        for (int i = (int)num_resolved - 1; i >= 0; i--) {
+            mem__writef(file, "%s%s", entries[i].und_name, i > 0 ? ";" : "");
+        }
+    #elif SX_PLATFORM_OSX || SX_PLATFORM_LINUX
+        for (int i = (int)site->num_callstack_items - 1; i >= MEM_CALLSTACK_SKIP_FRAMES; i--) {
+            Dl_info syminfo;
+            if (!dladdr(site->callstack[i], &syminfo) || syminfo.dli_sname == NULL) {
+                mem__writef(file, "0x%p%s", site->callstack[i], i > MEM_CALLSTACK_SKIP_FRAMES ? ";" : "");
+                continue;
+            }
+
+            char* demangled = rizz__demangle(syminfo.dli_sname);
+            if (demangled) {
+                char* paranthesis = (char*)sx_strchar(demangled, '(');
+                if (paranthesis)
+                    *paranthesis = '\0';
+            }
+            mem__writef(file, "%s%s", demangled ? demangled : syminfo.dli_sname, i > MEM_CALLSTACK_SKIP_FRAMES ? ";" : "");
+            free(demangled);
+        }
+    #endif
+
+    mem__writef(file, " %llu\n", value);
+}
+
+// legacy heap profile format, which is still supported by `pprof` (google/pprof), example:
+//      heap profile:   <inuse_count>: <inuse_size> [<alloc_count>: <alloc_size>] @ heapprofile
+//      <inuse_count>: <inuse_size> [<alloc_count>: <alloc_size>] @ 0x1 0x2 0x3 ...
+//      MAPPED_LIBRARIES:
+//      <contents of /proc/self/maps>
+// stats are already scaled, so we don't write the sampling period in the header (heap_v2/N)
+static void mem__write_pprof(sx_file* file, const mem_sample_site* sites, int num_sites)
+{
+    double inuse_count = 0, inuse_size = 0, alloc_count = 0, alloc_size = 0;
+    for (int i = 0; i < num_sites; i++) {
+        inuse_count += sites[i].inuse_count;
+        inuse_size += sites[i].inuse_size;
+        alloc_count += sites[i].alloc_count;
+        alloc_size += sites[i].alloc_size;
+    }
+
+    mem__writef(file, "heap profile: %llu: %llu [%llu: %llu] @ heapprofile\n", 
+                (uint64_t)inuse_count, (uint64_t)inuse_size, (uint64_t)alloc_count, (uint64_t)alloc_size);
+    for (int i = 0; i < num_sites; i++) {
+        const mem_sample_site* site = &sites[i];
+        mem__writef(file, "%llu: %llu [%llu: %llu] @", 
+                    (uint64_t)site->inuse_count, (uint64_t)site->inuse_size, 
+                    (uint64_t)site->alloc_count, (uint64_t)site->alloc_size);
+        for (int k = MEM_CALLSTACK_SKIP_FRAMES; k < site->num_callstack_items; k++) {
+            mem__writef(file, " 0x%llx", (uint64_t)(uintptr_t)site->callstack[k]);
+        }
+        mem__writef(file, "\n");
+    }
+
+    mem__writef(file, "\nMAPPED_LIBRARIES:\n");
+    #if SX_PLATFORM_LINUX
+        FILE* maps = fopen("/proc/self/maps", "rb");
+        if (maps) {
+            char buff[4096];
+            size_t r;
+            while ((r = fread(buff, 1, sizeof(buff), maps)) > 0) {
+                sx_file_write(file, buff, (int64_t)r);
+            }
+            fclose(maps);
+        }
+    #endif
+}
+
+bool rizz__mem_sample_dump(const char* filepath, rizz_mem_sample_format format)
+{
+    char default_filepath[RIZZ_MAX_PATH];
+    if (!filepath) {
+        char name[64];
+        sx_snprintf(name, sizeof(name), "heap_%lld", the__core.frame_index());
+        mem__make_output_path(default_filepath, sizeof(default_filepath), name, 
+                              format == RIZZ_MEM_SAMPLE_FORMAT_PPROF ? ".heap" : ".folded");
+        filepath = default_filepath;
+    }
+
+    // copy sites, so we don't hold the lock during symbol resolving and disk writes
+    mem_sample_site* sites = NULL;
+    int num_sites = 0;
+    sx_mutex_lock(g_mem.sample_mtx) {
+        num_sites = sx_array_count(g_mem.sample_sites);
+        if (num_sites > 0) {
+            sites = sx_malloc(g_mem.alloc, sizeof(mem_sample_site)*(size_t)num_sites);
+            if (sites) {
+                sx_memcpy(sites, g_mem.sample_sites, sizeof(mem_sample_site)*(size_t)num_sites);
+            }
+        }
+    }
+
+    if (num_sites > 0 && !sites) {
+        sx_memory_fail();
+        return false;
+    }
+
+    sx_file file;
+    if (!sx_file_open(&file, filepath, SX_FILE_WRITE)) {
+        rizz__log_error("Could not open file '%s' for writing", filepath);
+        sx_free(g_mem.alloc, sites);
+        return false;
+    }
+
+    switch (format) {
+    case RIZZ_MEM_SAMPLE_FORMAT_PPROF:
+        mem__write_pprof(&file, sites, num_sites);
+        break;
+    case RIZZ_MEM_SAMPLE_FORMAT_COLLAPSED_INUSE:
+        for (int i = 0; i < num_sites; i++) {
+            mem__write_collapsed_site(&file, &sites[i], (uint64_t)sites[i].inuse_size);
+        }
+        break;
+    case RIZZ_MEM_SAMPLE_FORMAT_COLLAPSED_ALLOC:
+        for (int i = 0; i < num_sites; i++) {
+            mem__write_collapsed_site(&file, &sites[i], (uint64_t)sites[i].alloc_size);
+        }
+        break;
+    }
+
+    sx_file_close(&file);
+    sx_free(g_mem.alloc, sites);
+
+    double elapsed = sx_tm_sec(sx_tm_since(g_mem.sample_start_tm));
+    rizz__log_info("memory samples (%d callsites, %.1fs) written to: %s", num_sites, elapsed, filepath);
+    return true;
+}
@@ -6,6 +6,7 @@
 #include "internal.h"
 
 #include "sx/array.h"
+#include "sx/atomic.h"
 #include "sx/os.h"
 #include "sx/string.h"
 
@@ -39,6 +40,7 @@ SX_PRAGMA_DIAGNOSTIC_POP()
 
 typedef rizz_plugin cr_plugin;
 #    define CR_OTHER RIZZ_PLUGIN_CRASH_OTHER
+#    define CR_FIXED_STEP RIZZ_PLUGIN_EVENT_FIXED_STEP
 #endif
 
 static void* g_native_apis[_RIZZ_API_COUNT] = { &the__core,  &the__plugin, &the__app,
@@ -71,8 +73,11 @@ struct rizz__plugin_item {
     int order;
     char filepath[RIZZ_MAX_PATH];
     float update_tm;
+    uint32_t profile_hash;
     rizz__plugin_dependency* deps;
     int num_deps;
+    uint64_t deps_mask;     // all dependencies (recursive), bits are positions in update order
+    bool step_on_job;       // RIZZ_PLUGIN_INFO_UPDATE_ON_JOB
 };
 
 struct rizz__plugin_mgr {
@@ -81,6 +86,9 @@ struct rizz__plugin_mgr {
     int* plugin_update_order = nullptr;    // indices to 'plugins' array
     char plugin_path[256] = { 0 };
     rizz__plugin_injected_api* injected = nullptr;
+    sx_atomic_uint64 steps_done;            // bits are positions in update order
+    float step_dt;
+    int num_job_plugins;
     #if SX_PLATFORM_WINDOWS && !defined(RIZZ_BUNDLE)
         HMODULE dbghelp;
     #endif
@@ -106,6 +114,7 @@ SX_PRAGMA_DIAGNOSTIC_POP();
 bool rizz__plugin_init(const sx_alloc* alloc, const char* plugin_path, bool hot_reload)
 {
     static_assert(RIZZ_PLUGIN_CRASH_OTHER == (rizz_plugin_crash)CR_OTHER, "crash enum mismatch");
+    static_assert(RIZZ_PLUGIN_EVENT_FIXED_STEP == (rizz_plugin_event)CR_FIXED_STEP, "event enum mismatch");
     sx_assert(alloc);
     g_plugin.alloc = alloc;
     g_plugin.hot_reload = hot_reload;
@@ -213,6 +222,44 @@ void rizz__plugin_release(void)
     sx_memset(&g_plugin, 0x0, sizeof(g_plugin));
 }
 
+// plugins with RIZZ_PLUGIN_INFO_UPDATE_ON_JOB run their step on job threads, after all of their
+// dependencies are done. so we need every plugin's dependencies, including the indirect ones
+static void rizz__plugin_resolve_step_deps()
+{
+    static_assert(RIZZ_CONFIG_MAX_PLUGINS <= 64, "deps_mask cannot hold RIZZ_CONFIG_MAX_PLUGINS");
+    int num_plugins = sx_array_count(g_plugin.plugin_update_order);
+    sx_assert_alwaysf(num_plugins <= RIZZ_CONFIG_MAX_PLUGINS, "too many plugins");
+
+    g_plugin.num_job_plugins = 0;
+    for (int i = 0; i < num_plugins; i++) {
+        rizz__plugin_item* item = &g_plugin.plugins[g_plugin.plugin_update_order[i]];
+
+        // dependencies always come before the plugin in update order
+        item->deps_mask = 0;
+        for (int d = 0; d < item->num_deps; d++) {
+            int k = 0;
+            for (; k < i; k++) {
+                const rizz__plugin_item* dep = &g_plugin.plugins[g_plugin.plugin_update_order[k]];
+                if (sx_strequal(dep->info.name, item->deps[d].name)) {
+                    item->deps_mask |= dep->deps_mask | (1ull << k);
+                    break;
+                }
+            }
+            sx_assertf(k < i, "plugin '%s' is updated before it's dependency '%s'", item->info.name,
+                       item->deps[d].name);
+        }
+
+        // cr's crash protection and reloads only work on the main thread
+        item->step_on_job = (item->info.flags & RIZZ_PLUGIN_INFO_UPDATE_ON_JOB) && !g_plugin.hot_reload;
+        if (item->step_on_job) {
+            ++g_plugin.num_job_plugins;
+        } else if (item->info.flags & RIZZ_PLUGIN_INFO_UPDATE_ON_JOB) {
+            rizz__log_debug("plugin '%s' is updated on main thread, because hot-reload is enabled",
+                            item->info.name);
+        }
+    }
+}
+
 static bool rizz__plugin_order_dependencies()
 {
     int num_plugins = sx_array_count(g_plugin.plugins);
@@ -282,6 +329,7 @@ static bool rizz__plugin_order_dependencies()
     // sort them by their order and load
     rizz__plugin_tim_sort(g_plugin.plugin_update_order, sx_array_count(g_plugin.plugin_update_order));
 
+    rizz__plugin_resolve_step_deps();
     return true;
 }
 
@@ -308,6 +356,20 @@ static bool rizz__plugin_load(const char* name)
     return rizz__plugin_load_abs(name, false, NULL, 0);
 }
 
+// plugins are statically linked in bundle builds, so there is nothing to open in parallel
+bool rizz__plugin_load_all(const char** names, int num_names)
+{
+    for (int i = 0; i < num_names; i++) {
+        rizz__profile_startup_begin(names[i]);
+        bool r = rizz__plugin_load(names[i]);
+        rizz__profile_startup_end();
+        if (!r) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool rizz__plugin_load_abs(const char* name, bool entry, const char** edeps, int enum_deps)
 {
     // find the plugin and save it's flags, the list is already populated
@@ -380,15 +442,23 @@ bool rizz__plugin_init_plugins()
     return true;
 }
 
-void rizz__plugin_update(float dt)
+static void rizz__plugin_step(rizz__plugin_item* item, float dt)
 {
     sx_unused(dt);
+    if (item->p._p == (void*)0x1) {
+        sx_assert(item->info.main_cb);
+        item->info.main_cb((rizz_plugin*)&item->p, RIZZ_PLUGIN_EVENT_STEP);
+    }
+}
+
+void rizz__plugin_fixed_step(void)
+{
     for (int i = 0, c = sx_array_count(g_plugin.plugin_update_order); i < c; i++) {
         int index = g_plugin.plugin_update_order[i];
         rizz__plugin_item* item = &g_plugin.plugins[index];
         if (item->p._p == (void*)0x1) {
             sx_assert(item->info.main_cb);
-            item->info.main_cb((rizz_plugin*)&item->p, RIZZ_PLUGIN_EVENT_STEP);
+            item->info.main_cb((rizz_plugin*)&item->p, RIZZ_PLUGIN_EVENT_FIXED_STEP);
         }
     }
 }
@@ -416,27 +486,33 @@ static void rizz__plugin_reload_handler(cr_plugin* plugin, const char* filename,
     rizz__core_fix_callback_ptrs(ptrs, new_ptrs, num_ptrs);
 }
 
-static bool rizz__plugin_load(const char* name)
+static void rizz__plugin_make_filepath(char* filepath, int size, const char* name)
 {
-    sx_assertf(!g_plugin.loaded, "cannot load anymore plugins after `init_plugins` is called");
-
     // construct full filepath, by joining to root plugin path and adding extension
-    char filepath[256];
     #if SX_PLATFORM_LINUX || SX_PLATFORM_OSX || SX_PLATFORM_RPI
-        sx_os_path_join(filepath, sizeof(filepath), g_plugin.plugin_path, "lib");
-        sx_strcat(filepath, sizeof(filepath), name);
+        sx_os_path_join(filepath, size, g_plugin.plugin_path, "lib");
+        sx_strcat(filepath, size, name);
     #else
-        sx_os_path_join(filepath, sizeof(filepath), g_plugin.plugin_path, name);
+        sx_os_path_join(filepath, size, g_plugin.plugin_path, name);
     #endif
-    sx_strcat(filepath, sizeof(filepath), SX_DLL_EXT);
+    sx_strcat(filepath, size, SX_DLL_EXT);
+}
+
+static bool rizz__plugin_load(const char* name)
+{
+    sx_assertf(!g_plugin.loaded, "cannot load anymore plugins after `init_plugins` is called");
+
+    char filepath[256];
+    rizz__plugin_make_filepath(filepath, sizeof(filepath), name);
     return rizz__plugin_load_abs(filepath, false, NULL, 0);
 }
 
-bool rizz__plugin_load_abs(const char* filepath, bool entry, const char** edeps, int enum_deps)
+// opens the plugin module, gets the info and resolves the entry points
+// doesn't touch the plugin manager or allocate memory, so it can be called from job threads
+static void* rizz__plugin_open(rizz__plugin_item* item, const char* filepath, bool entry)
 {
-    rizz__plugin_item item;
-    sx_memset(&item, 0x0, sizeof(item));
-    item.p.userdata = &the__plugin;
+    sx_memset(item, 0x0, sizeof(*item));
+    item->p.userdata = &the__plugin;
 
     // get info from the plugin
     // plugins must have rizz_plugin_get_info function, but it is not mandatory for game module
@@ -445,61 +521,143 @@ bool rizz__plugin_load_abs(const char* filepath, bool entry, const char** edeps,
         dll = sx_os_dlopen(filepath);
         if (!dll) {
             rizz__log_error("plugin load failed: %s: dlerr(%s)", filepath, sx_os_dlerr());
-            return false;
+            return NULL;
         }
 
         rizz_plugin_get_info_cb* get_info = (rizz_plugin_get_info_cb*)sx_os_dlsym(dll, "rizz_plugin_get_info");
         if (!get_info) {
             rizz__log_error("plugin missing rizz_plugin_get_info symbol: %s", filepath);
-            return false;
+            sx_os_dlclose(dll);
+            return NULL;
         }
 
-        get_info(&item.info);
+        get_info(&item->info);
     } else {
         dll = rizz__app_get_game_module();
-        sx_strcpy(item.info.name, sizeof(item.info.name), the__app.name());
+        sx_strcpy(item->info.name, sizeof(item->info.name), the__app.name());
     }
 
-    sx_strcpy(item.filepath, sizeof(item.filepath), filepath);
+    sx_strcpy(item->filepath, sizeof(item->filepath), filepath);
+
+    if (!g_plugin.hot_reload) {
+        item->obj.dll = dll;
+        item->obj.main = (rizz_plugin_main_cb*)sx_os_dlsym(dll, "rizz_plugin_main");
+        item->obj.event_handler = (rizz_plugin_event_handler_cb*)sx_os_dlsym(dll, "rizz_plugin_event_handler");
+    }
+
+    return dll;
+}
+
+// adds the opened plugin to the manager, plugins must be added on main thread and in load order
+static bool rizz__plugin_add(rizz__plugin_item* item, void* dll, bool entry, const char** edeps, int enum_deps)
+{
+    if (!g_plugin.hot_reload && !item->obj.main) {
+        rizz__log_error("plugin missing rizz_plugin_main function: %s", item->filepath);
+        return false;
+    }
 
     // We got the info, the plugin seems to be valid
-    int num_deps = entry ? enum_deps : item.info.num_deps;
-    const char** deps = entry ? edeps : item.info.deps;
+    int num_deps = entry ? enum_deps : item->info.num_deps;
+    const char** deps = entry ? edeps : item->info.deps;
     if (num_deps > 0 && deps) {
-        item.deps = (rizz__plugin_dependency*)sx_malloc(g_plugin.alloc,
-                                                        sizeof(rizz__plugin_dependency) * num_deps);
-        if (!item.deps) {
+        item->deps = (rizz__plugin_dependency*)sx_malloc(g_plugin.alloc,
+                                                         sizeof(rizz__plugin_dependency) * num_deps);
+        if (!item->deps) {
             sx_out_of_memory();
             return false;
         }
-        item.num_deps = num_deps;
+        item->num_deps = num_deps;
         for (int i = 0; i < num_deps; i++) {
-            sx_strcpy(item.deps[i].name, sizeof(item.deps[i].name), deps[i]);
+            sx_strcpy(item->deps[i].name, sizeof(item->deps[i].name), deps[i]);
         }
     }
 
-    item.order = -1;
+    item->order = -1;
 
-    if (!g_plugin.hot_reload) {
-        item.obj.dll = dll;
-        item.obj.main = (rizz_plugin_main_cb*)sx_os_dlsym(dll, "rizz_plugin_main");
-        item.obj.event_handler = (rizz_plugin_event_handler_cb*)sx_os_dlsym(dll, "rizz_plugin_event_handler");
-        if (!item.obj.main) {
-            rizz__log_error("plugin missing rizz_plugin_main function: %s", filepath);
-            sx_free(g_plugin.alloc, item.deps);
-            return false;
-        }
-    } else {
+    if (g_plugin.hot_reload) {
         // handle everything on the CR side
         sx_os_dlclose(dll);
     }
 
-    sx_array_push(g_plugin.alloc, g_plugin.plugins, item);
+    sx_array_push(g_plugin.alloc, g_plugin.plugins, *item);
     sx_array_push(g_plugin.alloc, g_plugin.plugin_update_order, sx_array_count(g_plugin.plugins) - 1);
 
     return true;
 }
 
+bool rizz__plugin_load_abs(const char* filepath, bool entry, const char** edeps, int enum_deps)
+{
+    rizz__plugin_item item;
+    void* dll = rizz__plugin_open(&item, filepath, entry);
+    if (!dll) {
+        return false;
+    }
+
+    return rizz__plugin_add(&item, dll, entry, edeps, enum_deps);
+}
+
+typedef struct rizz__plugin_open_data {
+    rizz__plugin_item item;
+    void* dll;
+    const char* name;
+    char filepath[256];
+} rizz__plugin_open_data;
+
+static void rizz__plugin_open_job_cb(int start, int end, int thrd_index, void* user)
+{
+    sx_unused(thrd_index);
+
+    rizz__plugin_open_data* data = (rizz__plugin_open_data*)user;
+    for (int i = start; i < end; i++) {
+        rizz__profile_startup_begin(data[i].name);
+        data[i].dll = rizz__plugin_open(&data[i].item, data[i].filepath, false);
+        rizz__profile_startup_end();
+    }
+}
+
+// loading is split into two phases:
+//  - open: dlopen, symbol lookup and get_info of all plugins, on job threads
+//  - add: dependency copy and registration, on main thread in the same order as `names`
+// plugins are initialized later in dependency order by `rizz__plugin_init_plugins`
+bool rizz__plugin_load_all(const char** names, int num_names)
+{
+    sx_assertf(!g_plugin.loaded, "cannot load anymore plugins after `init_plugins` is called");
+    if (num_names == 0) {
+        return true;
+    }
+
+    rizz__plugin_open_data* data = (rizz__plugin_open_data*)sx_malloc(g_plugin.alloc, sizeof(rizz__plugin_open_data) * num_names);
+    if (!data) {
+        sx_out_of_memory();
+        return false;
+    }
+
+    for (int i = 0; i < num_names; i++) {
+        data[i].dll = NULL;
+        data[i].name = names[i];
+        rizz__plugin_make_filepath(data[i].filepath, sizeof(data[i].filepath), names[i]);
+    }
+
+    rizz__profile_startup_begin("plugins_open");
+    sx_job_t job = the__core.job_dispatch(num_names, rizz__plugin_open_job_cb, data, SX_JOB_PRIORITY_HIGH, 0);
+    the__core.job_wait_and_del(job);
+    rizz__profile_startup_end();
+
+    rizz__profile_startup_begin("plugins_add");
+    bool r = true;
+    for (int i = 0; i < num_names; i++) {
+        if (r) {
+            r = data[i].dll && rizz__plugin_add(&data[i].item, data[i].dll, false, NULL, 0);
+        } else if (data[i].dll) {
+            sx_os_dlclose(data[i].dll);
+        }
+    }
+    rizz__profile_startup_end();
+
+    sx_free(g_plugin.alloc, data);
+    return r;
+}
+
 bool rizz__plugin_init_plugins(void)
 {
     if (!rizz__plugin_order_dependencies())
@@ -547,47 +705,66 @@ bool rizz__plugin_init_plugins(void)
     return true;
 }
 
-void rizz__plugin_update(float dt)
+static void rizz__plugin_step(rizz__plugin_item* plugin, float dt)
 {
-    for (int i = 0, c = sx_array_count(g_plugin.plugin_update_order); i < c; i++) {
-        rizz__plugin_item* plugin = &g_plugin.plugins[g_plugin.plugin_update_order[i]];
-        bool check_reload = false;
-        plugin->update_tm += dt;
-        if (plugin->update_tm >= RIZZ_CONFIG_PLUGIN_UPDATE_INTERVAL) {
-            check_reload = true;
-            plugin->update_tm = 0;
-        }
+    bool check_reload = false;
+    plugin->update_tm += dt;
+    if (plugin->update_tm >= RIZZ_CONFIG_PLUGIN_UPDATE_INTERVAL) {
+        check_reload = true;
+        plugin->update_tm = 0;
+    }
 
-        if (i == c - 1) {
-            static uint32_t game_name_cache = 0;
-            const char* name = plugin->info.name[0] ? plugin->info.name : "Game";
-            the__core.begin_profile_sample(name, 0, &game_name_cache);
+    // each plugin gets it's own sample, last one is the game
+    the__core.begin_profile_sample(plugin->info.name[0] ? plugin->info.name : "Game", 0,
+                                   &plugin->profile_hash);
+
+    if (!g_plugin.hot_reload) {
+        rizz_plugin p = {};
+        p._p = plugin->obj.dll;
+        p.api = &the__plugin;
+        int r = plugin->obj.main(&p, RIZZ_PLUGIN_EVENT_STEP);
+        if (r < -1) {
+            rizz__log_error("something went wrong with plugin '%s' (update ret code=%d)", plugin->info.name, r);
+        }
+    } else {
+        // plugin's format strings must stay valid until it's log entries are dispatched
+        bool reload = check_reload && cr_plugin_changed(plugin->p);
+        if (reload)
+            rizz__log_set_async(false);
+        int r = cr_plugin_update(plugin->p, check_reload);
+        if (reload)
+            rizz__log_set_async(true);
+        if (r == -2) {
+            rizz__log_error("plugin '%s' failed to reload", plugin->info.name);
+        } else if (r < -1) {
+            if (plugin->p.failure == CR_USER) {
+                rizz__log_error("plugin '%s' failed (main ret = -1)", plugin->info.name);
+            } else {
+                rizz__log_error("plugin '%s' crashed", plugin->info.name);
+            }
         }
-        
+    }
+
+    the__core.end_profile_sample();
+}
+
+void rizz__plugin_fixed_step(void)
+{
+    for (int i = 0, c = sx_array_count(g_plugin.plugin_update_order); i < c; i++) {
+        rizz__plugin_item* plugin = &g_plugin.plugins[g_plugin.plugin_update_order[i]];
+        int r;
         if (!g_plugin.hot_reload) {
             rizz_plugin p = {};
             p._p = plugin->obj.dll;
             p.api = &the__plugin;
-            int r = plugin->obj.main(&p, RIZZ_PLUGIN_EVENT_STEP);
-            if (r < -1) {
-                rizz__log_error("something went wrong with plugin '%s' (update ret code=%d)", plugin->info.name, r);
-            }
+            r = plugin->obj.main(&p, RIZZ_PLUGIN_EVENT_FIXED_STEP);
         } else {
-            int r = cr_plugin_update(plugin->p, check_reload);
-            if (r == -2) {
-                rizz__log_error("plugin '%s' failed to reload", g_plugin.plugins[i].info.name);
-            } else if (r < -1) {
-                if (plugin->p.failure == CR_USER) {
-                    rizz__log_error("plugin '%s' failed (main ret = -1)",
-                        g_plugin.plugins[i].info.name);
-                } else {
-                    rizz__log_error("plugin '%s' crashed", g_plugin.plugins[i].info.name);
-                }
-            }
+            // reloads and crash recovery are left to the regular update (cr_plugin_update)
+            r = cr_plugin_call(plugin->p, CR_FIXED_STEP);
         }
 
-        if (i == c - 1) {
-            the__core.end_profile_sample();
+        if (r < -1) {
+            rizz__log_error("something went wrong with plugin '%s' (fixed step ret code=%d)", plugin->info.name, r);
         }
     }
 }
@@ -608,6 +785,82 @@ void rizz__plugin_broadcast_event(const rizz_app_event* e)
 }
 #endif    // RIZZ_BUNDLE
 
+static void rizz__plugin_step_job_cb(int start, int end, int thrd_index, void* user)
+{
+    sx_unused(start);
+    sx_unused(end);
+    sx_unused(thrd_index);
+
+    int pos = (int)(intptr_t)user;
+    rizz__plugin_step(&g_plugin.plugins[g_plugin.plugin_update_order[pos]], g_plugin.step_dt);
+    sx_atomic_fetch_or64(&g_plugin.steps_done, 1ull << pos);
+}
+
+// plugins are stepped in update order on the main thread. plugins with RIZZ_PLUGIN_INFO_UPDATE_ON_JOB
+// are dispatched to job threads as soon as their dependencies are done, so they run concurrently
+// with the plugins that they don't depend on. main thread plugins wait for their job dependencies
+void rizz__plugin_update(float dt)
+{
+    int num_plugins = sx_array_count(g_plugin.plugin_update_order);
+    if (g_plugin.num_job_plugins == 0) {
+        for (int i = 0; i < num_plugins; i++) {
+            rizz__plugin_step(&g_plugin.plugins[g_plugin.plugin_update_order[i]], dt);
+        }
+        return;
+    }
+
+    sx_job_t jobs[RIZZ_CONFIG_MAX_PLUGINS];
+    int first_job = 0;
+    int num_jobs = 0;
+    uint64_t dispatched = 0;
+    uint64_t all_done = num_plugins < 64 ? ((1ull << num_plugins) - 1) : ~0ull;
+    int next_main = 0;
+
+    g_plugin.step_dt = dt;
+    sx_atomic_store64(&g_plugin.steps_done, 0);
+
+    for (;;) {
+        uint64_t done = sx_atomic_load64(&g_plugin.steps_done);
+        if (done == all_done) {
+            break;
+        }
+
+        for (int i = 0; i < num_plugins; i++) {
+            const rizz__plugin_item* item = &g_plugin.plugins[g_plugin.plugin_update_order[i]];
+            if (item->step_on_job && !(dispatched & (1ull << i)) &&
+                (item->deps_mask & done) == item->deps_mask) {
+                jobs[num_jobs++] = the__core.job_dispatch(1, rizz__plugin_step_job_cb, (void*)(intptr_t)i,
+                                                          SX_JOB_PRIORITY_HIGH, 0);
+                dispatched |= 1ull << i;
+            }
+        }
+
+        while (next_main < num_plugins &&
+               g_plugin.plugins[g_plugin.plugin_update_order[next_main]].step_on_job) {
+            ++next_main;
+        }
+
+        if (next_main < num_plugins) {
+            rizz__plugin_item* item = &g_plugin.plugins[g_plugin.plugin_update_order[next_main]];
+            if ((item->deps_mask & done) == item->deps_mask) {
+                rizz__plugin_step(item, dt);
+                sx_atomic_fetch_or64(&g_plugin.steps_done, 1ull << next_main);
+                ++next_main;
+                continue;
+            }
+        }
+
+        // nothing to do on main thread, wait for the oldest job to finish
+        sx_assert(first_job < num_jobs);
+        the__core.job_wait_and_del(jobs[first_job++]);
+    }
+
+    // all plugins are done, but jobs may not be deleted yet
+    for (int i = first_job; i < num_jobs; i++) {
+        the__core.job_wait_and_del(jobs[i]);
+    }
+}
+
 void rizz__plugin_inject_api(const char* name, uint32_t version, void* api)
 {
     int api_idx = -1;
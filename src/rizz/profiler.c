@@ -9,6 +9,7 @@
 
 #include "sx/allocator.h"
 #include "sx/array.h"
+#include "sx/atomic.h"
 #include "sx/io.h"
 #include "sx/handle.h"
 #include "sx/macros.h"
@@ -16,27 +17,156 @@
 #include "sx/string.h"
 #include "sx/os.h"
 #include "sx/hash.h"
+#include "sx/timer.h"
 
-typedef struct profile_item {
+// Capture profiler records samples into per-thread blocks, so begin/end calls only touch memory
+// owned by the calling thread and never take a lock.
+// Each thread registers a buffer to the capture the first time it records into it (locked), and
+// caches the pointer in thread-local slots. Names and file names are interned to 32bit ids.
+// Full blocks are handed to the capture's writer thread, which encodes and streams them to the trace
+// file, so long captures don't pile up in memory or stall in profile_capture_end.
+// Any thread that records into a capture must be finished with it (job waited) before the capture
+// is ended
+//
+// Trace file (.profiler/<name>.rtrace) layout. integers are little-endian, varints are LEB128 and
+// signed varints are zigzag encoded:
+//      header: profile_trace_header
+//      records: each record starts with a `profile_trace_record_type` byte
+//          STRING: varint index, varint length, string (not null-terminated)
+//                  indexes start from 1 in the order of appearance, each string is written once
+//                  before the first block that references it
+//          BLOCK:  varint thread_id, varint num_events, signed varint base time (cycles since start_cycle)
+//                  followed by `num_events` of:
+//                      varint (name_index << 1 | end), signed varint cycles since the previous event
+//                      begin events only: varint file_index (=0 if no file), varint line
+//                  events of each thread are written in order, end events close the last open sample
+//          END:    profile_trace_end_record
+// Use scripts/profile-tools/profile-trace-convert.py to convert it to chrome json or perfetto trace
+#define PROFILE_MAX_DEPTH 64
+#define PROFILE_MAX_THREAD_CAPTURES 8
+#define PROFILE_STRING_CACHE_SIZE 256    // must be power-of-two
+#define PROFILE_TRACE_SIGN 0x43525452    // 'RTRC'
+#define PROFILE_TRACE_VERSION 1
+
+typedef enum profile_trace_record_type {
+    PROFILE_TRACE_RECORD_STRING = 1,
+    PROFILE_TRACE_RECORD_BLOCK,
+    PROFILE_TRACE_RECORD_END
+} profile_trace_record_type;
+
+typedef struct profile_trace_header {
+    uint32_t sign;          // PROFILE_TRACE_SIGN
+    uint32_t version;       // PROFILE_TRACE_VERSION
+    uint32_t pid;
+    uint32_t _reserved;
+    double   start_us;      // timer (sx_tm_us) at the start of the capture
     char     name[32];
+} profile_trace_header;
+
+typedef struct profile_trace_end_record {
+    uint8_t  type;
+    uint8_t  _reserved[3];
+    uint32_t num_dropped;
+    uint64_t num_events;
+    uint64_t cycles;        // cycles from start to the end of the capture
+    double   duration_us;   // timer duration of the capture, used to convert cycles to time
+} profile_trace_end_record;
+
+typedef struct profile_event {
+    uint64_t tm;         // sx_cycle_clock
+    uint32_t name_id;
+    uint32_t file_id;
+    uint32_t line : 31;
+    uint32_t end : 1;
+} profile_event;
+
+typedef struct profile_block {
+    uint32_t thread_id;
+    int num_events;
+    profile_event events[RIZZ_CONFIG_PROFILE_CAPTURE_EVENTS];
+} profile_block;
+
+typedef struct profile_capture_stream profile_capture_stream;
+typedef struct profile_thread_buffer profile_thread_buffer;
+
+typedef struct profile_thread_buffer {
+    profile_thread_buffer* next;
+    profile_capture_stream* stream;
+    profile_block* block;   // current block that is being filled
+    uint32_t thread_id;
+    int num_open;
+    int num_dropped;
+    int drop_depth;         // >0 when we are inside a dropped sample, so we skip the matching end calls
+    uint32_t stack[PROFILE_MAX_DEPTH];
+} profile_thread_buffer;
+
+typedef struct profile_capture_stream {
+    sx_file file;
+    sx_mutex mtx;
+    sx_sem writer_sem;
+    sx_thread* writer_thrd;                 // file and writer thread are created with the first full block
+    profile_block** SX_ARRAY full_blocks;   // producer: recording threads, consumer: writer thread
+    profile_block** SX_ARRAY free_blocks;
+    bool quit;
+    bool started;
+    bool failed;                            // could not open the file, blocks are discarded
+    char name[32];
     uint64_t start_tm;
-    uint64_t duration;
+    uint64_t start_cycle;
+
+    // writer thread only
+    sx_hashtbl* string_tbl;                 // key: string id, value: index in the trace file
+    int num_strings;
+    uint64_t num_events;
+} profile_capture_stream;
+
+typedef struct profile_thread_slot {
+    uint32_t capture_id;
+    uint32_t epoch;                 // `capture_epoch` at the time the slot was filled
+    profile_thread_buffer* buff;
+} profile_thread_slot;
+
+typedef struct profile_string_cache_item {
+    uint32_t hash;
+    uint32_t id;
+    char str[32];
+} profile_string_cache_item;
+
+typedef struct profile_file_cache_item {
+    const char* file;
+    uint32_t id;
+} profile_file_cache_item;
+
+typedef struct profile_string {
+    char str[32];
+} profile_string;
+
+// frame profiler history: ring-buffer per thread that always records the latest samples coming from
+// begin_profile_sample/end_profile_sample. owning thread is the only writer, the buffer is only read
+// when the history is dumped. readers detect the events overwritten while copying with `write_idx`
+typedef struct profile_history_event {
+    uint64_t tm;        // sx_cycle_clock
+    uint32_t name_id;
+    uint32_t end;
+} profile_history_event;
+
+typedef struct profile_history_buffer profile_history_buffer;
+typedef struct profile_history_buffer {
+    profile_history_buffer* next;
     uint32_t thread_id;
-    uint32_t caller_line;
-    char     caller_file[32];
-} profile_item;
+    sx_atomic_uint64 write_idx;     // total number of written events, ring index = write_idx % count
+    profile_history_event events[RIZZ_CONFIG_PROFILE_HISTORY_EVENTS];
+} profile_history_buffer;
 
-typedef struct profile_item_track {
-    uint32_t name_hash;
-    int      index;
-} profile_item_track;
+#if (RIZZ_CONFIG_PROFILE_HISTORY_EVENTS & (RIZZ_CONFIG_PROFILE_HISTORY_EVENTS - 1)) != 0
+#    error "RIZZ_CONFIG_PROFILE_HISTORY_EVENTS must be power-of-two"
+#endif
 
 typedef struct profile_capture_context {
     char filename[32];
-    sx_mutex mtx;
-    profile_item* SX_ARRAY items;
-    profile_item_track* SX_ARRAY item_stack;   // keep trace of profiler stack, so we don't do any mistakes in begin/end calls
-    uint32_t last_name_hash;
+    uint64_t start_tm;
+    profile_capture_stream* stream;
+    profile_thread_buffer* buffers;    // linked-list, one buffer per thread that recorded samples
 } profile_capture_context;
 
 typedef struct profile_state
@@ -45,19 +175,41 @@ typedef struct profile_state
     sx_mutex capture_context_mtx;
     sx_handle_pool* capture_context_handles;               // profile_capture_context
     profile_capture_context* SX_ARRAY capture_contexts;    // capture-profiler is mainly used for load times and one-time captures
+    sx_atomic_uint32 capture_epoch;                        // incremented on capture end, invalidates thread slots
+    sx_mutex strings_mtx;
+    sx_hashtbl* string_tbl;                                // key: string id (fnv32 hash, probed on collisions), value: index to strings
+    profile_string* SX_ARRAY strings;
+
+    bool history_enabled;
+    int history_secs;
+    float spike_threshold_ms;
+    uint64_t last_spike_tm;
+    uint64_t calib_tm;                          // timer/cycle-clock pair at init, used to convert cycles to time
+    uint64_t calib_cycle;
+    sx_mutex history_mtx;
+    profile_history_buffer* history_buffers;    // linked-list, one buffer per thread (never freed until release)
+    sx_thread* history_writer_thrd;             // writes the last history dump, joined on the next dump
 } profile_state;
 
 static profile_state g_profile;
+static _Thread_local profile_thread_slot tl_profile_slots[PROFILE_MAX_THREAD_CAPTURES];
+static _Thread_local profile_string_cache_item tl_profile_string_cache[PROFILE_STRING_CACHE_SIZE];
+static _Thread_local profile_file_cache_item tl_profile_file_cache[PROFILE_STRING_CACHE_SIZE];
+static _Thread_local profile_history_buffer* tl_profile_history;
 
 bool rizz__profile_init(const sx_alloc* alloc)
 {
     #if RIZZ_CONFIG_PROFILER
         g_profile.alloc = alloc;
-    
+
         sx_mutex_init(&g_profile.capture_context_mtx);
+        sx_mutex_init(&g_profile.strings_mtx);
         g_profile.capture_context_handles = sx_handle_create_pool(g_profile.alloc, 16);
         if (!g_profile.capture_context_handles)
             return false;
+        g_profile.string_tbl = sx_hashtbl_create(g_profile.alloc, 256);
+        if (!g_profile.string_tbl)
+            return false;
     #else
         sx_unused(alloc);
     #endif
@@ -67,29 +219,743 @@ bool rizz__profile_init(const sx_alloc* alloc)
 void rizz__profile_release(void)
 {
     #if RIZZ_CONFIG_PROFILER
+        // the last history dump may still be in progress and it needs the string table
+        if (g_profile.history_writer_thrd) {
+            sx_thread_destroy(g_profile.history_writer_thrd, g_profile.alloc);
+            g_profile.history_writer_thrd = NULL;
+        }
+
         // go through all the open handles and end them
-        for (int i = 0; i < g_profile.capture_context_handles->count; i++) {
-            sx_handle_t h = sx_handle_at(g_profile.capture_context_handles, i);
+        while (g_profile.capture_context_handles->count > 0) {
+            sx_handle_t h = sx_handle_at(g_profile.capture_context_handles, 0);
             the__core.profile_capture_end((rizz_profile_capture) { .id = h });
         }
-    
+
         sx_mutex_release(&g_profile.capture_context_mtx);
+        sx_mutex_release(&g_profile.strings_mtx);
         sx_handle_destroy_pool(g_profile.capture_context_handles, g_profile.alloc);
+        if (g_profile.string_tbl)
+            sx_hashtbl_destroy(g_profile.string_tbl, g_profile.alloc);
+        sx_array_free(g_profile.alloc, g_profile.capture_contexts);
+        sx_array_free(g_profile.alloc, g_profile.strings);
+
+        if (g_profile.history_enabled) {
+            g_profile.history_enabled = false;
+            profile_history_buffer* b = g_profile.history_buffers;
+            while (b) {
+                profile_history_buffer* next = b->next;
+                sx_free(g_profile.alloc, b);
+                b = next;
+            }
+            g_profile.history_buffers = NULL;
+            sx_mutex_release(&g_profile.history_mtx);
+        }
     #endif
 }
 
+#if RIZZ_CONFIG_PROFILER
+// returns the id of the string, which is the hash of the string unless it collides with another
+// string. global string table is only locked for the first time that the calling thread sees the string
+static uint32_t rizz__profile_intern(const char* str, bool basename)
+{
+    profile_string s;
+    if (basename) {
+        sx_os_path_basename(s.str, sizeof(s.str), str);
+    } else {
+        sx_strcpy(s.str, sizeof(s.str), str);
+    }
+
+    uint32_t hash = sx_hash_fnv32_str(s.str);
+    profile_string_cache_item* cached = &tl_profile_string_cache[hash & (PROFILE_STRING_CACHE_SIZE - 1)];
+    if (cached->id && cached->hash == hash && sx_strequal(cached->str, s.str)) {
+        return cached->id;
+    }
+
+    // on collisions, probe the next ids until we find the string or an empty one. zero is reserved
+    // for "no string" (and empty hash table keys)
+    uint32_t id = hash ? hash : 1;
+    sx_mutex_lock(g_profile.strings_mtx) {
+        while (1) {
+            int index = sx_hashtbl_find(g_profile.string_tbl, id);
+            if (index == -1) {
+                sx_array_push(g_profile.alloc, g_profile.strings, s);
+                if (sx_hashtbl_full(g_profile.string_tbl)) {
+                    sx_hashtbl_grow(&g_profile.string_tbl, g_profile.alloc);
+                }
+                sx_hashtbl_add(g_profile.string_tbl, id, sx_array_count(g_profile.strings) - 1);
+                break;
+            }
+            if (sx_strequal(g_profile.strings[sx_hashtbl_get(g_profile.string_tbl, index)].str, s.str)) {
+                break;
+            }
+            id = (id + 1) ? (id + 1) : 1;
+        }
+    }
+
+    cached->hash = hash;
+    cached->id = id;
+    sx_memcpy(cached->str, s.str, sizeof(cached->str));
+    return id;
+}
+
+// file names always come from __FILE__ and are static strings, so we can skip hashing the (long)
+// paths and cache them by pointer
+static uint32_t rizz__profile_intern_file(const char* file)
+{
+    profile_file_cache_item* item =
+        &tl_profile_file_cache[((uintptr_t)file >> 3) & (PROFILE_STRING_CACHE_SIZE - 1)];
+    if (item->file != file) {
+        item->id = rizz__profile_intern(file, true);
+        item->file = file;
+    }
+    return item->id;
+}
+
+static const char* rizz__profile_string(uint32_t id)
+{
+    int index = sx_hashtbl_find_get(g_profile.string_tbl, id, -1);
+    return index != -1 ? g_profile.strings[index].str : "";
+}
+
+static bool rizz__profile_start_stream(profile_capture_stream* stream);
+
+// hands over the full `block` (if not NULL) to the writer thread and returns an empty block
+static profile_block* rizz__profile_submit_block(profile_capture_stream* stream, profile_block* block,
+                                                 uint32_t thread_id)
+{
+    profile_block* new_block = NULL;
+    sx_mutex_lock(stream->mtx) {
+        if (block && !stream->started) {
+            rizz__profile_start_stream(stream);
+        }
+
+        if (block && stream->failed) {
+            sx_array_push(g_profile.alloc, stream->free_blocks, block);
+            block = NULL;
+        } else if (block) {
+            sx_array_push(g_profile.alloc, stream->full_blocks, block);
+        }
+        if (sx_array_count(stream->free_blocks) > 0) {
+            new_block = sx_array_last(stream->free_blocks);
+            sx_array_pop_last(stream->free_blocks);
+        }
+    }
+
+    if (block) {
+        sx_semaphore_post(&stream->writer_sem, 1);
+    }
+
+    if (!new_block) {
+        new_block = sx_malloc(g_profile.alloc, sizeof(profile_block));
+        if (!new_block) {
+            sx_out_of_memory();
+            return NULL;
+        }
+    }
+    new_block->thread_id = thread_id;
+    new_block->num_events = 0;
+    return new_block;
+}
+
+// finds the calling thread's buffer for the capture, creates and registers one if not found
+// thread slots are only valid while `capture_epoch` is unchanged, ending any capture frees its buffers
+// and invalidates the slots of all threads, so they are looked up again under the lock
+static profile_thread_buffer* rizz__profile_thread_buffer(rizz_profile_capture cid)
+{
+    uint32_t epoch = sx_atomic_load32_explicit(&g_profile.capture_epoch, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    for (int i = 0; i < PROFILE_MAX_THREAD_CAPTURES; i++) {
+        if (tl_profile_slots[i].capture_id == cid.id && tl_profile_slots[i].epoch == epoch) {
+            return tl_profile_slots[i].buff;
+        }
+    }
+
+    profile_thread_buffer* buff = NULL;
+    uint32_t tid = sx_thread_tid();
+    sx_mutex_lock(g_profile.capture_context_mtx) {
+        if (!sx_handle_valid(g_profile.capture_context_handles, cid.id)) {
+            sx_assertf(0, "invalid profile capture handle");
+            sx_mutex_exit(&g_profile.capture_context_mtx);
+            return NULL;
+        }
+
+        // slots may have been recycled while the capture was alive, search the registered buffers first
+        profile_capture_context* ctx = &g_profile.capture_contexts[sx_handle_index(cid.id)];
+        for (profile_thread_buffer* b = ctx->buffers; b; b = b->next) {
+            if (b->thread_id == tid) {
+                buff = b;
+                break;
+            }
+        }
+
+        if (!buff) {
+            buff = sx_malloc(g_profile.alloc, sizeof(profile_thread_buffer));
+            if (!buff) {
+                sx_mutex_exit(&g_profile.capture_context_mtx);
+                sx_out_of_memory();
+                return NULL;
+            }
+            buff->next = ctx->buffers;
+            buff->stream = ctx->stream;
+            buff->block = rizz__profile_submit_block(ctx->stream, NULL, tid);
+            buff->thread_id = tid;
+            buff->num_open = buff->num_dropped = buff->drop_depth = 0;
+            ctx->buffers = buff;
+        }
+
+        // pick the stale slot of this capture, an empty slot or the one that it's capture is already
+        // ended, otherwise recycle the first one
+        epoch = sx_atomic_load32_explicit(&g_profile.capture_epoch, SX_ATOMIC_MEMORYORDER_RELAXED);
+        int slot_idx = -1;
+        for (int i = 0; i < PROFILE_MAX_THREAD_CAPTURES && slot_idx == -1; i++) {
+            if (tl_profile_slots[i].capture_id == cid.id) {
+                slot_idx = i;
+            }
+        }
+        for (int i = 0; i < PROFILE_MAX_THREAD_CAPTURES && slot_idx == -1; i++) {
+            uint32_t id = tl_profile_slots[i].capture_id;
+            if (id == 0 || !sx_handle_valid(g_profile.capture_context_handles, id)) {
+                slot_idx = i;
+            }
+        }
+        tl_profile_slots[slot_idx != -1 ? slot_idx : 0] =
+            (profile_thread_slot) { .capture_id = cid.id, .epoch = epoch, .buff = buff };
+    }
+
+    return buff;
+}
+
+static void rizz__profile_write_varint(sx_mem_writer* writer, uint64_t value)
+{
+    uint8_t buff[10];
+    int len = 0;
+    do {
+        uint8_t b = (uint8_t)(value & 0x7f);
+        value >>= 7;
+        buff[len++] = value ? (b | 0x80) : b;
+    } while (value);
+    sx_mem_write(writer, buff, len);
+}
+
+static void rizz__profile_write_svarint(sx_mem_writer* writer, int64_t value)
+{
+    rizz__profile_write_varint(writer, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+// returns the string index in the trace file, writes the string record for the first time
+static uint32_t rizz__profile_stream_string(profile_capture_stream* stream, sx_mem_writer* writer, uint32_t id)
+{
+    int index = sx_hashtbl_find_get(stream->string_tbl, id, 0);
+    if (index > 0) {
+        return (uint32_t)index;
+    }
+
+    char str[32];
+    sx_mutex_lock(g_profile.strings_mtx) {
+        sx_strcpy(str, sizeof(str), rizz__profile_string(id));
+    }
+
+    index = ++stream->num_strings;
+    if (sx_hashtbl_full(stream->string_tbl)) {
+        sx_hashtbl_grow(&stream->string_tbl, g_profile.alloc);
+    }
+    sx_hashtbl_add(stream->string_tbl, id, index);
+
+    int len = sx_strlen(str);
+    uint8_t type = PROFILE_TRACE_RECORD_STRING;
+    sx_mem_write_var(writer, type);
+    rizz__profile_write_varint(writer, (uint64_t)index);
+    rizz__profile_write_varint(writer, (uint64_t)len);
+    sx_mem_write(writer, str, len);
+    return (uint32_t)index;
+}
+
+static void rizz__profile_encode_block(profile_capture_stream* stream, sx_mem_writer* writer,
+                                       const profile_block* block)
+{
+    if (block->num_events == 0) {
+        return;
+    }
+
+    // strings go before the block, so readers always know them when they parse the events
+    for (int i = 0; i < block->num_events; i++) {
+        const profile_event* e = &block->events[i];
+        if (!e->end) {
+            rizz__profile_stream_string(stream, writer, e->name_id);
+            if (e->file_id) {
+                rizz__profile_stream_string(stream, writer, e->file_id);
+            }
+        }
+    }
+
+    uint8_t type = PROFILE_TRACE_RECORD_BLOCK;
+    sx_mem_write_var(writer, type);
+    rizz__profile_write_varint(writer, block->thread_id);
+    rizz__profile_write_varint(writer, (uint64_t)block->num_events);
+    uint64_t last_tm = block->events[0].tm;
+    rizz__profile_write_svarint(writer, (int64_t)(last_tm - stream->start_cycle));
+
+    for (int i = 0; i < block->num_events; i++) {
+        const profile_event* e = &block->events[i];
+        if (e->end) {
+            rizz__profile_write_varint(writer, 1);
+        } else {
+            uint32_t name_index = rizz__profile_stream_string(stream, writer, e->name_id);
+            rizz__profile_write_varint(writer, (uint64_t)name_index << 1);
+        }
+        rizz__profile_write_svarint(writer, (int64_t)(e->tm - last_tm));
+        last_tm = e->tm;
+
+        if (!e->end) {
+            uint32_t file_index = e->file_id ? rizz__profile_stream_string(stream, writer, e->file_id) : 0;
+            rizz__profile_write_varint(writer, file_index);
+            rizz__profile_write_varint(writer, e->line);
+        }
+    }
+
+    stream->num_events += (uint64_t)block->num_events;
+}
+
+static int rizz__profile_writer_thread(void* user1, void* user2)
+{
+    sx_unused(user2);
+    profile_capture_stream* stream = user1;
+
+    profile_block** SX_ARRAY blocks = NULL;
+    sx_mem_writer writer;
+    sx_mem_init_writer(&writer, g_profile.alloc, 64*1024);
+
+    bool quit = false;
+    while (!quit) {
+        sx_semaphore_wait(&stream->writer_sem, -1);
+
+        sx_mutex_lock(stream->mtx) {
+            for (int i = 0, c = sx_array_count(stream->full_blocks); i < c; i++) {
+                sx_array_push(g_profile.alloc, blocks, stream->full_blocks[i]);
+            }
+            sx_array_clear(stream->full_blocks);
+            quit = stream->quit;
+        }
+
+        for (int i = 0, c = sx_array_count(blocks); i < c; i++) {
+            sx_mem_seekw(&writer, 0, SX_WHENCE_BEGIN);
+            rizz__profile_encode_block(stream, &writer, blocks[i]);
+            sx_file_write(&stream->file, writer.data, writer.pos);
+        }
+
+        sx_mutex_lock(stream->mtx) {
+            for (int i = 0, c = sx_array_count(blocks); i < c; i++) {
+                sx_array_push(g_profile.alloc, stream->free_blocks, blocks[i]);
+            }
+        }
+        sx_array_clear(blocks);
+    }
+
+    sx_array_free(g_profile.alloc, blocks);
+    sx_mem_release_writer(&writer);
+    return 0;
+}
+
+// opens .profiler/<name><ext> next to the executable for writing
+static bool rizz__profile_open_trace_file(sx_file* f, const char* name, const char* ext, char* filepath,
+                                          int filepath_size)
+{
+    #if !SX_PLATFORM_ANDROID && !SX_PLATFORM_IOS
+        sx_os_path_exepath(filepath, filepath_size);
+    #endif
+    sx_os_path_dirname(filepath, filepath_size, filepath);
+    sx_os_path_join(filepath, filepath_size, filepath, ".profiler");
+
+    if (!sx_os_path_isdir(filepath)) {
+        sx_os_mkdir(filepath);
+    }
+
+    sx_os_path_join(filepath, filepath_size, filepath, name);
+    sx_strcat(filepath, filepath_size, ext);
+
+    if (!sx_file_open(f, filepath, SX_FILE_WRITE)) {
+        rizz__log_error("[profiler] could not open '%s' for writing", filepath);
+        return false;
+    }
+    return true;
+}
+
+// the stream only allocates the in-memory state, the file and the writer thread are created lazily
+// when the first block is submitted, so captures that don't record anything cost almost nothing
+static profile_capture_stream* rizz__profile_create_stream(const char* name, uint64_t start_tm,
+                                                           uint64_t start_cycle)
+{
+    profile_capture_stream* stream = sx_malloc(g_profile.alloc, sizeof(profile_capture_stream));
+    if (!stream) {
+        sx_out_of_memory();
+        return NULL;
+    }
+    sx_memset(stream, 0x0, sizeof(*stream));
+
+    stream->string_tbl = sx_hashtbl_create(g_profile.alloc, 256);
+    if (!stream->string_tbl) {
+        sx_free(g_profile.alloc, stream);
+        sx_out_of_memory();
+        return NULL;
+    }
+
+    sx_mutex_init(&stream->mtx);
+    sx_semaphore_init(&stream->writer_sem);
+    sx_strcpy(stream->name, sizeof(stream->name), name);
+    stream->start_tm = start_tm;
+    stream->start_cycle = start_cycle;
+    return stream;
+}
+
+// opens the trace file, writes the header and starts the writer thread. must be called with `stream->mtx` locked
+static bool rizz__profile_start_stream(profile_capture_stream* stream)
+{
+    sx_assert(!stream->started);
+    stream->started = true;
+
+    char filepath[RIZZ_MAX_PATH];
+    if (!rizz__profile_open_trace_file(&stream->file, stream->name, ".rtrace", filepath, sizeof(filepath))) {
+        stream->failed = true;
+        return false;
+    }
+
+    profile_trace_header header = {
+        .sign = PROFILE_TRACE_SIGN,
+        .version = PROFILE_TRACE_VERSION,
+        .pid = sx_os_getpid(),
+        .start_us = sx_tm_us(stream->start_tm)
+    };
+    sx_strcpy(header.name, sizeof(header.name), stream->name);
+    sx_file_write_var(&stream->file, header);
+
+    stream->writer_thrd = sx_thread_create(g_profile.alloc, rizz__profile_writer_thread, stream,
+                                           128*1024, "profile_writer", NULL);
+    if (!stream->writer_thrd) {
+        // failed streams recycle the submitted blocks instead of queueing them for the writer
+        rizz__log_error("[profiler] could not create capture writer thread for '%s'", stream->name);
+        sx_file_close(&stream->file);
+        stream->failed = true;
+        return false;
+    }
+    return true;
+}
+
+// flushes the remaining blocks, waits for the writer thread to finish and closes the trace file
+// returns false if the trace file could not be written
+static bool rizz__profile_close_stream(profile_capture_context* ctx, uint64_t end_tm, uint64_t end_cycle)
+{
+    profile_capture_stream* stream = ctx->stream;
+    int num_dropped = 0;
+    int num_unclosed = 0;
+
+    sx_mutex_lock(stream->mtx) {
+        // nothing is submitted yet (short captures), still write the file so the capture is not lost
+        if (!stream->started) {
+            rizz__profile_start_stream(stream);
+        }
+
+        for (profile_thread_buffer* b = ctx->buffers; b; b = b->next) {
+            if (b->block) {
+                if (stream->failed) {
+                    sx_array_push(g_profile.alloc, stream->free_blocks, b->block);
+                } else {
+                    sx_array_push(g_profile.alloc, stream->full_blocks, b->block);
+                }
+                b->block = NULL;
+            }
+            num_dropped += b->num_dropped;
+            num_unclosed += b->num_open;
+        }
+        stream->quit = true;
+    }
+
+    bool written = !stream->failed;
+    if (written) {
+        sx_semaphore_post(&stream->writer_sem, 1);
+        sx_thread_destroy(stream->writer_thrd, g_profile.alloc);
+
+        profile_trace_end_record end = {
+            .type = PROFILE_TRACE_RECORD_END,
+            .num_dropped = (uint32_t)num_dropped,
+            .num_events = stream->num_events,
+            .cycles = end_cycle - stream->start_cycle,
+            .duration_us = sx_tm_us(sx_tm_diff(end_tm, ctx->start_tm))
+        };
+        sx_file_write_var(&stream->file, end);
+        sx_file_close(&stream->file);
+    }
+
+    if (num_dropped > 0) {
+        rizz__log_warn("(profiler) capture '%s': %d samples dropped", ctx->filename, num_dropped);
+    }
+    if (num_unclosed > 0) {
+        rizz__log_warn("(profiler) capture '%s': %d samples are not ended", ctx->filename, num_unclosed);
+    }
+
+    // cleanup
+    profile_thread_buffer* b = ctx->buffers;
+    while (b) {
+        profile_thread_buffer* next = b->next;
+        sx_free(g_profile.alloc, b);
+        b = next;
+    }
+    for (int i = 0, c = sx_array_count(stream->free_blocks); i < c; i++) {
+        sx_free(g_profile.alloc, stream->free_blocks[i]);
+    }
+    sx_array_free(g_profile.alloc, stream->free_blocks);
+    sx_array_free(g_profile.alloc, stream->full_blocks);
+    sx_hashtbl_destroy(stream->string_tbl, g_profile.alloc);
+    sx_semaphore_release(&stream->writer_sem);
+    sx_mutex_release(&stream->mtx);
+    sx_free(g_profile.alloc, stream);
+    return written;
+}
+
+static profile_history_buffer* rizz__profile_history_thread_buffer(void)
+{
+    profile_history_buffer* buff = tl_profile_history;
+    if (!buff) {
+        buff = sx_malloc(g_profile.alloc, sizeof(profile_history_buffer));
+        if (!buff) {
+            sx_out_of_memory();
+            return NULL;
+        }
+        buff->thread_id = sx_thread_tid();
+        sx_atomic_store64_explicit(&buff->write_idx, 0, SX_ATOMIC_MEMORYORDER_RELAXED);
+
+        sx_mutex_lock(g_profile.history_mtx) {
+            buff->next = g_profile.history_buffers;
+            g_profile.history_buffers = buff;
+        }
+        tl_profile_history = buff;
+    }
+    return buff;
+}
+
+static void rizz__profile_history_push(uint32_t name_id, uint32_t end)
+{
+    profile_history_buffer* buff = rizz__profile_history_thread_buffer();
+    if (!buff)
+        return;
+
+    uint64_t idx = sx_atomic_load64_explicit(&buff->write_idx, SX_ATOMIC_MEMORYORDER_RELAXED);
+    buff->events[idx & (RIZZ_CONFIG_PROFILE_HISTORY_EVENTS - 1)] = (profile_history_event) {
+        .tm = sx_cycle_clock(),
+        .name_id = name_id,
+        .end = end
+    };
+    sx_atomic_store64_explicit(&buff->write_idx, idx + 1, SX_ATOMIC_MEMORYORDER_RELEASE);
+}
+
+// copies the events of the ring-buffer that are recorded after `start_cycle` into `events` (ordered)
+// returns the number of copied events
+static int rizz__profile_history_copy(profile_history_buffer* buff, profile_history_event* events,
+                                      uint64_t start_cycle)
+{
+    const uint64_t capacity = RIZZ_CONFIG_PROFILE_HISTORY_EVENTS;
+    uint64_t end_idx = sx_atomic_load64_explicit(&buff->write_idx, SX_ATOMIC_MEMORYORDER_ACQUIRE);
+    uint64_t start_idx = end_idx > capacity ? (end_idx - capacity) : 0;
+    for (uint64_t i = start_idx; i < end_idx; i++) {
+        events[i - start_idx] = buff->events[i & (capacity - 1)];
+    }
+    sx_atomic_thread_fence(SX_ATOMIC_MEMORYORDER_ACQUIRE);
+
+    // skip the events that the owner thread overwrote while we were copying (+1 for the one being written)
+    uint64_t new_end_idx = sx_atomic_load64_explicit(&buff->write_idx, SX_ATOMIC_MEMORYORDER_RELAXED);
+    uint64_t valid_idx = (new_end_idx + 1) > capacity ? (new_end_idx + 1 - capacity) : 0;
+    uint64_t first = sx_max(start_idx, valid_idx);
+    if (first >= end_idx) {
+        return 0;
+    }
+
+    int offset = (int)(first - start_idx);
+    int count = (int)(end_idx - first);
+    while (count > 0 && (int64_t)(events[offset].tm - start_cycle) < 0) {
+        ++offset;
+        --count;
+    }
+    if (offset > 0) {
+        sx_memmove(events, events + offset, sizeof(profile_history_event) * count);
+    }
+    return count;
+}
+
+// snapshot of the history of all threads, written to json by the history writer thread
+typedef struct profile_history_dump_thread profile_history_dump_thread;
+typedef struct profile_history_dump_thread {
+    profile_history_dump_thread* next;
+    uint32_t thread_id;
+    int num_events;
+    profile_history_event events[1];
+} profile_history_dump_thread;
+
+typedef struct profile_history_dump {
+    char name[64];
+    double us_per_cycle;
+    double calib_us;
+    profile_history_dump_thread* threads;
+} profile_history_dump;
+
+static void rizz__profile_history_free_dump(profile_history_dump* dump)
+{
+    profile_history_dump_thread* t = dump->threads;
+    while (t) {
+        profile_history_dump_thread* next = t->next;
+        sx_free(g_profile.alloc, t);
+        t = next;
+    }
+    sx_free(g_profile.alloc, dump);
+}
+
+static int rizz__profile_history_writer_thread(void* user1, void* user2)
+{
+    sx_unused(user2);
+    profile_history_dump* dump = user1;
+
+    char trace_filepath[RIZZ_MAX_PATH];
+    sx_file f;
+    if (!rizz__profile_open_trace_file(&f, dump->name, ".json", trace_filepath, sizeof(trace_filepath))) {
+        rizz__profile_history_free_dump(dump);
+        return -1;
+    }
+
+    char entry[512];
+    char name[32];
+    uint32_t pid = sx_os_getpid();
+    bool first = true;
+
+    sx_file_write_text(&f, "[\n");
+
+    for (profile_history_dump_thread* t = dump->threads; t; t = t->next) {
+        const profile_history_event* stack[PROFILE_MAX_DEPTH];
+        int depth = 0;
+
+        for (int i = 0; i < t->num_events; i++) {
+            const profile_history_event* e = &t->events[i];
+            if (!e->end) {
+                if (depth < PROFILE_MAX_DEPTH) {
+                    stack[depth] = e;
+                }
+                ++depth;
+                continue;
+            }
+
+            // begin of this sample is older than the history, or it's too deep
+            if (depth == 0 || depth-- > PROFILE_MAX_DEPTH) {
+                continue;
+            }
+
+            // only lock for the lookup, recording threads may intern new strings meanwhile
+            const profile_history_event* begin = stack[depth];
+            sx_mutex_lock(g_profile.strings_mtx) {
+                sx_strcpy(name, sizeof(name), rizz__profile_string(begin->name_id));
+            }
+
+            double ts = dump->calib_us + (double)(int64_t)(begin->tm - g_profile.calib_cycle) * dump->us_per_cycle;
+            double dur = (double)(e->tm - begin->tm) * dump->us_per_cycle;
+            sx_snprintf(entry, sizeof(entry),
+                "%s\t{\"ph\": \"X\", \"pid\": %u, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f, \"name\": \"%s\"}",
+                first ? "" : ",\n", pid, t->thread_id, ts, dur, name);
+            sx_file_write_text(&f, entry);
+            first = false;
+        }
+    }
+
+    sx_file_write_text(&f, "\n]\n");
+    sx_file_close(&f);
+
+    rizz__log_info("(profiler) frame history (%ds) saved to: %s", g_profile.history_secs, trace_filepath);
+    rizz__profile_history_free_dump(dump);
+    return 0;
+}
+
+// takes a snapshot of the last `history_secs` of all threads, and hands it to the history writer
+// thread, which writes it into .profiler/<name>.json. the caller only pays for copying the events
+static bool rizz__profile_history_write(const char* name)
+{
+    uint64_t now_tm = sx_tm_now();
+    uint64_t now_cycle = sx_cycle_clock();
+    uint64_t cycles = now_cycle - g_profile.calib_cycle;
+    double us_per_cycle = cycles > 0 ? sx_tm_us(sx_tm_diff(now_tm, g_profile.calib_tm)) / (double)cycles : 0;
+    if (us_per_cycle <= 0) {
+        return false;
+    }
+    uint64_t history_cycles = (uint64_t)((double)g_profile.history_secs * 1000000.0 / us_per_cycle);
+    uint64_t start_cycle = now_cycle - sx_min(history_cycles, cycles);
+
+    profile_history_dump* dump = sx_malloc(g_profile.alloc, sizeof(profile_history_dump));
+    profile_history_event* events =
+        sx_malloc(g_profile.alloc, sizeof(profile_history_event) * RIZZ_CONFIG_PROFILE_HISTORY_EVENTS);
+    if (!dump || !events) {
+        if (dump)
+            sx_free(g_profile.alloc, dump);
+        if (events)
+            sx_free(g_profile.alloc, events);
+        sx_out_of_memory();
+        return false;
+    }
+    sx_strcpy(dump->name, sizeof(dump->name), name);
+    dump->us_per_cycle = us_per_cycle;
+    dump->calib_us = sx_tm_us(g_profile.calib_tm);
+    dump->threads = NULL;
+
+    profile_history_buffer* buffers;
+    sx_mutex_lock(g_profile.history_mtx) {
+        buffers = g_profile.history_buffers;
+    }
+
+    for (profile_history_buffer* b = buffers; b; b = b->next) {
+        int num_events = rizz__profile_history_copy(b, events, start_cycle);
+        profile_history_dump_thread* t = sx_malloc(g_profile.alloc, 
+            sizeof(profile_history_dump_thread) + sizeof(profile_history_event) * (sx_max(num_events, 1) - 1));
+        if (!t) {
+            sx_out_of_memory();
+            break;
+        }
+        t->thread_id = b->thread_id;
+        t->num_events = num_events;
+        sx_memcpy(t->events, events, sizeof(profile_history_event) * num_events);
+        t->next = dump->threads;
+        dump->threads = t;
+    }
+    sx_free(g_profile.alloc, events);
+
+    // only one dump is written at a time. dumps are at least `history_secs` apart, so the previous 
+    // writer is normally finished by now
+    if (g_profile.history_writer_thrd) {
+        sx_thread_destroy(g_profile.history_writer_thrd, g_profile.alloc);
+    }
+    g_profile.history_writer_thrd = sx_thread_create(g_profile.alloc, rizz__profile_history_writer_thread,
+                                                     dump, 128*1024, "profile_history_writer", NULL);
+    if (!g_profile.history_writer_thrd) {
+        rizz__log_error("(profiler) could not create history writer thread");
+        rizz__profile_history_free_dump(dump);
+        return false;
+    }
+    return true;
+}
+#endif // RIZZ_CONFIG_PROFILER
+
 rizz_profile_capture rizz__profile_capture_create(const char* filename)
 {
     #if RIZZ_CONFIG_PROFILER
+        uint64_t start_tm = sx_tm_now();
+        uint64_t start_cycle = sx_cycle_clock();
+        profile_capture_stream* stream = rizz__profile_create_stream(filename, start_tm, start_cycle);
+        if (!stream) {
+            return (rizz_profile_capture) { 0 };
+        }
+
         rizz_profile_capture handle = { 0 };
         sx_mutex_lock(g_profile.capture_context_mtx) {
             handle.id = sx_handle_new_and_grow(g_profile.capture_context_handles, g_profile.alloc);
             sx_assert(handle.id);
-            
-            profile_capture_context profiler = {0};
-            sx_mutex_init(&profiler.mtx);
+
+            profile_capture_context profiler = {
+                .start_tm = start_tm,
+                .stream = stream
+            };
             sx_strcpy(profiler.filename, sizeof(profiler.filename), filename);
-            
+
             int index = sx_handle_index(handle.id);
             if (index >= sx_array_count(g_profile.capture_contexts)) {
                 sx_array_push(g_profile.alloc, g_profile.capture_contexts, profiler);
@@ -107,63 +973,28 @@ rizz_profile_capture rizz__profile_capture_create(const char* filename)
 void rizz__profile_capture_end(rizz_profile_capture cid)
 {
     #if RIZZ_CONFIG_PROFILER
-        if (cid.id == 0) 
+        if (cid.id == 0)
             return;
 
+        uint64_t end_tm = sx_tm_now();
+        uint64_t end_cycle = sx_cycle_clock();
+
+        // detach the context, so the rest of the trace can be written without holding the lock
+        profile_capture_context profiler;
         sx_mutex_lock(g_profile.capture_context_mtx) {
-            // write all entries to the file and delete the profiler
             sx_assert_always(sx_handle_valid(g_profile.capture_context_handles, cid.id));
-            
-            profile_capture_context* profiler = &g_profile.capture_contexts[sx_handle_index(cid.id)];
+
+            profiler = g_profile.capture_contexts[sx_handle_index(cid.id)];
+            g_profile.capture_contexts[sx_handle_index(cid.id)].buffers = NULL;
+            g_profile.capture_contexts[sx_handle_index(cid.id)].stream = NULL;
             sx_handle_del(g_profile.capture_context_handles, cid.id);
-            
-            char trace_filepath[RIZZ_MAX_PATH];
-            #if !SX_PLATFORM_ANDROID && !SX_PLATFORM_IOS
-                sx_os_path_exepath(trace_filepath, sizeof(trace_filepath));
-            #endif
-            sx_os_path_dirname(trace_filepath, sizeof(trace_filepath), trace_filepath);
-            sx_os_path_join(trace_filepath, sizeof(trace_filepath), trace_filepath, ".profiler");
-            
-            if (!sx_os_path_isdir(trace_filepath)) {
-                sx_os_mkdir(trace_filepath);
-            }
-            
-            sx_os_path_join(trace_filepath, sizeof(trace_filepath), trace_filepath, profiler->filename);
-            sx_strcat(trace_filepath, sizeof(trace_filepath), ".json");
-            
-            sx_file f;
-            if (!sx_file_open(&f, trace_filepath, SX_FILE_WRITE)) {
-                rizz__log_error("[profiler] could not open '%s' for writing", trace_filepath);
-                sx_mutex_exit(&g_profile.capture_context_mtx);
-                return;
-            }
-            
-            char entry[1024];
-            uint32_t pid = sx_os_getpid();
-            
-            sx_file_write_text(&f, "[\n");
-            
-            for (int i = 0, c = sx_array_count(profiler->items); i < c; i++) {
-                profile_item* item = &profiler->items[i];
-                sx_snprintf(entry, sizeof(entry), 
-                    "\t{\"ph\": \"X\", \"pid\": %u, \"tid\": %u, \"ts\": %llu, \"dur\": %llu, \"name\": \"%s\", \"args\": {\"caller\":\"%s@%u\"}}",
-                    pid, item->thread_id, item->start_tm/1000, item->duration/1000, item->name, item->caller_file, item->caller_line);
-                if (i != c - 1) 
-                    sx_strcat(entry, sizeof(entry), ",\n");
-                else
-                    sx_strcat(entry, sizeof(entry), "\n");
-                sx_file_write_text(&f, entry);
-            }
-            
-            sx_file_write_text(&f, "\n]\n");
-            sx_file_close(&f);
-            
-            // cleanup
-            sx_array_free(g_profile.alloc, profiler->items);
-            sx_mutex_release(&profiler->mtx);
-
-            rizz__log_info("(profiler) chrome trace file saved to: %s", trace_filepath);
-        } // lock
+            sx_atomic_fetch_add32_explicit(&g_profile.capture_epoch, 1, SX_ATOMIC_MEMORYORDER_RELEASE);
+        }
+
+        if (rizz__profile_close_stream(&profiler, end_tm, end_cycle)) {
+            rizz__log_info("(profiler) trace file saved to: .profiler/%s.rtrace (convert with scripts/profile-tools/profile-trace-convert.py)",
+                           profiler.filename);
+        }
     #else
         sx_unused(cid);
     #endif
@@ -172,33 +1003,37 @@ void rizz__profile_capture_end(rizz_profile_capture cid)
 void rizz__profile_capture_sample_begin(rizz_profile_capture cid, const char* name, const char* file, uint32_t line)
 {
     #if RIZZ_CONFIG_PROFILER
-        if (cid.id == 0) 
+        if (cid.id == 0)
             return;
 
-        sx_mutex_enter(&g_profile.capture_context_mtx);
-        profile_capture_context* profiler = &g_profile.capture_contexts[sx_handle_index(cid.id)];
-        sx_mutex_exit(&g_profile.capture_context_mtx);
-        
-        sx_mutex_lock(profiler->mtx) {
-            profile_item item = {
-                .start_tm = sx_tm_now(),
-                .thread_id = sx_thread_tid(),
-                .caller_line = line
-            };
-            sx_strcpy(item.name, sizeof(item.name), name);
-            if (file)
-                sx_os_path_basename(item.caller_file, sizeof(item.caller_file), file);
-            sx_array_push(g_profile.alloc, profiler->items, item);
-    
-            profile_item_track track = {
-                .name_hash = sx_hash_fnv32_str(item.name),
-                .index = sx_array_count(profiler->items) - 1,
-    
-            };
-            sx_array_push(g_profile.alloc, profiler->item_stack, track);
-    
-            profiler->last_name_hash = track.name_hash;
-        } // lock
+        profile_thread_buffer* buff = rizz__profile_thread_buffer(cid);
+        if (!buff)
+            return;
+
+        if (buff->drop_depth > 0 || buff->num_open == PROFILE_MAX_DEPTH) {
+            ++buff->drop_depth;
+            ++buff->num_dropped;
+            return;
+        }
+
+        profile_block* block = buff->block;
+        if (!block || block->num_events == RIZZ_CONFIG_PROFILE_CAPTURE_EVENTS) {
+            block = buff->block = rizz__profile_submit_block(buff->stream, block, buff->thread_id);
+            if (!block) {
+                ++buff->drop_depth;
+                ++buff->num_dropped;
+                return;
+            }
+        }
+
+        uint32_t name_id = rizz__profile_intern(name, false);
+        block->events[block->num_events++] = (profile_event) {
+            .name_id = name_id,
+            .file_id = file ? rizz__profile_intern_file(file) : 0,
+            .line = line,
+            .tm = sx_cycle_clock()
+        };
+        buff->stack[buff->num_open++] = name_id;
     #else
         sx_unused(cid);
         sx_unused(name);
@@ -210,26 +1045,110 @@ void rizz__profile_capture_sample_begin(rizz_profile_capture cid, const char* na
 void rizz__profile_capture_sample_end(rizz_profile_capture cid)
 {
     #if RIZZ_CONFIG_PROFILER
-        if (cid.id == 0) 
+        if (cid.id == 0)
             return;
-        sx_mutex_enter(&g_profile.capture_context_mtx);
-        profile_capture_context* profiler = &g_profile.capture_contexts[sx_handle_index(cid.id)];
-        sx_mutex_exit(&g_profile.capture_context_mtx);
-        
-        sx_mutex_lock(profiler->mtx) {
-            sx_assert(sx_array_count(profiler->item_stack) > 0);
-            profile_item_track track = sx_array_last(profiler->item_stack);
-            sx_array_pop_last(profiler->item_stack);
-    
-            profile_item* item = &profiler->items[track.index];
-            sx_assertf(track.name_hash == profiler->last_name_hash, "invalid begin/end order for trace profile '%s'", item->name);
-            item->duration = sx_tm_diff(sx_tm_now(), item->start_tm);
-    
-            int item_stack_count = sx_array_count(profiler->item_stack);
-            profiler->last_name_hash = item_stack_count ? profiler->item_stack[item_stack_count-1].name_hash : 0;
-        } // lock
+        uint64_t tm = sx_cycle_clock();
+
+        profile_thread_buffer* buff = rizz__profile_thread_buffer(cid);
+        if (!buff)
+            return;
+
+        if (buff->drop_depth > 0) {
+            --buff->drop_depth;
+            return;
+        }
+
+        sx_assertf(buff->num_open > 0, "profile_capture_sample_end is called without a matching begin");
+        if (buff->num_open == 0)
+            return;
+
+        profile_block* block = buff->block;
+        if (!block || block->num_events == RIZZ_CONFIG_PROFILE_CAPTURE_EVENTS) {
+            block = buff->block = rizz__profile_submit_block(buff->stream, block, buff->thread_id);
+            if (!block) {
+                --buff->num_open;
+                return;
+            }
+        }
+
+        block->events[block->num_events++] = (profile_event) {
+            .name_id = buff->stack[--buff->num_open],
+            .end = 1,
+            .tm = tm
+        };
     #else
         sx_unused(cid);
     #endif
 }
 
+void rizz__profile_history_init(int history_secs, float spike_threshold_ms)
+{
+    #if RIZZ_CONFIG_PROFILER
+        sx_mutex_init(&g_profile.history_mtx);
+        g_profile.history_secs = history_secs > 0 ? history_secs : 2;
+        g_profile.spike_threshold_ms = spike_threshold_ms;
+        g_profile.calib_tm = sx_tm_now();
+        g_profile.calib_cycle = sx_cycle_clock();
+        g_profile.history_enabled = true;
+    #else
+        sx_unused(history_secs);
+        sx_unused(spike_threshold_ms);
+    #endif
+}
+
+void rizz__profile_history_begin(const char* name)
+{
+    #if RIZZ_CONFIG_PROFILER
+        if (g_profile.history_enabled) {
+            rizz__profile_history_push(rizz__profile_intern(name, false), 0);
+        }
+    #else
+        sx_unused(name);
+    #endif
+}
+
+void rizz__profile_history_end(void)
+{
+    #if RIZZ_CONFIG_PROFILER
+        if (g_profile.history_enabled) {
+            rizz__profile_history_push(0, 1);
+        }
+    #endif
+}
+
+// called by the main thread at the end of each frame, dumps the history if the frame took longer than
+// the threshold. after each dump, we wait for the history to fill up again before dumping the next one
+void rizz__profile_history_frame(int64_t frame_idx, uint64_t frame_tick)
+{
+    #if RIZZ_CONFIG_PROFILER
+        if (!g_profile.history_enabled || g_profile.spike_threshold_ms <= 0) {
+            return;
+        }
+
+        double frame_ms = sx_tm_ms(frame_tick);
+        if (frame_ms < (double)g_profile.spike_threshold_ms ||
+            (g_profile.last_spike_tm && sx_tm_sec(sx_tm_since(g_profile.last_spike_tm)) < (double)g_profile.history_secs)) {
+            return;
+        }
+
+        char name[64];
+        sx_snprintf(name, sizeof(name), "spike_%lld_%dms", (long long)frame_idx, (int)frame_ms);
+        rizz__log_warn("(profiler) frame %lld took %.1fms (threshold = %.1fms)", (long long)frame_idx, frame_ms,
+                       g_profile.spike_threshold_ms);
+        rizz__profile_history_write(name);
+        g_profile.last_spike_tm = sx_tm_now();
+    #else
+        sx_unused(frame_idx);
+        sx_unused(frame_tick);
+    #endif
+}
+
+bool rizz__profile_history_dump(const char* name)
+{
+    #if RIZZ_CONFIG_PROFILER
+        return g_profile.history_enabled ? rizz__profile_history_write(name) : false;
+    #else
+        sx_unused(name);
+        return false;
+    #endif
+}
@@ -158,6 +158,7 @@ typedef struct snd__context {
     sx_pool* clocked_pool;
     snd__clocked** clocked;
     int num_cmdbuffers;
+    int cmdbuffer_tls;      // slot of "snd_cmdbuffer" tls variable
     rizz_snd_instance playlist[RIZZ_SND_DEVICE_MAX_LANES];
     int num_plays;
     snd__ringbuffer mixer_buffer;
@@ -675,7 +676,7 @@ static bool snd__init()
     }
     g_snd.num_cmdbuffers = the_core->job_num_threads();
     sx_memset(g_snd.cmd_buffers, 0x0, sizeof(snd__cmdbuffer*) * the_core->job_num_threads());
-    the_core->tls_register("snd_cmdbuffer", NULL, snd__cmdbuffer_init);
+    g_snd.cmdbuffer_tls = the_core->tls_register("snd_cmdbuffer", NULL, snd__cmdbuffer_init);
 
     return true;
 }
@@ -1538,7 +1539,7 @@ typedef struct snd__play_params {
 
 static void snd__cb_play(rizz_snd_source src, int bus, float volume, float pan, bool paused)
 {
-    snd__cmdbuffer* cb = the_core->tls_var("snd_cmdbuffer");
+    snd__cmdbuffer* cb = the_core->tls_var_slot(g_snd.cmdbuffer_tls);
     sx_assert(cb->cmd_idx < INT_MAX);
 
     int offset = 0;
@@ -1566,7 +1567,7 @@ static uint8_t* snd__cb_run_play(uint8_t* buff)
 static void snd__cb_play_clocked(rizz_snd_source src, float wait_tm, int bus, float volume,
                                  float pan)
 {
-    snd__cmdbuffer* cb = the_core->tls_var("snd_cmdbuffer");
+    snd__cmdbuffer* cb = the_core->tls_var_slot(g_snd.cmdbuffer_tls);
     sx_assert(cb->cmd_idx < INT_MAX);
 
     int offset = 0;
@@ -1593,7 +1594,7 @@ static uint8_t* snd__cb_run_play_clocked(uint8_t* buff)
 
 static void snd__cb_bus_stop(int bus)
 {
-    snd__cmdbuffer* cb = the_core->tls_var("snd_cmdbuffer");
+    snd__cmdbuffer* cb = the_core->tls_var_slot(g_snd.cmdbuffer_tls);
     sx_assert(cb->cmd_idx < INT_MAX);
 
     int offset = 0;
@@ -1619,7 +1620,7 @@ static uint8_t* snd__cb_run_bus_stop(uint8_t* buff)
 
 static void snd__cb_set_master_volume(float volume)
 {
-    snd__cmdbuffer* cb = the_core->tls_var("snd_cmdbuffer");
+    snd__cmdbuffer* cb = the_core->tls_var_slot(g_snd.cmdbuffer_tls);
     sx_assert(cb->cmd_idx < INT_MAX);
 
     int offset = 0;
@@ -1645,7 +1646,7 @@ static uint8_t* snd__cb_run_set_master_volume(uint8_t* buff)
 
 static void snd__cb_set_master_pan(float pan)
 {
-    snd__cmdbuffer* cb = the_core->tls_var("snd_cmdbuffer");
+    snd__cmdbuffer* cb = the_core->tls_var_slot(g_snd.cmdbuffer_tls);
     sx_assert(cb->cmd_idx < INT_MAX);
 
     int offset = 0;
@@ -1671,7 +1672,7 @@ static uint8_t* snd__cb_run_set_master_pan(uint8_t* buff)
 
 static void snd__cb_source_stop(rizz_snd_source src)
 {
-    snd__cmdbuffer* cb = the_core->tls_var("snd_cmdbuffer");
+    snd__cmdbuffer* cb = the_core->tls_var_slot(g_snd.cmdbuffer_tls);
     sx_assert(cb->cmd_idx < INT_MAX);
 
     int offset = 0;
@@ -1697,7 +1698,7 @@ static uint8_t* snd__cb_run_source_stop(uint8_t* buff)
 
 static void snd__cb_source_set_volume(rizz_snd_source src, float vol)
 {
-    snd__cmdbuffer* cb = the_core->tls_var("snd_cmdbuffer");
+    snd__cmdbuffer* cb = the_core->tls_var_slot(g_snd.cmdbuffer_tls);
     sx_assert(cb->cmd_idx < INT_MAX);
 
     int offset = 0;
@@ -6,6 +6,8 @@
 #include "sx/allocator.h"
 #include "sx/os.h"
 #include "sx/pool.h"
+#include "sx/array.h"
+#include "sx/lockless.h"
 
 #include <stdlib.h>
 
@@ -111,10 +113,22 @@ typedef enum {
     CORO_RET_WAIT      // Wait for msecs: 'arg' is msecs in sx_fiber_return
 } sx_coro_ret_type;
 
-typedef union {
-    float tm;
-    int n;
-} sx__coro_state_counter;
+// Waiting coroutines are scheduled, so that update only touches the ones that are due:
+//  - yields are kept in frame buckets, indexed by the update they should be resumed in
+//  - waits are kept in a hierarchical timer wheel with millisecond ticks. each level has 64 slots
+//    and slots of upper levels are cascaded to lower levels when the lower level wraps
+#define SX__CORO_FRAME_SLOTS 64
+#define SX__CORO_WHEEL_BITS 6
+#define SX__CORO_WHEEL_SLOTS (1 << SX__CORO_WHEEL_BITS)
+#define SX__CORO_WHEEL_LEVELS 4
+#define SX__CORO_WHEEL_MAX_TICKS (1ull << (SX__CORO_WHEEL_BITS * SX__CORO_WHEEL_LEVELS))
+
+typedef struct sx__coro_state sx__coro_state;
+
+typedef struct sx__coro_list {
+    sx__coro_state* first;
+    sx__coro_state* last;
+} sx__coro_list;
 
 typedef struct sx__coro_state {
     sx_fiber_t fiber;
@@ -122,47 +136,172 @@ typedef struct sx__coro_state {
     sx_fiber_cb* callback;
     void* user;
     sx_coro_ret_type ret_state;
-    sx__coro_state_counter arg;
-    sx__coro_state_counter counter;
+    int arg;                        // msecs for WAIT, number of updates for YIELD
+    uint64_t due;                   // update index (YIELD) or tick (WAIT) to resume the coroutine
+    sx__coro_list* list;            // frame bucket or wheel slot that the coroutine is waiting in
     struct sx__coro_state* next;
     struct sx__coro_state* prev;
+    bool any_thread;                // can be resumed on any thread (see sx_coro_update_begin)
     bool init;
 } sx__coro_state;
 
 typedef struct sx_coro_context {
+    sx_lock_t lock;                 // scheduling and pool, coroutines may be resumed on many threads
     const sx_alloc* alloc;
     sx_pool* coro_pool;             // sx__coro_state
-    sx__coro_state* run_list;
-    sx__coro_state* run_list_last;
-    sx__coro_state* cur_coro;
+    sx__coro_list frames[SX__CORO_FRAME_SLOTS];
+    sx__coro_list wheel[SX__CORO_WHEEL_LEVELS][SX__CORO_WHEEL_SLOTS];
+    sx__coro_state** SX_ARRAY ready;        // due coroutines of current update (calling thread)
+    sx__coro_state** SX_ARRAY ready_jobs;   // due coroutines of current update (any thread)
+    uint64_t frame;                 // number of updates
+    uint64_t tick;                  // elapsed time in msecs
+    double elapsed;                 // elapsed time in msecs (fractional), accumulated by update
+    int num_waits;                  // number of coroutines in the timer wheel
     int stack_sz;
 } sx_coro_context;
 
-static inline void sx__coro_add_list(sx__coro_state** pfirst, sx__coro_state** plast,
-                                     sx__coro_state* node)
+// current coroutine is per-thread, because coroutines can be resumed on multiple threads
+static _Thread_local sx__coro_state* sx__cur_coro;
+
+static inline void sx__coro_add_list(sx__coro_list* list, sx__coro_state* node)
 {
     // Add to the end of the list
-    if (*plast) {
-        (*plast)->next = node;
-        node->prev = *plast;
+    node->next = NULL;
+    node->prev = list->last;
+    if (list->last) {
+        list->last->next = node;
     }
-    *plast = node;
-    if (*pfirst == NULL)
-        *pfirst = node;
+    list->last = node;
+    if (list->first == NULL)
+        list->first = node;
+    node->list = list;
 }
 
-static inline void sx__coro_remove_list(sx__coro_state** pfirst, sx__coro_state** plast,
-                                        sx__coro_state* node)
+static inline void sx__coro_remove_list(sx__coro_state* node)
 {
+    sx__coro_list* list = node->list;
     if (node->prev)
         node->prev->next = node->next;
     if (node->next)
         node->next->prev = node->prev;
-    if (*pfirst == node)
-        *pfirst = node->next;
-    if (*plast == node)
-        *plast = node->prev;
+    if (list->first == node)
+        list->first = node->next;
+    if (list->last == node)
+        list->last = node->prev;
     node->prev = node->next = NULL;
+    node->list = NULL;
+}
+
+static void sx__coro_add_timer(sx_coro_context* ctx, sx__coro_state* fs)
+{
+    uint64_t due = fs->due;
+    uint64_t delta = due - ctx->tick;
+    int level = 0;
+
+    if (delta >= SX__CORO_WHEEL_MAX_TICKS) {
+        // too far, put it in the last slot of top level, it will be re-added when it's cascaded
+        level = SX__CORO_WHEEL_LEVELS - 1;
+        due = ctx->tick + SX__CORO_WHEEL_MAX_TICKS - 1;
+    } else {
+        while (delta >= (1ull << (SX__CORO_WHEEL_BITS * (level + 1)))) {
+            ++level;
+        }
+    }
+
+    int slot = (int)(due >> (SX__CORO_WHEEL_BITS * level)) & (SX__CORO_WHEEL_SLOTS - 1);
+    sx__coro_add_list(&ctx->wheel[level][slot], fs);
+}
+
+// puts the coroutine back to the scheduler after it returns with wait/yield, or deletes it
+// the coroutine is switched out at this point, so it's safe to re-schedule it from any thread
+static void sx__coro_schedule(sx_coro_context* ctx, sx__coro_state* fs)
+{
+    sx_lock(ctx->lock) {
+        switch (fs->ret_state) {
+        case CORO_RET_END:
+            sx_pool_del(ctx->coro_pool, fs);
+            break;
+        case CORO_RET_WAIT:
+            if (fs->arg > 0) {
+                fs->due = ctx->tick + (uint64_t)fs->arg;
+                sx__coro_add_timer(ctx, fs);
+                ++ctx->num_waits;
+                break;
+            }
+            // zero waits are resumed on the next update, same as yield
+            fs->ret_state = CORO_RET_YIELD;
+            fs->arg = 1;
+            // fall through
+        case CORO_RET_YIELD:
+            fs->due = ctx->frame + (uint64_t)sx_max(fs->arg, 1);
+            sx__coro_add_list(&ctx->frames[fs->due & (SX__CORO_FRAME_SLOTS - 1)], fs);
+            break;
+        default:
+            sx_assertf(0, "coroutine must return with sx_coro_end/sx_coro_yield/sx_coro_wait");
+            break;
+        }
+    }
+}
+
+// switches to the coroutine and schedules it again when it returns
+static void sx__coro_resume(sx_coro_context* ctx, sx__coro_state* fs, void* user)
+{
+    // keep the current coroutine, in case another coroutine is invoked from within a coroutine
+    sx__coro_state* prev_coro = sx__cur_coro;
+    sx__cur_coro = fs;
+    fs->ret_state = CORO_RET_NONE;
+    fs->fiber = sx_fiber_switch(fs->fiber, user).from;
+    sx__cur_coro = prev_coro;
+
+    sx__coro_schedule(ctx, fs);
+}
+
+static void sx__coro_add_ready(sx_coro_context* ctx, sx__coro_state* fs)
+{
+    sx__coro_remove_list(fs);
+    if (fs->any_thread) {
+        sx_array_push(ctx->alloc, ctx->ready_jobs, fs);
+    } else {
+        sx_array_push(ctx->alloc, ctx->ready, fs);
+    }
+}
+
+// advances the timer wheel to `tick`, due coroutines are added to the ready lists
+static void sx__coro_advance_timers(sx_coro_context* ctx, uint64_t tick)
+{
+    if (ctx->num_waits == 0) {
+        ctx->tick = tick;
+        return;
+    }
+
+    while (ctx->tick < tick && ctx->num_waits > 0) {
+        uint64_t t = ++ctx->tick;
+
+        // cascade upper levels when the lower level wraps around
+        for (int level = 1; level < SX__CORO_WHEEL_LEVELS; level++) {
+            if (t & ((1ull << (SX__CORO_WHEEL_BITS * level)) - 1)) {
+                break;
+            }
+
+            int slot = (int)(t >> (SX__CORO_WHEEL_BITS * level)) & (SX__CORO_WHEEL_SLOTS - 1);
+            sx__coro_state* fs = ctx->wheel[level][slot].first;
+            ctx->wheel[level][slot].first = ctx->wheel[level][slot].last = NULL;
+            while (fs) {
+                sx__coro_state* next = fs->next;
+                sx__coro_add_timer(ctx, fs);
+                fs = next;
+            }
+        }
+
+        sx__coro_list* list = &ctx->wheel[0][t & (SX__CORO_WHEEL_SLOTS - 1)];
+        while (list->first) {
+            sx_assert(list->first->due == t);
+            sx__coro_add_ready(ctx, list->first);
+            --ctx->num_waits;
+        }
+    }
+
+    ctx->tick = tick;
 }
 
 sx_coro_context* sx_coro_create_context(const sx_alloc* alloc, int num_initial_fibers, int stack_sz)
@@ -208,14 +347,20 @@ void sx_coro_destroy_context(sx_coro_context* ctx)
             page = page->next;
         }
 
+        sx_array_free(alloc, ctx->ready);
+        sx_array_free(alloc, ctx->ready_jobs);
         sx_pool_destroy(ctx->coro_pool, alloc);
         sx_free(alloc, ctx);
     }
 }
 
-void sx__coro_invoke(sx_coro_context* ctx, sx_fiber_cb* callback, void* user)
+static void sx__coro_invoke_state(sx_coro_context* ctx, sx_fiber_cb* callback, void* user,
+                                  bool any_thread)
 {
-    sx__coro_state* fs = sx_pool_new_and_grow(ctx->coro_pool, ctx->alloc);
+    sx__coro_state* fs;
+    sx_lock(ctx->lock) {
+        fs = sx_pool_new_and_grow(ctx->coro_pool, ctx->alloc);
+    }
     if (!fs) {
         sx_out_of_memory();
         return;
@@ -233,55 +378,74 @@ void sx__coro_invoke(sx_coro_context* ctx, sx_fiber_cb* callback, void* user)
     fs->fiber = sx_fiber_create(fs->stack_mem, callback);
     fs->callback = callback;
     fs->user = user;
-    // Add to the end of the list
-    sx__coro_add_list(&ctx->run_list, &ctx->run_list_last, fs);
+    fs->any_thread = any_thread;
+    fs->list = NULL;
+    fs->next = fs->prev = NULL;
 
-    ctx->cur_coro = fs;
-    fs->fiber = sx_fiber_switch(fs->fiber, user).from;
+    sx__coro_resume(ctx, fs, user);
 }
 
-void sx_coro_update(sx_coro_context* ctx, float dt)
+void sx__coro_invoke(sx_coro_context* ctx, sx_fiber_cb* callback, void* user)
 {
-    sx_assert(ctx->cur_coro == NULL);
+    sx__coro_invoke_state(ctx, callback, user, false);
+}
 
-    sx__coro_state* fs = ctx->run_list;
-    while (fs) {
-        sx__coro_state* next = fs->next;
+void sx__coro_invoke_any_thread(sx_coro_context* ctx, sx_fiber_cb* callback, void* user)
+{
+    sx__coro_invoke_state(ctx, callback, user, true);
+}
 
-        // Check state and take action for pending fibers
-        switch (fs->ret_state) {
-        case CORO_RET_YIELD: {
-            ++fs->counter.n;
-            if (fs->counter.n >= fs->arg.n) {
-                ctx->cur_coro = fs;
-                fs->fiber = sx_fiber_switch(fs->fiber, fs->user).from;
-            }
-            break;
-        }
-        case CORO_RET_WAIT: {
-            fs->counter.tm += dt;
-            if (fs->counter.tm >= fs->arg.tm) {
-                ctx->cur_coro = fs;
-                fs->fiber = sx_fiber_switch(fs->fiber, fs->user).from;
+int sx_coro_update_begin(sx_coro_context* ctx, float dt)
+{
+    sx_assert(sx__cur_coro == NULL);
+
+    sx_array_clear(ctx->ready);
+    sx_array_clear(ctx->ready_jobs);
+
+    sx_lock(ctx->lock) {
+        // yields that are due on this update, the rest of the bucket belongs to later rounds
+        uint64_t frame = ++ctx->frame;
+        sx__coro_state* fs = ctx->frames[frame & (SX__CORO_FRAME_SLOTS - 1)].first;
+        while (fs) {
+            sx__coro_state* next = fs->next;
+            if (fs->due == frame) {
+                sx__coro_add_ready(ctx, fs);
             }
-            break;
-        }
-        default:
-            sx_assertf(0, "Invalid ret type in update loop");
-            break;
+            fs = next;
         }
 
-        fs = next;
+        ctx->elapsed += (double)dt * 1000.0;
+        sx__coro_advance_timers(ctx, (uint64_t)ctx->elapsed);
+    }
+
+    // coroutines that are added to the scheduler from now on, are resumed on the next update
+    for (int i = 0, c = sx_array_count(ctx->ready); i < c; i++) {
+        sx__coro_resume(ctx, ctx->ready[i], ctx->ready[i]->user);
     }
+
+    return sx_array_count(ctx->ready_jobs);
 }
 
-bool sx_coro_replace_callback(sx_coro_context* ctx, sx_fiber_cb* callback,
-                              sx_fiber_cb* new_callback)
+void sx_coro_resume_ready(sx_coro_context* ctx, int index)
 {
-    sx_assert(callback);
-    bool r = false;
+    sx_assert(index >= 0 && index < sx_array_count(ctx->ready_jobs));
+    sx__coro_state* fs = ctx->ready_jobs[index];
+    sx__coro_resume(ctx, fs, fs->user);
+}
 
-    sx__coro_state* fs = ctx->run_list;
+void sx_coro_update(sx_coro_context* ctx, float dt)
+{
+    int num_ready = sx_coro_update_begin(ctx, dt);
+    for (int i = 0; i < num_ready; i++) {
+        sx_coro_resume_ready(ctx, i);
+    }
+}
+
+static bool sx__coro_replace_in_list(sx_coro_context* ctx, sx__coro_list* list,
+                                     sx_fiber_cb* callback, sx_fiber_cb* new_callback)
+{
+    bool r = false;
+    sx__coro_state* fs = list->first;
     while (fs) {
         sx__coro_state* next = fs->next;
 
@@ -292,12 +456,36 @@ bool sx_coro_replace_callback(sx_coro_context* ctx, sx_fiber_cb* callback,
                 fs->fiber = sx_fiber_create(fs->stack_mem, new_callback);
                 r = true;
             } else {
-                sx__coro_remove_list(&ctx->run_list, &ctx->run_list_last, fs);
+                if (fs->ret_state == CORO_RET_WAIT) {
+                    --ctx->num_waits;
+                }
+                sx__coro_remove_list(fs);
                 sx_pool_del(ctx->coro_pool, fs);
             }
         }
         fs = next;
     }
+    return r;
+}
+
+bool sx_coro_replace_callback(sx_coro_context* ctx, sx_fiber_cb* callback,
+                              sx_fiber_cb* new_callback)
+{
+    sx_assert(callback);
+    sx_assert(sx__cur_coro == NULL);
+    bool r = false;
+
+    sx_lock(ctx->lock) {
+        for (int i = 0; i < SX__CORO_FRAME_SLOTS; i++) {
+            r |= sx__coro_replace_in_list(ctx, &ctx->frames[i], callback, new_callback);
+        }
+
+        for (int level = 0; level < SX__CORO_WHEEL_LEVELS; level++) {
+            for (int i = 0; i < SX__CORO_WHEEL_SLOTS; i++) {
+                r |= sx__coro_replace_in_list(ctx, &ctx->wheel[level][i], callback, new_callback);
+            }
+        }
+    }
 
     return r;
 }
@@ -305,26 +493,16 @@ bool sx_coro_replace_callback(sx_coro_context* ctx, sx_fiber_cb* callback,
 static inline void sx__coro_return(sx_coro_context* ctx, sx_fiber_t* pfrom, sx_coro_ret_type type,
                                    int arg)
 {
-    sx_assertf(ctx->cur_coro,
+    sx_unused(ctx);
+    sx_assertf(sx__cur_coro,
               "You must call this function from within sx_fiber_cb invoked by sx_fiber_invoke");
     sx_assertf(type != CORO_RET_NONE, "Invalid enum for type");
 
-    sx__coro_state* fs = ctx->cur_coro;
-
-    // If fiber is finished, just remove it from the list
-    if (type == CORO_RET_END) {
-        sx__coro_remove_list(&ctx->run_list, &ctx->run_list_last, fs);
-        sx_pool_del(ctx->coro_pool, fs);
-    } else {
-        fs->ret_state = type;
-        fs->counter.n = 0;
-        if (type == CORO_RET_WAIT)
-            fs->arg.tm = ((float)arg) * 0.001f;    // Convert msecs to seconds
-        else if (type == CORO_RET_YIELD)
-            fs->arg.n = arg;    // Number of next update passes
-    }
+    // the coroutine is scheduled by the resumer after it's switched out (see sx__coro_resume)
+    sx__coro_state* fs = sx__cur_coro;
+    fs->ret_state = type;
+    fs->arg = arg;
 
-    ctx->cur_coro = NULL;
     *pfrom = sx_fiber_switch(*pfrom, NULL).from;
 }
 
@@ -0,0 +1,277 @@
+//
+// Copyright 2018 Sepehr Taghdisian (septag@github). All rights reserved.
+// License: https://github.com/septag/sx#license-bsd-2-clause
+//
+
+#include "sx/math-batch.h"
+#include "sx/math-vec.h"
+
+#define SX__BATCH_AVX2 0
+#define SX__BATCH_SSE 0
+#define SX__BATCH_NEON 0
+
+#if !SX_CONFIG_SIMD_DISABLE
+#    if defined(__AVX2__) && defined(__FMA__)
+#        include <immintrin.h>
+#        undef SX__BATCH_AVX2
+#        undef SX__BATCH_SSE
+#        define SX__BATCH_AVX2 1
+#        define SX__BATCH_SSE 1
+#    elif defined(__SSE2__) || (SX_COMPILER_MSVC && (SX_ARCH_64BIT || _M_IX86_FP >= 2))
+#        include <xmmintrin.h>
+#        undef SX__BATCH_SSE
+#        define SX__BATCH_SSE 1
+#    elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#        include <arm_neon.h>
+#        undef SX__BATCH_NEON
+#        define SX__BATCH_NEON 1
+#    endif
+#endif    // SX_CONFIG_SIMD_DISABLE
+
+#define SX__BATCH_SIMD (SX__BATCH_SSE || SX__BATCH_NEON)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// sx__wvec: widest register for SoA streams, sx__v4: 4 floats, for AoS matrix/transform kernels
+#if SX__BATCH_AVX2
+typedef __m256 sx__wvec;
+#    define SX__BATCH_WIDTH 8
+#    define sx__wload(_p) _mm256_loadu_ps(_p)
+#    define sx__wstore(_p, _v) _mm256_storeu_ps((_p), (_v))
+#    define sx__wsplat(_f) _mm256_set1_ps(_f)
+#    define sx__wadd(_a, _b) _mm256_add_ps((_a), (_b))
+#    define sx__wsub(_a, _b) _mm256_sub_ps((_a), (_b))
+#    define sx__wmul(_a, _b) _mm256_mul_ps((_a), (_b))
+#    define sx__wmadd(_a, _b, _c) _mm256_fmadd_ps((_a), (_b), (_c))
+#    define sx__wabs(_a) _mm256_andnot_ps(_mm256_set1_ps(-0.0f), (_a))
+#elif SX__BATCH_SSE
+typedef __m128 sx__wvec;
+#    define SX__BATCH_WIDTH 4
+#    define sx__wload(_p) _mm_loadu_ps(_p)
+#    define sx__wstore(_p, _v) _mm_storeu_ps((_p), (_v))
+#    define sx__wsplat(_f) _mm_set1_ps(_f)
+#    define sx__wadd(_a, _b) _mm_add_ps((_a), (_b))
+#    define sx__wsub(_a, _b) _mm_sub_ps((_a), (_b))
+#    define sx__wmul(_a, _b) _mm_mul_ps((_a), (_b))
+#    define sx__wmadd(_a, _b, _c) _mm_add_ps(_mm_mul_ps((_a), (_b)), (_c))
+#    define sx__wabs(_a) _mm_andnot_ps(_mm_set1_ps(-0.0f), (_a))
+#elif SX__BATCH_NEON
+typedef float32x4_t sx__wvec;
+#    define SX__BATCH_WIDTH 4
+#    define sx__wload(_p) vld1q_f32(_p)
+#    define sx__wstore(_p, _v) vst1q_f32((_p), (_v))
+#    define sx__wsplat(_f) vdupq_n_f32(_f)
+#    define sx__wadd(_a, _b) vaddq_f32((_a), (_b))
+#    define sx__wsub(_a, _b) vsubq_f32((_a), (_b))
+#    define sx__wmul(_a, _b) vmulq_f32((_a), (_b))
+#    define sx__wmadd(_a, _b, _c) vmlaq_f32((_c), (_a), (_b))
+#    define sx__wabs(_a) vabsq_f32(_a)
+#endif
+
+#if SX__BATCH_SSE
+typedef __m128 sx__v4;
+#    define sx__v4load(_p) _mm_loadu_ps(_p)
+#    define sx__v4store(_p, _v) _mm_storeu_ps((_p), (_v))
+#    define sx__v4splat(_f) _mm_set1_ps(_f)
+#    if SX__BATCH_AVX2
+#        define sx__v4madd(_a, _b, _c) _mm_fmadd_ps((_a), (_b), (_c))
+#    else
+#        define sx__v4madd(_a, _b, _c) _mm_add_ps(_mm_mul_ps((_a), (_b)), (_c))
+#    endif
+#    define sx__v4mul(_a, _b) _mm_mul_ps((_a), (_b))
+// (a.yzw, a.w): moves the last 3 elements to the front
+#    define sx__v4shift1(_a) _mm_shuffle_ps((_a), (_a), _MM_SHUFFLE(3, 3, 2, 1))
+// (a.z, b.xyz)
+#    define sx__v4zxyz(_a, _b) \
+        _mm_shuffle_ps(_mm_shuffle_ps((_a), (_b), _MM_SHUFFLE(0, 0, 2, 2)), (_b), _MM_SHUFFLE(2, 1, 2, 0))
+#elif SX__BATCH_NEON
+typedef float32x4_t sx__v4;
+#    define sx__v4load(_p) vld1q_f32(_p)
+#    define sx__v4store(_p, _v) vst1q_f32((_p), (_v))
+#    define sx__v4splat(_f) vdupq_n_f32(_f)
+#    define sx__v4madd(_a, _b, _c) vmlaq_f32((_c), (_a), (_b))
+#    define sx__v4mul(_a, _b) vmulq_f32((_a), (_b))
+#    define sx__v4shift1(_a) vextq_f32((_a), (_a), 1)
+#    define sx__v4zxyz(_a, _b) vsetq_lane_f32(vgetq_lane_f32((_a), 2), vextq_f32((_b), (_b), 3), 0)
+#endif
+
+void sx_mat4_mul_vec3_batch(sx_vec3_soa dst, const sx_vec3_soa src, const sx_mat4* mat, int count)
+{
+    sx_assert(count >= 0);
+    int i = 0;
+
+#if SX__BATCH_SIMD
+    const sx__wvec m11 = sx__wsplat(mat->m11), m12 = sx__wsplat(mat->m12), m13 = sx__wsplat(mat->m13);
+    const sx__wvec m21 = sx__wsplat(mat->m21), m22 = sx__wsplat(mat->m22), m23 = sx__wsplat(mat->m23);
+    const sx__wvec m31 = sx__wsplat(mat->m31), m32 = sx__wsplat(mat->m32), m33 = sx__wsplat(mat->m33);
+    const sx__wvec m14 = sx__wsplat(mat->m14), m24 = sx__wsplat(mat->m24), m34 = sx__wsplat(mat->m34);
+
+    for (; i + SX__BATCH_WIDTH <= count; i += SX__BATCH_WIDTH) {
+        sx__wvec x = sx__wload(src.x + i);
+        sx__wvec y = sx__wload(src.y + i);
+        sx__wvec z = sx__wload(src.z + i);
+
+        sx__wstore(dst.x + i, sx__wmadd(x, m11, sx__wmadd(y, m12, sx__wmadd(z, m13, m14))));
+        sx__wstore(dst.y + i, sx__wmadd(x, m21, sx__wmadd(y, m22, sx__wmadd(z, m23, m24))));
+        sx__wstore(dst.z + i, sx__wmadd(x, m31, sx__wmadd(y, m32, sx__wmadd(z, m33, m34))));
+    }
+#endif
+
+    for (; i < count; i++) {
+        sx_vec3 v = sx_mat4_mul_vec3(mat, sx_vec3f(src.x[i], src.y[i], src.z[i]));
+        dst.x[i] = v.x;
+        dst.y[i] = v.y;
+        dst.z[i] = v.z;
+    }
+}
+
+void sx_mat4_mul_vec3_xyz0_batch(sx_vec3_soa dst, const sx_vec3_soa src, const sx_mat4* mat, int count)
+{
+    sx_assert(count >= 0);
+    int i = 0;
+
+#if SX__BATCH_SIMD
+    const sx__wvec m11 = sx__wsplat(mat->m11), m12 = sx__wsplat(mat->m12), m13 = sx__wsplat(mat->m13);
+    const sx__wvec m21 = sx__wsplat(mat->m21), m22 = sx__wsplat(mat->m22), m23 = sx__wsplat(mat->m23);
+    const sx__wvec m31 = sx__wsplat(mat->m31), m32 = sx__wsplat(mat->m32), m33 = sx__wsplat(mat->m33);
+
+    for (; i + SX__BATCH_WIDTH <= count; i += SX__BATCH_WIDTH) {
+        sx__wvec x = sx__wload(src.x + i);
+        sx__wvec y = sx__wload(src.y + i);
+        sx__wvec z = sx__wload(src.z + i);
+
+        sx__wstore(dst.x + i, sx__wmadd(x, m11, sx__wmadd(y, m12, sx__wmul(z, m13))));
+        sx__wstore(dst.y + i, sx__wmadd(x, m21, sx__wmadd(y, m22, sx__wmul(z, m23))));
+        sx__wstore(dst.z + i, sx__wmadd(x, m31, sx__wmadd(y, m32, sx__wmul(z, m33))));
+    }
+#endif
+
+    for (; i < count; i++) {
+        sx_vec3 v = sx_mat4_mul_vec3_xyz0(mat, sx_vec3f(src.x[i], src.y[i], src.z[i]));
+        dst.x[i] = v.x;
+        dst.y[i] = v.y;
+        dst.z[i] = v.z;
+    }
+}
+
+void sx_aabb_transform_batch(sx_aabb_soa dst, const sx_aabb_soa src, const sx_mat4* mat, int count)
+{
+    sx_assert(count >= 0);
+    int i = 0;
+
+#if SX__BATCH_SIMD
+    const sx__wvec m11 = sx__wsplat(mat->m11), m12 = sx__wsplat(mat->m12), m13 = sx__wsplat(mat->m13);
+    const sx__wvec m21 = sx__wsplat(mat->m21), m22 = sx__wsplat(mat->m22), m23 = sx__wsplat(mat->m23);
+    const sx__wvec m31 = sx__wsplat(mat->m31), m32 = sx__wsplat(mat->m32), m33 = sx__wsplat(mat->m33);
+    const sx__wvec m14 = sx__wsplat(mat->m14), m24 = sx__wsplat(mat->m24), m34 = sx__wsplat(mat->m34);
+    const sx__wvec a11 = sx__wabs(m11), a12 = sx__wabs(m12), a13 = sx__wabs(m13);
+    const sx__wvec a21 = sx__wabs(m21), a22 = sx__wabs(m22), a23 = sx__wabs(m23);
+    const sx__wvec a31 = sx__wabs(m31), a32 = sx__wabs(m32), a33 = sx__wabs(m33);
+    const sx__wvec half = sx__wsplat(0.5f);
+
+    for (; i + SX__BATCH_WIDTH <= count; i += SX__BATCH_WIDTH) {
+        sx__wvec xmin = sx__wload(src.xmin + i), xmax = sx__wload(src.xmax + i);
+        sx__wvec ymin = sx__wload(src.ymin + i), ymax = sx__wload(src.ymax + i);
+        sx__wvec zmin = sx__wload(src.zmin + i), zmax = sx__wload(src.zmax + i);
+
+        sx__wvec cx = sx__wmul(sx__wadd(xmin, xmax), half);
+        sx__wvec cy = sx__wmul(sx__wadd(ymin, ymax), half);
+        sx__wvec cz = sx__wmul(sx__wadd(zmin, zmax), half);
+        sx__wvec ex = sx__wmul(sx__wsub(xmax, xmin), half);
+        sx__wvec ey = sx__wmul(sx__wsub(ymax, ymin), half);
+        sx__wvec ez = sx__wmul(sx__wsub(zmax, zmin), half);
+
+        sx__wvec ncx = sx__wmadd(cx, m11, sx__wmadd(cy, m12, sx__wmadd(cz, m13, m14)));
+        sx__wvec ncy = sx__wmadd(cx, m21, sx__wmadd(cy, m22, sx__wmadd(cz, m23, m24)));
+        sx__wvec ncz = sx__wmadd(cx, m31, sx__wmadd(cy, m32, sx__wmadd(cz, m33, m34)));
+        sx__wvec nex = sx__wmadd(ex, a11, sx__wmadd(ey, a12, sx__wmul(ez, a13)));
+        sx__wvec ney = sx__wmadd(ex, a21, sx__wmadd(ey, a22, sx__wmul(ez, a23)));
+        sx__wvec nez = sx__wmadd(ex, a31, sx__wmadd(ey, a32, sx__wmul(ez, a33)));
+
+        sx__wstore(dst.xmin + i, sx__wsub(ncx, nex));
+        sx__wstore(dst.ymin + i, sx__wsub(ncy, ney));
+        sx__wstore(dst.zmin + i, sx__wsub(ncz, nez));
+        sx__wstore(dst.xmax + i, sx__wadd(ncx, nex));
+        sx__wstore(dst.ymax + i, sx__wadd(ncy, ney));
+        sx__wstore(dst.zmax + i, sx__wadd(ncz, nez));
+    }
+#endif
+
+    for (; i < count; i++) {
+        sx_aabb aabb = sx_aabbf(src.xmin[i], src.ymin[i], src.zmin[i],
+                                src.xmax[i], src.ymax[i], src.zmax[i]);
+        aabb = sx_aabb_transform(&aabb, mat);
+        dst.xmin[i] = aabb.xmin;
+        dst.ymin[i] = aabb.ymin;
+        dst.zmin[i] = aabb.zmin;
+        dst.xmax[i] = aabb.xmax;
+        dst.ymax[i] = aabb.ymax;
+        dst.zmax[i] = aabb.zmax;
+    }
+}
+
+void sx_mat4_mul_batch(sx_mat4* dst, const sx_mat4* a, const sx_mat4* b, int count)
+{
+    sx_assert(count >= 0);
+
+    for (int i = 0; i < count; i++) {
+#if SX__BATCH_SIMD
+        const sx__v4 ac1 = sx__v4load(a[i].fc1);
+        const sx__v4 ac2 = sx__v4load(a[i].fc2);
+        const sx__v4 ac3 = sx__v4load(a[i].fc3);
+        const sx__v4 ac4 = sx__v4load(a[i].fc4);
+        const float* bf = b[i].f;
+
+        // dst can be the same as `a` or `b`, columns of `a` are already loaded and each column of
+        // `b` is read before the same column of `dst` is written
+        for (int c = 0; c < 4; c++) {
+            const float* bc = bf + c*4;
+            sx__v4 r = sx__v4mul(ac1, sx__v4splat(bc[0]));
+            r = sx__v4madd(ac2, sx__v4splat(bc[1]), r);
+            r = sx__v4madd(ac3, sx__v4splat(bc[2]), r);
+            r = sx__v4madd(ac4, sx__v4splat(bc[3]), r);
+            sx__v4store(dst[i].f + c*4, r);
+        }
+#else
+        dst[i] = sx_mat4_mul(&a[i], &b[i]);
+#endif
+    }
+}
+
+void sx_tx3d_mul_batch(sx_tx3d* dst, const sx_tx3d* a, const sx_tx3d* b, int count)
+{
+    sx_assert(count >= 0);
+
+    for (int i = 0; i < count; i++) {
+#if SX__BATCH_SIMD
+        // sx_tx3d is 12 packed floats: pos(3), rot.fc1(3), rot.fc2(3), rot.fc3(3)
+        // all 4-wide loads/stores stay inside the struct, the 4th lane is ignored
+        const float* af = a[i].pos.f;
+        const sx__v4 apos = sx__v4load(af);
+        const sx__v4 ac1 = sx__v4load(af + 3);
+        const sx__v4 ac2 = sx__v4load(af + 6);
+        const sx__v4 ac3 = sx__v4shift1(sx__v4load(af + 8));
+
+        const sx_tx3d tb = b[i];
+        sx__v4 pos = sx__v4madd(ac1, sx__v4splat(tb.pos.x), apos);
+        pos = sx__v4madd(ac2, sx__v4splat(tb.pos.y), pos);
+        pos = sx__v4madd(ac3, sx__v4splat(tb.pos.z), pos);
+
+        sx__v4 r[3];
+        for (int c = 0; c < 3; c++) {
+            const float* bc = tb.rot.f + c*3;
+            sx__v4 v = sx__v4mul(ac1, sx__v4splat(bc[0]));
+            v = sx__v4madd(ac2, sx__v4splat(bc[1]), v);
+            r[c] = sx__v4madd(ac3, sx__v4splat(bc[2]), v);
+        }
+
+        // overlapping stores, each one overwrites the garbage 4th lane of the previous one
+        float* df = dst[i].pos.f;
+        sx__v4store(df, pos);
+        sx__v4store(df + 3, r[0]);
+        sx__v4store(df + 6, r[1]);
+        sx__v4store(df + 8, sx__v4zxyz(r[1], r[2]));
+#else
+        dst[i] = sx_tx3d_mul(&a[i], &b[i]);
+#endif
+    }
+}
@@ -6,6 +6,29 @@
 
 #include "sx/rng.h"
 #include "sx/hash.h"
+#include "sx/math-scalar.h"
+
+#define SX__RNG_AVX2 0
+#define SX__RNG_SSE 0
+#define SX__RNG_NEON 0
+
+#if !SX_CONFIG_SIMD_DISABLE
+#    if defined(__AVX2__)
+#        include <immintrin.h>
+#        undef SX__RNG_AVX2
+#        define SX__RNG_AVX2 1
+#    elif defined(__SSE2__) || (SX_COMPILER_MSVC && (SX_ARCH_64BIT || _M_IX86_FP >= 2))
+#        include <emmintrin.h>
+#        undef SX__RNG_SSE
+#        define SX__RNG_SSE 1
+#    elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#        include <arm_neon.h>
+#        undef SX__RNG_NEON
+#        define SX__RNG_NEON 1
+#    endif
+#endif    // SX_CONFIG_SIMD_DISABLE
+
+#define SX__RNG_SIMD (SX__RNG_AVX2 || SX__RNG_SSE || SX__RNG_NEON)
 
 
 // This implementation is taken from: https://github.com/mattiasgustavsson/libs/blob/master/rnd.h
@@ -64,4 +87,268 @@ float sx_rng_genf(sx_rng* rng)
     return sx__rng_float_normalized(sx_rng_gen(rng));
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// sx_rng_wide: xoshiro128++ (David Blackman and Sebastiano Vigna), SX_RNG_WIDE_LANES streams
+// sx__rw: SIMD register of uint32 lanes, SX__RNG_GROUPS registers make up all the lanes
+#if SX__RNG_AVX2
+#    define SX__RNG_WIDTH 8
+typedef __m256i sx__rw;
+#    define sx__rw_load(_p) _mm256_loadu_si256((const __m256i*)(_p))
+#    define sx__rw_store(_p, _v) _mm256_storeu_si256((__m256i*)(_p), (_v))
+#    define sx__rw_splat(_i) _mm256_set1_epi32((int)(_i))
+#    define sx__rw_add(_a, _b) _mm256_add_epi32((_a), (_b))
+#    define sx__rw_xor(_a, _b) _mm256_xor_si256((_a), (_b))
+#    define sx__rw_or(_a, _b) _mm256_or_si256((_a), (_b))
+#    define sx__rw_slli(_a, _n) _mm256_slli_epi32((_a), (_n))
+#    define sx__rw_srli(_a, _n) _mm256_srli_epi32((_a), (_n))
+// converts [1..2) float bits to [0..1) and then to _r*_scale + _bias, stores the floats
+#    define sx__rw_store_float(_p, _r, _scale, _bias)                                  \
+        _mm256_storeu_ps((_p), _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_castsi256_ps(_r), \
+                                                                         _mm256_set1_ps(1.0f)),   \
+                                                           _mm256_set1_ps(_scale)),               \
+                                             _mm256_set1_ps(_bias)))
+#elif SX__RNG_SSE
+#    define SX__RNG_WIDTH 4
+typedef __m128i sx__rw;
+#    define sx__rw_load(_p) _mm_loadu_si128((const __m128i*)(_p))
+#    define sx__rw_store(_p, _v) _mm_storeu_si128((__m128i*)(_p), (_v))
+#    define sx__rw_splat(_i) _mm_set1_epi32((int)(_i))
+#    define sx__rw_add(_a, _b) _mm_add_epi32((_a), (_b))
+#    define sx__rw_xor(_a, _b) _mm_xor_si128((_a), (_b))
+#    define sx__rw_or(_a, _b) _mm_or_si128((_a), (_b))
+#    define sx__rw_slli(_a, _n) _mm_slli_epi32((_a), (_n))
+#    define sx__rw_srli(_a, _n) _mm_srli_epi32((_a), (_n))
+#    define sx__rw_store_float(_p, _r, _scale, _bias)                                         \
+        _mm_storeu_ps((_p), _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_castsi128_ps(_r),            \
+                                                             _mm_set1_ps(1.0f)),               \
+                                                  _mm_set1_ps(_scale)),                        \
+                                       _mm_set1_ps(_bias)))
+#elif SX__RNG_NEON
+#    define SX__RNG_WIDTH 4
+typedef uint32x4_t sx__rw;
+#    define sx__rw_load(_p) vld1q_u32(_p)
+#    define sx__rw_store(_p, _v) vst1q_u32((_p), (_v))
+#    define sx__rw_splat(_i) vdupq_n_u32(_i)
+#    define sx__rw_add(_a, _b) vaddq_u32((_a), (_b))
+#    define sx__rw_xor(_a, _b) veorq_u32((_a), (_b))
+#    define sx__rw_or(_a, _b) vorrq_u32((_a), (_b))
+#    define sx__rw_slli(_a, _n) vshlq_n_u32((_a), (_n))
+#    define sx__rw_srli(_a, _n) vshrq_n_u32((_a), (_n))
+#    define sx__rw_store_float(_p, _r, _scale, _bias)                                        \
+        vst1q_f32((_p), vaddq_f32(vmulq_f32(vsubq_f32(vreinterpretq_f32_u32(_r),             \
+                                                      vdupq_n_f32(1.0f)),                     \
+                                            vdupq_n_f32(_scale)),                             \
+                                  vdupq_n_f32(_bias)))
+#endif
+
+#if SX__RNG_SIMD
+#    define SX__RNG_GROUPS (SX_RNG_WIDE_LANES / SX__RNG_WIDTH)
+#    define sx__rw_rotl(_a, _k) sx__rw_or(sx__rw_slli((_a), (_k)), sx__rw_srli((_a), 32 - (_k)))
+#endif
+
+static inline uint32_t sx__rng_rotl(uint32_t x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+static inline uint32_t sx__rng_wide_next_lane(sx_rng_wide* rng, int lane)
+{
+    uint32_t* s0 = &rng->state[0][lane];
+    uint32_t* s1 = &rng->state[1][lane];
+    uint32_t* s2 = &rng->state[2][lane];
+    uint32_t* s3 = &rng->state[3][lane];
+
+    uint32_t result = sx__rng_rotl(*s0 + *s3, 7) + *s0;
+    uint32_t t = *s1 << 9;
+    *s2 ^= *s0;
+    *s3 ^= *s1;
+    *s1 ^= *s2;
+    *s0 ^= *s3;
+    *s2 ^= t;
+    *s3 = sx__rng_rotl(*s3, 11);
+    return result;
+}
+
+static void sx__rng_wide_jump_lane(sx_rng_wide* rng, int lane, const uint32_t poly[4])
+{
+    uint32_t t[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 32; b++) {
+            if (poly[i] & (1u << b)) {
+                t[0] ^= rng->state[0][lane];
+                t[1] ^= rng->state[1][lane];
+                t[2] ^= rng->state[2][lane];
+                t[3] ^= rng->state[3][lane];
+            }
+            sx__rng_wide_next_lane(rng, lane);
+        }
+    }
+
+    for (int i = 0; i < 4; i++) {
+        rng->state[i][lane] = t[i];
+    }
+}
+
+static inline uint64_t sx__rng_splitmix64(uint64_t* x)
+{
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+void sx_rng_wide_seed(sx_rng_wide* rng, uint32_t seed)
+{
+    // 2^64 steps
+    static const uint32_t k_jump[4] = { 0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b };
+
+    uint64_t x = seed;
+    uint64_t a = sx__rng_splitmix64(&x);
+    uint64_t b = sx__rng_splitmix64(&x);
+    rng->state[0][0] = (uint32_t)a;
+    rng->state[1][0] = (uint32_t)(a >> 32);
+    rng->state[2][0] = (uint32_t)b;
+    rng->state[3][0] = (uint32_t)(b >> 32) | 1u;    // state must not be all zeros
+
+    for (int l = 1; l < SX_RNG_WIDE_LANES; l++) {
+        for (int i = 0; i < 4; i++) {
+            rng->state[i][l] = rng->state[i][l - 1];
+        }
+        sx__rng_wide_jump_lane(rng, l, k_jump);
+    }
+}
+
+void sx_rng_wide_seed_stream(sx_rng_wide* rng, uint32_t seed, int stream)
+{
+    sx_assert(stream >= 0);
+
+    sx_rng_wide_seed(rng, seed);
+    for (int i = 0; i < stream; i++) {
+        sx_rng_wide_jump(rng);
+    }
+}
+
+void sx_rng_wide_jump(sx_rng_wide* rng)
+{
+    // 2^96 steps
+    static const uint32_t k_long_jump[4] = { 0xb523952e, 0x0b6f099f, 0xccf5a0ef, 0x1c580662 };
+
+    for (int l = 0; l < SX_RNG_WIDE_LANES; l++) {
+        sx__rng_wide_jump_lane(rng, l, k_long_jump);
+    }
+}
+
+// output layout: out[block*SX_RNG_WIDE_LANES + lane]
+// as_float: output is float(rnd)*scale + bias, where rnd is in [0..1)
+static void sx__rng_wide_fill(sx_rng_wide* rng, void* out, int count, bool as_float, float scale,
+                              float bias)
+{
+    sx_assert(out);
+    sx_assert(count >= 0);
+
+    int num_blocks = count / SX_RNG_WIDE_LANES;
+    int remain = count % SX_RNG_WIDE_LANES;
+    uint32_t* out_u32 = out;
+    float* out_f32 = out;
+    uint32_t tmp[SX_RNG_WIDE_LANES];
+
+#if SX__RNG_SIMD
+    sx__rw s0[SX__RNG_GROUPS], s1[SX__RNG_GROUPS], s2[SX__RNG_GROUPS], s3[SX__RNG_GROUPS];
+    for (int g = 0; g < SX__RNG_GROUPS; g++) {
+        s0[g] = sx__rw_load(&rng->state[0][g * SX__RNG_WIDTH]);
+        s1[g] = sx__rw_load(&rng->state[1][g * SX__RNG_WIDTH]);
+        s2[g] = sx__rw_load(&rng->state[2][g * SX__RNG_WIDTH]);
+        s3[g] = sx__rw_load(&rng->state[3][g * SX__RNG_WIDTH]);
+    }
+
+    for (int b = 0, nb = num_blocks + (remain ? 1 : 0); b < nb; b++) {
+        bool partial = b == num_blocks;
+        for (int g = 0; g < SX__RNG_GROUPS; g++) {
+            sx__rw r = sx__rw_add(sx__rw_rotl(sx__rw_add(s0[g], s3[g]), 7), s0[g]);
+            sx__rw t = sx__rw_slli(s1[g], 9);
+            s2[g] = sx__rw_xor(s2[g], s0[g]);
+            s3[g] = sx__rw_xor(s3[g], s1[g]);
+            s1[g] = sx__rw_xor(s1[g], s2[g]);
+            s0[g] = sx__rw_xor(s0[g], s3[g]);
+            s2[g] = sx__rw_xor(s2[g], t);
+            s3[g] = sx__rw_rotl(s3[g], 11);
+
+            int offset = partial ? g * SX__RNG_WIDTH : b * SX_RNG_WIDE_LANES + g * SX__RNG_WIDTH;
+            if (as_float) {
+                r = sx__rw_or(sx__rw_srli(r, 9), sx__rw_splat(0x3f800000));
+                sx__rw_store_float(partial ? (float*)tmp + offset : out_f32 + offset, r, scale,
+                                   bias);
+            } else {
+                sx__rw_store(partial ? tmp + offset : out_u32 + offset, r);
+            }
+        }
+    }
+
+    for (int g = 0; g < SX__RNG_GROUPS; g++) {
+        sx__rw_store(&rng->state[0][g * SX__RNG_WIDTH], s0[g]);
+        sx__rw_store(&rng->state[1][g * SX__RNG_WIDTH], s1[g]);
+        sx__rw_store(&rng->state[2][g * SX__RNG_WIDTH], s2[g]);
+        sx__rw_store(&rng->state[3][g * SX__RNG_WIDTH], s3[g]);
+    }
+#else
+    for (int b = 0, nb = num_blocks + (remain ? 1 : 0); b < nb; b++) {
+        bool partial = b == num_blocks;
+        for (int l = 0; l < SX_RNG_WIDE_LANES; l++) {
+            uint32_t r = sx__rng_wide_next_lane(rng, l);
+            int offset = partial ? l : b * SX_RNG_WIDE_LANES + l;
+            if (as_float) {
+                float f = sx__rng_float_normalized(r) * scale + bias;
+                if (partial) {
+                    sx_memcpy(&tmp[l], &f, sizeof(f));
+                } else {
+                    out_f32[offset] = f;
+                }
+            } else {
+                (partial ? tmp : out_u32)[offset] = r;
+            }
+        }
+    }
+#endif    // SX__RNG_SIMD
+
+    if (remain) {
+        sx_memcpy(out_u32 + num_blocks * SX_RNG_WIDE_LANES, tmp, sizeof(uint32_t) * remain);
+    }
+}
+
+void sx_rng_fill_u32(sx_rng_wide* rng, uint32_t* out, int count)
+{
+    sx__rng_wide_fill(rng, out, count, false, 0, 0);
+}
+
+void sx_rng_fill_float01(sx_rng_wide* rng, float* out, int count)
+{
+    sx__rng_wide_fill(rng, out, count, true, 1.0f, 0);
+}
 
+void sx_rng_fill_rangef(sx_rng_wide* rng, float* out, int count, float _min, float _max)
+{
+    sx_assert(_min <= _max);
+    sx__rng_wide_fill(rng, out, count, true, _max - _min, _min);
+}
+
+void sx_rng_fill_gauss(sx_rng_wide* rng, float* out, int count, float mean, float stddev)
+{
+    sx_assert(out);
+
+    // uniforms are generated in bulk, then transformed in pairs (box-muller)
+    float uniforms[256];
+    for (int i = 0; i < count; i += 256) {
+        int n = sx_min(count - i, 256);
+        int num_uniforms = (n + 1) & ~1;
+        sx_rng_fill_float01(rng, uniforms, num_uniforms);
+        for (int k = 0; k < n; k += 2) {
+            // 1 - u is in (0..1], so log never receives zero
+            float r = stddev * sx_sqrt(-2.0f * sx_log(1.0f - uniforms[k]));
+            float theta = SX_PI2 * uniforms[k + 1];
+            out[i + k] = mean + r * sx_cos(theta);
+            if (k + 1 < n) {
+                out[i + k + 1] = mean + r * sx_sin(theta);
+            }
+        }
+    }
+}
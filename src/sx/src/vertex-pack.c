@@ -0,0 +1,419 @@
+//
+// Copyright 2018 Sepehr Taghdisian (septag@github). All rights reserved.
+// License: https://github.com/septag/sx#license-bsd-2-clause
+//
+
+#include "sx/vertex-pack.h"
+#include "sx/math-scalar.h"
+
+#define SX__VPACK_SSE 0
+#define SX__VPACK_NEON 0
+
+#if !SX_CONFIG_SIMD_DISABLE
+#    if defined(__SSE2__) || (SX_COMPILER_MSVC && (SX_ARCH_64BIT || _M_IX86_FP >= 2))
+#        include <emmintrin.h>
+#        undef SX__VPACK_SSE
+#        define SX__VPACK_SSE 1
+#    elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#        include <arm_neon.h>
+#        undef SX__VPACK_NEON
+#        define SX__VPACK_NEON 1
+#    endif
+#endif    // SX_CONFIG_SIMD_DISABLE
+
+// F16C is not part of the x86-64 baseline, so the half-float kernels are compiled with a target
+// attribute and selected at runtime. On ARM64, half conversion is part of the base NEON set
+#if SX__VPACK_SSE && SX_CPU_X86 && (SX_COMPILER_GCC || SX_COMPILER_CLANG)
+#    include <immintrin.h>
+#    define SX__VPACK_F16C 1
+#    define SX__VPACK_F16C_FUNC __attribute__((target("f16c")))
+#elif SX__VPACK_SSE && SX_CPU_X86 && SX_COMPILER_MSVC
+#    include <immintrin.h>
+#    include <intrin.h>
+#    define SX__VPACK_F16C 1
+#    define SX__VPACK_F16C_FUNC
+#else
+#    define SX__VPACK_F16C 0
+#endif
+
+#if SX__VPACK_NEON && SX_ARCH_64BIT
+#    define SX__VPACK_NEON_F16 1
+#else
+#    define SX__VPACK_NEON_F16 0
+#endif
+
+typedef union sx__vpack_f32 {
+    uint32_t u;
+    float f;
+} sx__vpack_f32;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// scalar references, all SIMD paths produce the same bits as these
+// half-float conversion: https://gist.github.com/rygorous/2156668 (float_to_half_fast3_rtne)
+static inline uint16_t sx__float_to_half(float f)
+{
+    const uint32_t f32infty = 255u << 23;
+    const uint32_t f16max = (127u + 16u) << 23;
+    const sx__vpack_f32 denorm_magic = { .u = ((127u - 15u) + (23u - 10u) + 1u) << 23 };
+
+    sx__vpack_f32 v = { .f = f };
+    uint32_t sign = v.u & 0x80000000u;
+    uint16_t o;
+    v.u ^= sign;
+
+    if (v.u >= f16max) {
+        o = (v.u > f32infty) ? 0x7e00 : 0x7c00;    // NaN stays NaN, overflow goes to Inf
+    } else if (v.u < (113u << 23)) {
+        // resulting value is a subnormal/zero, let the FPU do the rounding
+        v.f += denorm_magic.f;
+        o = (uint16_t)(v.u - denorm_magic.u);
+    } else {
+        uint32_t mant_odd = (v.u >> 13) & 1;
+        v.u += ((uint32_t)(15 - 127) << 23) + 0xfff;
+        v.u += mant_odd;
+        o = (uint16_t)(v.u >> 13);
+    }
+
+    return (uint16_t)(o | (sign >> 16));
+}
+
+static inline float sx__half_to_float(uint16_t h)
+{
+    const sx__vpack_f32 magic = { .u = 113u << 23 };
+    const uint32_t shifted_exp = 0x7c00u << 13;
+
+    sx__vpack_f32 o = { .u = (uint32_t)(h & 0x7fff) << 13 };
+    uint32_t exp = shifted_exp & o.u;
+    o.u += (127u - 15u) << 23;
+
+    if (exp == shifted_exp) {
+        o.u += (128u - 16u) << 23;    // Inf/NaN
+    } else if (exp == 0) {
+        o.u += 1u << 23;    // zero/subnormal, renormalize
+        o.f -= magic.f;
+    }
+
+    o.u |= (uint32_t)(h & 0x8000) << 16;
+    return o.f;
+}
+
+// rounds half away from zero, SIMD paths emulate this with `trunc(x + copysign(0.5, x))`
+static inline int32_t sx__vpack_round(float f)
+{
+    return (int32_t)(f + (f >= 0 ? 0.5f : -0.5f));
+}
+
+static inline int16_t sx__pack_snorm16(float f)
+{
+    return (int16_t)sx__vpack_round(sx_clamp(f, -1.0f, 1.0f) * 32767.0f);
+}
+
+static inline uint16_t sx__pack_unorm16(float f)
+{
+    return (uint16_t)sx__vpack_round(sx_clamp(f, 0.0f, 1.0f) * 65535.0f);
+}
+
+static inline int8_t sx__pack_snorm8(float f)
+{
+    return (int8_t)sx__vpack_round(sx_clamp(f, -1.0f, 1.0f) * 127.0f);
+}
+
+static inline uint8_t sx__pack_unorm8(float f)
+{
+    return (uint8_t)sx__vpack_round(sx_clamp(f, 0.0f, 1.0f) * 255.0f);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// SIMD helpers: `sx__vpack_quant4` clamps 4 floats to [lo, hi], scales and rounds to int32
+#if SX__VPACK_SSE
+static inline __m128i sx__vpack_quant4(const float* src, __m128 lo, __m128 hi, __m128 scale)
+{
+    __m128 v = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src), lo), hi), scale);
+    __m128 half = _mm_or_ps(_mm_and_ps(v, _mm_set1_ps(-0.0f)), _mm_set1_ps(0.5f));
+    return _mm_cvttps_epi32(_mm_add_ps(v, half));
+}
+#elif SX__VPACK_NEON
+static inline int32x4_t sx__vpack_quant4(const float* src, float32x4_t lo, float32x4_t hi,
+                                         float32x4_t scale)
+{
+    float32x4_t v = vmulq_f32(vminq_f32(vmaxq_f32(vld1q_f32(src), lo), hi), scale);
+    uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(v), vdupq_n_u32(0x80000000u));
+    float32x4_t half =
+        vreinterpretq_f32_u32(vorrq_u32(sign, vreinterpretq_u32_f32(vdupq_n_f32(0.5f))));
+    return vcvtq_s32_f32(vaddq_f32(v, half));
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// half-floats
+#if SX__VPACK_F16C
+static SX__VPACK_F16C_FUNC void sx__pack_half_f16c(uint16_t* dst, const float* src, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i h0 = _mm_cvtps_ph(_mm_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        __m128i h1 = _mm_cvtps_ph(_mm_loadu_ps(src + i + 4), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_unpacklo_epi64(h0, h1));
+    }
+    for (; i < count; i++) {
+        dst[i] = sx__float_to_half(src[i]);
+    }
+}
+
+static SX__VPACK_F16C_FUNC void sx__unpack_half_f16c(float* dst, const uint16_t* src, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i h = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_ps(dst + i, _mm_cvtph_ps(h));
+        _mm_storeu_ps(dst + i + 4, _mm_cvtph_ps(_mm_unpackhi_epi64(h, h)));
+    }
+    for (; i < count; i++) {
+        dst[i] = sx__half_to_float(src[i]);
+    }
+}
+
+static bool sx__vpack_has_f16c(void)
+{
+#    if SX_COMPILER_MSVC
+    static volatile int has_f16c = -1;    // benign race, every thread computes the same value
+    if (has_f16c == -1) {
+        int info[4];
+        __cpuid(info, 1);
+        has_f16c = (info[2] >> 29) & 1;
+    }
+    return has_f16c != 0;
+#    else
+    return __builtin_cpu_supports("f16c");
+#    endif
+}
+#endif    // SX__VPACK_F16C
+
+void sx_pack_half(uint16_t* dst, const float* src, int count)
+{
+    sx_assert(count >= 0);
+
+#if SX__VPACK_F16C
+    if (sx__vpack_has_f16c()) {
+        sx__pack_half_f16c(dst, src, count);
+        return;
+    }
+#endif
+
+    int i = 0;
+#if SX__VPACK_NEON_F16
+    for (; i + 4 <= count; i += 4) {
+        vst1_u16(dst + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = sx__float_to_half(src[i]);
+    }
+}
+
+void sx_unpack_half(float* dst, const uint16_t* src, int count)
+{
+    sx_assert(count >= 0);
+
+#if SX__VPACK_F16C
+    if (sx__vpack_has_f16c()) {
+        sx__unpack_half_f16c(dst, src, count);
+        return;
+    }
+#endif
+
+    int i = 0;
+#if SX__VPACK_NEON_F16
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = sx__half_to_float(src[i]);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// normalized integers
+void sx_pack_snorm16(int16_t* dst, const float* src, int count)
+{
+    sx_assert(count >= 0);
+
+    int i = 0;
+#if SX__VPACK_SSE
+    const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f), scale = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = sx__vpack_quant4(src + i, lo, hi, scale);
+        __m128i b = sx__vpack_quant4(src + i + 4, lo, hi, scale);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(a, b));
+    }
+#elif SX__VPACK_NEON
+    const float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f),
+                      scale = vdupq_n_f32(32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        int16x4_t a = vmovn_s32(sx__vpack_quant4(src + i, lo, hi, scale));
+        int16x4_t b = vmovn_s32(sx__vpack_quant4(src + i + 4, lo, hi, scale));
+        vst1q_s16(dst + i, vcombine_s16(a, b));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = sx__pack_snorm16(src[i]);
+    }
+}
+
+void sx_pack_unorm16(uint16_t* dst, const float* src, int count)
+{
+    sx_assert(count >= 0);
+
+    int i = 0;
+#if SX__VPACK_SSE
+    // SSE2 has no unsigned saturating 32->16 pack, so bias to signed range and flip the sign
+    // bit back after packing. values are already clamped, so saturation never kicks in
+    const __m128 lo = _mm_setzero_ps(), hi = _mm_set1_ps(1.0f), scale = _mm_set1_ps(65535.0f);
+    const __m128i bias32 = _mm_set1_epi32(32768);
+    const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_sub_epi32(sx__vpack_quant4(src + i, lo, hi, scale), bias32);
+        __m128i b = _mm_sub_epi32(sx__vpack_quant4(src + i + 4, lo, hi, scale), bias32);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_xor_si128(_mm_packs_epi32(a, b), bias16));
+    }
+#elif SX__VPACK_NEON
+    const float32x4_t lo = vdupq_n_f32(0), hi = vdupq_n_f32(1.0f), scale = vdupq_n_f32(65535.0f);
+    for (; i + 8 <= count; i += 8) {
+        uint16x4_t a =
+            vmovn_u32(vreinterpretq_u32_s32(sx__vpack_quant4(src + i, lo, hi, scale)));
+        uint16x4_t b =
+            vmovn_u32(vreinterpretq_u32_s32(sx__vpack_quant4(src + i + 4, lo, hi, scale)));
+        vst1q_u16(dst + i, vcombine_u16(a, b));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = sx__pack_unorm16(src[i]);
+    }
+}
+
+void sx_pack_snorm8(int8_t* dst, const float* src, int count)
+{
+    sx_assert(count >= 0);
+
+    int i = 0;
+#if SX__VPACK_SSE
+    const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f), scale = _mm_set1_ps(127.0f);
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_packs_epi32(sx__vpack_quant4(src + i, lo, hi, scale),
+                                    sx__vpack_quant4(src + i + 4, lo, hi, scale));
+        __m128i b = _mm_packs_epi32(sx__vpack_quant4(src + i + 8, lo, hi, scale),
+                                    sx__vpack_quant4(src + i + 12, lo, hi, scale));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi16(a, b));
+    }
+#elif SX__VPACK_NEON
+    const float32x4_t lo = vdupq_n_f32(-1.0f), hi = vdupq_n_f32(1.0f), scale = vdupq_n_f32(127.0f);
+    for (; i + 8 <= count; i += 8) {
+        int16x4_t a = vmovn_s32(sx__vpack_quant4(src + i, lo, hi, scale));
+        int16x4_t b = vmovn_s32(sx__vpack_quant4(src + i + 4, lo, hi, scale));
+        vst1_s8(dst + i, vmovn_s16(vcombine_s16(a, b)));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = sx__pack_snorm8(src[i]);
+    }
+}
+
+void sx_pack_unorm8(uint8_t* dst, const float* src, int count)
+{
+    sx_assert(count >= 0);
+
+    int i = 0;
+#if SX__VPACK_SSE
+    const __m128 lo = _mm_setzero_ps(), hi = _mm_set1_ps(1.0f), scale = _mm_set1_ps(255.0f);
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_packs_epi32(sx__vpack_quant4(src + i, lo, hi, scale),
+                                    sx__vpack_quant4(src + i + 4, lo, hi, scale));
+        __m128i b = _mm_packs_epi32(sx__vpack_quant4(src + i + 8, lo, hi, scale),
+                                    sx__vpack_quant4(src + i + 12, lo, hi, scale));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(a, b));
+    }
+#elif SX__VPACK_NEON
+    const float32x4_t lo = vdupq_n_f32(0), hi = vdupq_n_f32(1.0f), scale = vdupq_n_f32(255.0f);
+    for (; i + 8 <= count; i += 8) {
+        uint16x4_t a =
+            vmovn_u32(vreinterpretq_u32_s32(sx__vpack_quant4(src + i, lo, hi, scale)));
+        uint16x4_t b =
+            vmovn_u32(vreinterpretq_u32_s32(sx__vpack_quant4(src + i + 4, lo, hi, scale)));
+        vst1_u8(dst + i, vmovn_u16(vcombine_u16(a, b)));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = sx__pack_unorm8(src[i]);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// vectors
+static inline float sx__vpack_sign_nz(float f)
+{
+    return f >= 0 ? 1.0f : -1.0f;
+}
+
+void sx_pack_oct_snorm16(int16_t* dst, const sx_vec3* src, int count)
+{
+    sx_assert(count >= 0);
+
+    for (int i = 0; i < count; i++) {
+        sx_vec3 n = src[i];
+        float l1 = sx_abs(n.x) + sx_abs(n.y) + sx_abs(n.z);
+        float inv = l1 > 0 ? 1.0f / l1 : 0;
+        float px = n.x * inv;
+        float py = n.y * inv;
+        if (n.z < 0) {
+            float ox = (1.0f - sx_abs(py)) * sx__vpack_sign_nz(px);
+            float oy = (1.0f - sx_abs(px)) * sx__vpack_sign_nz(py);
+            px = ox;
+            py = oy;
+        }
+        dst[i * 2] = sx__pack_snorm16(px);
+        dst[i * 2 + 1] = sx__pack_snorm16(py);
+    }
+}
+
+void sx_unpack_oct_snorm16(sx_vec3* dst, const int16_t* src, int count)
+{
+    sx_assert(count >= 0);
+
+    for (int i = 0; i < count; i++) {
+        float x = sx_max((float)src[i * 2] / 32767.0f, -1.0f);
+        float y = sx_max((float)src[i * 2 + 1] / 32767.0f, -1.0f);
+        float z = 1.0f - sx_abs(x) - sx_abs(y);
+        if (z < 0) {
+            float ox = (1.0f - sx_abs(y)) * sx__vpack_sign_nz(x);
+            float oy = (1.0f - sx_abs(x)) * sx__vpack_sign_nz(y);
+            x = ox;
+            y = oy;
+        }
+        float len = sx_sqrt(x * x + y * y + z * z);
+        float inv = len > 0 ? 1.0f / len : 0;
+        dst[i] = (sx_vec3){ .x = x * inv, .y = y * inv, .z = z * inv };
+    }
+}
+
+void sx_pack_quantize_pos(uint16_t* dst, const sx_vec3* src, int count, const sx_aabb* bounds)
+{
+    sx_assert(count >= 0);
+    sx_assert(bounds);
+
+    float ix = bounds->xmax - bounds->xmin;
+    float iy = bounds->ymax - bounds->ymin;
+    float iz = bounds->zmax - bounds->zmin;
+    // degenerate axes (flat meshes) all map to zero
+    ix = ix > 0 ? 1.0f / ix : 0;
+    iy = iy > 0 ? 1.0f / iy : 0;
+    iz = iz > 0 ? 1.0f / iz : 0;
+
+    for (int i = 0; i < count; i++) {
+        uint16_t* d = dst + i * 4;
+        d[0] = sx__pack_unorm16((src[i].x - bounds->xmin) * ix);
+        d[1] = sx__pack_unorm16((src[i].y - bounds->ymin) * iy);
+        d[2] = sx__pack_unorm16((src[i].z - bounds->zmin) * iz);
+        d[3] = 0xffff;
+    }
+}
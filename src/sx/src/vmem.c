@@ -22,6 +22,17 @@ SX_PRAGMA_DIAGNOSTIC_POP()
 #    endif
 #endif
 
+// default huge page size for x86_64 and arm64 (4k granule) systems
+#define SX__VMEM_HUGE_PAGE_SIZE 0x200000
+
+// touches every page in the range, so they get mapped to physical memory right away
+static void sx__vmem_touch_pages(void* ptr, size_t size, size_t page_size)
+{
+    volatile uint8_t* p = (volatile uint8_t*)ptr;
+    for (size_t offset = 0; offset < size; offset += page_size) {
+        p[offset] = p[offset];
+    }
+}
 
 size_t sx_vmem_get_bytes(int num_pages)
 {
@@ -45,6 +56,8 @@ bool sx_vmem_init(sx_vmem_context* vmem, sx_vmem_flags flags, int max_pages)
     vmem->page_size = (int)sx_os_pagesz();
     vmem->num_pages = 0;
     vmem->max_pages = max_pages;
+    // large pages on windows need SeLockMemoryPrivilege and can't be committed on demand
+    vmem->flags = flags & ~(SX_VMEM_HUGE_PAGES|SX_VMEM_HUGE_PAGES_EXPLICIT);
     vmem->ptr =
         VirtualAlloc(NULL, (size_t)vmem->page_size * (size_t)max_pages,
                      MEM_RESERVE | ((flags & SX_VMEM_WATCH) ? MEM_WRITE_WATCH : 0), PAGE_READWRITE);
@@ -82,6 +95,10 @@ void* sx_vmem_commit_page(sx_vmem_context* vmem, int page_id)
         return NULL;
     }
 
+    if (vmem->flags & SX_VMEM_POPULATE) {
+        sx__vmem_touch_pages(ptr, vmem->page_size, vmem->page_size);
+    }
+
     ++vmem->num_pages;
 
     return ptr;
@@ -116,6 +133,10 @@ void* sx_vmem_commit_pages(sx_vmem_context* vmem, int start_page_id, int num_pag
     if (!VirtualAlloc(ptr, (size_t)vmem->page_size*(size_t)num_pages, MEM_COMMIT, PAGE_READWRITE)) {
         return NULL;
     }
+
+    if (vmem->flags & SX_VMEM_POPULATE) {
+        sx__vmem_touch_pages(ptr, (size_t)vmem->page_size*(size_t)num_pages, vmem->page_size);
+    }
     vmem->num_pages += num_pages;
 
     return ptr;
@@ -177,16 +198,42 @@ bool sx_vmem_init(sx_vmem_context* vmem, sx_vmem_flags flags, int max_pages)
 {
     sx_assert(vmem);
     sx_assert(max_pages > 0);
-    sx_unused(flags);
 
     vmem->page_size = (int)sx_os_pagesz();
     vmem->num_pages = 0;
     vmem->max_pages = max_pages;
-    vmem->ptr = mmap(NULL, (size_t)vmem->page_size * (size_t)max_pages, PROT_NONE,
-                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    vmem->flags = flags & ~SX_VMEM_WATCH;
+    vmem->ptr = MAP_FAILED;
+
+#if defined(MAP_HUGETLB)
+    if (flags & SX_VMEM_HUGE_PAGES_EXPLICIT) {
+        // without MAP_NORESERVE, mmap fails right away if the huge page pool is too small, 
+        // instead of raising SIGBUS on first touch
+        size_t size = sx_align_mask((size_t)vmem->page_size * (size_t)max_pages, 
+                                    SX__VMEM_HUGE_PAGE_SIZE - 1);
+        vmem->ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, 
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#endif
+
     if (vmem->ptr == MAP_FAILED) {
-        vmem->ptr = NULL;
-        return false;
+        if (vmem->flags & SX_VMEM_HUGE_PAGES_EXPLICIT) {
+            vmem->flags = (vmem->flags & ~SX_VMEM_HUGE_PAGES_EXPLICIT) | SX_VMEM_HUGE_PAGES;
+        }
+
+        vmem->ptr = mmap(NULL, (size_t)vmem->page_size * (size_t)max_pages, PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (vmem->ptr == MAP_FAILED) {
+            vmem->ptr = NULL;
+            return false;
+        }
+
+#if defined(MADV_HUGEPAGE)
+        if (vmem->flags & SX_VMEM_HUGE_PAGES) {
+            // only a hint, THP can be disabled system-wide
+            madvise(vmem->ptr, (size_t)vmem->page_size * (size_t)max_pages, MADV_HUGEPAGE);
+        }
+#endif
     }
 
     return true;
@@ -197,11 +244,37 @@ void sx_vmem_release(sx_vmem_context* vmem)
     sx_assert(vmem);
 
     if (vmem->ptr) {
-        munmap(vmem->ptr, (size_t)vmem->page_size * (size_t)vmem->max_pages);
+        size_t size = (size_t)vmem->page_size * (size_t)vmem->max_pages;
+        if (vmem->flags & SX_VMEM_HUGE_PAGES_EXPLICIT) {
+            size = sx_align_mask(size, SX__VMEM_HUGE_PAGE_SIZE - 1);
+        }
+        munmap(vmem->ptr, size);
     }
     vmem->num_pages = vmem->max_pages = 0;
 }
 
+static bool sx__vmem_commit(sx_vmem_context* vmem, void* ptr, size_t size)
+{
+    // huge TLB mappings are already read/write, see `sx_vmem_init`
+    if (!(vmem->flags & SX_VMEM_HUGE_PAGES_EXPLICIT)) {
+        if (mprotect(ptr, size, PROT_READ | PROT_WRITE) != 0) {
+            return false;
+        }
+    }
+
+    if (vmem->flags & SX_VMEM_POPULATE) {
+#if defined(MADV_POPULATE_WRITE)
+        // linux 5.14+: fault-in the whole range with a single syscall
+        if (madvise(ptr, size, MADV_POPULATE_WRITE) == 0) {
+            return true;
+        }
+#endif
+        sx__vmem_touch_pages(ptr, size, (size_t)vmem->page_size);
+    }
+
+    return true;
+}
+
 void* sx_vmem_commit_page(sx_vmem_context* vmem, int page_id)
 {
     sx_assert(vmem);
@@ -212,7 +285,7 @@ void* sx_vmem_commit_page(sx_vmem_context* vmem, int page_id)
     }
 
     void* ptr = (uint8_t*)vmem->ptr + vmem->page_size * page_id;
-    if (mprotect(ptr, vmem->page_size, PROT_READ | PROT_WRITE) != 0) {
+    if (!sx__vmem_commit(vmem, ptr, (size_t)vmem->page_size)) {
         sx_assert_always(0);
         return NULL;
     }
@@ -228,12 +301,7 @@ void sx_vmem_free_page(sx_vmem_context* vmem, int page_id)
     sx_assert(page_id < vmem->max_pages);
     sx_assert(vmem->num_pages > 0);
 
-    void* ptr = (uint8_t*)vmem->ptr + vmem->page_size * page_id;
-    int r = munmap(ptr, vmem->page_size);
-    madvise(ptr, vmem->page_size, MADV_DONTNEED);
-    sx_unused(r);
-    sx_assert(r == 0);
-    --vmem->num_pages;
+    sx_vmem_free_pages(vmem, page_id, 1);
 }
 
 void* sx_vmem_commit_pages(sx_vmem_context* vmem, int start_page_id, int num_pages)
@@ -248,7 +316,7 @@ void* sx_vmem_commit_pages(sx_vmem_context* vmem, int start_page_id, int num_pag
     }
 
     void* ptr = (uint8_t*)vmem->ptr + vmem->page_size * start_page_id;
-    if (mprotect(ptr, (size_t)vmem->page_size*(size_t)num_pages, PROT_READ | PROT_WRITE) != 0) {
+    if (!sx__vmem_commit(vmem, ptr, (size_t)vmem->page_size*(size_t)num_pages)) {
         sx_assert_always(0);
         return NULL;
     }
@@ -265,10 +333,13 @@ void sx_vmem_free_pages(sx_vmem_context* vmem, int start_page_id, int num_pages)
     sx_assert(vmem->num_pages >= num_pages);
 
     if (num_pages > 0) {
-        void* ptr = (uint8_t*)vmem->ptr + vmem->page_size * start_page_id;
-        int r = madvise(ptr, (size_t)vmem->page_size*(size_t)num_pages, MADV_DONTNEED);
-        sx_unused(r);
-        sx_assert(r == 0);
+        // huge TLB pages can only be discarded as a whole, so they stay resident until release
+        if (!(vmem->flags & SX_VMEM_HUGE_PAGES_EXPLICIT)) {
+            void* ptr = (uint8_t*)vmem->ptr + vmem->page_size * start_page_id;
+            int r = madvise(ptr, (size_t)vmem->page_size*(size_t)num_pages, MADV_DONTNEED);
+            sx_unused(r);
+            sx_assert(r == 0);
+        }
         vmem->num_pages -= num_pages;
     }
 }
@@ -288,6 +359,39 @@ void sx_vmem_watch_clear(sx_vmem_context* vmem)
 
 #endif // elif SX_PLATFORM_POSIX
 
+// ranges must start at a page boundary, size is rounded up to whole pages by both commit and free,
+// so a commit_range/free_range pair with the same arguments touches exactly the same pages
+static void sx__vmem_range_pages(sx_vmem_context* vmem, size_t offset, size_t size, int* start_page_id,
+                                 int* num_pages)
+{
+    size_t page_size = (size_t)vmem->page_size;
+    sx_assertf(offset % page_size == 0, "range offset must be aligned to page size");
+    *start_page_id = (int)(offset / page_size);
+    *num_pages = (int)((size + page_size - 1) / page_size);
+}
+
+void* sx_vmem_commit_range(sx_vmem_context* vmem, size_t offset, size_t size)
+{
+    sx_assert(vmem);
+    sx_assert(size > 0);
+
+    int start_page_id, num_pages;
+    sx__vmem_range_pages(vmem, offset, size, &start_page_id, &num_pages);
+    if (!sx_vmem_commit_pages(vmem, start_page_id, num_pages)) {
+        return NULL;
+    }
+    return (uint8_t*)vmem->ptr + offset;
+}
+
+void sx_vmem_free_range(sx_vmem_context* vmem, size_t offset, size_t size)
+{
+    sx_assert(vmem);
+
+    int start_page_id, num_pages;
+    sx__vmem_range_pages(vmem, offset, size, &start_page_id, &num_pages);
+    sx_vmem_free_pages(vmem, start_page_id, num_pages);
+}
+
 void* sx_vmem_get_page(sx_vmem_context* vmem, int page_id)
 {
     sx_assert(vmem);
@@ -20,6 +20,8 @@ static inline void sortkeys(rizz_gradient* gradient)
     }
 }
 
+void gradient__bake(rizz_gradient* gradient);
+
 void gradient__init(rizz_gradient* gradient, sx_color start, sx_color end)
 {
     *gradient = (rizz_gradient){
@@ -39,6 +41,8 @@ bool gradient__add_key(rizz_gradient* gradient, rizz_gradient_key key)
     gradient->keys[index] = key;
     gradient->num_keys++;
     sortkeys(gradient);
+    if (gradient->baked)
+        gradient__bake(gradient);
     return true;
 }
 
@@ -52,6 +56,8 @@ bool gradient__move_key(rizz_gradient* gradient, int index, float t)
     t = sx_clamp(t, min, max);
     gradient->keys[index].t = t;
     sortkeys(gradient);
+    if (gradient->baked)
+        gradient__bake(gradient);
     return true;
 }
 
@@ -63,10 +69,12 @@ bool gradient__remove_key(rizz_gradient* gradient, int index)
     gradient->num_keys--;
     sx_memmove(&gradient->keys[index], &gradient->keys[index + 1],
                (gradient->num_keys - index) * sizeof(rizz_gradient_key));
+    if (gradient->baked)
+        gradient__bake(gradient);
     return true;
 }
 
-void gradient__eval(const rizz_gradient* gradient, float t, sx_color* outcolor)
+static void gradient__eval_keys(const rizz_gradient* gradient, float t, sx_color* outcolor)
 {
     sx_assert(gradient->num_keys);
 
@@ -101,6 +109,53 @@ void gradient__eval(const rizz_gradient* gradient, float t, sx_color* outcolor)
     };
 }
 
+static inline sx_color gradient__eval_lut(const rizz_gradient* gradient, float t)
+{
+    float x = sx_clamp(t, 0.0f, 1.0f) * (float)(RIZZ_GRADIENT_LUT_SIZE - 1);
+    int i = sx_min((int)x, RIZZ_GRADIENT_LUT_SIZE - 2);
+    float f = x - (float)i;
+    sx_color ac = gradient->lut[i];
+    sx_color bc = gradient->lut[i + 1];
+    return (sx_color){
+        .r = (uint8_t)sx_lerp((float)ac.r, (float)bc.r, f),
+        .g = (uint8_t)sx_lerp((float)ac.g, (float)bc.g, f),
+        .b = (uint8_t)sx_lerp((float)ac.b, (float)bc.b, f),
+        .a = (uint8_t)sx_lerp((float)ac.a, (float)bc.a, f),
+    };
+}
+
+void gradient__bake(rizz_gradient* gradient)
+{
+    for (int i = 0; i < RIZZ_GRADIENT_LUT_SIZE; i++) {
+        gradient__eval_keys(gradient, (float)i / (float)(RIZZ_GRADIENT_LUT_SIZE - 1),
+                            &gradient->lut[i]);
+    }
+    gradient->baked = true;
+}
+
+void gradient__eval(const rizz_gradient* gradient, float t, sx_color* outcolor)
+{
+    if (gradient->baked) {
+        *outcolor = gradient__eval_lut(gradient, t);
+    } else {
+        gradient__eval_keys(gradient, t, outcolor);
+    }
+}
+
+void gradient__eval_many(const rizz_gradient* gradient, const float* ts, sx_color* outcolors,
+                         int count)
+{
+    if (gradient->baked) {
+        for (int i = 0; i < count; i++) {
+            outcolors[i] = gradient__eval_lut(gradient, ts[i]);
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            gradient__eval_keys(gradient, ts[i], &outcolors[i]);
+        }
+    }
+}
+
 void gradient__edit(const rizz_api_imgui* gui, const char* label, rizz_gradient* gradient)
 {
     gui->PushID_Str(label);
@@ -148,6 +203,7 @@ void gradient__edit(const rizz_api_imgui* gui, const char* label, rizz_gradient*
 
     // draw keys
     int del_i = -1;
+    bool color_changed = false;
     for (int i = 0; i < count; i++) {
         gui->PushID_Int(i);
         sx_color ic = gradient->keys[i].color;
@@ -177,18 +233,24 @@ void gradient__edit(const rizz_api_imgui* gui, const char* label, rizz_gradient*
             ImGuiColorEditFlags_ flags =
                 ImGuiColorEditFlags_NoSidePreview | ImGuiColorEditFlags_AlphaBar |
                 ImGuiColorEditFlags_AlphaPreview | ImGuiColorEditFlags_AlphaPreviewHalf;
-            gui->ColorPicker4("", c.f, flags, NULL);
-            gradient->keys[i].color = (sx_color){
-                .r = (uint8_t)(sx_clamp(c.x, 0, 1) * 255),
-                .g = (uint8_t)(sx_clamp(c.y, 0, 1) * 255),
-                .b = (uint8_t)(sx_clamp(c.z, 0, 1) * 255),
-                .a = (uint8_t)(sx_clamp(c.w, 0, 1) * 255),
-            };
+            if (gui->ColorPicker4("", c.f, flags, NULL)) {
+                gradient->keys[i].color = (sx_color){
+                    .r = (uint8_t)(sx_clamp(c.x, 0, 1) * 255),
+                    .g = (uint8_t)(sx_clamp(c.y, 0, 1) * 255),
+                    .b = (uint8_t)(sx_clamp(c.z, 0, 1) * 255),
+                    .a = (uint8_t)(sx_clamp(c.w, 0, 1) * 255),
+                };
+                color_changed = true;
+            }
             gui->EndPopup();
         }
         gui->PopID();
     }
 
+    // key colors are modified directly above, other edits bake by themselves
+    if (color_changed && gradient->baked)
+        gradient__bake(gradient);
+
     if (del_i != -1)
         gradient__remove_key(gradient, del_i);
 
@@ -20,6 +20,8 @@ static inline void sortkeys(rizz_graph* graph)
     }
 }
 
+void graph__bake(rizz_graph* graph);
+
 SX_ALLOW_UNUSED static inline float bezier(float a, float b, float c, float d, float t)
 {
     float ab = sx_lerp(a, b, t);
@@ -54,6 +56,8 @@ bool graph__add_key(rizz_graph* graph, rizz_graph_key key)
     graph->keys[index] = key;
     graph->num_keys++;
     sortkeys(graph);
+    if (graph->baked)
+        graph__bake(graph);
     return true;
 }
 
@@ -68,6 +72,8 @@ bool graph__move_key(rizz_graph* graph, int index, float t, float value)
     value = sx_clamp(value, 0, 1);
     graph->keys[index].value = value;
     sortkeys(graph);
+    if (graph->baked)
+        graph__bake(graph);
     return true;
 }
 
@@ -79,10 +85,12 @@ bool graph__remove_key(rizz_graph* graph, int index)
     graph->num_keys--;
     sx_memmove(&graph->keys[index], &graph->keys[index + 1],
                (graph->num_keys - index) * sizeof(rizz_graph_key));
+    if (graph->baked)
+        graph__bake(graph);
     return true;
 }
 
-float graph__eval(const rizz_graph* graph, float t)
+static float graph__eval_keys(const rizz_graph* graph, float t)
 {
     sx_assert(graph->num_keys);
 
@@ -111,6 +119,39 @@ float graph__eval(const rizz_graph* graph, float t)
     return bezier(av, av + aw, bv + bw, bv, t);
 }
 
+static inline float graph__eval_lut(const rizz_graph* graph, float t)
+{
+    float x = sx_clamp(t, 0.0f, 1.0f) * (float)(RIZZ_GRAPH_LUT_SIZE - 1);
+    int i = sx_min((int)x, RIZZ_GRAPH_LUT_SIZE - 2);
+    return sx_lerp(graph->lut[i], graph->lut[i + 1], x - (float)i);
+}
+
+void graph__bake(rizz_graph* graph)
+{
+    for (int i = 0; i < RIZZ_GRAPH_LUT_SIZE; i++) {
+        graph->lut[i] = graph__eval_keys(graph, (float)i / (float)(RIZZ_GRAPH_LUT_SIZE - 1));
+    }
+    graph->baked = true;
+}
+
+float graph__eval(const rizz_graph* graph, float t)
+{
+    return graph->baked ? graph__eval_lut(graph, t) : graph__eval_keys(graph, t);
+}
+
+void graph__eval_many(const rizz_graph* graph, const float* ts, float* outvalues, int count)
+{
+    if (graph->baked) {
+        for (int i = 0; i < count; i++) {
+            outvalues[i] = graph__eval_lut(graph, ts[i]);
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            outvalues[i] = graph__eval_keys(graph, ts[i]);
+        }
+    }
+}
+
 float graph__eval_remap(const rizz_graph* graph, float t, float t_min, float t_max, float v_min,
                         float v_max)
 {
@@ -201,6 +242,7 @@ void graph__edit_multiple(const rizz_api_imgui* gui, rizz_graph** graphs, const
     gui->ImDrawList_PushClipRect(dlst, sx_vec2fv(clip_rect.vmin), sx_vec2fv(clip_rect.vmax), true);
     // draw keys
     int del_i = -1;
+    bool wings_changed = false;
     for (int i = 0; i < count; i++) {
         gui->PushID_Int(i);
         sx_vec2 kpos = sx_vec2f(rpos.x + graph->keys[i].t * rsize.x,
@@ -225,11 +267,12 @@ void graph__edit_multiple(const rizz_api_imgui* gui, rizz_graph** graphs, const
         }
         if (gui->BeginPopupContextItem("graph-key-popup", 1)) {
             float t = graph->keys[i].t, v = graph->keys[i].value;
-            gui->DragFloat("Time", &t, 0.05f, 0.0f, 1.0f, "%.2f", 1);
-            gui->DragFloat("Value", &v, 0.05f, 0.0f, 1.0f, "%.2f", 1);
-            graph__move_key(graph, i, t, v);
-            gui->DragFloat("R-Wing", &graph->keys[i].rwing, 0.05f, -1.0f, 1.0f, "%.2f", 1);
-            gui->DragFloat("L-Wing", &graph->keys[i].lwing, 0.05f, -1.0f, 1.0f, "%.2f", 1);
+            bool moved = gui->DragFloat("Time", &t, 0.05f, 0.0f, 1.0f, "%.2f", 1);
+            moved |= gui->DragFloat("Value", &v, 0.05f, 0.0f, 1.0f, "%.2f", 1);
+            if (moved)
+                graph__move_key(graph, i, t, v);
+            wings_changed |= gui->DragFloat("R-Wing", &graph->keys[i].rwing, 0.05f, -1.0f, 1.0f, "%.2f", 1);
+            wings_changed |= gui->DragFloat("L-Wing", &graph->keys[i].lwing, 0.05f, -1.0f, 1.0f, "%.2f", 1);
             gui->EndPopup();
         }
 
@@ -243,6 +286,7 @@ void graph__edit_multiple(const rizz_api_imgui* gui, rizz_graph** graphs, const
             if (gui->IsItemActive()) {
                 graph->keys[i].lwing = (kpos.y - mpos.y) / wdist;
                 graph->keys[i].lwing = sx_clamp(graph->keys[i].lwing, -1, 1);
+                wings_changed = true;
             }
         }
         {
@@ -254,6 +298,7 @@ void graph__edit_multiple(const rizz_api_imgui* gui, rizz_graph** graphs, const
             if (gui->IsItemActive()) {
                 graph->keys[i].rwing = (kpos.y - mpos.y) / wdist;
                 graph->keys[i].rwing = sx_clamp(graph->keys[i].rwing, -1, 1);
+                wings_changed = true;
             }
         }
 
@@ -261,6 +306,10 @@ void graph__edit_multiple(const rizz_api_imgui* gui, rizz_graph** graphs, const
     }
     gui->PopClipRect();
 
+    // wings are modified directly above, other edits bake by themselves
+    if (wings_changed && graph->baked)
+        graph__bake(graph);
+
     // invisible button for add new key
     gui->SetCursorScreenPos(rpos);
     if (gui->InvisibleButton("graph-add-key", rsize, 0)) {
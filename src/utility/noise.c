@@ -1,5 +1,35 @@
+#include "rizz/utility.h"
+
 #include "sx/math-scalar.h"
 
+#define NOISE_SIMD_AVX2 0
+#define NOISE_SIMD_SSE 0
+#define NOISE_SIMD_NEON 0
+
+#if !SX_CONFIG_SIMD_DISABLE
+#    if defined(__AVX2__)
+#        include <immintrin.h>
+#        undef NOISE_SIMD_AVX2
+#        define NOISE_SIMD_AVX2 1
+#    elif defined(__SSE2__) || (SX_COMPILER_MSVC && (SX_ARCH_64BIT || _M_IX86_FP >= 2))
+#        include <emmintrin.h>
+#        undef NOISE_SIMD_SSE
+#        define NOISE_SIMD_SSE 1
+#    elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#        include <arm_neon.h>
+#        undef NOISE_SIMD_NEON
+#        define NOISE_SIMD_NEON 1
+#    endif
+#endif    // SX_CONFIG_SIMD_DISABLE
+
+#define NOISE_SIMD (NOISE_SIMD_AVX2 || NOISE_SIMD_SSE || NOISE_SIMD_NEON)
+
+// grids bigger than this are split into row tiles and evaluated with job_dispatch
+#define NOISE_GRID_JOB_THRESHOLD (128 * 128)
+#define NOISE_GRID_TILE_ROWS 16
+
+RIZZ_STATE static rizz_api_core* the_core;
+
 // clang-format off
 static int perm[] = {
     151,160,137,91,90,15,131,13,201,95,96,53,194,233,7,225,140,36,
@@ -105,11 +135,12 @@ float noise__perlin3d(float x, float y, float z)
     int ba = (perm[b + 0] + hz) & 0xff;
     int ab = (perm[a + 1] + hz) & 0xff;
     int bb = (perm[b + 1] + hz) & 0xff;
-    return sx_lerp(s, 
-           sx_lerp(v, sx_lerp(u, grad3(perm[aa + 0], x, y, z),        grad3(perm[ba + 0], x - 1, y, z)),
-                      sx_lerp(u, grad3(perm[ab + 0], x, y - 1, z),    grad3(perm[bb + 0], x - 1, y - 1, z))),
-           sx_lerp(v, sx_lerp(u, grad3(perm[aa + 1], x, y, z - 1),    grad3(perm[ba + 1], x - 1, y, z - 1)),
-                      sx_lerp(u, grad3(perm[ab + 1], x, y - 1, z - 1),grad3(perm[bb + 1], x - 1, y - 1, z - 1))));
+    return sx_lerp(
+           sx_lerp(sx_lerp(grad3(perm[aa + 0], x, y, z),         grad3(perm[ba + 0], x - 1, y, z), u),
+                   sx_lerp(grad3(perm[ab + 0], x, y - 1, z),     grad3(perm[bb + 0], x - 1, y - 1, z), u), v),
+           sx_lerp(sx_lerp(grad3(perm[aa + 1], x, y, z - 1),     grad3(perm[ba + 1], x - 1, y, z - 1), u),
+                   sx_lerp(grad3(perm[ab + 1], x, y - 1, z - 1), grad3(perm[bb + 1], x - 1, y - 1, z - 1), u), v),
+           s);
 }
 
 float noise__perlin1d_fbm(float x, int octave)
@@ -146,4 +177,523 @@ float noise__perlin3d_fbm(float x, float y, float z, int octave)
         w *= 0.5f;
     }
     return f;
-}
\ No newline at end of file
+}
+
+// Simplex noise, based on Stefan Gustavson's "simplexnoise1234"
+// Cheaper than perlin per octave in 2d (3 corners instead of 4), output is roughly in [-1, 1]
+static inline float simplex_grad2(int hash, float x, float y)
+{
+    int h = hash & 7;
+    float u = h < 4 ? x : y;
+    float v = h < 4 ? y : x;
+    return ((h & 1) ? -u : u) + ((h & 2) ? -2.0f * v : 2.0f * v);
+}
+
+float noise__simplex2d(float x, float y)
+{
+    const float F2 = 0.366025403f;    // 0.5*(sqrt(3)-1)
+    const float G2 = 0.211324865f;    // (3-sqrt(3))/6
+
+    float s = (x + y) * F2;
+    float fi = sx_floor(x + s);
+    float fj = sx_floor(y + s);
+    float t = (fi + fj) * G2;
+    float x0 = x - (fi - t);
+    float y0 = y - (fj - t);
+
+    int i1 = x0 > y0 ? 1 : 0;
+    int j1 = 1 - i1;
+
+    float x1 = x0 - (float)i1 + G2;
+    float y1 = y0 - (float)j1 + G2;
+    float x2 = x0 - 1.0f + 2.0f * G2;
+    float y2 = y0 - 1.0f + 2.0f * G2;
+
+    int ii = (int)fi & 0xff;
+    int jj = (int)fj & 0xff;
+
+    float n0 = 0, n1 = 0, n2 = 0;
+    float t0 = 0.5f - x0 * x0 - y0 * y0;
+    if (t0 > 0) {
+        t0 *= t0;
+        n0 = t0 * t0 * simplex_grad2(perm[ii + perm[jj]], x0, y0);
+    }
+
+    float t1 = 0.5f - x1 * x1 - y1 * y1;
+    if (t1 > 0) {
+        t1 *= t1;
+        n1 = t1 * t1 * simplex_grad2(perm[ii + i1 + perm[jj + j1]], x1, y1);
+    }
+
+    float t2 = 0.5f - x2 * x2 - y2 * y2;
+    if (t2 > 0) {
+        t2 *= t2;
+        n2 = t2 * t2 * simplex_grad2(perm[ii + 1 + perm[jj + 1]], x2, y2);
+    }
+
+    return 40.0f * (n0 + n1 + n2);
+}
+
+float noise__simplex2d_fbm(float x, float y, int octave)
+{
+    float f = 0.0f, w = 0.5f;
+    for (int i = 0; i < octave; i++) {
+        f += w * noise__simplex2d(x, y);
+        x *= 2.0f;
+        y *= 2.0f;
+        w *= 0.5f;
+    }
+    return f;
+}
+
+// Value noise: smoothly interpolates random values at lattice points, no gradients involved
+// Cheapest of the three, but has more visible grid artifacts. output is in [-1, 1]
+static inline float value_lattice(int hx, int hy)
+{
+    return (float)perm[(perm[hx] + hy) & 0xff] * (2.0f / 255.0f) - 1.0f;
+}
+
+float noise__value2d(float x, float y)
+{
+    float fx = sx_floor(x);
+    float fy = sx_floor(y);
+    int hx = (int)fx & 0xff;
+    int hy = (int)fy & 0xff;
+    float u = fade(x - fx);
+    float v = fade(y - fy);
+    return sx_lerp(sx_lerp(value_lattice(hx, hy), value_lattice(hx + 1, hy), u),
+                   sx_lerp(value_lattice(hx, hy + 1), value_lattice(hx + 1, hy + 1), u), v);
+}
+
+float noise__value2d_fbm(float x, float y, int octave)
+{
+    float f = 0.0f, w = 0.5f;
+    for (int i = 0; i < octave; i++) {
+        f += w * noise__value2d(x, y);
+        x *= 2.0f;
+        y *= 2.0f;
+        w *= 0.5f;
+    }
+    return f;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Wide perlin2d: evaluates NOISE_WIDTH samples at once. permutation lookups are still scalar per
+// lane, but floor/fade/gradients/lerps are done in SIMD registers
+// results are the same as noise__perlin2d_fbm (within float rounding)
+#if NOISE_SIMD_AVX2
+#    define NOISE_WIDTH 8
+typedef __m256 noise__vf;
+typedef __m256i noise__vi;
+#    define noise__fload(_p) _mm256_loadu_ps(_p)
+#    define noise__fstore(_p, _v) _mm256_storeu_ps((_p), (_v))
+#    define noise__fsplat(_f) _mm256_set1_ps(_f)
+#    define noise__fadd(_a, _b) _mm256_add_ps((_a), (_b))
+#    define noise__fsub(_a, _b) _mm256_sub_ps((_a), (_b))
+#    define noise__fmul(_a, _b) _mm256_mul_ps((_a), (_b))
+#    define noise__ffloor(_a) _mm256_floor_ps(_a)
+#    define noise__ftoi(_a) _mm256_cvttps_epi32(_a)
+#    define noise__itof(_a) _mm256_cvtepi32_ps(_a)
+#    define noise__iload(_p) _mm256_loadu_si256((const __m256i*)(_p))
+#    define noise__istore(_p, _v) _mm256_storeu_si256((__m256i*)(_p), (_v))
+#    define noise__isplat(_i) _mm256_set1_epi32(_i)
+#    define noise__iand(_a, _b) _mm256_and_si256((_a), (_b))
+#    define noise__islli(_a, _n) _mm256_slli_epi32((_a), (_n))
+#    define noise__iota() _mm256_setr_ps(0, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f)
+#    define noise__ilt(_a, _b) _mm256_cmpgt_epi32((_b), (_a))
+#    define noise__ieq(_a, _b) _mm256_cmpeq_epi32((_a), (_b))
+#    define noise__mor(_a, _b) _mm256_or_si256((_a), (_b))
+#    define noise__fselect(_m, _a, _b) _mm256_blendv_ps((_b), (_a), _mm256_castsi256_ps(_m))
+#    define noise__fxor_sign(_f, _i) \
+        _mm256_castsi256_ps(_mm256_xor_si256(_mm256_castps_si256(_f), (_i)))
+#elif NOISE_SIMD_SSE
+#    define NOISE_WIDTH 4
+typedef __m128 noise__vf;
+typedef __m128i noise__vi;
+#    define noise__fload(_p) _mm_loadu_ps(_p)
+#    define noise__fstore(_p, _v) _mm_storeu_ps((_p), (_v))
+#    define noise__fsplat(_f) _mm_set1_ps(_f)
+#    define noise__fadd(_a, _b) _mm_add_ps((_a), (_b))
+#    define noise__fsub(_a, _b) _mm_sub_ps((_a), (_b))
+#    define noise__fmul(_a, _b) _mm_mul_ps((_a), (_b))
+#    define noise__ftoi(_a) _mm_cvttps_epi32(_a)
+#    define noise__itof(_a) _mm_cvtepi32_ps(_a)
+#    define noise__iload(_p) _mm_loadu_si128((const __m128i*)(_p))
+#    define noise__istore(_p, _v) _mm_storeu_si128((__m128i*)(_p), (_v))
+#    define noise__isplat(_i) _mm_set1_epi32(_i)
+#    define noise__iand(_a, _b) _mm_and_si128((_a), (_b))
+#    define noise__islli(_a, _n) _mm_slli_epi32((_a), (_n))
+#    define noise__iota() _mm_setr_ps(0, 1.0f, 2.0f, 3.0f)
+#    define noise__ilt(_a, _b) _mm_cmplt_epi32((_a), (_b))
+#    define noise__ieq(_a, _b) _mm_cmpeq_epi32((_a), (_b))
+#    define noise__mor(_a, _b) _mm_or_si128((_a), (_b))
+#    define noise__fselect(_m, _a, _b) \
+        _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(_m), (_a)), _mm_andnot_ps(_mm_castsi128_ps(_m), (_b)))
+#    define noise__fxor_sign(_f, _i) _mm_castsi128_ps(_mm_xor_si128(_mm_castps_si128(_f), (_i)))
+// SSE2 doesn't have round instructions: truncate and subtract 1 where truncation rounded up
+static inline __m128 noise__ffloor(__m128 a)
+{
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmplt_ps(a, t), _mm_set1_ps(1.0f)));
+}
+#elif NOISE_SIMD_NEON
+#    define NOISE_WIDTH 4
+typedef float32x4_t noise__vf;
+typedef int32x4_t noise__vi;
+#    define noise__fload(_p) vld1q_f32(_p)
+#    define noise__fstore(_p, _v) vst1q_f32((_p), (_v))
+#    define noise__fsplat(_f) vdupq_n_f32(_f)
+#    define noise__fadd(_a, _b) vaddq_f32((_a), (_b))
+#    define noise__fsub(_a, _b) vsubq_f32((_a), (_b))
+#    define noise__fmul(_a, _b) vmulq_f32((_a), (_b))
+#    define noise__ftoi(_a) vcvtq_s32_f32(_a)
+#    define noise__itof(_a) vcvtq_f32_s32(_a)
+#    define noise__iload(_p) vld1q_s32(_p)
+#    define noise__istore(_p, _v) vst1q_s32((_p), (_v))
+#    define noise__isplat(_i) vdupq_n_s32(_i)
+#    define noise__iand(_a, _b) vandq_s32((_a), (_b))
+#    define noise__islli(_a, _n) vshlq_n_s32((_a), (_n))
+#    define noise__fxor_sign(_f, _i) \
+        vreinterpretq_f32_s32(veorq_s32(vreinterpretq_s32_f32(_f), (_i)))
+#    define noise__ilt(_a, _b) vcltq_s32((_a), (_b))
+#    define noise__ieq(_a, _b) vceqq_s32((_a), (_b))
+#    define noise__mor(_a, _b) vorrq_u32((_a), (_b))
+#    define noise__fselect(_m, _a, _b) vbslq_f32((_m), (_a), (_b))
+static inline float32x4_t noise__iota(void)
+{
+    static const float iota[4] = { 0, 1.0f, 2.0f, 3.0f };
+    return vld1q_f32(iota);
+}
+static inline float32x4_t noise__ffloor(float32x4_t a)
+{
+    float32x4_t t = vcvtq_f32_s32(vcvtq_s32_f32(a));
+    uint32x4_t adj = vandq_u32(vcltq_f32(a, t), vreinterpretq_u32_f32(vdupq_n_f32(1.0f)));
+    return vsubq_f32(t, vreinterpretq_f32_u32(adj));
+}
+#endif
+
+#if NOISE_SIMD
+static inline noise__vf noise__fade_wide(noise__vf t)
+{
+    // t * t * t * (t * (t * 6 - 15) + 10)
+    noise__vf r = noise__fsub(noise__fmul(t, noise__fsplat(6.0f)), noise__fsplat(15.0f));
+    r = noise__fadd(noise__fmul(t, r), noise__fsplat(10.0f));
+    return noise__fmul(noise__fmul(noise__fmul(t, t), t), r);
+}
+
+// same formulation as sx_lerp: (1 - t) * a + t * b
+static inline noise__vf noise__lerp_wide(noise__vf a, noise__vf b, noise__vf t)
+{
+    return noise__fadd(noise__fmul(noise__fsub(noise__fsplat(1.0f), t), a), noise__fmul(t, b));
+}
+
+// branchless grad2: bit 0 of the hash flips the sign of x, bit 1 flips the sign of y
+static inline noise__vf noise__grad2_wide(noise__vi hash, noise__vf x, noise__vf y)
+{
+    noise__vi sx = noise__islli(noise__iand(hash, noise__isplat(1)), 31);
+    noise__vi sy = noise__islli(noise__iand(hash, noise__isplat(2)), 30);
+    return noise__fadd(noise__fxor_sign(x, sx), noise__fxor_sign(y, sy));
+}
+
+static inline noise__vf noise__perlin2d_wide(noise__vf x, noise__vf y)
+{
+    noise__vf fx = noise__ffloor(x);
+    noise__vf fy = noise__ffloor(y);
+    noise__vi mask = noise__isplat(0xff);
+
+    int hx[NOISE_WIDTH], hy[NOISE_WIDTH];
+    int h00[NOISE_WIDTH], h10[NOISE_WIDTH], h01[NOISE_WIDTH], h11[NOISE_WIDTH];
+    noise__istore(hx, noise__iand(noise__ftoi(fx), mask));
+    noise__istore(hy, noise__iand(noise__ftoi(fy), mask));
+    for (int i = 0; i < NOISE_WIDTH; i++) {
+        int a = (perm[hx[i] + 0] + hy[i]) & 0xff;
+        int b = (perm[hx[i] + 1] + hy[i]) & 0xff;
+        h00[i] = perm[a + 0];
+        h10[i] = perm[b + 0];
+        h01[i] = perm[a + 1];
+        h11[i] = perm[b + 1];
+    }
+
+    noise__vf one = noise__fsplat(1.0f);
+    x = noise__fsub(x, fx);
+    y = noise__fsub(y, fy);
+    noise__vf x1 = noise__fsub(x, one);
+    noise__vf y1 = noise__fsub(y, one);
+    noise__vf u = noise__fade_wide(x);
+    noise__vf v = noise__fade_wide(y);
+
+    noise__vf g00 = noise__grad2_wide(noise__iload(h00), x, y);
+    noise__vf g10 = noise__grad2_wide(noise__iload(h10), x1, y);
+    noise__vf g01 = noise__grad2_wide(noise__iload(h01), x, y1);
+    noise__vf g11 = noise__grad2_wide(noise__iload(h11), x1, y1);
+    return noise__lerp_wide(noise__lerp_wide(g00, g10, u), noise__lerp_wide(g01, g11, u), v);
+}
+
+// grad3 with selects instead of branches, same gradient table as the scalar version
+static inline noise__vf noise__grad3_wide(noise__vi hash, noise__vf x, noise__vf y, noise__vf z)
+{
+    noise__vi h = noise__iand(hash, noise__isplat(15));
+    noise__vf u = noise__fselect(noise__ilt(h, noise__isplat(8)), x, y);
+    noise__vf xz = noise__fselect(noise__mor(noise__ieq(h, noise__isplat(12)), noise__ieq(h, noise__isplat(14))), x, z);
+    noise__vf v = noise__fselect(noise__ilt(h, noise__isplat(4)), y, xz);
+    noise__vi su = noise__islli(noise__iand(h, noise__isplat(1)), 31);
+    noise__vi sv = noise__islli(noise__iand(h, noise__isplat(2)), 30);
+    return noise__fadd(noise__fxor_sign(u, su), noise__fxor_sign(v, sv));
+}
+
+static inline noise__vf noise__perlin3d_wide(noise__vf x, noise__vf y, noise__vf z)
+{
+    noise__vf fx = noise__ffloor(x);
+    noise__vf fy = noise__ffloor(y);
+    noise__vf fz = noise__ffloor(z);
+    noise__vi mask = noise__isplat(0xff);
+
+    int hx[NOISE_WIDTH], hy[NOISE_WIDTH], hz[NOISE_WIDTH];
+    int h000[NOISE_WIDTH], h100[NOISE_WIDTH], h010[NOISE_WIDTH], h110[NOISE_WIDTH];
+    int h001[NOISE_WIDTH], h101[NOISE_WIDTH], h011[NOISE_WIDTH], h111[NOISE_WIDTH];
+    noise__istore(hx, noise__iand(noise__ftoi(fx), mask));
+    noise__istore(hy, noise__iand(noise__ftoi(fy), mask));
+    noise__istore(hz, noise__iand(noise__ftoi(fz), mask));
+    for (int i = 0; i < NOISE_WIDTH; i++) {
+        int a = (perm[hx[i] + 0] + hy[i]) & 0xff;
+        int b = (perm[hx[i] + 1] + hy[i]) & 0xff;
+        int aa = (perm[a + 0] + hz[i]) & 0xff;
+        int ba = (perm[b + 0] + hz[i]) & 0xff;
+        int ab = (perm[a + 1] + hz[i]) & 0xff;
+        int bb = (perm[b + 1] + hz[i]) & 0xff;
+        h000[i] = perm[aa + 0];
+        h100[i] = perm[ba + 0];
+        h010[i] = perm[ab + 0];
+        h110[i] = perm[bb + 0];
+        h001[i] = perm[aa + 1];
+        h101[i] = perm[ba + 1];
+        h011[i] = perm[ab + 1];
+        h111[i] = perm[bb + 1];
+    }
+
+    noise__vf one = noise__fsplat(1.0f);
+    x = noise__fsub(x, fx);
+    y = noise__fsub(y, fy);
+    z = noise__fsub(z, fz);
+    noise__vf x1 = noise__fsub(x, one);
+    noise__vf y1 = noise__fsub(y, one);
+    noise__vf z1 = noise__fsub(z, one);
+    noise__vf u = noise__fade_wide(x);
+    noise__vf v = noise__fade_wide(y);
+    noise__vf s = noise__fade_wide(z);
+
+    noise__vf g000 = noise__grad3_wide(noise__iload(h000), x, y, z);
+    noise__vf g100 = noise__grad3_wide(noise__iload(h100), x1, y, z);
+    noise__vf g010 = noise__grad3_wide(noise__iload(h010), x, y1, z);
+    noise__vf g110 = noise__grad3_wide(noise__iload(h110), x1, y1, z);
+    noise__vf g001 = noise__grad3_wide(noise__iload(h001), x, y, z1);
+    noise__vf g101 = noise__grad3_wide(noise__iload(h101), x1, y, z1);
+    noise__vf g011 = noise__grad3_wide(noise__iload(h011), x, y1, z1);
+    noise__vf g111 = noise__grad3_wide(noise__iload(h111), x1, y1, z1);
+    return noise__lerp_wide(
+        noise__lerp_wide(noise__lerp_wide(g000, g100, u), noise__lerp_wide(g010, g110, u), v),
+        noise__lerp_wide(noise__lerp_wide(g001, g101, u), noise__lerp_wide(g011, g111, u), v), s);
+}
+
+static inline noise__vf noise__perlin3d_fbm_wide(noise__vf x, noise__vf y, noise__vf z, int octave)
+{
+    noise__vf f = noise__fsplat(0);
+    noise__vf two = noise__fsplat(2.0f);
+    float w = 0.5f;
+    for (int i = 0; i < octave; i++) {
+        f = noise__fadd(f, noise__fmul(noise__fsplat(w), noise__perlin3d_wide(x, y, z)));
+        x = noise__fmul(x, two);
+        y = noise__fmul(y, two);
+        z = noise__fmul(z, two);
+        w *= 0.5f;
+    }
+    return f;
+}
+
+static inline noise__vf noise__perlin2d_fbm_wide(noise__vf x, noise__vf y, int octave)
+{
+    noise__vf f = noise__fsplat(0);
+    noise__vf two = noise__fsplat(2.0f);
+    float w = 0.5f;
+    for (int i = 0; i < octave; i++) {
+        f = noise__fadd(f, noise__fmul(noise__fsplat(w), noise__perlin2d_wide(x, y)));
+        x = noise__fmul(x, two);
+        y = noise__fmul(y, two);
+        w *= 0.5f;
+    }
+    return f;
+}
+#endif    // NOISE_SIMD
+
+void noise__perlin2d_fbm_many(float* out, const float* xs, const float* ys, int count, int octave)
+{
+    sx_assert(out && xs && ys);
+
+    int i = 0;
+#if NOISE_SIMD
+    for (; i + NOISE_WIDTH <= count; i += NOISE_WIDTH) {
+        noise__fstore(&out[i],
+                      noise__perlin2d_fbm_wide(noise__fload(&xs[i]), noise__fload(&ys[i]), octave));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = noise__perlin2d_fbm(xs[i], ys[i], octave);
+    }
+}
+
+void noise__perlin3d_fbm_many(float* out, const float* xs, const float* ys, const float* zs,
+                              int count, int octave)
+{
+    sx_assert(out && xs && ys && zs);
+
+    int i = 0;
+#if NOISE_SIMD
+    for (; i + NOISE_WIDTH <= count; i += NOISE_WIDTH) {
+        noise__fstore(&out[i], noise__perlin3d_fbm_wide(noise__fload(&xs[i]), noise__fload(&ys[i]),
+                                                        noise__fload(&zs[i]), octave));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = noise__perlin3d_fbm(xs[i], ys[i], zs[i], octave);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Grid evaluation: out[(z*height + y)*width + x] = noise(origin + (x, y, z)*step)
+// 2d grids have a single slice (depth = 1)
+typedef enum noise__kind { NOISE_PERLIN = 0, NOISE_PERLIN3D, NOISE_SIMPLEX, NOISE_VALUE } noise__kind;
+
+typedef struct noise__grid_job {
+    float* out;
+    int width;
+    int height;
+    int depth;
+    sx_vec3 origin;
+    sx_vec3 step;
+    int octave;
+    noise__kind kind;
+} noise__grid_job;
+
+// rows of all slices are numbered continuously: row = z*height + y
+static void noise__grid_rows(const noise__grid_job* g, int row_start, int row_end)
+{
+    for (int r = row_start; r < row_end; r++) {
+        float y = g->origin.y + (float)(r % g->height) * g->step.y;
+        float z = g->origin.z + (float)(r / g->height) * g->step.z;
+        float* row = g->out + (size_t)r * (size_t)g->width;
+        int c = 0;
+
+        switch (g->kind) {
+        case NOISE_PERLIN: {
+#if NOISE_SIMD
+            noise__vf iota_step = noise__fmul(noise__iota(), noise__fsplat(g->step.x));
+            noise__vf yv = noise__fsplat(y);
+            for (; c + NOISE_WIDTH <= g->width; c += NOISE_WIDTH) {
+                noise__vf x = noise__fadd(noise__fsplat(g->origin.x + (float)c * g->step.x),
+                                          iota_step);
+                noise__fstore(&row[c], noise__perlin2d_fbm_wide(x, yv, g->octave));
+            }
+#endif
+            for (; c < g->width; c++) {
+                row[c] = noise__perlin2d_fbm(g->origin.x + (float)c * g->step.x, y, g->octave);
+            }
+            break;
+        }
+        case NOISE_PERLIN3D: {
+#if NOISE_SIMD
+            noise__vf iota_step = noise__fmul(noise__iota(), noise__fsplat(g->step.x));
+            noise__vf yv = noise__fsplat(y);
+            noise__vf zv = noise__fsplat(z);
+            for (; c + NOISE_WIDTH <= g->width; c += NOISE_WIDTH) {
+                noise__vf x = noise__fadd(noise__fsplat(g->origin.x + (float)c * g->step.x),
+                                          iota_step);
+                noise__fstore(&row[c], noise__perlin3d_fbm_wide(x, yv, zv, g->octave));
+            }
+#endif
+            for (; c < g->width; c++) {
+                row[c] = noise__perlin3d_fbm(g->origin.x + (float)c * g->step.x, y, z, g->octave);
+            }
+            break;
+        }
+        case NOISE_SIMPLEX:
+            for (; c < g->width; c++) {
+                row[c] = noise__simplex2d_fbm(g->origin.x + (float)c * g->step.x, y, g->octave);
+            }
+            break;
+        case NOISE_VALUE:
+            for (; c < g->width; c++) {
+                row[c] = noise__value2d_fbm(g->origin.x + (float)c * g->step.x, y, g->octave);
+            }
+            break;
+        }
+    }
+}
+
+static void noise__grid_job_cb(int start, int end, int thrd_index, void* user)
+{
+    sx_unused(thrd_index);
+    const noise__grid_job* g = user;
+    noise__grid_rows(g, start * NOISE_GRID_TILE_ROWS,
+                     sx_min(end * NOISE_GRID_TILE_ROWS, g->height * g->depth));
+}
+
+static void noise__grid(noise__kind kind, float* out, int width, int height, int depth,
+                        sx_vec3 origin, sx_vec3 step, int octave)
+{
+    sx_assert(out);
+    sx_assert(width >= 0 && height >= 0 && depth >= 0);
+    if (height == 0 || depth == 0) {
+        return;
+    }
+
+    noise__grid_job g = { .out = out,
+                          .width = width,
+                          .height = height,
+                          .depth = depth,
+                          .origin = origin,
+                          .step = step,
+                          .octave = octave,
+                          .kind = kind };
+
+    int num_rows = height * depth;
+    if (the_core && (int64_t)width * (int64_t)num_rows >= NOISE_GRID_JOB_THRESHOLD) {
+        int num_tiles = (num_rows + NOISE_GRID_TILE_ROWS - 1) / NOISE_GRID_TILE_ROWS;
+        sx_job_t job = the_core->job_dispatch(num_tiles, noise__grid_job_cb, &g,
+                                              SX_JOB_PRIORITY_HIGH, 0);
+        the_core->job_wait_and_del(job);
+    } else {
+        noise__grid_rows(&g, 0, num_rows);
+    }
+}
+
+void noise__perlin2d_grid(float* out, int width, int height, sx_vec2 origin, sx_vec2 step,
+                          int octave)
+{
+    noise__grid(NOISE_PERLIN, out, width, height, 1, sx_vec3f(origin.x, origin.y, 0),
+                sx_vec3f(step.x, step.y, 0), octave);
+}
+
+void noise__perlin3d_grid(float* out, int width, int height, int depth, sx_vec3 origin,
+                          sx_vec3 step, int octave)
+{
+    noise__grid(NOISE_PERLIN3D, out, width, height, depth, origin, step, octave);
+}
+
+void noise__simplex2d_grid(float* out, int width, int height, sx_vec2 origin, sx_vec2 step,
+                           int octave)
+{
+    noise__grid(NOISE_SIMPLEX, out, width, height, 1, sx_vec3f(origin.x, origin.y, 0),
+                sx_vec3f(step.x, step.y, 0), octave);
+}
+
+void noise__value2d_grid(float* out, int width, int height, sx_vec2 origin, sx_vec2 step,
+                         int octave)
+{
+    noise__grid(NOISE_VALUE, out, width, height, 1, sx_vec3f(origin.x, origin.y, 0),
+                sx_vec3f(step.x, step.y, 0), octave);
+}
+
+void noise__init(rizz_api_core* core)
+{
+    the_core = core;
+}
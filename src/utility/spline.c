@@ -1,5 +1,6 @@
 #include "rizz/utility.h"
 
+#include "sx/allocator.h"
 #include "sx/math-vec.h"
 
 static sx_vec3 bezier3d(sx_vec3 a, sx_vec3 b, sx_vec3 c, sx_vec3 d, float t)
@@ -30,28 +31,37 @@ static sx_vec2 bezier2d(sx_vec2 a, sx_vec2 b, sx_vec2 c, sx_vec2 d, float t)
     return sx_vec2_lerp(abc, bcd, t);
 }
 
-void spline__eval3d(const rizz_spline3d_desc* desc, sx_vec3* result)
+// maps spline time to the segment [a, b] and returns the local time inside the segment
+static inline float spline__find_segment(float t, int num_nodes, bool norm, bool loop, int* pa,
+                                         int* pb)
 {
-    float t = desc->time;
-    int num = desc->num_nodes;
-
-    if (desc->norm)
-        t *= (float)(num + (uint32_t)desc->loop);
+    if (norm)
+        t *= (float)(num_nodes + (int)loop);
 
     int a, b;
-    if (desc->loop) {
-        t = sx_mod(t, (float)desc->num_nodes);
+    if (loop) {
+        t = sx_mod(t, (float)num_nodes);
         a = (int)sx_floor(t);
         b = a + 1;
 
-        if (t >= (float)(desc->num_nodes - 1))
+        if (t >= (float)(num_nodes - 1))
             b = 0;
     } else {
-        t = sx_mod(t, (float)(desc->num_nodes - 1));
+        t = sx_mod(t, (float)(num_nodes - 1));
         a = (int)sx_floor(t);
         b = a + 1;
     }
 
+    *pa = a;
+    *pb = b;
+    return t - (float)a;
+}
+
+void spline__eval3d(const rizz_spline3d_desc* desc, sx_vec3* result)
+{
+    int a, b;
+    float t = spline__find_segment(desc->time, (int)desc->num_nodes, desc->norm, desc->loop, &a, &b);
+
     const rizz_spline3d_node* n1;
     const rizz_spline3d_node* n2;
 
@@ -63,7 +73,6 @@ void spline__eval3d(const rizz_spline3d_desc* desc, sx_vec3* result)
         n2 = (rizz_spline3d_node*)(((char*)desc->nodes) + desc->node_stride * b);
     }
 
-    t = t - (float)a;
     *result = bezier3d(n1->pos, sx_vec3_add(n1->pos, n1->rwing), sx_vec3_add(n2->pos, n2->lwing),
                        n2->pos, t);
     if (desc->usereval)
@@ -72,25 +81,8 @@ void spline__eval3d(const rizz_spline3d_desc* desc, sx_vec3* result)
 
 void spline__eval2d(const rizz_spline2d_desc* desc, sx_vec2* result)
 {
-    float t = desc->time;
-    int num = desc->num_nodes;
-
-    if (desc->norm)
-        t *= (float)(num + (uint32_t)desc->loop);
-
     int a, b;
-    if (desc->loop) {
-        t = sx_mod(t, (float)desc->num_nodes);
-        a = (int)sx_floor(t);
-        b = a + 1;
-
-        if (t >= (float)(desc->num_nodes - 1))
-            b = 0;
-    } else {
-        t = sx_mod(t, (float)(desc->num_nodes - 1));
-        a = (int)sx_floor(t);
-        b = a + 1;
-    }
+    float t = spline__find_segment(desc->time, (int)desc->num_nodes, desc->norm, desc->loop, &a, &b);
 
     const rizz_spline2d_node* n1;
     const rizz_spline2d_node* n2;
@@ -103,9 +95,238 @@ void spline__eval2d(const rizz_spline2d_desc* desc, sx_vec2* result)
         n2 = (rizz_spline2d_node*)(((char*)desc->nodes) + desc->node_stride * b);
     }
 
-    t = t - (float)a;
     *result = bezier2d(n1->pos, sx_vec2_add(n1->pos, n1->rwing), sx_vec2_add(n2->pos, n2->lwing),
                        n2->pos, t);
     if (desc->usereval)
         desc->usereval(n1, n2, t, result);
-}
\ No newline at end of file
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Evaluator: bezier segments are converted to polynomial form, c0 + c1*t + c2*t^2 + c3*t^3, so
+// each sample is 3 multiply-adds per component instead of 6 lerps. Samples are evaluated with all
+// components in one 4-float row: coefs[seg][coef][4]
+// arc-length table stores cumulative length at `arclen_res` uniform steps per segment
+typedef struct rizz_spline_evaluator {
+    int dims;
+    int num_nodes;
+    int num_segs;
+    int arclen_res;
+    bool norm;
+    bool loop;
+    float length;
+    float (*coefs)[4][4];
+    float* arclen;    // count = num_segs*arclen_res + 1
+} rizz_spline_evaluator;
+
+static rizz_spline_evaluator* spline__create_evaluator(int dims, const void* nodes, int num_nodes,
+                                                       int node_stride, bool norm, bool loop,
+                                                       int arclen_res, const sx_alloc* alloc)
+{
+    sx_assert(num_nodes > 1);
+    sx_assert(dims == 2 || dims == 3);
+
+    if (arclen_res <= 0) {
+        arclen_res = 16;
+    }
+
+    int num_segs = loop ? num_nodes : num_nodes - 1;
+    int num_arclen = num_segs * arclen_res + 1;
+    size_t total_sz = sizeof(rizz_spline_evaluator) + sizeof(float) * 16 * (size_t)num_segs +
+                      sizeof(float) * (size_t)num_arclen;
+    uint8_t* buff = sx_malloc(alloc, total_sz);
+    if (!buff) {
+        sx_out_of_memory();
+        return NULL;
+    }
+
+    rizz_spline_evaluator* ev = (rizz_spline_evaluator*)buff;
+    buff += sizeof(rizz_spline_evaluator);
+    *ev = (rizz_spline_evaluator){ .dims = dims,
+                                   .num_nodes = num_nodes,
+                                   .num_segs = num_segs,
+                                   .arclen_res = arclen_res,
+                                   .norm = norm,
+                                   .loop = loop };
+    ev->coefs = (float(*)[4][4])buff;
+    buff += sizeof(float) * 16 * num_segs;
+    ev->arclen = (float*)buff;
+
+    // node layout starts with pos, lwing, rwing for both 2d and 3d, see RIZZ_SPLINEXX_NODE_FIELDS
+    for (int i = 0; i < num_segs; i++) {
+        int j = (i + 1) % num_nodes;
+        const float* n1 = (const float*)((const uint8_t*)nodes + (size_t)node_stride * i);
+        const float* n2 = (const float*)((const uint8_t*)nodes + (size_t)node_stride * j);
+        float(*c)[4] = ev->coefs[i];
+        sx_memset(c, 0x0, sizeof(float) * 16);
+
+        for (int k = 0; k < dims; k++) {
+            float p0 = n1[k];
+            float p1 = n1[k] + n1[dims * 2 + k];    // pos + rwing
+            float p2 = n2[k] + n2[dims + k];        // pos + lwing
+            float p3 = n2[k];
+            c[0][k] = p0;
+            c[1][k] = 3.0f * (p1 - p0);
+            c[2][k] = 3.0f * (p2 - 2.0f * p1 + p0);
+            c[3][k] = p3 - p0 + 3.0f * (p1 - p2);
+        }
+    }
+
+    // arc-length table, straight line distances between uniform samples
+    float len = 0;
+    float prev[4];
+    float step = 1.0f / (float)arclen_res;
+    sx_memcpy(prev, ev->coefs[0][0], sizeof(prev));
+    ev->arclen[0] = 0;
+    for (int i = 0; i < num_segs; i++) {
+        const float(*c)[4] = ev->coefs[i];
+        for (int s = 1; s <= arclen_res; s++) {
+            float t = (float)s * step;
+            float d2 = 0;
+            for (int k = 0; k < 4; k++) {
+                float p = ((c[3][k] * t + c[2][k]) * t + c[1][k]) * t + c[0][k];
+                d2 += (p - prev[k]) * (p - prev[k]);
+                prev[k] = p;
+            }
+            len += sx_sqrt(d2);
+            ev->arclen[i * arclen_res + s] = len;
+        }
+    }
+    ev->length = len;
+
+    return ev;
+}
+
+rizz_spline_evaluator* spline__create_evaluator3d(const rizz_spline3d_desc* desc, int arclen_res,
+                                                  const sx_alloc* alloc)
+{
+    sx_assert(!desc->usereval && "custom evaluation is not supported with evaluator objects");
+    return spline__create_evaluator(
+        3, desc->nodes, (int)desc->num_nodes,
+        desc->node_stride ? (int)desc->node_stride : (int)sizeof(rizz_spline3d_node), desc->norm,
+        desc->loop, arclen_res, alloc);
+}
+
+rizz_spline_evaluator* spline__create_evaluator2d(const rizz_spline2d_desc* desc, int arclen_res,
+                                                  const sx_alloc* alloc)
+{
+    sx_assert(!desc->usereval && "custom evaluation is not supported with evaluator objects");
+    return spline__create_evaluator(
+        2, desc->nodes, (int)desc->num_nodes,
+        desc->node_stride ? (int)desc->node_stride : (int)sizeof(rizz_spline2d_node), desc->norm,
+        desc->loop, arclen_res, alloc);
+}
+
+void spline__destroy_evaluator(rizz_spline_evaluator* ev, const sx_alloc* alloc)
+{
+    sx_assert(ev);
+    sx_free(alloc, ev);
+}
+
+float spline__length(const rizz_spline_evaluator* ev)
+{
+    return ev->length;
+}
+
+static inline void spline__eval_poly(const rizz_spline_evaluator* ev, int seg, float t,
+                                     float* result)
+{
+    const float(*c)[4] = ev->coefs[seg];
+    float r[4];
+    t = sx_clamp(t, 0.0f, 1.0f);
+    for (int k = 0; k < 4; k++) {
+        r[k] = ((c[3][k] * t + c[2][k]) * t + c[1][k]) * t + c[0][k];
+    }
+    sx_memcpy(result, r, sizeof(float) * ev->dims);
+}
+
+static void spline__eval_many(const rizz_spline_evaluator* ev, const float* ts, float* results,
+                              int count)
+{
+    for (int i = 0; i < count; i++) {
+        int a, b;
+        float t = spline__find_segment(ts[i], ev->num_nodes, ev->norm, ev->loop, &a, &b);
+        spline__eval_poly(ev, a, t, results + i * ev->dims);
+    }
+}
+
+// constant-speed sampling: distance -> arc-length table -> segment time
+// The last found table index is kept between samples, so sorted distances are found by walking
+// forward a few entries and only unsorted ones fall back to binary search
+static void spline__eval_distance(const rizz_spline_evaluator* ev, const float* distances,
+                                  float* results, int count)
+{
+    const float* arclen = ev->arclen;
+    int last = ev->num_segs * ev->arclen_res;
+    int k = 0;
+
+    // all nodes are at the same position, every distance maps to the first node
+    if (ev->length <= 0) {
+        for (int i = 0; i < count; i++) {
+            spline__eval_poly(ev, 0, 0, results + i * ev->dims);
+        }
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        float d = distances[i];
+        if (ev->loop) {
+            d = sx_mod(d, ev->length);
+            if (d < 0) {
+                d += ev->length;
+            }
+        } else {
+            d = sx_clamp(d, 0.0f, ev->length);
+        }
+
+        if (d < arclen[k]) {
+            int lo = 0, hi = k;
+            while (lo < hi) {
+                int mid = (lo + hi + 1) >> 1;
+                if (arclen[mid] <= d)
+                    lo = mid;
+                else
+                    hi = mid - 1;
+            }
+            k = lo;
+        } else {
+            while (k < last - 1 && arclen[k + 1] <= d) {
+                k++;
+            }
+        }
+        k = sx_min(k, last - 1);
+
+        float seg_len = arclen[k + 1] - arclen[k];
+        float f = seg_len > 0 ? sx_clamp((d - arclen[k]) / seg_len, 0.0f, 1.0f) : 0;
+        int seg = k / ev->arclen_res;
+        float t = ((float)(k - seg * ev->arclen_res) + f) / (float)ev->arclen_res;
+        spline__eval_poly(ev, seg, t, results + i * ev->dims);
+    }
+}
+
+void spline__eval_many3d(const rizz_spline_evaluator* ev, const float* ts, sx_vec3* results,
+                         int count)
+{
+    sx_assert(ev->dims == 3);
+    spline__eval_many(ev, ts, results->f, count);
+}
+
+void spline__eval_many2d(const rizz_spline_evaluator* ev, const float* ts, sx_vec2* results,
+                         int count)
+{
+    sx_assert(ev->dims == 2);
+    spline__eval_many(ev, ts, results->f, count);
+}
+
+void spline__eval_distance3d(const rizz_spline_evaluator* ev, const float* distances,
+                             sx_vec3* results, int count)
+{
+    sx_assert(ev->dims == 3);
+    spline__eval_distance(ev, distances, results->f, count);
+}
+
+void spline__eval_distance2d(const rizz_spline_evaluator* ev, const float* distances,
+                             sx_vec2* results, int count)
+{
+    sx_assert(ev->dims == 2);
+    spline__eval_distance(ev, distances, results->f, count);
+}
@@ -5,6 +5,20 @@ RIZZ_STATE static rizz_api_plugin* the_plugin;
 
 void spline__eval2d(const rizz_spline2d_desc* desc, sx_vec2* result);
 void spline__eval3d(const rizz_spline3d_desc* desc, sx_vec3* result);
+rizz_spline_evaluator* spline__create_evaluator3d(const rizz_spline3d_desc* desc, int arclen_res,
+                                                  const sx_alloc* alloc);
+rizz_spline_evaluator* spline__create_evaluator2d(const rizz_spline2d_desc* desc, int arclen_res,
+                                                  const sx_alloc* alloc);
+void spline__destroy_evaluator(rizz_spline_evaluator* ev, const sx_alloc* alloc);
+float spline__length(const rizz_spline_evaluator* ev);
+void spline__eval_many3d(const rizz_spline_evaluator* ev, const float* ts, sx_vec3* results,
+                         int count);
+void spline__eval_many2d(const rizz_spline_evaluator* ev, const float* ts, sx_vec2* results,
+                         int count);
+void spline__eval_distance3d(const rizz_spline_evaluator* ev, const float* distances,
+                             sx_vec3* results, int count);
+void spline__eval_distance2d(const rizz_spline_evaluator* ev, const float* distances,
+                             sx_vec2* results, int count);
 
 float noise__perlin1d(float x);
 float noise__perlin2d(float x, float y);
@@ -12,12 +26,31 @@ float noise__perlin3d(float x, float y, float z);
 float noise__perlin1d_fbm(float x, int octave);
 float noise__perlin2d_fbm(float x, float y, int octave);
 float noise__perlin3d_fbm(float x, float y, float z, int octave);
+void noise__perlin2d_grid(float* out, int width, int height, sx_vec2 origin, sx_vec2 step,
+                          int octave);
+void noise__perlin2d_fbm_many(float* out, const float* xs, const float* ys, int count, int octave);
+void noise__perlin3d_grid(float* out, int width, int height, int depth, sx_vec3 origin,
+                          sx_vec3 step, int octave);
+void noise__perlin3d_fbm_many(float* out, const float* xs, const float* ys, const float* zs,
+                              int count, int octave);
+float noise__simplex2d(float x, float y);
+float noise__simplex2d_fbm(float x, float y, int octave);
+void noise__simplex2d_grid(float* out, int width, int height, sx_vec2 origin, sx_vec2 step,
+                           int octave);
+float noise__value2d(float x, float y);
+float noise__value2d_fbm(float x, float y, int octave);
+void noise__value2d_grid(float* out, int width, int height, sx_vec2 origin, sx_vec2 step,
+                         int octave);
+void noise__init(rizz_api_core* core);
 
 void gradient__init(rizz_gradient* gradient, sx_color start, sx_color end);
 bool gradient__add_key(rizz_gradient* gradient, rizz_gradient_key key);
 bool gradient__remove_key(rizz_gradient* gradient, int index);
 bool gradient__move_key(rizz_gradient* gradient, int index, float t);
 void gradient__eval(const rizz_gradient* gradient, float t, sx_color* outcolor);
+void gradient__bake(rizz_gradient* gradient);
+void gradient__eval_many(const rizz_gradient* gradient, const float* ts, sx_color* outcolors,
+                         int count);
 void gradient__edit(const rizz_api_imgui* gui, const char* label, rizz_gradient* gradient);
 
 void graph__init(rizz_graph* graph, float start, float end);
@@ -25,6 +58,8 @@ bool graph__add_key(rizz_graph* graph, rizz_graph_key key);
 bool graph__remove_key(rizz_graph* graph, int index);
 bool graph__move_key(rizz_graph* graph, int index, float t, float value);
 float graph__eval(const rizz_graph* graph, float t);
+void graph__bake(rizz_graph* graph);
+void graph__eval_many(const rizz_graph* graph, const float* ts, float* outvalues, int count);
 float graph__eval_remap(const rizz_graph* graph, float t, float t_min, float t_max, float v_min,
                         float v_max);
 void graph__edit(const rizz_api_imgui* gui, const char* label, rizz_graph* graph, sx_color color);
@@ -34,6 +69,14 @@ void graph__edit_multiple(const rizz_api_imgui* api, rizz_graph** graphs, const
 static rizz_api_utility the__utility = {
     .spline.eval2d = spline__eval2d,
     .spline.eval3d = spline__eval3d,
+    .spline.create_evaluator3d = spline__create_evaluator3d,
+    .spline.create_evaluator2d = spline__create_evaluator2d,
+    .spline.destroy_evaluator = spline__destroy_evaluator,
+    .spline.length = spline__length,
+    .spline.eval_many3d = spline__eval_many3d,
+    .spline.eval_many2d = spline__eval_many2d,
+    .spline.eval_distance3d = spline__eval_distance3d,
+    .spline.eval_distance2d = spline__eval_distance2d,
 
     .noise.perlin1d = noise__perlin1d,
     .noise.perlin2d = noise__perlin2d,
@@ -41,12 +84,24 @@ static rizz_api_utility the__utility = {
     .noise.perlin1d_fbm = noise__perlin1d_fbm,
     .noise.perlin2d_fbm = noise__perlin2d_fbm,
     .noise.perlin3d_fbm = noise__perlin3d_fbm,
+    .noise.perlin2d_grid = noise__perlin2d_grid,
+    .noise.perlin2d_fbm_many = noise__perlin2d_fbm_many,
+    .noise.perlin3d_grid = noise__perlin3d_grid,
+    .noise.perlin3d_fbm_many = noise__perlin3d_fbm_many,
+    .noise.simplex2d = noise__simplex2d,
+    .noise.simplex2d_fbm = noise__simplex2d_fbm,
+    .noise.simplex2d_grid = noise__simplex2d_grid,
+    .noise.value2d = noise__value2d,
+    .noise.value2d_fbm = noise__value2d_fbm,
+    .noise.value2d_grid = noise__value2d_grid,
 
     .gradient.init = gradient__init,
     .gradient.add_key = gradient__add_key,
     .gradient.remove_key = gradient__remove_key,
     .gradient.move_key = gradient__move_key,
     .gradient.eval = gradient__eval,
+    .gradient.bake = gradient__bake,
+    .gradient.eval_many = gradient__eval_many,
     .gradient.edit = gradient__edit,
 
     .graph.init = graph__init,
@@ -54,6 +109,8 @@ static rizz_api_utility the__utility = {
     .graph.remove_key = graph__remove_key,
     .graph.move_key = graph__move_key,
     .graph.eval = graph__eval,
+    .graph.bake = graph__bake,
+    .graph.eval_many = graph__eval_many,
     .graph.eval_remap = graph__eval_remap,
     .graph.edit = graph__edit,
     .graph.edit_multiple = graph__edit_multiple,
@@ -66,6 +123,7 @@ rizz_plugin_decl_main(utility, plugin, e)
         break;
     case RIZZ_PLUGIN_EVENT_INIT:
         the_plugin = plugin->api;
+        noise__init(the_plugin->get_api(RIZZ_API_CORE, 0));
 
         the_plugin->inject_api("utility", 0, &the__utility);
         break;